@@ -1,5 +1,7 @@
 #version 450
 
+layout(constant_id = 0) const bool TEXTURED = true;
+
 layout(binding = 1) uniform sampler2D texSampler;
 
 layout(location = 0) in vec3 fragColor;
@@ -8,5 +10,8 @@ layout(location = 1) in vec2 fragTexCoord;
 layout(location = 0) out vec4 outColor;
 
 void main() {
-    outColor = texture(texSampler, fragTexCoord) * vec4(fragColor, 1.0);
+    if(TEXTURED)
+        outColor = texture(texSampler, fragTexCoord) * vec4(fragColor, 1.0);
+    else
+        outColor = vec4(fragColor, 1.0);
 }
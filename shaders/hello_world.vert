@@ -1,11 +1,16 @@
 #version 450
 
+layout(constant_id = 1) const bool VERTEX_COLOR      = true;
+layout(constant_id = 2) const bool COMPRESSED_VERTEX = false;
+
 layout(binding = 0) uniform UniformBufferObject {
     vec3 color;
 } ubo;
 
 layout( push_constant ) uniform PushConstants {
     mat4 matrix;
+    uint textureIndex;
+    float positionScale;
 } pushConstant;
 
 layout(location = 0)  in vec3 inPosition;
@@ -16,7 +21,17 @@ layout(location = 0) out vec3 fragColor;
 layout(location = 1) out vec2 fragTexCoord;
 
 void main() {
-    gl_Position = pushConstant.matrix * vec4(inPosition, 1.0);
-    fragColor = inColor * ubo.color;
+    vec3 position = inPosition;
+
+    if(COMPRESSED_VERTEX)
+        position *= pushConstant.positionScale;
+
+    gl_Position = pushConstant.matrix * vec4(position, 1.0);
+
+    if(VERTEX_COLOR)
+        fragColor = inColor * ubo.color;
+    else
+        fragColor = ubo.color;
+
     fragTexCoord = inTexCoord;
 }
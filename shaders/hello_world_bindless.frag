@@ -0,0 +1,22 @@
+#version 450
+#extension GL_EXT_nonuniform_qualifier : require
+
+layout(constant_id = 0) const bool TEXTURED = true;
+
+layout(binding = 1) uniform sampler2D texSamplers[];
+
+layout( push_constant ) uniform PushConstants {
+    layout(offset = 64) uint textureIndex;
+} pushConstant;
+
+layout(location = 0) in vec3 fragColor;
+layout(location = 1) in vec2 fragTexCoord;
+
+layout(location = 0) out vec4 outColor;
+
+void main() {
+    if(TEXTURED)
+        outColor = texture(texSamplers[pushConstant.textureIndex], fragTexCoord) * vec4(fragColor, 1.0);
+    else
+        outColor = vec4(fragColor, 1.0);
+}
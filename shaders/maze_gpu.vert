@@ -0,0 +1,46 @@
+#version 450
+
+// hello_world.vert for the pieces that maze_gen.comp instanced. Each instance is a cell position instead of a matrix.
+
+layout(constant_id = 1) const bool VERTEX_COLOR      = true;
+layout(constant_id = 2) const bool COMPRESSED_VERTEX = false;
+
+layout(binding = 0) uniform UniformBufferObject {
+    vec3 color;
+} ubo;
+
+layout(std430, set = 1, binding = 0) readonly buffer Instances {
+    vec2 positions[];
+} instances;
+
+layout( push_constant ) uniform PushConstants {
+    mat4 matrix; // Only the view and the projection.
+    uint textureIndex;
+    float positionScale;
+} pushConstant;
+
+layout(location = 0)  in vec3 inPosition;
+layout(location = 1)  in vec3 inColor;
+layout(location = 2)  in vec2 inTexCoord;
+
+layout(location = 0) out vec3 fragColor;
+layout(location = 1) out vec2 fragTexCoord;
+
+void main() {
+    vec3 position = inPosition;
+
+    if(COMPRESSED_VERTEX)
+        position *= pushConstant.positionScale;
+
+    // gl_InstanceIndex starts at the firstInstance of the indirect draw, so it indexes the instances of the piece.
+    position += vec3(instances.positions[gl_InstanceIndex], -3.0); // V_MAZE_MESH_FLOOR_Z
+
+    gl_Position = pushConstant.matrix * vec4(position, 1.0);
+
+    if(VERTEX_COLOR)
+        fragColor = inColor * ubo.color;
+    else
+        fragColor = ubo.color;
+
+    fragTexCoord = inTexCoord;
+}
@@ -4,11 +4,16 @@
 #include "SDL.h"
 #include <vulkan/vulkan.h>
 
+#include "u_cache_def.h"
 #include "u_config_def.h"
 #include "v_buffer_def.h"
+#include "v_maze_def.h"
 #include "v_model_def.h"
+#include "v_pipeline_def.h"
+#include "v_world_def.h"
 
 #define MAX_FRAMES_IN_FLIGHT 2
+#define MAX_BINDLESS_TEXTURES 1024
 
 typedef struct Context {
     char title[64];
@@ -24,11 +29,17 @@ typedef struct Context {
     Matrix modelView;
 
     UConfig config;
+    UCache cache;
+    VWorld world;
+    VMazeStream mazeStream;
+    VMazeGpu mazeGpu;
 
     struct {
         VkDevice device;
         VkInstance instance;
+        uint32_t apiVersion;
         VkPhysicalDevice physicalDevice;
+        VkPhysicalDeviceFeatures enabledFeatures;
         VkQueueFamilyProperties *pQueueFamilyProperties;
         VkSurfaceKHR surface;
         uint32_t queueFamilyPropertyCount;
@@ -52,8 +63,17 @@ typedef struct Context {
 
         VkRenderPass renderPass;
         VkDescriptorSetLayout descriptorSetLayout;
+        VkDescriptorSetLayout instanceDescriptorSetLayout; // Set 1. The instances of the V_PIPELINE_GPU_INSTANCED variants.
         VkPipelineLayout pipelineLayout;
-        VkPipeline graphicsPipeline;
+        struct {
+            VkShaderModule vertexShaderModule;
+            VkShaderModule gpuInstancedShaderModule; // NULL if maze_gpu_vert.spv is missing. Then no V_PIPELINE_GPU_INSTANCED variant can be made.
+            VkShaderModule fragmentShaderModule;
+            VkPipeline variants[V_PIPELINE_VARIANT_AMOUNT];
+            SDL_atomic_t status[V_PIPELINE_VARIANT_AMOUNT]; // VPipelineStatus. Ready is only set after variants[] is written.
+            SDL_Thread *pCompileThreads[V_PIPELINE_VARIANT_AMOUNT];
+            VPipelineStats stats;
+        } pipelines;
 
         unsigned modelAmount;
         VModelData *pModels;
@@ -64,11 +84,19 @@ typedef struct Context {
 
         struct {
             uint32_t mipLevels;
+            VkFormat format;
             VkImage image;
             VkImageView imageView;
             VkDeviceMemory imageMemory;
+            uint32_t index; // The slot that this texture is registered to.
         } texture;
 
+        struct {
+            VkBool32 enabled; // VK_TRUE if binding 1 is a partially bound update after bind array.
+            uint32_t limit;   // The length of the texture array. One if bindless is not enabled.
+            uint32_t amount;  // The amount of slots that are registered.
+        } bindless;
+
         struct {
             VkSampleCountFlagBits samples;
             VkImage image;
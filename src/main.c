@@ -1,8 +1,11 @@
 #include "context.h"
 
+#include "u_cache.h"
 #include "u_config.h"
 #include "v_init.h"
+#include "v_maze.h"
 #include "v_render.h"
+#include "v_world.h"
 
 #include "SDL.h"
 
@@ -123,6 +126,11 @@ void loop() {
             context.modelView = MatrixMultiply(MatrixTranslate(context.position.x, context.position.y, context.position.z), QuaternionToMatrix(quaterion));
         }
 
+        if(context.config.current.worldMode)
+            v_world_update(&context);
+        else
+            v_maze_stream_update(&context);
+
         if(!isWindowMinimized) {
             vResult = v_render_frame(&context, delta);
 
@@ -144,6 +152,10 @@ int main(int argc, char **argv) {
         u_config_defaults(&context.config);
     }
 
+    if(!u_cache_open(&context.cache, "cache", U_CACHE_DEFAULT_SIZE_LIMIT)) {
+        SDL_Log("Assets will be processed without the cache");
+    }
+
     context.w = context.config.current.width;
     context.h = context.config.current.height;
 
@@ -181,6 +193,8 @@ int main(int argc, char **argv) {
     if(!u_config_save(&context.config, "config.ini")) {
     }
 
+    u_cache_close(&context.cache);
+
     v_init_dealloc(&context);
     SDL_DestroyWindow(context.pWindow);
 
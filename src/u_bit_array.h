@@ -14,9 +14,9 @@ typedef unsigned UBitElement;
 #define U_BIT_ARRAY_GET(array, index) ((array[index / U_BIT_ELEMENT_BIT_COUNT] >> (index % U_BIT_ELEMENT_BIT_COUNT)) & 1)
 
 #define U_BIT_ARRAY_SET(array, index, bitValue)\
-    array[index / U_BIT_ELEMENT_BIT_COUNT] &= (~((UBitElement)0)) ^ (1 << (index % U_BIT_ELEMENT_BIT_COUNT));\
+    array[index / U_BIT_ELEMENT_BIT_COUNT] &= (~((UBitElement)0)) ^ ((UBitElement)1 << (index % U_BIT_ELEMENT_BIT_COUNT));\
     if(bitValue == 1)\
-        array[index / U_BIT_ELEMENT_BIT_COUNT] |= (1 << (index % U_BIT_ELEMENT_BIT_COUNT))
+        array[index / U_BIT_ELEMENT_BIT_COUNT] |= ((UBitElement)1 << (index % U_BIT_ELEMENT_BIT_COUNT))
 
 
 #endif // U_BIT_ARRAY_29
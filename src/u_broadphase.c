@@ -0,0 +1,561 @@
+#include "u_broadphase.h"
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+static inline UBroadphaseAABB combine(const UBroadphaseAABB *pA, const UBroadphaseAABB *pB) {
+    return (UBroadphaseAABB){Vector3Min(pA->min, pB->min), Vector3Max(pA->max, pB->max)};
+}
+
+static inline int overlaps(const UBroadphaseAABB *pA, const UBroadphaseAABB *pB) {
+    return pA->min.x <= pB->max.x && pB->min.x <= pA->max.x &&
+           pA->min.y <= pB->max.y && pB->min.y <= pA->max.y &&
+           pA->min.z <= pB->max.z && pB->min.z <= pA->max.z;
+}
+
+static inline int contains(const UBroadphaseAABB *pOuter, const UBroadphaseAABB *pInner) {
+    return pOuter->min.x <= pInner->min.x && pOuter->min.y <= pInner->min.y && pOuter->min.z <= pInner->min.z &&
+           pInner->max.x <= pOuter->max.x && pInner->max.y <= pOuter->max.y && pInner->max.z <= pOuter->max.z;
+}
+
+static inline float surfaceArea(const UBroadphaseAABB *pAABB) {
+    const Vector3 size = Vector3Subtract(pAABB->max, pAABB->min);
+
+    return 2.0f * (size.x * size.y + size.y * size.z + size.z * size.x);
+}
+
+static int reservePairs(UBroadphasePair **ppPairs, uint32_t *pPairCapacity, uint32_t pairAmount);
+static int treeReserveNodes(UBroadphaseTree *this, uint32_t amount);
+static int treeReserveStack(UBroadphaseTree *this, uint32_t amount);
+static uint32_t treeAllocNode(UBroadphaseTree *this);
+static void treeFreeNode(UBroadphaseTree *this, uint32_t node);
+static void treeInsertLeaf(UBroadphaseTree *this, uint32_t leaf);
+static void treeRemoveLeaf(UBroadphaseTree *this, uint32_t leaf);
+static void treeRefit(UBroadphaseTree *this, uint32_t node);
+static uint32_t treeBalance(UBroadphaseTree *this, uint32_t node);
+
+UBroadphaseAABB u_broadphase_aabb_poly(const UCollisionPolyhedron *pPoly) {
+    assert(pPoly != NULL);
+    assert(pPoly->amountVertices != 0);
+
+    UBroadphaseAABB aabb = {pPoly->vertices[0], pPoly->vertices[0]};
+
+    for(size_t i = 1; i < pPoly->amountVertices; i++) {
+        aabb.min = Vector3Min(aabb.min, pPoly->vertices[i]);
+        aabb.max = Vector3Max(aabb.max, pPoly->vertices[i]);
+    }
+
+    return aabb;
+}
+
+UBroadphaseAABB u_broadphase_aabb_sphere(const UCollisionSphere *pSphere) {
+    assert(pSphere != NULL);
+
+    const Vector3 extent = {pSphere->radius, pSphere->radius, pSphere->radius};
+
+    return (UBroadphaseAABB){Vector3Subtract(pSphere->position, extent), Vector3Add(pSphere->position, extent)};
+}
+
+void u_broadphase_tree_init(UBroadphaseTree *this, float margin) {
+    assert(this != NULL);
+    assert(margin >= 0.0f);
+
+    memset(this, 0, sizeof(*this));
+
+    this->margin = margin;
+    this->root = U_BROADPHASE_NULL;
+    this->freeNode = U_BROADPHASE_NULL;
+}
+
+void u_broadphase_tree_free(UBroadphaseTree *this) {
+    free(this->pNodes);
+    free(this->pBoxes);
+    free(this->pStack);
+    free(this->pPairs);
+
+    u_broadphase_tree_init(this, this->margin);
+}
+
+uint32_t u_broadphase_tree_insert(UBroadphaseTree *this, const UBroadphaseAABB *pAABB) {
+    assert(this != NULL);
+    assert(pAABB != NULL);
+
+    // The leaf and the parent it gets are both reserved here, so nothing below can run out of memory.
+    if(!treeReserveNodes(this, 2))
+        return U_BROADPHASE_NULL;
+
+    const uint32_t leaf = treeAllocNode(this);
+    const Vector3 margin = {this->margin, this->margin, this->margin};
+    UBroadphaseNode *pLeaf = &this->pNodes[leaf];
+
+    pLeaf->aabb.min = Vector3Subtract(pAABB->min, margin);
+    pLeaf->aabb.max = Vector3Add(pAABB->max, margin);
+    pLeaf->children[0] = U_BROADPHASE_NULL;
+    pLeaf->children[1] = U_BROADPHASE_NULL;
+    pLeaf->height = 0;
+    this->pBoxes[leaf] = *pAABB;
+
+    treeInsertLeaf(this, leaf);
+
+    return leaf;
+}
+
+void u_broadphase_tree_remove(UBroadphaseTree *this, uint32_t proxy) {
+    assert(this != NULL);
+    assert(proxy < this->nodeAmount && this->pNodes[proxy].height == 0);
+
+    treeRemoveLeaf(this, proxy);
+    treeFreeNode(this, proxy);
+}
+
+int u_broadphase_tree_update(UBroadphaseTree *this, uint32_t proxy, const UBroadphaseAABB *pAABB) {
+    assert(this != NULL);
+    assert(pAABB != NULL);
+    assert(proxy < this->nodeAmount && this->pNodes[proxy].height == 0);
+
+    this->pBoxes[proxy] = *pAABB;
+
+    if(contains(&this->pNodes[proxy].aabb, pAABB))
+        return 0;
+
+    // Removing the leaf frees its parent, which the insert takes again.
+    const Vector3 margin = {this->margin, this->margin, this->margin};
+
+    treeRemoveLeaf(this, proxy);
+
+    this->pNodes[proxy].aabb.min = Vector3Subtract(pAABB->min, margin);
+    this->pNodes[proxy].aabb.max = Vector3Add(pAABB->max, margin);
+
+    treeInsertLeaf(this, proxy);
+
+    return 1;
+}
+
+int u_broadphase_tree_pairs(UBroadphaseTree *this) {
+    assert(this != NULL);
+
+    const UBroadphaseNode *pNodes = this->pNodes;
+    uint32_t stackAmount = 0;
+
+    this->pairAmount = 0;
+
+    if(this->root == U_BROADPHASE_NULL)
+        return 1;
+
+    if(!treeReserveStack(this, 2))
+        return 0;
+
+    // The tree descends against itself. A node against itself checks both of its children against themselves and each other, so every pair of nodes is only met once.
+    this->pStack[stackAmount++] = this->root;
+    this->pStack[stackAmount++] = this->root;
+
+    while(stackAmount != 0) {
+        const uint32_t node_1 = this->pStack[--stackAmount];
+        const uint32_t node_0 = this->pStack[--stackAmount];
+        const UBroadphaseNode *pNode_0 = &pNodes[node_0];
+        const UBroadphaseNode *pNode_1 = &pNodes[node_1];
+
+        if(!treeReserveStack(this, stackAmount + 6))
+            return 0;
+
+        if(node_0 == node_1) {
+            if(pNode_0->height == 0)
+                continue;
+
+            this->pStack[stackAmount++] = pNode_0->children[0];
+            this->pStack[stackAmount++] = pNode_0->children[0];
+            this->pStack[stackAmount++] = pNode_0->children[1];
+            this->pStack[stackAmount++] = pNode_0->children[1];
+            this->pStack[stackAmount++] = pNode_0->children[0];
+            this->pStack[stackAmount++] = pNode_0->children[1];
+            continue;
+        }
+
+        if(!overlaps(&pNode_0->aabb, &pNode_1->aabb))
+            continue;
+
+        if(pNode_0->height == 0 && pNode_1->height == 0) {
+            // The fat boxes overlapping is not enough, the boxes have to.
+            if(!overlaps(&this->pBoxes[node_0], &this->pBoxes[node_1]))
+                continue;
+
+            if(!reservePairs(&this->pPairs, &this->pairCapacity, this->pairAmount + 1))
+                return 0;
+
+            this->pPairs[this->pairAmount].proxies[0] = node_0 < node_1 ? node_0 : node_1;
+            this->pPairs[this->pairAmount].proxies[1] = node_0 < node_1 ? node_1 : node_0;
+            this->pairAmount++;
+            continue;
+        }
+
+        // Split the taller node, so both sides shrink at about the same rate.
+        if(pNode_1->height == 0 || (pNode_0->height != 0 && pNode_0->height >= pNode_1->height)) {
+            this->pStack[stackAmount++] = pNode_0->children[0];
+            this->pStack[stackAmount++] = node_1;
+            this->pStack[stackAmount++] = pNode_0->children[1];
+            this->pStack[stackAmount++] = node_1;
+        }
+        else {
+            this->pStack[stackAmount++] = node_0;
+            this->pStack[stackAmount++] = pNode_1->children[0];
+            this->pStack[stackAmount++] = node_0;
+            this->pStack[stackAmount++] = pNode_1->children[1];
+        }
+    }
+
+    return 1;
+}
+
+void u_broadphase_sweep_init(UBroadphaseSweep *this) {
+    assert(this != NULL);
+
+    memset(this, 0, sizeof(*this));
+
+    this->freeProxy = U_BROADPHASE_NULL;
+}
+
+void u_broadphase_sweep_free(UBroadphaseSweep *this) {
+    free(this->pBoxes);
+    free(this->pNextFree);
+    free(this->pOrder);
+    free(this->pPairs);
+
+    u_broadphase_sweep_init(this);
+}
+
+uint32_t u_broadphase_sweep_insert(UBroadphaseSweep *this, const UBroadphaseAABB *pAABB) {
+    assert(this != NULL);
+    assert(pAABB != NULL);
+
+    uint32_t proxy = this->freeProxy;
+
+    if(proxy != U_BROADPHASE_NULL)
+        this->freeProxy = this->pNextFree[proxy];
+    else {
+        if(this->proxyAmount == this->proxyCapacity) {
+            const uint32_t capacity = this->proxyCapacity == 0 ? 64 : 2 * this->proxyCapacity;
+            UBroadphaseAABB *pBoxes = realloc(this->pBoxes, capacity * sizeof(UBroadphaseAABB));
+
+            if(pBoxes == NULL)
+                return U_BROADPHASE_NULL;
+
+            this->pBoxes = pBoxes;
+
+            uint32_t *pNextFree = realloc(this->pNextFree, capacity * sizeof(uint32_t));
+
+            if(pNextFree == NULL)
+                return U_BROADPHASE_NULL;
+
+            this->pNextFree = pNextFree;
+
+            uint32_t *pOrder = realloc(this->pOrder, capacity * sizeof(uint32_t));
+
+            if(pOrder == NULL)
+                return U_BROADPHASE_NULL;
+
+            this->pOrder = pOrder;
+            this->proxyCapacity = capacity;
+        }
+
+        proxy = this->proxyAmount++;
+    }
+
+    this->pBoxes[proxy] = *pAABB;
+    this->pNextFree[proxy] = U_BROADPHASE_NULL;
+    this->pOrder[this->orderAmount++] = proxy;
+
+    return proxy;
+}
+
+void u_broadphase_sweep_remove(UBroadphaseSweep *this, uint32_t proxy) {
+    assert(this != NULL);
+    assert(proxy < this->proxyAmount && this->pNextFree[proxy] == U_BROADPHASE_NULL);
+
+    uint32_t index = 0;
+
+    while(this->pOrder[index] != proxy)
+        index++;
+
+    memmove(&this->pOrder[index], &this->pOrder[index + 1], (this->orderAmount - index - 1) * sizeof(uint32_t));
+    this->orderAmount--;
+
+    this->pNextFree[proxy] = this->freeProxy;
+    this->freeProxy = proxy;
+}
+
+void u_broadphase_sweep_update(UBroadphaseSweep *this, uint32_t proxy, const UBroadphaseAABB *pAABB) {
+    assert(this != NULL);
+    assert(pAABB != NULL);
+    assert(proxy < this->proxyAmount && this->pNextFree[proxy] == U_BROADPHASE_NULL);
+
+    this->pBoxes[proxy] = *pAABB;
+}
+
+int u_broadphase_sweep_pairs(UBroadphaseSweep *this) {
+    assert(this != NULL);
+
+    const UBroadphaseAABB *pBoxes = this->pBoxes;
+    uint32_t *pOrder = this->pOrder;
+
+    for(uint32_t i = 1; i < this->orderAmount; i++) {
+        const uint32_t proxy = pOrder[i];
+        const float minX = pBoxes[proxy].min.x;
+        uint32_t k = i;
+
+        for(; k != 0 && pBoxes[pOrder[k - 1]].min.x > minX; k--)
+            pOrder[k] = pOrder[k - 1];
+
+        pOrder[k] = proxy;
+    }
+
+    this->pairAmount = 0;
+
+    // Only the boxes that start before a box ends on x can overlap it.
+    for(uint32_t i = 0; i < this->orderAmount; i++) {
+        const UBroadphaseAABB *pBox = &pBoxes[pOrder[i]];
+
+        for(uint32_t k = i + 1; k < this->orderAmount && pBoxes[pOrder[k]].min.x <= pBox->max.x; k++) {
+            if(!overlaps(&pBoxes[pOrder[k]], pBox))
+                continue;
+
+            if(!reservePairs(&this->pPairs, &this->pairCapacity, this->pairAmount + 1))
+                return 0;
+
+            const uint32_t proxy_0 = pOrder[i];
+            const uint32_t proxy_1 = pOrder[k];
+
+            this->pPairs[this->pairAmount].proxies[0] = proxy_0 < proxy_1 ? proxy_0 : proxy_1;
+            this->pPairs[this->pairAmount].proxies[1] = proxy_0 < proxy_1 ? proxy_1 : proxy_0;
+            this->pairAmount++;
+        }
+    }
+
+    return 1;
+}
+
+static int reservePairs(UBroadphasePair **ppPairs, uint32_t *pPairCapacity, uint32_t pairAmount) {
+    if(pairAmount <= *pPairCapacity)
+        return 1;
+
+    const uint32_t capacity = *pPairCapacity == 0 ? 256 : 2 * *pPairCapacity;
+    UBroadphasePair *pPairs = realloc(*ppPairs, capacity * sizeof(UBroadphasePair));
+
+    if(pPairs == NULL)
+        return 0;
+
+    *ppPairs = pPairs;
+    *pPairCapacity = capacity;
+
+    return 1;
+}
+
+static int treeReserveNodes(UBroadphaseTree *this, uint32_t amount) {
+    if(this->nodeAmount + amount <= this->nodeCapacity)
+        return 1;
+
+    const uint32_t capacity = this->nodeCapacity == 0 ? 64 : 2 * this->nodeCapacity;
+
+    UBroadphaseNode *pNodes = realloc(this->pNodes, capacity * sizeof(UBroadphaseNode));
+
+    if(pNodes == NULL)
+        return 0;
+
+    this->pNodes = pNodes;
+
+    UBroadphaseAABB *pBoxes = realloc(this->pBoxes, capacity * sizeof(UBroadphaseAABB));
+
+    if(pBoxes == NULL)
+        return 0;
+
+    this->pBoxes = pBoxes;
+    this->nodeCapacity = capacity;
+
+    return 1;
+}
+
+static int treeReserveStack(UBroadphaseTree *this, uint32_t amount) {
+    if(amount <= this->stackCapacity)
+        return 1;
+
+    const uint32_t capacity = this->stackCapacity == 0 ? 256 : 2 * this->stackCapacity;
+    uint32_t *pStack = realloc(this->pStack, capacity * sizeof(uint32_t));
+
+    if(pStack == NULL)
+        return 0;
+
+    this->pStack = pStack;
+    this->stackCapacity = capacity;
+
+    return 1;
+}
+
+static uint32_t treeAllocNode(UBroadphaseTree *this) {
+    uint32_t node = this->freeNode;
+
+    if(node != U_BROADPHASE_NULL)
+        this->freeNode = this->pNodes[node].parent;
+    else
+        node = this->nodeAmount++;
+
+    this->pNodes[node].parent = U_BROADPHASE_NULL;
+
+    return node;
+}
+
+static void treeFreeNode(UBroadphaseTree *this, uint32_t node) {
+    this->pNodes[node].parent = this->freeNode;
+    this->pNodes[node].height = -1;
+    this->freeNode = node;
+}
+
+static void treeInsertLeaf(UBroadphaseTree *this, uint32_t leaf) {
+    UBroadphaseNode *pNodes = this->pNodes;
+
+    if(this->root == U_BROADPHASE_NULL) {
+        this->root = leaf;
+        pNodes[leaf].parent = U_BROADPHASE_NULL;
+        return;
+    }
+
+    // Walk down to the sibling that costs the least. Making a new parent over a node costs its new surface, and going below it also grows the surface of every node on the way.
+    const UBroadphaseAABB *pLeafAABB = &pNodes[leaf].aabb;
+    uint32_t sibling = this->root;
+
+    while(pNodes[sibling].height != 0) {
+        const UBroadphaseNode *pNode = &pNodes[sibling];
+        const UBroadphaseAABB combined = combine(&pNode->aabb, pLeafAABB);
+        const float combinedArea = surfaceArea(&combined);
+        const float cost = 2.0f * combinedArea;
+        const float inheritanceCost = 2.0f * (combinedArea - surfaceArea(&pNode->aabb));
+        float childCosts[2];
+
+        for(unsigned c = 0; c < 2; c++) {
+            const UBroadphaseNode *pChild = &pNodes[pNode->children[c]];
+            const UBroadphaseAABB childCombined = combine(&pChild->aabb, pLeafAABB);
+
+            childCosts[c] = surfaceArea(&childCombined) + inheritanceCost;
+
+            if(pChild->height != 0)
+                childCosts[c] -= surfaceArea(&pChild->aabb);
+        }
+
+        if(cost < childCosts[0] && cost < childCosts[1])
+            break;
+
+        sibling = pNode->children[childCosts[0] < childCosts[1] ? 0 : 1];
+    }
+
+    // The parent was reserved by u_broadphase_tree_insert() or freed by the remove of u_broadphase_tree_update().
+    const uint32_t oldParent = pNodes[sibling].parent;
+    const uint32_t newParent = treeAllocNode(this);
+
+    pNodes[newParent].parent = oldParent;
+    pNodes[newParent].aabb = combine(&pNodes[sibling].aabb, pLeafAABB);
+    pNodes[newParent].children[0] = sibling;
+    pNodes[newParent].children[1] = leaf;
+    pNodes[newParent].height = pNodes[sibling].height + 1;
+
+    if(oldParent == U_BROADPHASE_NULL)
+        this->root = newParent;
+    else if(pNodes[oldParent].children[0] == sibling)
+        pNodes[oldParent].children[0] = newParent;
+    else
+        pNodes[oldParent].children[1] = newParent;
+
+    pNodes[sibling].parent = newParent;
+    pNodes[leaf].parent = newParent;
+
+    treeRefit(this, pNodes[leaf].parent);
+}
+
+static void treeRemoveLeaf(UBroadphaseTree *this, uint32_t leaf) {
+    UBroadphaseNode *pNodes = this->pNodes;
+
+    if(leaf == this->root) {
+        this->root = U_BROADPHASE_NULL;
+        return;
+    }
+
+    // The sibling takes the place of the parent.
+    const uint32_t parent = pNodes[leaf].parent;
+    const uint32_t grandParent = pNodes[parent].parent;
+    const uint32_t sibling = pNodes[parent].children[pNodes[parent].children[0] == leaf ? 1 : 0];
+
+    pNodes[sibling].parent = grandParent;
+    treeFreeNode(this, parent);
+
+    if(grandParent == U_BROADPHASE_NULL) {
+        this->root = sibling;
+        return;
+    }
+
+    if(pNodes[grandParent].children[0] == parent)
+        pNodes[grandParent].children[0] = sibling;
+    else
+        pNodes[grandParent].children[1] = sibling;
+
+    treeRefit(this, grandParent);
+}
+
+static void treeRefit(UBroadphaseTree *this, uint32_t node) {
+    UBroadphaseNode *pNodes = this->pNodes;
+
+    while(node != U_BROADPHASE_NULL) {
+        node = treeBalance(this, node);
+
+        const UBroadphaseNode *pChild_0 = &pNodes[pNodes[node].children[0]];
+        const UBroadphaseNode *pChild_1 = &pNodes[pNodes[node].children[1]];
+
+        pNodes[node].aabb = combine(&pChild_0->aabb, &pChild_1->aabb);
+        pNodes[node].height = 1 + (pChild_0->height > pChild_1->height ? pChild_0->height : pChild_1->height);
+
+        node = pNodes[node].parent;
+    }
+}
+
+static uint32_t treeBalance(UBroadphaseTree *this, uint32_t a) {
+    UBroadphaseNode *pNodes = this->pNodes;
+    UBroadphaseNode *pA = &pNodes[a];
+
+    if(pA->height < 2)
+        return a;
+
+    // The taller child takes the place of a, and a takes the shorter grandchild of that side.
+    const int32_t balance = pNodes[pA->children[1]].height - pNodes[pA->children[0]].height;
+
+    if(balance >= -1 && balance <= 1)
+        return a;
+
+    const unsigned upSide = balance > 1 ? 1 : 0;
+    const uint32_t up = pA->children[upSide];
+    const uint32_t stay = pA->children[1 - upSide];
+    UBroadphaseNode *pUp = &pNodes[up];
+    const uint32_t grandChild_0 = pUp->children[0];
+    const uint32_t grandChild_1 = pUp->children[1];
+    const uint32_t taller  = pNodes[grandChild_0].height > pNodes[grandChild_1].height ? grandChild_0 : grandChild_1;
+    const uint32_t shorter = taller == grandChild_0 ? grandChild_1 : grandChild_0;
+
+    pUp->children[0] = a;
+    pUp->children[1] = taller;
+    pUp->parent = pA->parent;
+    pA->parent = up;
+
+    if(pUp->parent == U_BROADPHASE_NULL)
+        this->root = up;
+    else if(pNodes[pUp->parent].children[0] == a)
+        pNodes[pUp->parent].children[0] = up;
+    else
+        pNodes[pUp->parent].children[1] = up;
+
+    pA->children[upSide] = shorter;
+    pNodes[shorter].parent = a;
+
+    pA->aabb = combine(&pNodes[stay].aabb, &pNodes[shorter].aabb);
+    pA->height = 1 + (pNodes[stay].height > pNodes[shorter].height ? pNodes[stay].height : pNodes[shorter].height);
+
+    pUp->aabb = combine(&pA->aabb, &pNodes[taller].aabb);
+    pUp->height = 1 + (pA->height > pNodes[taller].height ? pA->height : pNodes[taller].height);
+
+    return up;
+}
@@ -0,0 +1,112 @@
+#ifndef U_BROADPHASE_29
+#define U_BROADPHASE_29
+
+#include "u_broadphase_def.h"
+#include "u_collision_def.h"
+
+/**
+ * @param pPoly The polyhedron to bound. @warning Do not put a zero point polyhedron.
+ * @return The smallest box around pPoly.
+ */
+UBroadphaseAABB u_broadphase_aabb_poly(const UCollisionPolyhedron *pPoly);
+
+/**
+ * @param pSphere The sphere to bound.
+ * @return The smallest box around pSphere.
+ */
+UBroadphaseAABB u_broadphase_aabb_sphere(const UCollisionSphere *pSphere);
+
+/**
+ * Make an empty dynamic AABB tree.
+ * @warning You are responsiable for calling u_broadphase_tree_free().
+ * @param this The tree to fill.
+ * @param margin How far the fat boxes of the leaves reach past their boxes. U_BROADPHASE_DEFAULT_MARGIN is a good start.
+ */
+void u_broadphase_tree_init(UBroadphaseTree *this, float margin);
+
+/**
+ * Free the nodes and the pairs of the tree.
+ * @param this The tree from u_broadphase_tree_init().
+ */
+void u_broadphase_tree_free(UBroadphaseTree *this);
+
+/**
+ * Add a box to the tree. Its leaf goes where it grows the surface of the tree the least and the tree is rotated on the way back up to stay balanced.
+ * @param this The tree from u_broadphase_tree_init().
+ * @param pAABB The box of the body.
+ * @return The proxy of the body, which stays the same until it is removed. U_BROADPHASE_NULL if memory ran out.
+ */
+uint32_t u_broadphase_tree_insert(UBroadphaseTree *this, const UBroadphaseAABB *pAABB);
+
+/**
+ * Remove a box from the tree.
+ * @param this The tree from u_broadphase_tree_init().
+ * @param proxy The proxy from u_broadphase_tree_insert(). It can be reused by a later insert.
+ */
+void u_broadphase_tree_remove(UBroadphaseTree *this, uint32_t proxy);
+
+/**
+ * Move the box of a body.
+ * @note As long as the box stays in the fat box of its leaf only the box is stored. Otherwise the leaf is moved to where the new fat box fits best, and the boxes of its old and new ancestors are refit on the way up.
+ * @param this The tree from u_broadphase_tree_init().
+ * @param proxy The proxy from u_broadphase_tree_insert().
+ * @param pAABB The new box of the body.
+ * @return 1 if the leaf was moved. 0 if it still fit in its fat box.
+ */
+int u_broadphase_tree_update(UBroadphaseTree *this, uint32_t proxy, const UBroadphaseAABB *pAABB);
+
+/**
+ * Find every pair of proxies whose boxes overlap. Only these pairs need u_collision_poly() or the other narrow tests.
+ * @note The tree is descended against itself and only pairs of nodes whose fat boxes overlap are opened, so this is about O(n log n) instead of the O(n * n) of testing every pair.
+ * @param this The tree from u_broadphase_tree_init().
+ * @return 1 if this->pPairs holds this->pairAmount pairs. 0 if memory ran out.
+ */
+int u_broadphase_tree_pairs(UBroadphaseTree *this);
+
+/**
+ * Make an empty sweep and prune.
+ * @note This is the other broadphase. It has no tree to keep balanced and its memory is flat, so it does well with small amounts of bodies spread along x. The tree is better for large or crowded scenes and for bodies stacked along x.
+ * @warning You are responsiable for calling u_broadphase_sweep_free().
+ * @param this The sweep to fill.
+ */
+void u_broadphase_sweep_init(UBroadphaseSweep *this);
+
+/**
+ * Free the proxies and the pairs of the sweep.
+ * @param this The sweep from u_broadphase_sweep_init().
+ */
+void u_broadphase_sweep_free(UBroadphaseSweep *this);
+
+/**
+ * Add a box to the sweep.
+ * @param this The sweep from u_broadphase_sweep_init().
+ * @param pAABB The box of the body.
+ * @return The proxy of the body, which stays the same until it is removed. U_BROADPHASE_NULL if memory ran out.
+ */
+uint32_t u_broadphase_sweep_insert(UBroadphaseSweep *this, const UBroadphaseAABB *pAABB);
+
+/**
+ * Remove a box from the sweep.
+ * @note This is O(n) because the proxy is taken out of the sorted order.
+ * @param this The sweep from u_broadphase_sweep_init().
+ * @param proxy The proxy from u_broadphase_sweep_insert(). It can be reused by a later insert.
+ */
+void u_broadphase_sweep_remove(UBroadphaseSweep *this, uint32_t proxy);
+
+/**
+ * Move the box of a body.
+ * @param this The sweep from u_broadphase_sweep_init().
+ * @param proxy The proxy from u_broadphase_sweep_insert().
+ * @param pAABB The new box of the body.
+ */
+void u_broadphase_sweep_update(UBroadphaseSweep *this, uint32_t proxy, const UBroadphaseAABB *pAABB);
+
+/**
+ * Find every pair of proxies whose boxes overlap.
+ * @note The order by min.x from the last call is fixed with an insertion sort, which is close to O(n) when the bodies only moved a little. Then a sweep only tests boxes that overlap on x.
+ * @param this The sweep from u_broadphase_sweep_init().
+ * @return 1 if this->pPairs holds this->pairAmount pairs. 0 if memory ran out.
+ */
+int u_broadphase_sweep_pairs(UBroadphaseSweep *this);
+
+#endif // U_BROADPHASE_29
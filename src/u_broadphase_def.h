@@ -0,0 +1,62 @@
+#ifndef U_BROADPHASE_DEF_29
+#define U_BROADPHASE_DEF_29
+
+#include "raymath.h"
+
+#include <stdint.h>
+
+#define U_BROADPHASE_NULL UINT32_MAX
+
+// How far the fat box of a tree leaf reaches past its box. A body that moves less than this does not touch the tree.
+#define U_BROADPHASE_DEFAULT_MARGIN 0.1f
+
+typedef struct UBroadphaseAABB {
+    Vector3 min;
+    Vector3 max;
+} UBroadphaseAABB;
+
+typedef struct UBroadphasePair {
+    uint32_t proxies[2]; // The smaller proxy is first.
+} UBroadphasePair;
+
+typedef struct UBroadphaseNode {
+    UBroadphaseAABB aabb; // The fat box of a leaf or the box around both children.
+    uint32_t parent;      // The next free node if this node is free.
+    uint32_t children[2]; // U_BROADPHASE_NULL for leaves.
+    int32_t  height;      // 0 for leaves and -1 for free nodes.
+} UBroadphaseNode;
+
+typedef struct UBroadphaseTree {
+    float margin;
+    uint32_t root;
+
+    uint32_t nodeAmount;
+    uint32_t nodeCapacity;
+    uint32_t freeNode;
+    UBroadphaseNode *pNodes;
+    UBroadphaseAABB *pBoxes; // The box of every leaf by node. The proxies of the tree are its leaves.
+
+    uint32_t stackCapacity;
+    uint32_t *pStack; // Search memory of u_broadphase_tree_pairs(). It holds pairs of nodes.
+
+    uint32_t pairAmount;
+    uint32_t pairCapacity;
+    UBroadphasePair *pPairs; // The result of u_broadphase_tree_pairs(). It is valid until the next call.
+} UBroadphaseTree;
+
+typedef struct UBroadphaseSweep {
+    uint32_t proxyAmount;
+    uint32_t proxyCapacity;
+    uint32_t freeProxy;
+    UBroadphaseAABB *pBoxes;
+    uint32_t *pNextFree; // U_BROADPHASE_NULL for proxies that are in use.
+
+    uint32_t orderAmount;
+    uint32_t *pOrder; // The proxies in use by min.x. It is kept between calls, so sorting only has to fix what moved.
+
+    uint32_t pairAmount;
+    uint32_t pairCapacity;
+    UBroadphasePair *pPairs; // The result of u_broadphase_sweep_pairs(). It is valid until the next call.
+} UBroadphaseSweep;
+
+#endif // U_BROADPHASE_DEF_29
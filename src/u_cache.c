@@ -0,0 +1,385 @@
+#include "u_cache.h"
+
+#include "SDL_rwops.h"
+#include "SDL_log.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#endif
+
+#define INDEX_MAGIC 0x31494355 // "UCI1"
+#define ENTRY_MAGIC 0x31454355 // "UCE1"
+
+// Bump this when the layout of any derived data changes, so that old entries are never matched.
+#define CACHE_VERSION 1
+
+static const uint64_t PRIME64_1 = 0x9E3779B185EBCA87ULL;
+static const uint64_t PRIME64_2 = 0xC2B2AE3D27D4EB4FULL;
+static const uint64_t PRIME64_3 = 0x165667B19E3779F9ULL;
+static const uint64_t PRIME64_4 = 0x85EBCA77C2B2AE63ULL;
+static const uint64_t PRIME64_5 = 0x27D4EB2F165667C5ULL;
+
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t key;
+    uint64_t size;
+} EntryHeader;
+
+static inline uint64_t rotateLeft(uint64_t value, unsigned amount);
+static inline uint64_t read64(const uint8_t *pData);
+static inline uint32_t read32(const uint8_t *pData);
+static inline uint64_t hashRound(uint64_t accumulator, uint64_t input);
+static inline uint64_t hashMergeRound(uint64_t accumulator, uint64_t value);
+static void entryPath(const UCache *this, uint64_t key, char *pPath, size_t pathSize);
+static UCacheEntry* findEntry(UCache *this, uint64_t key);
+static void removeEntry(UCache *this, UCacheEntry *pEntry, int deleteFile);
+static SDL_RWops* openEntry(UCache *this, uint64_t key, uint64_t *pSize);
+
+uint64_t u_cache_hash(const void *pData, size_t size, uint64_t seed) {
+    const uint8_t *pBytes = pData;
+    const uint8_t *const pEnd = pBytes + size;
+    uint64_t hash;
+
+    if(size >= 32) {
+        const uint8_t *const pLimit = pEnd - 32;
+        uint64_t v1 = seed + PRIME64_1 + PRIME64_2;
+        uint64_t v2 = seed + PRIME64_2;
+        uint64_t v3 = seed;
+        uint64_t v4 = seed - PRIME64_1;
+
+        do {
+            v1 = hashRound(v1, read64(pBytes +  0));
+            v2 = hashRound(v2, read64(pBytes +  8));
+            v3 = hashRound(v3, read64(pBytes + 16));
+            v4 = hashRound(v4, read64(pBytes + 24));
+            pBytes += 32;
+        } while(pBytes <= pLimit);
+
+        hash = rotateLeft(v1, 1) + rotateLeft(v2, 7) + rotateLeft(v3, 12) + rotateLeft(v4, 18);
+        hash = hashMergeRound(hash, v1);
+        hash = hashMergeRound(hash, v2);
+        hash = hashMergeRound(hash, v3);
+        hash = hashMergeRound(hash, v4);
+    }
+    else
+        hash = seed + PRIME64_5;
+
+    hash += (uint64_t)size;
+
+    while(pBytes + 8 <= pEnd) {
+        hash ^= hashRound(0, read64(pBytes));
+        hash  = rotateLeft(hash, 27) * PRIME64_1 + PRIME64_4;
+        pBytes += 8;
+    }
+
+    if(pBytes + 4 <= pEnd) {
+        hash ^= (uint64_t)read32(pBytes) * PRIME64_1;
+        hash  = rotateLeft(hash, 23) * PRIME64_2 + PRIME64_3;
+        pBytes += 4;
+    }
+
+    while(pBytes < pEnd) {
+        hash ^= (*pBytes) * PRIME64_5;
+        hash  = rotateLeft(hash, 11) * PRIME64_1;
+        pBytes++;
+    }
+
+    hash ^= hash >> 33;
+    hash *= PRIME64_2;
+    hash ^= hash >> 29;
+    hash *= PRIME64_3;
+    hash ^= hash >> 32;
+
+    return hash;
+}
+
+uint64_t u_cache_key(const void *pSource, size_t sourceSize, const void *pOptions, size_t optionsSize) {
+    return u_cache_hash(pOptions, optionsSize, u_cache_hash(pSource, sourceSize, CACHE_VERSION));
+}
+
+int u_cache_open(UCache *this, const char *const pUTF8Directory, uint64_t sizeLimit) {
+    memset(this, 0, sizeof(*this));
+
+    this->sizeLimit = sizeLimit;
+
+    if(snprintf(this->directory, sizeof(this->directory), "%s", pUTF8Directory) >= (int)sizeof(this->directory)) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "u_cache_open: \"%s\" is too long for a cache directory", pUTF8Directory);
+        this->directory[0] = '\0';
+        return 0;
+    }
+
+#ifdef _WIN32
+    _mkdir(this->directory);
+#else
+    mkdir(this->directory, 0755);
+#endif
+
+    char path[sizeof(this->directory) + 16];
+    snprintf(path, sizeof(path), "%s/index.bin", this->directory);
+
+    SDL_RWops *pRead = SDL_RWFromFile(path, "rb");
+
+    if(pRead == NULL) {
+        // Check that the directory can be written to. Otherwise every store would fail later on.
+        // An empty index is written, so that the next launch does not find a damaged one if this one never closes the cache.
+        SDL_RWops *pWrite = SDL_RWFromFile(path, "wb");
+        uint32_t emptyHeader[2] = {INDEX_MAGIC, 0};
+
+        if(pWrite == NULL || SDL_RWwrite(pWrite, emptyHeader, sizeof(emptyHeader), 1) != 1) {
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "u_cache_open: Cannot use \"%s\" as a cache directory", this->directory);
+            if(pWrite != NULL)
+                SDL_RWclose(pWrite);
+            this->directory[0] = '\0';
+            return 0;
+        }
+        SDL_RWclose(pWrite);
+        return 1;
+    }
+
+    uint32_t header[2] = {0, 0};
+
+    if(SDL_RWread(pRead, header, sizeof(header), 1) != 1 || header[0] != INDEX_MAGIC || header[1] > U_CACHE_MAX_ENTRIES ||
+       (header[1] != 0 && SDL_RWread(pRead, this->entries, sizeof(this->entries[0]) * header[1], 1) != 1)) {
+        SDL_Log("u_cache_open: The index of \"%s\" is damaged. The cache starts empty", this->directory);
+        SDL_RWclose(pRead);
+        return 1;
+    }
+    SDL_RWclose(pRead);
+
+    this->entryAmount = header[1];
+
+    for(unsigned i = 0; i < this->entryAmount; i++) {
+        this->totalSize += this->entries[i].size + sizeof(EntryHeader);
+
+        if(this->entries[i].lastUse >= this->useCounter)
+            this->useCounter = this->entries[i].lastUse + 1;
+    }
+
+    return 1;
+}
+
+int u_cache_close(UCache *this) {
+    SDL_Log("Asset cache: %lu hits, %lu misses, %lu bytes saved, %lu bytes stored, %lu evictions",
+        (unsigned long)this->stats.hits, (unsigned long)this->stats.misses, (unsigned long)this->stats.bytesSaved,
+        (unsigned long)this->stats.bytesStored, (unsigned long)this->stats.evictions);
+
+    if(this->directory[0] == '\0')
+        return 0;
+
+    char path[sizeof(this->directory) + 16];
+    snprintf(path, sizeof(path), "%s/index.bin", this->directory);
+
+    SDL_RWops *pWrite = SDL_RWFromFile(path, "wb");
+
+    if(pWrite == NULL) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "u_cache_close: Cannot write \"%s\"", path);
+        return 0;
+    }
+
+    const uint32_t header[2] = {INDEX_MAGIC, this->entryAmount};
+    int written = SDL_RWwrite(pWrite, header, sizeof(header), 1) == 1;
+
+    if(written && this->entryAmount != 0)
+        written = SDL_RWwrite(pWrite, this->entries, sizeof(this->entries[0]) * this->entryAmount, 1) == 1;
+
+    SDL_RWclose(pWrite);
+
+    return written;
+}
+
+void* u_cache_load(UCache *this, uint64_t key, uint64_t *pSize) {
+    *pSize = 0;
+
+    uint64_t size;
+    SDL_RWops *pRead = openEntry(this, key, &size);
+
+    if(pRead == NULL)
+        return NULL;
+
+    void *pData = malloc(size == 0 ? 1 : size);
+
+    if(pData == NULL || (size != 0 && SDL_RWread(pRead, pData, size, 1) != 1)) {
+        SDL_RWclose(pRead);
+        free(pData);
+        removeEntry(this, findEntry(this, key), 1);
+        this->stats.misses++;
+        return NULL;
+    }
+    SDL_RWclose(pRead);
+
+    this->stats.hits++;
+    this->stats.bytesSaved += size;
+    *pSize = size;
+    return pData;
+}
+
+int u_cache_read(UCache *this, uint64_t key, void *pDestination, uint64_t size) {
+    uint64_t entrySize;
+    SDL_RWops *pRead = openEntry(this, key, &entrySize);
+
+    if(pRead == NULL)
+        return 0;
+
+    if(entrySize != size || (size != 0 && SDL_RWread(pRead, pDestination, size, 1) != 1)) {
+        SDL_RWclose(pRead);
+        removeEntry(this, findEntry(this, key), 1);
+        this->stats.misses++;
+        return 0;
+    }
+    SDL_RWclose(pRead);
+
+    this->stats.hits++;
+    this->stats.bytesSaved += size;
+    return 1;
+}
+
+int u_cache_store(UCache *this, uint64_t key, const void *pData, uint64_t size) {
+    const uint64_t fileSize = size + sizeof(EntryHeader);
+
+    if(this->directory[0] == '\0' || fileSize > this->sizeLimit)
+        return 0;
+
+    UCacheEntry *pEntry = findEntry(this, key);
+
+    if(pEntry != NULL)
+        removeEntry(this, pEntry, 0); // The file is overwritten below.
+
+    // Evict the least recently used entries until the new one fits.
+    while(this->entryAmount != 0 && (this->totalSize + fileSize > this->sizeLimit || this->entryAmount == U_CACHE_MAX_ENTRIES)) {
+        UCacheEntry *pOldest = &this->entries[0];
+
+        for(unsigned i = 1; i < this->entryAmount; i++) {
+            if(this->entries[i].lastUse < pOldest->lastUse)
+                pOldest = &this->entries[i];
+        }
+
+        removeEntry(this, pOldest, 1);
+        this->stats.evictions++;
+    }
+
+    char path[sizeof(this->directory) + 24];
+    entryPath(this, key, path, sizeof(path));
+
+    SDL_RWops *pWrite = SDL_RWFromFile(path, "wb");
+
+    if(pWrite == NULL) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "u_cache_store: Cannot write \"%s\"", path);
+        return 0;
+    }
+
+    const EntryHeader entryHeader = {ENTRY_MAGIC, CACHE_VERSION, key, size};
+    int written = SDL_RWwrite(pWrite, &entryHeader, sizeof(entryHeader), 1) == 1;
+
+    if(written && size != 0)
+        written = SDL_RWwrite(pWrite, pData, size, 1) == 1;
+
+    SDL_RWclose(pWrite);
+
+    if(!written) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "u_cache_store: Failed to write %lu bytes to \"%s\"", (unsigned long)fileSize, path);
+        remove(path);
+        return 0;
+    }
+
+    pEntry = &this->entries[this->entryAmount];
+    pEntry->key = key;
+    pEntry->size = size;
+    pEntry->lastUse = this->useCounter++;
+    this->entryAmount++;
+    this->totalSize += fileSize;
+
+    this->stats.bytesStored += size;
+    return 1;
+}
+
+static inline uint64_t rotateLeft(uint64_t value, unsigned amount) {
+    return (value << amount) | (value >> (64 - amount));
+}
+
+static inline uint64_t read64(const uint8_t *pData) {
+    uint64_t value;
+    memcpy(&value, pData, sizeof(value));
+    return value;
+}
+
+static inline uint32_t read32(const uint8_t *pData) {
+    uint32_t value;
+    memcpy(&value, pData, sizeof(value));
+    return value;
+}
+
+static inline uint64_t hashRound(uint64_t accumulator, uint64_t input) {
+    accumulator += input * PRIME64_2;
+    accumulator  = rotateLeft(accumulator, 31);
+    return accumulator * PRIME64_1;
+}
+
+static inline uint64_t hashMergeRound(uint64_t accumulator, uint64_t value) {
+    accumulator ^= hashRound(0, value);
+    return accumulator * PRIME64_1 + PRIME64_4;
+}
+
+static void entryPath(const UCache *this, uint64_t key, char *pPath, size_t pathSize) {
+    snprintf(pPath, pathSize, "%s/%08lx%08lx.bin", this->directory, (unsigned long)(key >> 32), (unsigned long)(key & 0xFFFFFFFF));
+}
+
+static UCacheEntry* findEntry(UCache *this, uint64_t key) {
+    for(unsigned i = 0; i < this->entryAmount; i++) {
+        if(this->entries[i].key == key)
+            return &this->entries[i];
+    }
+    return NULL;
+}
+
+static void removeEntry(UCache *this, UCacheEntry *pEntry, int deleteFile) {
+    if(pEntry == NULL)
+        return;
+
+    if(deleteFile) {
+        char path[sizeof(this->directory) + 24];
+        entryPath(this, pEntry->key, path, sizeof(path));
+        remove(path);
+    }
+
+    this->totalSize -= pEntry->size + sizeof(EntryHeader);
+    this->entryAmount--;
+    *pEntry = this->entries[this->entryAmount];
+}
+
+static SDL_RWops* openEntry(UCache *this, uint64_t key, uint64_t *pSize) {
+    UCacheEntry *pEntry = findEntry(this, key);
+
+    if(this->directory[0] == '\0' || pEntry == NULL) {
+        this->stats.misses++;
+        return NULL;
+    }
+
+    char path[sizeof(this->directory) + 24];
+    entryPath(this, key, path, sizeof(path));
+
+    SDL_RWops *pRead = SDL_RWFromFile(path, "rb");
+    EntryHeader entryHeader;
+
+    if(pRead == NULL || SDL_RWread(pRead, &entryHeader, sizeof(entryHeader), 1) != 1 ||
+       entryHeader.magic != ENTRY_MAGIC || entryHeader.version != CACHE_VERSION || entryHeader.key != key || entryHeader.size != pEntry->size) {
+        SDL_Log("u_cache: \"%s\" is missing or damaged", path);
+
+        if(pRead != NULL)
+            SDL_RWclose(pRead);
+
+        removeEntry(this, pEntry, 1);
+        this->stats.misses++;
+        return NULL;
+    }
+
+    pEntry->lastUse = this->useCounter++;
+    *pSize = entryHeader.size;
+    return pRead;
+}
@@ -0,0 +1,74 @@
+#ifndef U_CACHE_29
+#define U_CACHE_29
+
+#include "u_cache_def.h"
+
+#include <stddef.h>
+
+/**
+ * Hash a block of memory with XXH64.
+ * @param pData The bytes to hash.
+ * @param size The amount of bytes in pData.
+ * @param seed The seed of the hash. Chaining the previous hash as the seed combines several blocks.
+ * @return The 64-bit hash.
+ */
+uint64_t u_cache_hash(const void *pData, size_t size, uint64_t seed);
+
+/**
+ * Make the key of a derived asset from the content of its source and the options it was processed with.
+ * @param pSource The content of the source file.
+ * @param sourceSize The size of pSource in bytes.
+ * @param pOptions The processing options. Anything that changes the derived data must be in here.
+ * @param optionsSize The size of pOptions in bytes.
+ * @return The key for u_cache_load(), u_cache_read() and u_cache_store().
+ */
+uint64_t u_cache_key(const void *pSource, size_t sourceSize, const void *pOptions, size_t optionsSize);
+
+/**
+ * Open a cache directory and read its index. The directory is created if it does not exist.
+ * @note A missing or damaged index only empties the cache.
+ * @param this The UCache to fill.
+ * @param pUTF8Directory The path of the cache directory. It is encoded with unicode.
+ * @param sizeLimit The amount of bytes the cache may hold before the least recently used entries are evicted.
+ * @return 1 if the cache can be used. 0 if the directory could not be made, in that case every lookup misses.
+ */
+int u_cache_open(UCache *this, const char *const pUTF8Directory, uint64_t sizeLimit);
+
+/**
+ * Write the index of the cache and log its statistics.
+ * @param this The UCache that was filled by u_cache_open().
+ * @return 1 if the index was written. 0 if otherwise.
+ */
+int u_cache_close(UCache *this);
+
+/**
+ * Read derived data from the cache into a new buffer.
+ * @warning If this function returns a pointer you are responsiable for freeing the returned pointer.
+ * @param this The UCache that was filled by u_cache_open().
+ * @param key The key from u_cache_key().
+ * @param pSize Returns the size of the data in bytes.
+ * @return A valid pointer to the buffer that YOU MUST free() or a null on a miss.
+ */
+void* u_cache_load(UCache *this, uint64_t key, uint64_t *pSize);
+
+/**
+ * Read derived data of a known size from the cache straight into a destination.
+ * @param this The UCache that was filled by u_cache_open().
+ * @param key The key from u_cache_key().
+ * @param pDestination The buffer to write to. It can be mapped Vulkan memory.
+ * @param size The expected size of the data in bytes. An entry with a different size is a miss.
+ * @return 1 if pDestination is filled. 0 on a miss.
+ */
+int u_cache_read(UCache *this, uint64_t key, void *pDestination, uint64_t size);
+
+/**
+ * Store derived data in the cache. The least recently used entries are evicted to keep under the size limit.
+ * @param this The UCache that was filled by u_cache_open().
+ * @param key The key from u_cache_key().
+ * @param pData The derived data.
+ * @param size The size of pData in bytes.
+ * @return 1 if the data was written. 0 if it is larger than the size limit or if it could not be written.
+ */
+int u_cache_store(UCache *this, uint64_t key, const void *pData, uint64_t size);
+
+#endif // U_CACHE_29
@@ -0,0 +1,33 @@
+#ifndef U_CACHE_DEF_29
+#define U_CACHE_DEF_29
+
+#include <stdint.h>
+
+#define U_CACHE_MAX_ENTRIES 256
+#define U_CACHE_DEFAULT_SIZE_LIMIT (256 * 1024 * 1024)
+
+typedef struct UCacheEntry {
+    uint64_t key;
+    uint64_t size;    // The size of the derived data in bytes, without the file header.
+    uint64_t lastUse; // Larger values are more recently used.
+} UCacheEntry;
+
+typedef struct UCacheStats {
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t bytesSaved;  // Derived bytes that were read from the cache instead of being processed again.
+    uint64_t bytesStored;
+    uint64_t evictions;
+} UCacheStats;
+
+typedef struct UCache {
+    char directory[256];
+    uint64_t sizeLimit;
+    uint64_t totalSize;
+    uint64_t useCounter;
+    unsigned entryAmount;
+    UCacheEntry entries[U_CACHE_MAX_ENTRIES];
+    UCacheStats stats;
+} UCache;
+
+#endif // U_CACHE_DEF_29
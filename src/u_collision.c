@@ -1,12 +1,23 @@
 #include "u_collision.h"
 
+#include "u_simd.h"
+
 #include <assert.h>
 #include <float.h>
 #include <stdlib.h>
+#include <string.h>
 
 #define U_GJK_MAX_RESOLVE 8
 
+// The state of the hill climbing of one polyhedron during one collision test.
+typedef struct Climb {
+    const UCollisionPolyhedronAdjacency *pAdjacency;
+    uint32_t vertex;
+} Climb;
+
 static Vector3 polyhedronFindFurthestPoint(const UCollisionPolyhedron *pPolygon, Vector3 direction);
+static Vector3 polyhedronSoAFindFurthestPoint(const UCollisionPolyhedronSoA *pPolygon, Vector3 direction);
+static Vector3 climbFindFurthestPoint(Climb *pClimb, Vector3 direction);
 static Vector3 sphereFindFurthestPoint(const UCollisionSphere *pSphere, Vector3 direction);
 
 static int gjkModifySimplex(UCollisionGJK *this);
@@ -197,6 +208,80 @@ UCollisionReturn u_collision_poly_sphere(const UCollisionPolyhedron *pShape0, co
     return gjkReturn;
 }
 
+UCollisionReturn u_collision_poly_soa(const UCollisionPolyhedronSoA *pShape0, const UCollisionPolyhedronSoA *pShape1, UCollisionBackoutCache *pBackoutCache) {
+    assert(pShape0 != NULL);
+    assert(pShape1 != NULL);
+    assert(pShape0->amountVertices != 0);
+    assert(pShape1->amountVertices != 0);
+    // pBackoutCache can be NULL or a valid address.
+
+    U_GJK_IMPLEMENTATION(pShape0->amountVertices + pShape1->amountVertices, polyhedronSoAFindFurthestPoint, polyhedronSoAFindFurthestPoint)
+
+    U_GJK_EPA_IMPLEMENTATION(polyhedronSoAFindFurthestPoint, polyhedronSoAFindFurthestPoint)
+
+    gjkReturn.normal = gjkMetadata.direction;
+    gjkReturn.distance = minDistance + 0.001f;
+
+    return gjkReturn;
+}
+
+UCollisionReturn u_collision_poly_soa_sphere(const UCollisionPolyhedronSoA *pShape0, const UCollisionSphere *pShape1, UCollisionBackoutCache *pBackoutCache) {
+    assert(pShape0 != NULL);
+    assert(pShape1 != NULL);
+    assert(pShape0->amountVertices != 0);
+    // pBackoutCache can be NULL or a valid address.
+
+    U_GJK_IMPLEMENTATION(3 * pShape0->amountVertices, polyhedronSoAFindFurthestPoint, sphereFindFurthestPoint)
+
+    U_GJK_EPA_IMPLEMENTATION(polyhedronSoAFindFurthestPoint, sphereFindFurthestPoint)
+
+    gjkReturn.normal = gjkMetadata.direction;
+    gjkReturn.distance = minDistance + 0.001f;
+
+    return gjkReturn;
+}
+
+UCollisionReturn u_collision_poly_adjacency(const UCollisionPolyhedronAdjacency *pPoly0, const UCollisionPolyhedronAdjacency *pPoly1, UCollisionBackoutCache *pBackoutCache) {
+    assert(pPoly0 != NULL);
+    assert(pPoly1 != NULL);
+    assert(pPoly0->pNeighbors != NULL);
+    assert(pPoly1->pNeighbors != NULL);
+    // pBackoutCache can be NULL or a valid address.
+
+    Climb climb0 = {pPoly0, pPoly0->startVertex};
+    Climb climb1 = {pPoly1, pPoly1->startVertex};
+    Climb *pShape0 = &climb0;
+    Climb *pShape1 = &climb1;
+
+    U_GJK_IMPLEMENTATION(pPoly0->pPoly->amountVertices + pPoly1->pPoly->amountVertices, climbFindFurthestPoint, climbFindFurthestPoint)
+
+    U_GJK_EPA_IMPLEMENTATION(climbFindFurthestPoint, climbFindFurthestPoint)
+
+    gjkReturn.normal = gjkMetadata.direction;
+    gjkReturn.distance = minDistance + 0.001f;
+
+    return gjkReturn;
+}
+
+UCollisionReturn u_collision_poly_adjacency_sphere(const UCollisionPolyhedronAdjacency *pPoly, const UCollisionSphere *pShape1, UCollisionBackoutCache *pBackoutCache) {
+    assert(pPoly != NULL);
+    assert(pPoly->pNeighbors != NULL);
+    assert(pShape1 != NULL);
+    // pBackoutCache can be NULL or a valid address.
+
+    Climb climb0 = {pPoly, pPoly->startVertex};
+    Climb *pShape0 = &climb0;
+
+    U_GJK_IMPLEMENTATION(3 * pPoly->pPoly->amountVertices, climbFindFurthestPoint, sphereFindFurthestPoint)
+
+    U_GJK_EPA_IMPLEMENTATION(climbFindFurthestPoint, sphereFindFurthestPoint)
+
+    gjkReturn.normal = gjkMetadata.direction;
+    gjkReturn.distance = minDistance + 0.001f;
+
+    return gjkReturn;
+}
+
 UCollisionReturn u_collision_sphere(const UCollisionSphere *pSphere0, const UCollisionSphere *pSphere1) {
     assert(pSphere0 != NULL);
     assert(pSphere0->radius > 0);
@@ -264,6 +349,134 @@ void u_collision_free_backout_cache(UCollisionBackoutCache *pBackoutCache) {
     free(pBackoutCache->pVertices);
 }
 
+UCollisionPolyhedronSoA u_collision_alloc_poly_soa(const UCollisionPolyhedron *pPoly) {
+    assert(pPoly != NULL);
+    assert(pPoly->amountVertices != 0);
+
+    UCollisionPolyhedronSoA polySoA = {0};
+
+    const size_t paddedAmount = (pPoly->amountVertices + U_COLLISION_SOA_PADDING - 1) / U_COLLISION_SOA_PADDING * U_COLLISION_SOA_PADDING;
+
+    float *pMem = malloc(3 * sizeof(float) * paddedAmount);
+
+    if(pMem == NULL)
+        return polySoA;
+
+    polySoA.amountVertices = pPoly->amountVertices;
+    polySoA.paddedAmountVertices = paddedAmount;
+    polySoA.pX = pMem;
+    polySoA.pY = pMem + paddedAmount;
+    polySoA.pZ = pMem + 2 * paddedAmount;
+
+    u_collision_update_poly_soa(&polySoA, pPoly);
+
+    return polySoA;
+}
+
+void u_collision_update_poly_soa(UCollisionPolyhedronSoA *pPolySoA, const UCollisionPolyhedron *pPoly) {
+    assert(pPolySoA != NULL);
+    assert(pPoly != NULL);
+    assert(pPolySoA->amountVertices == pPoly->amountVertices);
+
+    for(size_t i = 0; i < pPolySoA->paddedAmountVertices; i++) {
+        const Vector3 vertex = pPoly->vertices[i < pPoly->amountVertices ? i : pPoly->amountVertices - 1];
+
+        pPolySoA->pX[i] = vertex.x;
+        pPolySoA->pY[i] = vertex.y;
+        pPolySoA->pZ[i] = vertex.z;
+    }
+}
+
+void u_collision_free_poly_soa(UCollisionPolyhedronSoA *pPolySoA) {
+    assert(pPolySoA != NULL);
+
+    free(pPolySoA->pX);
+
+    memset(pPolySoA, 0, sizeof(*pPolySoA));
+}
+
+UCollisionPolyhedronAdjacency u_collision_alloc_poly_adjacency(const UCollisionPolyhedron *pPoly, const uint32_t *pTriangleIndexes, size_t indexAmount) {
+    assert(pPoly != NULL);
+    assert(pPoly->amountVertices != 0 && pPoly->amountVertices < UINT32_MAX);
+    assert(pTriangleIndexes != NULL);
+    assert(indexAmount != 0 && indexAmount % 3 == 0);
+
+    UCollisionPolyhedronAdjacency adjacency = {0};
+
+    adjacency.pPoly = pPoly;
+    adjacency.startVertex = pTriangleIndexes[0];
+
+    // Every edge of a triangle is stored from both of its ends. Most edges are in two triangles, which is fixed after sorting.
+    const size_t offsetAmount = pPoly->amountVertices + 1;
+    uint32_t *pMem = malloc(sizeof(uint32_t) * (offsetAmount + 2 * indexAmount));
+
+    if(pMem == NULL)
+        return adjacency;
+
+    uint32_t *pOffsets = pMem;
+    uint32_t *pNeighbors = pMem + offsetAmount;
+
+    memset(pOffsets, 0, sizeof(uint32_t) * offsetAmount);
+
+    for(size_t i = 0; i < indexAmount; i++) {
+        assert(pTriangleIndexes[i] < pPoly->amountVertices);
+
+        pOffsets[pTriangleIndexes[i] + 1] += 2;
+    }
+
+    for(size_t v = 0; v < pPoly->amountVertices; v++)
+        pOffsets[v + 1] += pOffsets[v];
+
+    for(size_t i = 0; i < indexAmount; i++) {
+        const size_t first = i - i % 3;
+        const uint32_t vertex = pTriangleIndexes[i];
+
+        pNeighbors[pOffsets[vertex]++] = pTriangleIndexes[first + (i + 1) % 3];
+        pNeighbors[pOffsets[vertex]++] = pTriangleIndexes[first + (i + 2) % 3];
+    }
+
+    // The fill moved every offset to the start of the next vertex. Sort each list and drop the repeats while moving them back.
+    uint32_t begin = 0;
+    uint32_t amount = 0;
+
+    for(size_t v = 0; v < pPoly->amountVertices; v++) {
+        const uint32_t end = pOffsets[v];
+
+        pOffsets[v] = amount;
+
+        for(uint32_t i = begin + 1; i < end; i++) {
+            const uint32_t neighbor = pNeighbors[i];
+            uint32_t n = i;
+
+            for(; n != begin && pNeighbors[n - 1] > neighbor; n--)
+                pNeighbors[n] = pNeighbors[n - 1];
+
+            pNeighbors[n] = neighbor;
+        }
+
+        for(uint32_t i = begin; i < end; i++) {
+            if(i == begin || pNeighbors[i] != pNeighbors[i - 1])
+                pNeighbors[amount++] = pNeighbors[i];
+        }
+
+        begin = end;
+    }
+    pOffsets[pPoly->amountVertices] = amount;
+
+    adjacency.pOffsets = pOffsets;
+    adjacency.pNeighbors = pNeighbors;
+
+    return adjacency;
+}
+
+void u_collision_free_poly_adjacency(UCollisionPolyhedronAdjacency *pAdjacency) {
+    assert(pAdjacency != NULL);
+
+    free(pAdjacency->pOffsets);
+
+    memset(pAdjacency, 0, sizeof(*pAdjacency));
+}
+
 static int gjkModifySimplex(UCollisionGJK *this) {
     switch(this->simplex.amountVertices) {
         case 2:
@@ -465,6 +678,98 @@ static Vector3 polyhedronFindFurthestPoint(const UCollisionPolyhedron *pPolygon,
     return maxPoint;
 }
 
+static Vector3 polyhedronSoAFindFurthestPoint(const UCollisionPolyhedronSoA *pPolygon, Vector3 direction) {
+    size_t maxIndex = 0;
+
+#if defined(U_SIMD)
+    // Every lane keeps its furthest dot product and the index it came from. The indexes are floats, which are exact below 2^24.
+    static const float LANE_INDEXES[8] = {0, 1, 2, 3, 4, 5, 6, 7};
+
+    const PackF32 directionX = PACK_F32_SET(direction.x);
+    const PackF32 directionY = PACK_F32_SET(direction.y);
+    const PackF32 directionZ = PACK_F32_SET(direction.z);
+    const PackF32 step = PACK_F32_SET(PACK_F32_WIDTH);
+
+    PackF32 index = PACK_F32_LOAD(LANE_INDEXES);
+    PackF32 maxIndexes = index;
+    PackF32 maxDistances = PACK_F32_SET(-FLT_MAX);
+
+    assert(pPolygon->paddedAmountVertices < (1 << 24));
+
+    for(size_t i = 0; i < pPolygon->paddedAmountVertices; i += PACK_F32_WIDTH) {
+        const PackF32 distance = PACK_F32_ADD(PACK_F32_ADD(
+            PACK_F32_MUL(PACK_F32_LOAD(&pPolygon->pX[i]), directionX),
+            PACK_F32_MUL(PACK_F32_LOAD(&pPolygon->pY[i]), directionY)),
+            PACK_F32_MUL(PACK_F32_LOAD(&pPolygon->pZ[i]), directionZ));
+
+        maxIndexes   = PACK_F32_SELECT_GT(distance, maxDistances, index, maxIndexes);
+        maxDistances = PACK_F32_MAX(distance, maxDistances);
+        index = PACK_F32_ADD(index, step);
+    }
+
+    float distances[PACK_F32_WIDTH];
+    float indexes[PACK_F32_WIDTH];
+
+    PACK_F32_STORE(distances, maxDistances);
+    PACK_F32_STORE(indexes, maxIndexes);
+
+    float maxDistance = distances[0];
+    maxIndex = indexes[0];
+
+    // Like the scalar scan, ties go to the lowest index. Each lane already kept its first maximum.
+    for(unsigned l = 1; l < PACK_F32_WIDTH; l++) {
+        if(distances[l] > maxDistance || (distances[l] == maxDistance && indexes[l] < maxIndex)) {
+            maxDistance = distances[l];
+            maxIndex = indexes[l];
+        }
+    }
+#else
+    float maxDistance = -FLT_MAX;
+
+    for(size_t i = 0; i < pPolygon->amountVertices; i++) {
+        const float distance = pPolygon->pX[i] * direction.x + pPolygon->pY[i] * direction.y + pPolygon->pZ[i] * direction.z;
+
+        if(distance > maxDistance) {
+            maxDistance = distance;
+            maxIndex = i;
+        }
+    }
+#endif
+
+    return (Vector3){pPolygon->pX[maxIndex], pPolygon->pY[maxIndex], pPolygon->pZ[maxIndex]};
+}
+
+static Vector3 climbFindFurthestPoint(Climb *pClimb, Vector3 direction) {
+    const UCollisionPolyhedronAdjacency *pAdjacency = pClimb->pAdjacency;
+    const Vector3 *pVertices = pAdjacency->pPoly->vertices;
+
+    if(pAdjacency->pPoly->amountVertices < U_COLLISION_CLIMB_MIN_VERTICES)
+        return polyhedronFindFurthestPoint(pAdjacency->pPoly, direction);
+
+    // On a convex hull a vertex without a further neighbor is the furthest vertex, so the climb can stop there.
+    uint32_t vertex = pClimb->vertex;
+    uint32_t lastVertex;
+    float maxDistance = Vector3DotProduct(pVertices[vertex], direction);
+
+    do {
+        lastVertex = vertex;
+
+        for(uint32_t n = pAdjacency->pOffsets[lastVertex]; n < pAdjacency->pOffsets[lastVertex + 1]; n++) {
+            const uint32_t neighbor = pAdjacency->pNeighbors[n];
+            const float distance = Vector3DotProduct(pVertices[neighbor], direction);
+
+            if(distance > maxDistance) {
+                maxDistance = distance;
+                vertex = neighbor;
+            }
+        }
+    } while(vertex != lastVertex);
+
+    pClimb->vertex = vertex;
+
+    return pVertices[vertex];
+}
+
 static Vector3 sphereFindFurthestPoint(const UCollisionSphere *pSphere, Vector3 direction) {
     return Vector3Add(pSphere->position, Vector3Scale(Vector3Normalize(direction), pSphere->radius));
 }
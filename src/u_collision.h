@@ -23,6 +23,46 @@ UCollisionReturn u_collision_poly(const UCollisionPolyhedron *pPoly0, const UCol
  */
 UCollisionReturn u_collision_poly_sphere(const UCollisionPolyhedron *pPoly, const UCollisionSphere *pSphere, UCollisionBackoutCache *pBackoutCache);
 
+/**
+ * This function determines if a polyhedron would collide with another polyhedron.
+ * @note This is u_collision_poly() for polyhedrons with many vertices. The furthest point of every GJK and EPA step is found with SIMD.
+ * @param pPoly0 The first polyhedron to compute. @warning Do not put a zero point polyhedron.
+ * @param pPoly1 The second polyhedron to compute. @warning Do not put a zero point polyhedron.
+ * @param pBackoutCache The back out cache if it is needed. @note This can actually be NULL, but then the backout code will not be run.
+ * @return The same as u_collision_poly().
+ */
+UCollisionReturn u_collision_poly_soa(const UCollisionPolyhedronSoA *pPoly0, const UCollisionPolyhedronSoA *pPoly1, UCollisionBackoutCache *pBackoutCache);
+
+/**
+ * This function determines if a polyhedron would collide with a sphere.
+ * @note This is u_collision_poly_sphere() for polyhedrons with many vertices.
+ * @param pPoly Polyhedron to compute. @warning Do not put a zero point polyhedron.
+ * @param pSphere The sphere to test the collision with.
+ * @param pBackoutCache The back out cache if it is needed. @note This can actually be NULL, but then the backout code will not be run.
+ * @return The same as u_collision_poly_sphere().
+ */
+UCollisionReturn u_collision_poly_soa_sphere(const UCollisionPolyhedronSoA *pPoly, const UCollisionSphere *pSphere, UCollisionBackoutCache *pBackoutCache);
+
+/**
+ * This function determines if a polyhedron would collide with another polyhedron.
+ * @note This is u_collision_poly() for hulls with hundreds of vertices or more. Every GJK and EPA step climbs the edges of the hulls from the point the last step found, so a step only visits about sqrt(n) vertices.
+ * @param pPoly0 The first polyhedron to compute.
+ * @param pPoly1 The second polyhedron to compute.
+ * @param pBackoutCache The back out cache if it is needed. @note This can actually be NULL, but then the backout code will not be run.
+ * @return The same as u_collision_poly().
+ */
+UCollisionReturn u_collision_poly_adjacency(const UCollisionPolyhedronAdjacency *pPoly0, const UCollisionPolyhedronAdjacency *pPoly1, UCollisionBackoutCache *pBackoutCache);
+
+/**
+ * This function determines if a polyhedron would collide with a sphere.
+ * @note This is u_collision_poly_sphere() for hulls with hundreds of vertices or more.
+ * @param pPoly Polyhedron to compute.
+ * @param pSphere The sphere to test the collision with.
+ * @param pBackoutCache The back out cache if it is needed. @note This can actually be NULL, but then the backout code will not be run.
+ * @return The same as u_collision_poly_sphere().
+ */
+UCollisionReturn u_collision_poly_adjacency_sphere(const UCollisionPolyhedronAdjacency *pPoly, const UCollisionSphere *pSphere, UCollisionBackoutCache *pBackoutCache);
+
 /**
  * This function determines if a sphere would collide with a sphere.
  * @note This function is faster than every single test.
@@ -48,4 +88,43 @@ UCollisionBackoutCache u_collision_alloc_backout_cache(size_t extraVertices);
  */
 void u_collision_free_backout_cache(UCollisionBackoutCache *pBackoutCache);
 
+/**
+ * This function allocates a polyhedron with its coordinates in separate arrays.
+ * @note Below about 16 vertices u_collision_poly() is as fast.
+ * @warning Use u_collision_free_poly_soa to delete the returned polyhedron.
+ * @param pPoly The polyhedron to copy. @warning Do not put a zero point polyhedron.
+ * @return The copy of pPoly. UCollisionPolyhedronSoA::amountVertices is zero if memory ran out.
+ */
+UCollisionPolyhedronSoA u_collision_alloc_poly_soa(const UCollisionPolyhedron *pPoly);
+
+/**
+ * This function copies the vertices of a moved polyhedron.
+ * @param pPolySoA The polyhedron from u_collision_alloc_poly_soa().
+ * @param pPoly The moved polyhedron. @warning It must have the same amount of vertices as the one pPolySoA was allocated with.
+ */
+void u_collision_update_poly_soa(UCollisionPolyhedronSoA *pPolySoA, const UCollisionPolyhedron *pPoly);
+
+/**
+ * This function frees pPolySoA.
+ * @param pPolySoA A pointer to the polyhedron to delete the internals used.
+ */
+void u_collision_free_poly_soa(UCollisionPolyhedronSoA *pPolySoA);
+
+/**
+ * This function finds which vertices of a convex hull share an edge.
+ * @warning The triangles must be the convex hull of pPoly, otherwise climbing can stop at a point that is not the furthest. Vertices that no triangle uses are never returned.
+ * @warning Use u_collision_free_poly_adjacency to delete the returned adjacency.
+ * @param pPoly The polyhedron. It is not copied, so it must outlive the returned adjacency. @warning Do not put a zero point polyhedron.
+ * @param pTriangleIndexes A triangle list of the hull, for example the index buffer of a convex collision mesh.
+ * @param indexAmount The amount of indexes in pTriangleIndexes. @warning It must be a non zero multiple of 3.
+ * @return The adjacency of pPoly. UCollisionPolyhedronAdjacency::pNeighbors is NULL if memory ran out.
+ */
+UCollisionPolyhedronAdjacency u_collision_alloc_poly_adjacency(const UCollisionPolyhedron *pPoly, const uint32_t *pTriangleIndexes, size_t indexAmount);
+
+/**
+ * This function frees pAdjacency.
+ * @param pAdjacency A pointer to the adjacency to delete the internals used.
+ */
+void u_collision_free_poly_adjacency(UCollisionPolyhedronAdjacency *pAdjacency);
+
 #endif // U_COLLISION_29
@@ -4,14 +4,36 @@
 #include "raymath.h"
 
 #include <stddef.h>
+#include <stdint.h>
 
 #define U_COLLISION_SIMPLEX_VERTEX_AMOUNT 4
 
+// Below this amount of vertices the support function of UCollisionPolyhedronAdjacency scans every vertex instead of climbing.
+#define U_COLLISION_CLIMB_MIN_VERTICES 32
+
+// UCollisionPolyhedronSoA pads its vertices to a multiple of this, which is the widest SIMD register in floats.
+#define U_COLLISION_SOA_PADDING 8
+
 typedef struct UCollisionPolyhedron {
     size_t amountVertices;
     Vector3 vertices[];
 } UCollisionPolyhedron;
 
+typedef struct UCollisionPolyhedronSoA {
+    size_t amountVertices;
+    size_t paddedAmountVertices; // The padding repeats the last vertex, so it never changes which point is furthest.
+    float *pX; // pX, pY and pZ are one allocation.
+    float *pY;
+    float *pZ;
+} UCollisionPolyhedronSoA;
+
+typedef struct UCollisionPolyhedronAdjacency {
+    const UCollisionPolyhedron *pPoly; // The vertices are not copied, so they can move as long as the hull stays the same shape.
+    uint32_t startVertex;  // A vertex on the hull, which every query of a collision test starts climbing from.
+    uint32_t *pOffsets;    // The neighbors of vertex i are pNeighbors[pOffsets[i]] to pNeighbors[pOffsets[i + 1] - 1].
+    uint32_t *pNeighbors;  // pOffsets and pNeighbors are one allocation.
+} UCollisionPolyhedronAdjacency;
+
 typedef struct UCollisionSphere {
     Vector3 position;
     float radius;
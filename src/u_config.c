@@ -12,6 +12,11 @@ void u_config_defaults(UConfig *this) {
     this->current.width = 1024;
     this->current.height = 764;
     this->current.sampleCount = 1;
+    this->current.generateMipmaps = 0;
+    this->current.compressVertices = 0;
+    this->current.worldMode = 0;
+    this->current.greedyMesh = 0;
+    this->current.gpuMazeSize = 0;
 
     for(unsigned i = 0; i < VK_UUID_SIZE; i++) {
         this->current.graphicsCardPipelineCacheUUID[i] = 0;
@@ -36,6 +41,36 @@ void u_config_bound(UConfig *this) {
     else
     if(this->current.sampleCount > this->max.sampleCount)
         this->current.sampleCount = this->max.sampleCount;
+
+    if(this->current.generateMipmaps < this->min.generateMipmaps)
+        this->current.generateMipmaps = this->min.generateMipmaps;
+    else
+    if(this->current.generateMipmaps > this->max.generateMipmaps)
+        this->current.generateMipmaps = this->max.generateMipmaps;
+
+    if(this->current.compressVertices < this->min.compressVertices)
+        this->current.compressVertices = this->min.compressVertices;
+    else
+    if(this->current.compressVertices > this->max.compressVertices)
+        this->current.compressVertices = this->max.compressVertices;
+
+    if(this->current.worldMode < this->min.worldMode)
+        this->current.worldMode = this->min.worldMode;
+    else
+    if(this->current.worldMode > this->max.worldMode)
+        this->current.worldMode = this->max.worldMode;
+
+    if(this->current.greedyMesh < this->min.greedyMesh)
+        this->current.greedyMesh = this->min.greedyMesh;
+    else
+    if(this->current.greedyMesh > this->max.greedyMesh)
+        this->current.greedyMesh = this->max.greedyMesh;
+
+    if(this->current.gpuMazeSize < this->min.gpuMazeSize)
+        this->current.gpuMazeSize = this->min.gpuMazeSize;
+    else
+    if(this->current.gpuMazeSize > this->max.gpuMazeSize)
+        this->current.gpuMazeSize = this->max.gpuMazeSize;
 }
 
 int u_config_gather_vulkan_devices(UConfig *this, uint32_t physicalDeviceCount, VkPhysicalDevice *pPhysicalDevices) {
@@ -73,6 +108,22 @@ int u_config_gather_vulkan_limits(UConfig *this, VkPhysicalDevice physicalDevice
     pMax->width  = physicalDeviceProperties.limits.maxFramebufferWidth;
     pMax->height = physicalDeviceProperties.limits.maxFramebufferHeight;
 
+    pMin->generateMipmaps = 0;
+    pMax->generateMipmaps = 1;
+
+    pMin->compressVertices = 0;
+    pMax->compressVertices = 1;
+
+    pMin->worldMode = 0;
+    pMax->worldMode = 1;
+
+    pMin->greedyMesh = 0;
+    pMax->greedyMesh = 1;
+
+    // 4096 * 4096 instances are 2^27 bytes, the least maxStorageBufferRange that Vulkan allows.
+    pMin->gpuMazeSize = 0;
+    pMax->gpuMazeSize = 4096;
+
     pMin->sampleCount = VK_SAMPLE_COUNT_64_BIT;
     pMax->sampleCount = VK_SAMPLE_COUNT_1_BIT;
     for(int i = VK_SAMPLE_COUNT_1_BIT; i <= VK_SAMPLE_COUNT_64_BIT; i = i << 1) {
@@ -113,6 +164,16 @@ int u_config_load(UConfig *this, const char *const pPath) {
 
     this->current.sampleCount = iniparser_getint(pDictionary, "window:sample_count", this->min.sampleCount);
 
+    this->current.generateMipmaps = iniparser_getint(pDictionary, "texture:generate_mipmaps", this->min.generateMipmaps);
+
+    this->current.compressVertices = iniparser_getint(pDictionary, "model:compress_vertices", this->min.compressVertices);
+
+    this->current.worldMode = iniparser_getint(pDictionary, "maze:world_mode", this->min.worldMode);
+
+    this->current.greedyMesh = iniparser_getint(pDictionary, "maze:greedy_mesh", this->min.greedyMesh);
+
+    this->current.gpuMazeSize = iniparser_getint(pDictionary, "maze:gpu_size", this->min.gpuMazeSize);
+
     const char *pUUIDString = iniparser_getstring(pDictionary, "window:graphics_card_pipeline_cache_uuid", NULL);
 
     unsigned uuid[VK_UUID_SIZE] = {0};
@@ -160,6 +221,27 @@ int u_config_save(const UConfig *const this, const char *const pPath) {
     snprintUUID(textBuffer, sizeof(textBuffer) / sizeof(textBuffer[0]), this->current.graphicsCardPipelineCacheUUID);
     iniparser_set(pDictionary, "window:graphics_card_pipeline_cache_uuid", textBuffer);
 
+    iniparser_set(pDictionary, "texture", NULL);
+
+    snprintf(textBuffer, sizeof(textBuffer) / sizeof(textBuffer[0]), "%i", this->current.generateMipmaps);
+    iniparser_set(pDictionary, "texture:generate_mipmaps", textBuffer);
+
+    iniparser_set(pDictionary, "model", NULL);
+
+    snprintf(textBuffer, sizeof(textBuffer) / sizeof(textBuffer[0]), "%i", this->current.compressVertices);
+    iniparser_set(pDictionary, "model:compress_vertices", textBuffer);
+
+    iniparser_set(pDictionary, "maze", NULL);
+
+    snprintf(textBuffer, sizeof(textBuffer) / sizeof(textBuffer[0]), "%i", this->current.worldMode);
+    iniparser_set(pDictionary, "maze:world_mode", textBuffer);
+
+    snprintf(textBuffer, sizeof(textBuffer) / sizeof(textBuffer[0]), "%i", this->current.greedyMesh);
+    iniparser_set(pDictionary, "maze:greedy_mesh", textBuffer);
+
+    snprintf(textBuffer, sizeof(textBuffer) / sizeof(textBuffer[0]), "%i", this->current.gpuMazeSize);
+    iniparser_set(pDictionary, "maze:gpu_size", textBuffer);
+
     iniparser_dump_ini(pDictionary, pData);
     fclose(pData);
     iniparser_freedict(pDictionary);
@@ -7,6 +7,11 @@ typedef struct UConfigParameters {
     int width;
     int height;
     int sampleCount;
+    int generateMipmaps;
+    int compressVertices;
+    int worldMode;
+    int greedyMesh;
+    int gpuMazeSize; // The width and depth of a maze that maze_gen.comp generates. 0 streams the maze from the CPU.
     uint8_t graphicsCardPipelineCacheUUID[VK_UUID_SIZE];
 } UConfigParameters;
 
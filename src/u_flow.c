@@ -0,0 +1,396 @@
+#include "u_flow.h"
+
+#include "u_thread.h"
+
+#include "SDL_atomic.h"
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct {
+    uint32_t vertex;
+    uint32_t slot;
+} Candidate;
+
+typedef struct {
+    UFlowField *pField;
+    uint32_t first;
+    uint32_t last;
+    unsigned taskAmount;
+    Candidate **ppCandidates;
+    uint32_t *pCandidateAmounts;
+    uint32_t *pCandidateCapacities;
+    SDL_atomic_t failed;
+} ScanTask;
+
+static uint32_t slotOf(const UMazeCompactData *const pGraph, uint32_t vertex, uint32_t link);
+static int sortGoals(const uint32_t *pGoals, uint32_t goalAmount, uint32_t vertexAmount, uint32_t **ppSortedGoals, uint32_t *pSortedAmount);
+static int compareVertices(const void *pLeft, const void *pRight);
+static int compareKeys(const void *pLeft, const void *pRight);
+static int searchLevels(UFlowField *this, int allowParallel);
+static void scanTask(void *pUserData, unsigned index);
+
+int u_flow_build(UFlowField *this, const UMazeCompactData *const pGraph, const uint32_t *pGoals, uint32_t goalAmount) {
+    assert(this != NULL);
+    assert(pGraph != NULL);
+    assert(goalAmount == 0 || pGoals != NULL);
+
+    memset(this, 0, sizeof(*this));
+
+    this->pGraph = pGraph;
+
+    if(!sortGoals(pGoals, goalAmount, pGraph->vertexAmount, &this->pGoals, &this->goalAmount)) {
+        memset(this, 0, sizeof(*this));
+        return 0;
+    }
+
+    this->pDistances  = malloc((pGraph->vertexAmount + 1) * sizeof(uint32_t));
+    this->pDirections = malloc((pGraph->vertexAmount + 1) * sizeof(uint16_t));
+    this->pQueue      = malloc((pGraph->vertexAmount + 1) * sizeof(uint32_t));
+
+    if(this->pDistances == NULL || this->pDirections == NULL || this->pQueue == NULL || !searchLevels(this, 1)) {
+        u_flow_free(this);
+        return 0;
+    }
+
+    return 1;
+}
+
+int u_flow_update(UFlowField *this, const uint32_t *pGoals, uint32_t goalAmount) {
+    assert(this != NULL);
+    assert(goalAmount == 0 || pGoals != NULL);
+
+    const UMazeCompactData *pGraph = this->pGraph;
+    uint32_t *pNewGoals;
+    uint32_t newGoalAmount;
+
+    if(!sortGoals(pGoals, goalAmount, pGraph->vertexAmount, &pNewGoals, &newGoalAmount))
+        return 0;
+
+    // Both goal lists are sorted, so one walk finds the removed and the added goals.
+    // A removed goal takes every vertex that leads to it along. Walking the direction tree backwards finds them.
+    uint32_t invalidAmount = 0;
+    uint32_t seedCapacity = 0;
+
+    for(uint32_t o = 0, n = 0; o < this->goalAmount; o++) {
+        while(n < newGoalAmount && pNewGoals[n] < this->pGoals[o])
+            n++;
+
+        if(n < newGoalAmount && pNewGoals[n] == this->pGoals[o])
+            continue;
+
+        this->pDistances[this->pGoals[o]]  = U_FLOW_UNREACHED;
+        this->pDirections[this->pGoals[o]] = U_FLOW_DIRECTION_NONE;
+        this->pQueue[invalidAmount++] = this->pGoals[o];
+    }
+
+    for(uint32_t i = 0; i < invalidAmount; i++) {
+        const uint32_t vertex = this->pQueue[i];
+
+        for(uint32_t c = pGraph->pLinkOffsets[vertex]; c < pGraph->pLinkOffsets[vertex + 1]; c++) {
+            const uint32_t link = pGraph->pVertexLinkArray[c];
+            const uint16_t direction = this->pDirections[link];
+
+            seedCapacity++;
+
+            if(direction >= U_FLOW_DIRECTION_GOAL || pGraph->pVertexLinkArray[pGraph->pLinkOffsets[link] + direction] != vertex)
+                continue;
+
+            this->pDistances[link]  = U_FLOW_UNREACHED;
+            this->pDirections[link] = U_FLOW_DIRECTION_NONE;
+            this->pQueue[invalidAmount++] = link;
+        }
+    }
+
+    // The search restarts from the reached vertices around the hole and from the added goals. The key is the distance followed by the vertex.
+    uint64_t *pSeeds = malloc((seedCapacity + newGoalAmount + 1) * sizeof(uint64_t));
+
+    if(pSeeds == NULL) {
+        // The hole is already made. A search without worker threads needs no memory, so the old goals are searched again.
+        free(pNewGoals);
+        searchLevels(this, 0);
+        return 0;
+    }
+
+    free(this->pGoals);
+    this->pGoals = pNewGoals;
+    this->goalAmount = newGoalAmount;
+
+    uint32_t seedAmount = 0;
+
+    for(uint32_t i = 0; i < invalidAmount; i++) {
+        const uint32_t vertex = this->pQueue[i];
+
+        for(uint32_t c = pGraph->pLinkOffsets[vertex]; c < pGraph->pLinkOffsets[vertex + 1]; c++) {
+            const uint32_t link = pGraph->pVertexLinkArray[c];
+
+            if(this->pDistances[link] != U_FLOW_UNREACHED)
+                pSeeds[seedAmount++] = ((uint64_t)this->pDistances[link] << 32) | link;
+        }
+    }
+
+    for(uint32_t g = 0; g < this->goalAmount; g++) {
+        const uint32_t goal = this->pGoals[g];
+
+        if(this->pDistances[goal] == 0)
+            continue;
+
+        this->pDistances[goal]  = 0;
+        this->pDirections[goal] = U_FLOW_DIRECTION_GOAL;
+        pSeeds[seedAmount++] = goal;
+    }
+
+    qsort(pSeeds, seedAmount, sizeof(uint64_t), compareKeys);
+
+    // The seeds and the queue are both in order of distance. Always taking the nearer of the two keeps the search in order, so no vertex is improved twice.
+    uint32_t head = 0, tail = 0, s = 0;
+
+    while(s < seedAmount || head != tail) {
+        uint32_t vertex;
+
+        if(head != tail && (s == seedAmount || this->pDistances[this->pQueue[head]] <= (uint32_t)(pSeeds[s] >> 32)))
+            vertex = this->pQueue[head++];
+        else
+            vertex = (uint32_t)pSeeds[s++];
+
+        const uint32_t distance = this->pDistances[vertex] + 1;
+
+        for(uint32_t c = pGraph->pLinkOffsets[vertex]; c < pGraph->pLinkOffsets[vertex + 1]; c++) {
+            const uint32_t link = pGraph->pVertexLinkArray[c];
+
+            if(this->pDistances[link] <= distance)
+                continue;
+
+            this->pDistances[link]  = distance;
+            this->pDirections[link] = slotOf(pGraph, link, vertex);
+
+            assert(tail < pGraph->vertexAmount);
+            this->pQueue[tail++] = link;
+        }
+    }
+
+    free(pSeeds);
+
+    return 1;
+}
+
+void u_flow_free(UFlowField *this) {
+    assert(this != NULL);
+
+    free(this->pGoals);
+    free(this->pDistances);
+    free(this->pDirections);
+    free(this->pQueue);
+
+    memset(this, 0, sizeof(*this));
+}
+
+uint32_t u_flow_distance(const UFlowField *const this, uint32_t vertex) {
+    assert(this != NULL);
+    assert(vertex < this->pGraph->vertexAmount);
+
+    return this->pDistances[vertex];
+}
+
+uint32_t u_flow_next(const UFlowField *const this, uint32_t vertex) {
+    assert(this != NULL);
+    assert(vertex < this->pGraph->vertexAmount);
+
+    const uint16_t direction = this->pDirections[vertex];
+
+    if(direction == U_FLOW_DIRECTION_GOAL)
+        return vertex;
+
+    if(direction == U_FLOW_DIRECTION_NONE)
+        return U_FLOW_UNREACHED;
+
+    return this->pGraph->pVertexLinkArray[this->pGraph->pLinkOffsets[vertex] + direction];
+}
+
+static uint32_t slotOf(const UMazeCompactData *const pGraph, uint32_t vertex, uint32_t link) {
+    for(uint32_t c = pGraph->pLinkOffsets[vertex]; c < pGraph->pLinkOffsets[vertex + 1]; c++) {
+        if(pGraph->pVertexLinkArray[c] == link)
+            return c - pGraph->pLinkOffsets[vertex];
+    }
+
+    // Every link is stored in both of its vertices.
+    assert(0);
+    return U_FLOW_DIRECTION_NONE;
+}
+
+static int sortGoals(const uint32_t *pGoals, uint32_t goalAmount, uint32_t vertexAmount, uint32_t **ppSortedGoals, uint32_t *pSortedAmount) {
+    uint32_t *pSortedGoals = malloc((goalAmount + 1) * sizeof(uint32_t));
+
+    if(pSortedGoals == NULL)
+        return 0;
+
+    for(uint32_t g = 0; g < goalAmount; g++) {
+        if(pGoals[g] >= vertexAmount) {
+            free(pSortedGoals);
+            return 0;
+        }
+        pSortedGoals[g] = pGoals[g];
+    }
+
+    qsort(pSortedGoals, goalAmount, sizeof(uint32_t), compareVertices);
+
+    uint32_t sortedAmount = 0;
+
+    for(uint32_t g = 0; g < goalAmount; g++) {
+        if(sortedAmount == 0 || pSortedGoals[sortedAmount - 1] != pSortedGoals[g])
+            pSortedGoals[sortedAmount++] = pSortedGoals[g];
+    }
+
+    *ppSortedGoals = pSortedGoals;
+    *pSortedAmount = sortedAmount;
+
+    return 1;
+}
+
+static int compareVertices(const void *pLeft, const void *pRight) {
+    const uint32_t left = *(const uint32_t*)pLeft, right = *(const uint32_t*)pRight;
+
+    return (left > right) - (left < right);
+}
+
+static int compareKeys(const void *pLeft, const void *pRight) {
+    const uint64_t left = *(const uint64_t*)pLeft, right = *(const uint64_t*)pRight;
+
+    return (left > right) - (left < right);
+}
+
+static int searchLevels(UFlowField *this, int allowParallel) {
+    const UMazeCompactData *pGraph = this->pGraph;
+    const unsigned taskAmount = u_thread_count();
+
+    memset(this->pDistances,  0xff, pGraph->vertexAmount * sizeof(uint32_t));
+    memset(this->pDirections, 0xff, pGraph->vertexAmount * sizeof(uint16_t));
+
+    uint32_t tail = 0;
+
+    for(uint32_t g = 0; g < this->goalAmount; g++) {
+        this->pDistances[this->pGoals[g]]  = 0;
+        this->pDirections[this->pGoals[g]] = U_FLOW_DIRECTION_GOAL;
+        this->pQueue[tail++] = this->pGoals[g];
+    }
+
+    // Every worker gathers the vertices that its part of a level finds without writing to the fields.
+    // They are claimed afterwards in the order of the level, which is the order that one thread would have found them in.
+    ScanTask scanTaskData;
+    memset(&scanTaskData, 0, sizeof(scanTaskData));
+
+    scanTaskData.pField = this;
+    scanTaskData.taskAmount = taskAmount;
+
+    int result = 1;
+    uint32_t levelStart = 0, levelEnd = tail;
+
+    for(uint32_t distance = 1; levelStart != levelEnd; distance++) {
+        if(allowParallel && taskAmount > 1 && levelEnd - levelStart >= U_FLOW_PARALLEL_FRONTIER) {
+            if(scanTaskData.ppCandidates == NULL) {
+                scanTaskData.ppCandidates         = calloc(taskAmount, sizeof(Candidate*));
+                scanTaskData.pCandidateAmounts    = calloc(taskAmount, sizeof(uint32_t));
+                scanTaskData.pCandidateCapacities = calloc(taskAmount, sizeof(uint32_t));
+            }
+
+            scanTaskData.first = levelStart;
+            scanTaskData.last  = levelEnd;
+
+            if(scanTaskData.ppCandidates != NULL && scanTaskData.pCandidateAmounts != NULL && scanTaskData.pCandidateCapacities != NULL)
+                u_thread_parallel_for(taskAmount, scanTask, &scanTaskData);
+            else
+                SDL_AtomicSet(&scanTaskData.failed, 1);
+
+            if(SDL_AtomicGet(&scanTaskData.failed)) {
+                result = 0;
+                break;
+            }
+
+            for(unsigned t = 0; t < taskAmount; t++) {
+                for(uint32_t i = 0; i < scanTaskData.pCandidateAmounts[t]; i++) {
+                    const Candidate *pCandidate = &scanTaskData.ppCandidates[t][i];
+
+                    if(this->pDistances[pCandidate->vertex] != U_FLOW_UNREACHED)
+                        continue;
+
+                    this->pDistances[pCandidate->vertex]  = distance;
+                    this->pDirections[pCandidate->vertex] = pCandidate->slot;
+                    this->pQueue[tail++] = pCandidate->vertex;
+                }
+            }
+        }
+        else {
+            for(uint32_t i = levelStart; i < levelEnd; i++) {
+                const uint32_t vertex = this->pQueue[i];
+
+                for(uint32_t c = pGraph->pLinkOffsets[vertex]; c < pGraph->pLinkOffsets[vertex + 1]; c++) {
+                    const uint32_t link = pGraph->pVertexLinkArray[c];
+
+                    if(this->pDistances[link] != U_FLOW_UNREACHED)
+                        continue;
+
+                    this->pDistances[link]  = distance;
+                    this->pDirections[link] = slotOf(pGraph, link, vertex);
+                    this->pQueue[tail++] = link;
+                }
+            }
+        }
+
+        levelStart = levelEnd;
+        levelEnd = tail;
+    }
+
+    if(scanTaskData.ppCandidates != NULL) {
+        for(unsigned t = 0; t < taskAmount; t++)
+            free(scanTaskData.ppCandidates[t]);
+    }
+    free(scanTaskData.ppCandidates);
+    free(scanTaskData.pCandidateAmounts);
+    free(scanTaskData.pCandidateCapacities);
+
+    return result;
+}
+
+static void scanTask(void *pUserData, unsigned index) {
+    ScanTask *pScanTask = pUserData;
+    const UFlowField *this = pScanTask->pField;
+    const UMazeCompactData *pGraph = this->pGraph;
+
+    const uint32_t levelAmount = pScanTask->last - pScanTask->first;
+    const uint32_t first = pScanTask->first + (uint64_t)levelAmount *  index      / pScanTask->taskAmount;
+    const uint32_t last  = pScanTask->first + (uint64_t)levelAmount * (index + 1) / pScanTask->taskAmount;
+
+    uint32_t amount = 0;
+
+    for(uint32_t i = first; i < last; i++) {
+        const uint32_t vertex = this->pQueue[i];
+
+        for(uint32_t c = pGraph->pLinkOffsets[vertex]; c < pGraph->pLinkOffsets[vertex + 1]; c++) {
+            const uint32_t link = pGraph->pVertexLinkArray[c];
+
+            if(this->pDistances[link] != U_FLOW_UNREACHED)
+                continue;
+
+            if(amount == pScanTask->pCandidateCapacities[index]) {
+                const uint32_t capacity = amount == 0 ? 1024 : 2 * amount;
+                Candidate *pCandidates = realloc(pScanTask->ppCandidates[index], capacity * sizeof(Candidate));
+
+                if(pCandidates == NULL) {
+                    SDL_AtomicSet(&pScanTask->failed, 1);
+                    pScanTask->pCandidateAmounts[index] = amount;
+                    return;
+                }
+
+                pScanTask->ppCandidates[index] = pCandidates;
+                pScanTask->pCandidateCapacities[index] = capacity;
+            }
+
+            pScanTask->ppCandidates[index][amount].vertex = link;
+            pScanTask->ppCandidates[index][amount].slot   = slotOf(pGraph, link, vertex);
+            amount++;
+        }
+    }
+
+    pScanTask->pCandidateAmounts[index] = amount;
+}
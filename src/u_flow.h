@@ -0,0 +1,49 @@
+#ifndef U_FLOW_29
+#define U_FLOW_29
+
+#include "u_flow_def.h"
+
+/**
+ * Build the distance and direction fields of a graph toward the nearest of several goals.
+ * @note This is a BFS that goes one level at a time. Levels of U_FLOW_PARALLEL_FRONTIER or more vertices are scanned on worker threads. The fields are the same for any amount of threads.
+ * @warning If this function succeeds you are responsiable for calling u_flow_free(). pGraph must outlive this.
+ * @param this The UFlowField to fill. It is cleared on failure.
+ * @param pGraph The graph to navigate. A vertexMazeData of u_maze_gen_sq_grid() works.
+ * @param pGoals The goal vertices. Duplicates are allowed.
+ * @param goalAmount The amount of vertices in pGoals. Can be zero, then every vertex is unreached.
+ * @return 1 if the fields are ready. 0 if memory ran out or a goal is not in pGraph.
+ */
+int u_flow_build(UFlowField *this, const UMazeCompactData *const pGraph, const uint32_t *pGoals, uint32_t goalAmount);
+
+/**
+ * Move the goals and repair the fields. Only the vertices whose nearest goal was removed, or that are now closer to an added goal, are searched again.
+ * @note The distances are the same as a new u_flow_build() would make. Between equally near goals the direction may be different.
+ * @param this The UFlowField that was filled by u_flow_build().
+ * @param pGoals The new goal vertices. Duplicates are allowed.
+ * @param goalAmount The amount of vertices in pGoals.
+ * @return 1 if the fields are up to date. 0 if memory ran out or a goal is not in the graph, in that case the fields are left as they were.
+ */
+int u_flow_update(UFlowField *this, const uint32_t *pGoals, uint32_t goalAmount);
+
+/**
+ * Free the fields.
+ * @param this The UFlowField that was filled by u_flow_build().
+ */
+void u_flow_free(UFlowField *this);
+
+/**
+ * @param this The UFlowField that was filled by u_flow_build().
+ * @param vertex The vertex an agent is at.
+ * @return The amount of links to the nearest goal or U_FLOW_UNREACHED.
+ */
+uint32_t u_flow_distance(const UFlowField *const this, uint32_t vertex);
+
+/**
+ * Find the next step of an agent.
+ * @param this The UFlowField that was filled by u_flow_build().
+ * @param vertex The vertex an agent is at.
+ * @return The neighbor of vertex that is one link closer to the nearest goal. vertex itself if it is a goal. U_FLOW_UNREACHED if no goal can be reached.
+ */
+uint32_t u_flow_next(const UFlowField *const this, uint32_t vertex);
+
+#endif // U_FLOW_29
@@ -0,0 +1,28 @@
+#ifndef U_FLOW_DEF_29
+#define U_FLOW_DEF_29
+
+#include "u_maze_def.h"
+
+#include <stdint.h>
+
+#define U_FLOW_UNREACHED UINT32_MAX
+
+// The values of pDirections that are not the slot of a link.
+#define U_FLOW_DIRECTION_GOAL 0xfffe
+#define U_FLOW_DIRECTION_NONE 0xffff
+
+// A BFS level with at least this many vertices is scanned on worker threads. Mazes mostly have narrow frontiers, so smaller levels stay on the calling thread.
+#define U_FLOW_PARALLEL_FRONTIER 4096
+
+typedef struct UFlowField {
+    const UMazeCompactData *pGraph; // Reference
+
+    uint32_t goalAmount;
+    uint32_t *pGoals; // Sorted.
+
+    uint32_t *pDistances;  // The amount of links to the nearest goal for every vertex, or U_FLOW_UNREACHED.
+    uint16_t *pDirections; // For every vertex the slot in its links that leads to the nearest goal. From pLinkOffsets[v] and up.
+    uint32_t *pQueue;      // vertexAmount vertices of search memory that is reused by every build and update.
+} UFlowField;
+
+#endif // U_FLOW_DEF_29
@@ -0,0 +1,481 @@
+#include "u_ktx2.h"
+
+#include "u_read.h"
+
+#include "SDL_log.h"
+#include <vulkan/vulkan.h>
+
+#include <stdlib.h>
+#include <string.h>
+
+#define HEADER_SIZE 80
+#define LEVEL_INDEX_ENTRY_SIZE 24
+
+static const uint8_t KTX2_IDENTIFIER[12] = {0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n'};
+
+// BC7 mode descriptions.
+typedef struct {
+    uint8_t subsetAmount;
+    uint8_t partitionBits;
+    uint8_t rotationBits;
+    uint8_t indexSelectionBits;
+    uint8_t colorBits;
+    uint8_t alphaBits;
+    uint8_t endpointPBits;
+    uint8_t sharedPBits;
+    uint8_t indexBits;
+    uint8_t secondaryIndexBits;
+} BC7Mode;
+
+static const BC7Mode BC7_MODES[8] = {
+//  NS, PB, RB, ISB, CB, AB, EPB, SPB, IB, IB2
+    { 3,  4,  0,   0,  4,  0,   1,   0,  3,   0},
+    { 2,  6,  0,   0,  6,  0,   0,   1,  3,   0},
+    { 3,  6,  0,   0,  5,  0,   0,   0,  2,   0},
+    { 2,  6,  0,   0,  7,  0,   1,   0,  2,   0},
+    { 1,  0,  2,   1,  5,  6,   0,   0,  2,   3},
+    { 1,  0,  2,   0,  7,  8,   0,   0,  2,   2},
+    { 1,  0,  0,   0,  7,  7,   1,   0,  4,   0},
+    { 2,  6,  0,   0,  5,  5,   1,   0,  2,   0}
+};
+
+// Bit i is the subset of pixel i.
+static const uint16_t BC7_PARTITIONS_2[64] = {
+    0xCCCC, 0x8888, 0xEEEE, 0xECC8, 0xC880, 0xFEEC, 0xFEC8, 0xEC80,
+    0xC800, 0xFFEC, 0xFE80, 0xE800, 0xFFE8, 0xFF00, 0xFFF0, 0xF000,
+    0xF710, 0x008E, 0x7100, 0x08CE, 0x008C, 0x7310, 0x3100, 0x8CCE,
+    0x088C, 0x3110, 0x6666, 0x366C, 0x17E8, 0x0FF0, 0x718E, 0x399C,
+    0xAAAA, 0xF0F0, 0x5A5A, 0x33CC, 0x3C3C, 0x55AA, 0x9696, 0xA55A,
+    0x73CE, 0x13C8, 0x324C, 0x3BDC, 0x6996, 0xC33C, 0x9966, 0x0660,
+    0x0272, 0x04E4, 0x4E40, 0x2720, 0xC936, 0x936C, 0x39C6, 0x639C,
+    0x9336, 0x9CC6, 0x817E, 0xE718, 0xCCF0, 0x0FCC, 0x7744, 0xEE22
+};
+
+// Bits 2i to 2i + 1 are the subset of pixel i.
+static const uint32_t BC7_PARTITIONS_3[64] = {
+    0xAA685050, 0x6A5A5040, 0x5A5A4200, 0x5450A0A8, 0xA5A50000, 0xA0A05050, 0x5555A0A0, 0x5A5A5050,
+    0xAA550000, 0xAA555500, 0xAAAA5500, 0x90909090, 0x94949494, 0xA4A4A4A4, 0xA9A59450, 0x2A0A4250,
+    0xA5945040, 0x0A425054, 0xA5A5A500, 0x55A0A0A0, 0xA8A85454, 0x6A6A4040, 0xA4A45000, 0x1A1A0500,
+    0x0050A4A4, 0xAAA59090, 0x14696914, 0x69691400, 0xA08585A0, 0xAA821414, 0x50A4A450, 0x6A5A0200,
+    0xA9A58000, 0x5090A0A8, 0xA8A09050, 0x24242424, 0x00AA5500, 0x24924924, 0x24499224, 0x50A50A50,
+    0x500AA550, 0xAAAA4444, 0x66660000, 0xA5A0A5A0, 0x50A050A0, 0x69286928, 0x44AAAA44, 0x66666600,
+    0xAA444444, 0x54A854A8, 0x95809580, 0x96969600, 0xA85454A8, 0x80959580, 0xAA141414, 0x96960000,
+    0xAAAA1414, 0xA05050A0, 0xA0A5A5A0, 0x96000000, 0x40804080, 0xA9A8A9A8, 0xAAAAAA44, 0x2A4A5254
+};
+
+static const uint8_t BC7_ANCHORS_2_1[64] = {
+    15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15,
+    15,  2,  8,  2,  2,  8,  8, 15,  2,  8,  2,  2,  8,  8,  2,  2,
+    15, 15,  6,  8,  2,  8, 15, 15,  2,  8,  2,  2,  2, 15, 15,  6,
+     6,  2,  6,  8, 15, 15,  2,  2, 15, 15, 15, 15, 15,  2,  2, 15
+};
+
+static const uint8_t BC7_ANCHORS_3_1[64] = {
+     3,  3, 15, 15,  8,  3, 15, 15,  8,  8,  6,  6,  6,  5,  3,  3,
+     3,  3,  8, 15,  3,  3,  6, 10,  5,  8,  8,  6,  8,  5, 15, 15,
+     8, 15,  3,  5,  6, 10,  8, 15, 15,  3, 15,  5, 15, 15, 15, 15,
+     3, 15,  5,  5,  5,  8,  5, 10,  5, 10,  8, 13, 15, 12,  3,  3
+};
+
+static const uint8_t BC7_ANCHORS_3_2[64] = {
+    15,  8,  8,  3, 15, 15,  3,  8, 15, 15, 15, 15, 15, 15, 15,  8,
+    15,  8, 15,  3, 15,  8, 15,  8,  3, 15,  6, 10, 15, 15, 10,  8,
+    15,  3, 15, 10, 10,  8,  9, 10,  6, 15,  8, 15,  3,  6,  6,  8,
+    15,  3, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15,  3, 15, 15,  8
+};
+
+static const uint8_t BC7_WEIGHTS_2[4]  = {0, 21, 43, 64};
+static const uint8_t BC7_WEIGHTS_3[8]  = {0, 9, 18, 27, 37, 46, 55, 64};
+static const uint8_t BC7_WEIGHTS_4[16] = {0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64};
+
+typedef struct {
+    uint64_t low;
+    uint64_t high;
+    unsigned position;
+} BlockBits;
+
+static uint32_t readU32(const uint8_t *pData);
+static uint64_t readU64(const uint8_t *pData);
+static int getBlockLayout(uint32_t vkFormat, uint32_t *pBlockWidth, uint32_t *pBlockHeight, uint32_t *pBlockSize);
+static unsigned readBits(BlockBits *pBits, unsigned count);
+static void decodeBC1Block(const uint8_t *pBlock, uint8_t pTexels[16][4], int hasAlpha);
+static void decodeBC7Block(const uint8_t *pBlock, uint8_t pTexels[16][4]);
+
+int u_ktx2_read(UKTX2Data *this, const char *const pUTF8Path) {
+    memset(this, 0, sizeof(*this));
+
+    this->pFileData = u_read_file(pUTF8Path, &this->fileSize);
+
+    if(this->pFileData == NULL)
+        return 0;
+
+    const uint8_t *pHeader = this->pFileData;
+
+    if(this->fileSize < HEADER_SIZE || memcmp(pHeader, KTX2_IDENTIFIER, sizeof(KTX2_IDENTIFIER)) != 0) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "u_ktx2_read: \"%s\" is not a KTX2 file.", pUTF8Path);
+        u_ktx2_free(this);
+        return 0;
+    }
+
+    this->vkFormat               = readU32(pHeader + 12);
+    this->typeSize               = readU32(pHeader + 16);
+    this->pixelWidth             = readU32(pHeader + 20);
+    this->pixelHeight            = readU32(pHeader + 24);
+    uint32_t pixelDepth          = readU32(pHeader + 28);
+    uint32_t layerCount          = readU32(pHeader + 32);
+    uint32_t faceCount           = readU32(pHeader + 36);
+    this->levelCount             = readU32(pHeader + 40);
+    this->supercompressionScheme = readU32(pHeader + 44);
+
+    // A level count of zero asks the loader to generate the mipmaps, so only the base level is in the file.
+    if(this->levelCount == 0)
+        this->levelCount = 1;
+
+    if(this->pixelWidth == 0 || this->pixelHeight == 0 || pixelDepth != 0 || layerCount > 1 || faceCount != 1) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "u_ktx2_read: \"%s\" is not a single 2D texture.", pUTF8Path);
+        u_ktx2_free(this);
+        return 0;
+    }
+
+    if(this->supercompressionScheme != 0) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "u_ktx2_read: \"%s\" uses unsupported supercompression scheme %u.", pUTF8Path, this->supercompressionScheme);
+        u_ktx2_free(this);
+        return 0;
+    }
+
+    uint32_t blockWidth, blockHeight, blockSize;
+
+    if(!getBlockLayout(this->vkFormat, &blockWidth, &blockHeight, &blockSize)) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "u_ktx2_read: \"%s\" uses unsupported VkFormat %u.", pUTF8Path, this->vkFormat);
+        u_ktx2_free(this);
+        return 0;
+    }
+
+    if(this->levelCount > U_KTX2_MAX_LEVELS || HEADER_SIZE + LEVEL_INDEX_ENTRY_SIZE * (int64_t)this->levelCount > this->fileSize) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "u_ktx2_read: \"%s\" has a bad level count of %u.", pUTF8Path, this->levelCount);
+        u_ktx2_free(this);
+        return 0;
+    }
+
+    for(uint32_t l = 0; l < this->levelCount; l++) {
+        const uint8_t *pEntry = pHeader + HEADER_SIZE + LEVEL_INDEX_ENTRY_SIZE * l;
+
+        this->levels[l].byteOffset             = readU64(pEntry);
+        this->levels[l].byteLength             = readU64(pEntry + 8);
+        this->levels[l].uncompressedByteLength = readU64(pEntry + 16);
+
+        uint32_t width  = this->pixelWidth  >> l;
+        uint32_t height = this->pixelHeight >> l;
+
+        if(width == 0)
+            width = 1;
+        if(height == 0)
+            height = 1;
+
+        uint64_t expectedLength = (uint64_t)((width + blockWidth - 1) / blockWidth) * ((height + blockHeight - 1) / blockHeight) * blockSize;
+
+        if(this->levels[l].byteLength != expectedLength ||
+           this->levels[l].byteOffset > (uint64_t)this->fileSize ||
+           this->levels[l].byteLength > (uint64_t)this->fileSize - this->levels[l].byteOffset) {
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "u_ktx2_read: \"%s\" level %u is out of bounds or has the wrong size.", pUTF8Path, l);
+            u_ktx2_free(this);
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+void u_ktx2_free(UKTX2Data *this) {
+    if(this->pFileData != NULL)
+        free(this->pFileData);
+
+    this->pFileData = NULL;
+    this->fileSize = 0;
+}
+
+const uint8_t* u_ktx2_get_level(const UKTX2Data *const this, uint32_t level, uint32_t *pWidth, uint32_t *pHeight, size_t *pByteLength) {
+    if(level >= this->levelCount)
+        return NULL;
+
+    uint32_t width  = this->pixelWidth  >> level;
+    uint32_t height = this->pixelHeight >> level;
+
+    if(pWidth != NULL)
+        *pWidth = width == 0 ? 1 : width;
+    if(pHeight != NULL)
+        *pHeight = height == 0 ? 1 : height;
+    if(pByteLength != NULL)
+        *pByteLength = this->levels[level].byteLength;
+
+    return this->pFileData + this->levels[level].byteOffset;
+}
+
+uint32_t u_ktx2_transcode_format(uint32_t vkFormat) {
+    switch(vkFormat) {
+        case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+        case VK_FORMAT_BC1_RGBA_SRGB_BLOCK:
+        case VK_FORMAT_BC7_SRGB_BLOCK:
+            return VK_FORMAT_R8G8B8A8_SRGB;
+        case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+        case VK_FORMAT_BC1_RGBA_UNORM_BLOCK:
+        case VK_FORMAT_BC7_UNORM_BLOCK:
+            return VK_FORMAT_R8G8B8A8_UNORM;
+        default:
+            return VK_FORMAT_UNDEFINED;
+    }
+}
+
+int u_ktx2_transcode_rgba8(const UKTX2Data *const this, uint32_t level, uint8_t *pDestination) {
+    uint32_t width, height;
+    const uint8_t *pBlock = u_ktx2_get_level(this, level, &width, &height, NULL);
+
+    if(pBlock == NULL || u_ktx2_transcode_format(this->vkFormat) == VK_FORMAT_UNDEFINED)
+        return 0;
+
+    const int isBC7 = this->vkFormat == VK_FORMAT_BC7_UNORM_BLOCK || this->vkFormat == VK_FORMAT_BC7_SRGB_BLOCK;
+    const int hasAlpha = this->vkFormat == VK_FORMAT_BC1_RGBA_UNORM_BLOCK || this->vkFormat == VK_FORMAT_BC1_RGBA_SRGB_BLOCK;
+    const unsigned blockSize = isBC7 ? 16 : 8;
+
+    uint8_t texels[16][4];
+
+    for(uint32_t by = 0; by < height; by += 4) {
+        for(uint32_t bx = 0; bx < width; bx += 4) {
+            if(isBC7)
+                decodeBC7Block(pBlock, texels);
+            else
+                decodeBC1Block(pBlock, texels, hasAlpha);
+
+            pBlock += blockSize;
+
+            // Blocks on the right and bottom edges can hang over the image.
+            for(uint32_t y = 0; y < 4 && by + y < height; y++) {
+                for(uint32_t x = 0; x < 4 && bx + x < width; x++) {
+                    memcpy(pDestination + 4 * ((by + y) * width + bx + x), texels[4 * y + x], 4);
+                }
+            }
+        }
+    }
+
+    return 1;
+}
+
+static uint32_t readU32(const uint8_t *pData) {
+    return (uint32_t)pData[0] | ((uint32_t)pData[1] << 8) | ((uint32_t)pData[2] << 16) | ((uint32_t)pData[3] << 24);
+}
+
+static uint64_t readU64(const uint8_t *pData) {
+    return (uint64_t)readU32(pData) | ((uint64_t)readU32(pData + 4) << 32);
+}
+
+static int getBlockLayout(uint32_t vkFormat, uint32_t *pBlockWidth, uint32_t *pBlockHeight, uint32_t *pBlockSize) {
+    *pBlockWidth  = 4;
+    *pBlockHeight = 4;
+
+    switch(vkFormat) {
+        case VK_FORMAT_R8G8B8A8_UNORM:
+        case VK_FORMAT_R8G8B8A8_SRGB:
+            *pBlockWidth  = 1;
+            *pBlockHeight = 1;
+            *pBlockSize   = 4;
+            return 1;
+        case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+        case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+        case VK_FORMAT_BC1_RGBA_UNORM_BLOCK:
+        case VK_FORMAT_BC1_RGBA_SRGB_BLOCK:
+        case VK_FORMAT_ETC2_R8G8B8_UNORM_BLOCK:
+        case VK_FORMAT_ETC2_R8G8B8_SRGB_BLOCK:
+            *pBlockSize = 8;
+            return 1;
+        case VK_FORMAT_BC7_UNORM_BLOCK:
+        case VK_FORMAT_BC7_SRGB_BLOCK:
+        case VK_FORMAT_ETC2_R8G8B8A8_UNORM_BLOCK:
+        case VK_FORMAT_ETC2_R8G8B8A8_SRGB_BLOCK:
+        case VK_FORMAT_ASTC_4x4_UNORM_BLOCK:
+        case VK_FORMAT_ASTC_4x4_SRGB_BLOCK:
+            *pBlockSize = 16;
+            return 1;
+        default:
+            return 0;
+    }
+}
+
+static unsigned readBits(BlockBits *pBits, unsigned count) {
+    uint64_t value;
+
+    if(pBits->position >= 64)
+        value = pBits->high >> (pBits->position - 64);
+    else if(pBits->position + count <= 64)
+        value = pBits->low >> pBits->position;
+    else
+        value = (pBits->low >> pBits->position) | (pBits->high << (64 - pBits->position));
+
+    pBits->position += count;
+
+    return (unsigned)(value & ((1u << count) - 1));
+}
+
+static void decodeBC1Block(const uint8_t *pBlock, uint8_t pTexels[16][4], int hasAlpha) {
+    uint8_t palette[4][4];
+    const unsigned color[2] = {pBlock[0] | (pBlock[1] << 8), pBlock[2] | (pBlock[3] << 8)};
+
+    for(unsigned e = 0; e < 2; e++) {
+        unsigned r = (color[e] >> 11) & 0x1F;
+        unsigned g = (color[e] >>  5) & 0x3F;
+        unsigned b = (color[e] >>  0) & 0x1F;
+
+        palette[e][0] = (r << 3) | (r >> 2);
+        palette[e][1] = (g << 2) | (g >> 4);
+        palette[e][2] = (b << 3) | (b >> 2);
+        palette[e][3] = 0xFF;
+    }
+
+    for(unsigned c = 0; c < 3; c++) {
+        if(color[0] > color[1]) {
+            palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+            palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+        }
+        else {
+            palette[2][c] = (palette[0][c] + palette[1][c]) / 2;
+            palette[3][c] = 0;
+        }
+    }
+    palette[2][3] = 0xFF;
+    palette[3][3] = (color[0] <= color[1] && hasAlpha) ? 0 : 0xFF;
+
+    const uint32_t indices = readU32(pBlock + 4);
+
+    for(unsigned i = 0; i < 16; i++)
+        memcpy(pTexels[i], palette[(indices >> (2 * i)) & 3], 4);
+}
+
+static void decodeBC7Block(const uint8_t *pBlock, uint8_t pTexels[16][4]) {
+    BlockBits bits = {readU64(pBlock), readU64(pBlock + 8), 0};
+
+    unsigned mode = 0;
+    while(mode < 8 && readBits(&bits, 1) == 0)
+        mode++;
+
+    // Reserved modes decode to transparent black.
+    if(mode == 8) {
+        memset(pTexels, 0, 16 * 4);
+        return;
+    }
+
+    const BC7Mode *const pMode = &BC7_MODES[mode];
+
+    const unsigned partition      = readBits(&bits, pMode->partitionBits);
+    const unsigned rotation       = readBits(&bits, pMode->rotationBits);
+    const unsigned indexSelection = readBits(&bits, pMode->indexSelectionBits);
+
+    uint8_t endpoints[3][2][4];
+
+    for(unsigned c = 0; c < 3; c++) {
+        for(unsigned s = 0; s < pMode->subsetAmount; s++) {
+            endpoints[s][0][c] = readBits(&bits, pMode->colorBits);
+            endpoints[s][1][c] = readBits(&bits, pMode->colorBits);
+        }
+    }
+
+    for(unsigned s = 0; s < pMode->subsetAmount; s++) {
+        endpoints[s][0][3] = readBits(&bits, pMode->alphaBits);
+        endpoints[s][1][3] = readBits(&bits, pMode->alphaBits);
+    }
+
+    uint8_t pBits[3][2] = {{0}};
+    const unsigned hasPBits = pMode->endpointPBits + pMode->sharedPBits;
+
+    for(unsigned s = 0; s < pMode->subsetAmount; s++) {
+        if(pMode->endpointPBits != 0) {
+            pBits[s][0] = readBits(&bits, 1);
+            pBits[s][1] = readBits(&bits, 1);
+        }
+        else if(pMode->sharedPBits != 0) {
+            pBits[s][0] = readBits(&bits, 1);
+            pBits[s][1] = pBits[s][0];
+        }
+    }
+
+    for(unsigned s = 0; s < pMode->subsetAmount; s++) {
+        for(unsigned e = 0; e < 2; e++) {
+            for(unsigned c = 0; c < 4; c++) {
+                unsigned precision = c < 3 ? pMode->colorBits : pMode->alphaBits;
+
+                if(precision == 0) {
+                    endpoints[s][e][c] = 0xFF;
+                    continue;
+                }
+
+                unsigned value = endpoints[s][e][c];
+
+                if(hasPBits) {
+                    value = (value << 1) | pBits[s][e];
+                    precision++;
+                }
+
+                value <<= 8 - precision;
+                endpoints[s][e][c] = value | (value >> precision);
+            }
+        }
+    }
+
+    uint8_t subsets[16];
+    uint8_t indices[16];
+    uint8_t secondaryIndices[16] = {0};
+
+    for(unsigned i = 0; i < 16; i++) {
+        int isAnchor = (i == 0);
+
+        if(pMode->subsetAmount == 2) {
+            subsets[i] = (BC7_PARTITIONS_2[partition] >> i) & 1;
+
+            isAnchor |= (subsets[i] == 1 && i == BC7_ANCHORS_2_1[partition]);
+        }
+        else if(pMode->subsetAmount == 3) {
+            subsets[i] = (BC7_PARTITIONS_3[partition] >> (2 * i)) & 3;
+
+            isAnchor |= (subsets[i] == 1 && i == BC7_ANCHORS_3_1[partition]);
+            isAnchor |= (subsets[i] == 2 && i == BC7_ANCHORS_3_2[partition]);
+        }
+        else
+            subsets[i] = 0;
+
+        // The most significant bit of an anchor index is always zero, so it is not stored.
+        indices[i] = readBits(&bits, pMode->indexBits - isAnchor);
+    }
+
+    if(pMode->secondaryIndexBits != 0) {
+        for(unsigned i = 0; i < 16; i++)
+            secondaryIndices[i] = readBits(&bits, pMode->secondaryIndexBits - (i == 0));
+    }
+
+    const uint8_t *const WEIGHTS[5] = {NULL, NULL, BC7_WEIGHTS_2, BC7_WEIGHTS_3, BC7_WEIGHTS_4};
+
+    for(unsigned i = 0; i < 16; i++) {
+        const uint8_t (*pEndpoints)[4] = endpoints[subsets[i]];
+        unsigned colorWeight, alphaWeight;
+
+        if(pMode->secondaryIndexBits == 0) {
+            colorWeight = WEIGHTS[pMode->indexBits][indices[i]];
+            alphaWeight = colorWeight;
+        }
+        else if(indexSelection == 0) {
+            colorWeight = WEIGHTS[pMode->indexBits][indices[i]];
+            alphaWeight = WEIGHTS[pMode->secondaryIndexBits][secondaryIndices[i]];
+        }
+        else {
+            colorWeight = WEIGHTS[pMode->secondaryIndexBits][secondaryIndices[i]];
+            alphaWeight = WEIGHTS[pMode->indexBits][indices[i]];
+        }
+
+        for(unsigned c = 0; c < 3; c++)
+            pTexels[i][c] = ((64 - colorWeight) * pEndpoints[0][c] + colorWeight * pEndpoints[1][c] + 32) >> 6;
+        pTexels[i][3] = ((64 - alphaWeight) * pEndpoints[0][3] + alphaWeight * pEndpoints[1][3] + 32) >> 6;
+
+        if(rotation != 0) {
+            uint8_t swap = pTexels[i][3];
+            pTexels[i][3] = pTexels[i][rotation - 1];
+            pTexels[i][rotation - 1] = swap;
+        }
+    }
+}
@@ -0,0 +1,52 @@
+#ifndef U_KTX2_29
+#define U_KTX2_29
+
+#include "u_ktx2_def.h"
+
+#include <stddef.h>
+
+/**
+ * Read a KTX2 container and validate its level index.
+ * @note Only supercompression scheme 0 (none) and 2D textures with a single layer and face are accepted.
+ * @warning If this function succeeds you are responsiable for calling u_ktx2_free().
+ * @param this The UKTX2Data to fill. It is cleared on failure.
+ * @param pUTF8Path The path to where the KTX2 file is. It is encoded with unicode.
+ * @return 1 if the file is a usable KTX2 container. 0 if the file could not be read, or if its format or layout is not supported.
+ */
+int u_ktx2_read(UKTX2Data *this, const char *const pUTF8Path);
+
+/**
+ * Free the file data held by this.
+ * @param this The UKTX2Data that was filled by u_ktx2_read().
+ */
+void u_ktx2_free(UKTX2Data *this);
+
+/**
+ * Get the texel data and the dimensions of a mip level.
+ * @param this The UKTX2Data that was filled by u_ktx2_read().
+ * @param level The mip level. Zero is the largest image.
+ * @param pWidth Returns the width of the level in pixel units. Can be NULL.
+ * @param pHeight Returns the height of the level in pixel units. Can be NULL.
+ * @param pByteLength Returns the size of the level in bytes. Can be NULL.
+ * @return A pointer into this->pFileData or NULL if level is out of range.
+ */
+const uint8_t* u_ktx2_get_level(const UKTX2Data *const this, uint32_t level, uint32_t *pWidth, uint32_t *pHeight, size_t *pByteLength);
+
+/**
+ * Find the VkFormat that u_ktx2_transcode_rgba8() would produce for a KTX2 format.
+ * @param vkFormat The VkFormat of the KTX2 container.
+ * @return VK_FORMAT_R8G8B8A8_SRGB or VK_FORMAT_R8G8B8A8_UNORM if vkFormat has a CPU decoder. Otherwise VK_FORMAT_UNDEFINED.
+ */
+uint32_t u_ktx2_transcode_format(uint32_t vkFormat);
+
+/**
+ * Decode a block compressed mip level into 8-bit RGBA on the CPU. This is the fallback for devices that cannot sample the stored format.
+ * @note Only BC1 and BC7 are decoded.
+ * @param this The UKTX2Data that was filled by u_ktx2_read().
+ * @param level The mip level. Zero is the largest image.
+ * @param pDestination The buffer to write 4 * width * height bytes to.
+ * @return 1 if the level was decoded. 0 if the format has no decoder or the level is out of range.
+ */
+int u_ktx2_transcode_rgba8(const UKTX2Data *const this, uint32_t level, uint8_t *pDestination);
+
+#endif // U_KTX2_29
@@ -0,0 +1,27 @@
+#ifndef U_KTX2_DEF_29
+#define U_KTX2_DEF_29
+
+#include <stdint.h>
+
+#define U_KTX2_MAX_LEVELS 16
+
+typedef struct UKTX2Level {
+    uint64_t byteOffset;
+    uint64_t byteLength;
+    uint64_t uncompressedByteLength;
+} UKTX2Level;
+
+typedef struct UKTX2Data {
+    uint32_t vkFormat; // The VkFormat that the texels are stored in.
+    uint32_t typeSize;
+    uint32_t pixelWidth;
+    uint32_t pixelHeight;
+    uint32_t levelCount; // Always at least one.
+    uint32_t supercompressionScheme;
+    UKTX2Level levels[U_KTX2_MAX_LEVELS]; // Level zero is the largest image.
+
+    int64_t fileSize;
+    uint8_t *pFileData;
+} UKTX2Data;
+
+#endif // U_KTX2_DEF_29
@@ -2,15 +2,42 @@
 
 #include "u_bit_array.h"
 #include "u_random.h"
+#include "u_thread.h"
 
 #include "SDL_log.h"
+#include "SDL_timer.h"
 
 #include <assert.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 // #define DEBUG_U_MAZE
 
+// The set of a cell that no row above has reached.
+#define ELLER_NO_SET UINT32_MAX
+
+static int primsWalk(UMazeCompactLink *pLinks, uint32_t *pLinkAmount, const UMazeCompactData *const pGraph, uint32_t vertexAmount, uint32_t width, URandom *pRandom);
+static int allocCompactResult(UMazeCompactGenResult *pUMazeGenResult, uint32_t vertexAmount);
+static void buildCompactVertexGrid(UMazeCompactGenResult *pUMazeGenResult, uint32_t vertexAmount, uint32_t width);
+static void seedStream(URandom *pRandom, uint32_t seed, uint32_t stream);
+static uint32_t tileExtent(uint32_t gridExtent, uint32_t start, uint32_t tileSize);
+static uint32_t disjointSetFind(uint32_t *pParents, uint32_t index);
+static int disjointSetUnion(uint32_t *pParents, uint8_t *pRanks, uint32_t index_0, uint32_t index_1);
+static void genTileTask(void *pUserData, unsigned index);
+static int ellerRow(UMazeEllerState *this, UMazeRowCallback callback, void *pUserData);
+
+typedef struct {
+    UMazeCompactLink *pLinks;
+    uint32_t width;
+    uint32_t depth;
+    uint32_t tileSize;
+    uint32_t tilesX;
+    uint32_t seed;
+    const uint32_t *pTileLinkOffsets; // Where each tile writes its links in pLinks.
+    uint32_t *pTileLinkAmounts;       // The amount of links each tile made. It is checked after every tile is done.
+} TiledGen;
+
 static int allocData(UMazeData *pMazeData, size_t vertexAmount, size_t linkAmount) {
     assert(pMazeData != NULL);
 
@@ -139,7 +166,10 @@ int u_maze_gen(UMazeGenResult *pUMazeGenResult, const UMazeData *const pMazeData
 
     pUMazeGenResult->pSource = pMazeData;
 
-    size_t vertexIndex = u_random_xorshift32(&seed) % pMazeData->vertexAmount;
+    URandom random;
+    u_random_seed(&random, seed);
+
+    size_t vertexIndex = u_random_range(&random, pMazeData->vertexAmount);
 
     U_BIT_ARRAY_SET(pBitVisitedArray, vertexIndex, 1);
     for(uint32_t i = 0; i < pMazeData->pVertices[vertexIndex].linkAmount; i++) {
@@ -152,7 +182,7 @@ int u_maze_gen(UMazeGenResult *pUMazeGenResult, const UMazeData *const pMazeData
     }
 
     while(answerIndex != answerSize && linkArraySize != 0) {
-        const size_t linkIndex = u_random_xorshift32(&seed) % linkArraySize;
+        const size_t linkIndex = u_random_range(&random, linkArraySize);
         const size_t vertexLinkIndex = pLinkArray[linkIndex].vertexIndex[1];
 
         if(U_BIT_ARRAY_GET(pBitVisitedArray, vertexLinkIndex) == 0) {
@@ -251,3 +281,928 @@ void u_maze_delete_result(UMazeGenResult *pMazeGenResult) {
 
     u_maze_delete_data(&pMazeGenResult->vertexMazeData); // pMazeGenResult->vertexMazeData
 }
+
+static int allocCompactData(UMazeCompactData *pMazeData, uint32_t vertexAmount, uint32_t linkAmount) {
+    assert(pMazeData != NULL);
+
+    // The offsets and the links share one allocation like allocData() does.
+    uint32_t *pMem = malloc(((size_t)vertexAmount + 1 + linkAmount) * sizeof(uint32_t));
+
+    if(pMem == NULL)
+        return 0;
+
+    pMazeData->vertexAmount = vertexAmount;
+    pMazeData->linkAmount   = linkAmount;
+
+    pMazeData->pLinkOffsets     = pMem;
+    pMazeData->pVertexLinkArray = pMem + vertexAmount + 1;
+
+    return 1;
+}
+
+int u_maze_compact_gen_full_sq_grid(UMazeCompactData *pMazeData, uint32_t width, uint32_t depth) {
+    assert(width >= 2);
+    assert(depth >= 2);
+
+    if((uint64_t)width * depth >= UINT32_MAX)
+        return 0;
+
+    const uint32_t totalVertices = width * depth;
+    const uint64_t totalLinks    = 2 * ((uint64_t)(width - 1) * depth + (uint64_t)width * (depth - 1));
+
+    if(totalLinks > UINT32_MAX || !allocCompactData(pMazeData, totalVertices, totalLinks))
+        return 0;
+
+    pMazeData->width = width;
+
+    uint32_t *pLinks = pMazeData->pVertexLinkArray;
+    uint32_t linkIndex = 0;
+
+    for(uint32_t y = 0; y < depth; y++) {
+        for(uint32_t x = 0; x < width; x++) {
+            const uint32_t offset = y * width + x;
+
+            pMazeData->pLinkOffsets[offset] = linkIndex;
+
+            if(x + 1 < width)
+                pLinks[linkIndex++] = offset + 1;
+            if(x != 0)
+                pLinks[linkIndex++] = offset - 1;
+            if(y + 1 < depth)
+                pLinks[linkIndex++] = offset + width;
+            if(y != 0)
+                pLinks[linkIndex++] = offset - width;
+        }
+    }
+
+    pMazeData->pLinkOffsets[totalVertices] = linkIndex;
+
+    assert(linkIndex == pMazeData->linkAmount);
+
+    return 1;
+}
+
+void u_maze_compact_delete_data(UMazeCompactData *pMazeData) {
+    assert(pMazeData != NULL);
+
+    if(pMazeData->pLinkOffsets != NULL)
+        free(pMazeData->pLinkOffsets); // pVertexLinkArray is in the same allocation.
+
+    pMazeData->pLinkOffsets = NULL;
+    pMazeData->pVertexLinkArray = NULL;
+    pMazeData->width = 0;
+    pMazeData->vertexAmount = 0;
+    pMazeData->linkAmount = 0;
+}
+
+Vector2 u_maze_compact_position(const UMazeCompactData *const pMazeData, uint32_t vertexIndex) {
+    Vector2 position;
+
+    position.x = vertexIndex % pMazeData->width;
+    position.y = vertexIndex / pMazeData->width;
+
+    return position;
+}
+
+int u_maze_compact_gen(UMazeCompactGenResult *pUMazeGenResult, const UMazeCompactData *const pMazeData, uint32_t seed, int genVertexGrid) {
+    assert(pMazeData != NULL);
+
+    if(pMazeData->vertexAmount < 2)
+        return 0;
+
+    if(!allocCompactResult(pUMazeGenResult, pMazeData->vertexAmount))
+        return 0;
+
+    URandom random;
+    u_random_seed(&random, seed);
+
+    if(!primsWalk(pUMazeGenResult->pLinks, &pUMazeGenResult->linkAmount, pMazeData, pMazeData->vertexAmount, pMazeData->width, &random)) {
+        u_maze_compact_delete_result(pUMazeGenResult);
+        return 0;
+    }
+
+    pUMazeGenResult->pSource = pMazeData;
+
+    if(genVertexGrid)
+        buildCompactVertexGrid(pUMazeGenResult, pMazeData->vertexAmount, pMazeData->width);
+
+    return 1;
+}
+
+int u_maze_gen_sq_grid(UMazeCompactGenResult *pUMazeGenResult, uint32_t width, uint32_t depth, uint32_t seed, int genVertexGrid) {
+    assert(width >= 2);
+    assert(depth >= 2);
+
+    if((uint64_t)width * depth >= UINT32_MAX)
+        return 0;
+
+    if(!allocCompactResult(pUMazeGenResult, width * depth))
+        return 0;
+
+    URandom random;
+    u_random_seed(&random, seed);
+
+    if(!primsWalk(pUMazeGenResult->pLinks, &pUMazeGenResult->linkAmount, NULL, width * depth, width, &random)) {
+        u_maze_compact_delete_result(pUMazeGenResult);
+        return 0;
+    }
+
+    pUMazeGenResult->pSource = NULL;
+
+    if(genVertexGrid)
+        buildCompactVertexGrid(pUMazeGenResult, width * depth, width);
+
+    return 1;
+}
+
+void u_maze_compact_delete_result(UMazeCompactGenResult *pMazeGenResult) {
+    assert(pMazeGenResult != NULL);
+
+    if(pMazeGenResult->pLinks != NULL)
+        free(pMazeGenResult->pLinks);
+
+    pMazeGenResult->linkAmount = 0;
+    pMazeGenResult->pLinks = NULL;
+
+    u_maze_compact_delete_data(&pMazeGenResult->vertexMazeData);
+}
+
+int u_maze_gen_sq_grid_tiled(UMazeCompactGenResult *pUMazeGenResult, uint32_t width, uint32_t depth, uint32_t tileSize, uint32_t seed, int genVertexGrid) {
+    assert(width >= 2);
+    assert(depth >= 2);
+    assert(tileSize >= 1);
+
+    if((uint64_t)width * depth >= UINT32_MAX)
+        return 0;
+
+    const uint32_t tilesX = (width + tileSize - 1) / tileSize;
+    const uint32_t tilesY = (depth + tileSize - 1) / tileSize;
+    const uint32_t tileAmount = tilesX * tilesY;
+
+    // Every tile is one spanning tree, so its links go right after the links of the tile before it.
+    uint32_t *pTileLinkOffsets = malloc(2 * (size_t)tileAmount * sizeof(uint32_t));
+
+    if(pTileLinkOffsets == NULL)
+        return 0;
+
+    uint32_t *pTileLinkAmounts = pTileLinkOffsets + tileAmount;
+    uint32_t linkOffset = 0;
+
+    for(uint32_t t = 0; t < tileAmount; t++) {
+        const uint32_t tileWidth = tileExtent(width, (t % tilesX) * tileSize, tileSize);
+        const uint32_t tileDepth = tileExtent(depth, (t / tilesX) * tileSize, tileSize);
+
+        pTileLinkOffsets[t] = linkOffset;
+        linkOffset += tileWidth * tileDepth - 1;
+    }
+
+    if(!allocCompactResult(pUMazeGenResult, width * depth)) {
+        free(pTileLinkOffsets);
+        return 0;
+    }
+
+    TiledGen tiledGen;
+    tiledGen.pLinks = pUMazeGenResult->pLinks;
+    tiledGen.width = width;
+    tiledGen.depth = depth;
+    tiledGen.tileSize = tileSize;
+    tiledGen.tilesX = tilesX;
+    tiledGen.seed = seed;
+    tiledGen.pTileLinkOffsets = pTileLinkOffsets;
+    tiledGen.pTileLinkAmounts = pTileLinkAmounts;
+
+    u_thread_parallel_for(tileAmount, genTileTask, &tiledGen);
+
+    int success = 1;
+
+    for(uint32_t t = 0; t < tileAmount; t++) {
+        const uint32_t nextOffset = (t + 1 < tileAmount) ? pTileLinkOffsets[t + 1] : linkOffset;
+
+        if(pTileLinkAmounts[t] != nextOffset - pTileLinkOffsets[t])
+            success = 0;
+    }
+
+    free(pTileLinkOffsets);
+
+    // The tiles are joined with randomized Kruskal over one random border link per pair of neighboring tiles.
+    const uint32_t candidateAmount = (tilesX - 1) * tilesY + tilesX * (tilesY - 1);
+    UMazeCompactLink *pCandidates = malloc((size_t)candidateAmount * sizeof(UMazeCompactLink) + (size_t)tileAmount * (sizeof(uint32_t) + sizeof(uint8_t)));
+
+    if(!success || pCandidates == NULL) {
+        free(pCandidates);
+        u_maze_compact_delete_result(pUMazeGenResult);
+        return 0;
+    }
+
+    uint32_t *pParents = (uint32_t*)(pCandidates + candidateAmount);
+    uint8_t  *pRanks   = (uint8_t*)(pParents + tileAmount);
+    URandom stitchRandom;
+    seedStream(&stitchRandom, seed, tileAmount);
+    uint32_t candidateIndex = 0;
+
+    for(uint32_t t = 0; t < tileAmount; t++) {
+        const uint32_t x = (t % tilesX) * tileSize;
+        const uint32_t y = (t / tilesX) * tileSize;
+        const uint32_t tileWidth = tileExtent(width, x, tileSize);
+        const uint32_t tileDepth = tileExtent(depth, y, tileSize);
+
+        pParents[t] = t;
+        pRanks[t] = 0;
+
+        if(t % tilesX + 1 < tilesX) {
+            const uint32_t row = y + u_random_range(&stitchRandom, tileDepth);
+
+            pCandidates[candidateIndex].vertexIndex[0] = row * width + x + tileWidth - 1;
+            pCandidates[candidateIndex].vertexIndex[1] = row * width + x + tileWidth;
+            candidateIndex++;
+        }
+
+        if(t / tilesX + 1 < tilesY) {
+            const uint32_t column = x + u_random_range(&stitchRandom, tileWidth);
+
+            pCandidates[candidateIndex].vertexIndex[0] = (y + tileDepth - 1) * width + column;
+            pCandidates[candidateIndex].vertexIndex[1] = (y + tileDepth)     * width + column;
+            candidateIndex++;
+        }
+    }
+
+    assert(candidateIndex == candidateAmount);
+
+    for(uint32_t i = candidateAmount; i > 1; i--) {
+        const uint32_t swapIndex = u_random_range(&stitchRandom, i);
+        const UMazeCompactLink swap = pCandidates[i - 1];
+
+        pCandidates[i - 1] = pCandidates[swapIndex];
+        pCandidates[swapIndex] = swap;
+    }
+
+    for(uint32_t i = 0; i < candidateAmount; i++) {
+        const uint32_t index_0 = pCandidates[i].vertexIndex[0];
+        const uint32_t index_1 = pCandidates[i].vertexIndex[1];
+        const uint32_t tile_0 = (index_0 / width / tileSize) * tilesX + (index_0 % width) / tileSize;
+        const uint32_t tile_1 = (index_1 / width / tileSize) * tilesX + (index_1 % width) / tileSize;
+
+        if(disjointSetUnion(pParents, pRanks, tile_0, tile_1)) {
+            pUMazeGenResult->pLinks[linkOffset] = pCandidates[i];
+            linkOffset++;
+        }
+    }
+
+    free(pCandidates);
+
+    assert(linkOffset == width * depth - 1);
+
+    pUMazeGenResult->linkAmount = linkOffset;
+    pUMazeGenResult->pSource = NULL;
+
+    if(genVertexGrid)
+        buildCompactVertexGrid(pUMazeGenResult, width * depth, width);
+
+    return 1;
+}
+
+int u_maze_gen_sq_grid_kruskal(UMazeCompactGenResult *pUMazeGenResult, uint32_t width, uint32_t depth, uint32_t seed, int genVertexGrid) {
+    assert(width >= 2);
+    assert(depth >= 2);
+
+    const uint64_t horizontalAmount = (uint64_t)(width - 1) * depth;
+    const uint64_t linkAmount = horizontalAmount + (uint64_t)width * (depth - 1);
+
+    if((uint64_t)width * depth >= UINT32_MAX || linkAmount >= UINT32_MAX)
+        return 0;
+
+    const uint32_t vertexAmount = width * depth;
+
+    // The links are not stored. Link ids below horizontalAmount go right and the rest go down.
+    uint32_t *pLinkIds = malloc((size_t)linkAmount * sizeof(uint32_t) + (size_t)vertexAmount * (sizeof(uint32_t) + sizeof(uint8_t)));
+
+    if(pLinkIds == NULL)
+        return 0;
+
+    if(!allocCompactResult(pUMazeGenResult, vertexAmount)) {
+        free(pLinkIds);
+        return 0;
+    }
+
+    uint32_t *pParents = pLinkIds + linkAmount;
+    uint8_t  *pRanks   = (uint8_t*)(pParents + vertexAmount);
+
+    for(uint32_t i = 0; i < vertexAmount; i++)
+        pParents[i] = i;
+    memset(pRanks, 0, vertexAmount);
+
+    for(uint32_t i = 0; i < linkAmount; i++)
+        pLinkIds[i] = i;
+
+    URandom random;
+    u_random_seed(&random, seed);
+
+    for(uint32_t i = linkAmount; i > 1; i--) {
+        const uint32_t swapIndex = u_random_range(&random, i);
+        const uint32_t swap = pLinkIds[i - 1];
+
+        pLinkIds[i - 1] = pLinkIds[swapIndex];
+        pLinkIds[swapIndex] = swap;
+    }
+
+    uint32_t answerIndex = 0;
+
+    for(uint32_t i = 0; i < linkAmount && answerIndex != vertexAmount - 1; i++) {
+        uint32_t index_0;
+        uint32_t index_1;
+
+        if(pLinkIds[i] < horizontalAmount) {
+            index_0 = (pLinkIds[i] / (width - 1)) * width + pLinkIds[i] % (width - 1);
+            index_1 = index_0 + 1;
+        }
+        else {
+            index_0 = pLinkIds[i] - horizontalAmount;
+            index_1 = index_0 + width;
+        }
+
+        if(disjointSetUnion(pParents, pRanks, index_0, index_1)) {
+            pUMazeGenResult->pLinks[answerIndex].vertexIndex[0] = index_0;
+            pUMazeGenResult->pLinks[answerIndex].vertexIndex[1] = index_1;
+            answerIndex++;
+        }
+    }
+
+    free(pLinkIds);
+
+    pUMazeGenResult->linkAmount = answerIndex;
+    pUMazeGenResult->pSource = NULL;
+
+    if(genVertexGrid)
+        buildCompactVertexGrid(pUMazeGenResult, vertexAmount, width);
+
+    return 1;
+}
+
+int u_maze_gen_sq_grid_wilson(UMazeCompactGenResult *pUMazeGenResult, uint32_t width, uint32_t depth, uint32_t seed, int genVertexGrid) {
+    assert(width >= 2);
+    assert(depth >= 2);
+
+    if((uint64_t)width * depth >= UINT32_MAX)
+        return 0;
+
+    const uint32_t vertexAmount = width * depth;
+
+    // The bit array goes first in the block, so that its elements are aligned.
+    UBitElement *pBitInTreeArray = malloc(U_BIT_ARRAY_SIZE(vertexAmount) + vertexAmount);
+
+    if(pBitInTreeArray == NULL)
+        return 0;
+
+    if(!allocCompactResult(pUMazeGenResult, vertexAmount)) {
+        free(pBitInTreeArray);
+        return 0;
+    }
+
+    memset(pBitInTreeArray, 0, U_BIT_ARRAY_SIZE(vertexAmount));
+
+    // The last direction taken out of every vertex. Overwriting it when a walk revisits a vertex is the loop erasure.
+    uint8_t *pDirections = (uint8_t*)pBitInTreeArray + U_BIT_ARRAY_SIZE(vertexAmount);
+
+    const int32_t offsets[4] = {1, -1, (int32_t)width, -(int32_t)width};
+    uint32_t answerIndex = 0;
+
+    URandom random;
+    u_random_seed(&random, seed);
+
+    const uint32_t root = u_random_range(&random, vertexAmount);
+    U_BIT_ARRAY_SET(pBitInTreeArray, root, 1);
+
+    // Every random number holds 32 directions of two bits.
+    uint64_t directionBits = 0;
+    unsigned directionBitAmount = 0;
+
+    for(uint32_t start = 0; start < vertexAmount; start++) {
+        if(U_BIT_ARRAY_GET(pBitInTreeArray, start) != 0)
+            continue;
+
+        // Random walk until the tree is hit.
+        uint32_t vertexIndex = start;
+
+        while(U_BIT_ARRAY_GET(pBitInTreeArray, vertexIndex) == 0) {
+            const uint32_t x = vertexIndex % width;
+            uint8_t direction;
+
+            do {
+                if(directionBitAmount == 0) {
+                    directionBits = u_random_next(&random);
+                    directionBitAmount = 64;
+                }
+
+                direction = directionBits & 3;
+                directionBits >>= 2;
+                directionBitAmount -= 2;
+            } while((direction == 0 && x + 1 == width) || (direction == 1 && x == 0) || (direction == 2 && vertexAmount - vertexIndex <= width) || (direction == 3 && vertexIndex < width));
+
+            pDirections[vertexIndex] = direction;
+            vertexIndex += offsets[direction];
+        }
+
+        // Add the loop erased path to the tree.
+        for(vertexIndex = start; U_BIT_ARRAY_GET(pBitInTreeArray, vertexIndex) == 0; vertexIndex += offsets[pDirections[vertexIndex]]) {
+            U_BIT_ARRAY_SET(pBitInTreeArray, vertexIndex, 1);
+
+            pUMazeGenResult->pLinks[answerIndex].vertexIndex[0] = vertexIndex;
+            pUMazeGenResult->pLinks[answerIndex].vertexIndex[1] = vertexIndex + offsets[pDirections[vertexIndex]];
+            answerIndex++;
+        }
+    }
+
+    free(pBitInTreeArray);
+
+    assert(answerIndex == vertexAmount - 1);
+
+    pUMazeGenResult->linkAmount = answerIndex;
+    pUMazeGenResult->pSource = NULL;
+
+    if(genVertexGrid)
+        buildCompactVertexGrid(pUMazeGenResult, vertexAmount, width);
+
+    return 1;
+}
+
+int u_maze_gen_eller(uint32_t width, uint32_t depth, uint32_t seed, UMazeRowCallback callback, void *pUserData) {
+    assert(width >= 1);
+    assert(callback != NULL);
+
+    UMazeEllerState ellerState;
+
+    if(!u_maze_eller_init(&ellerState, width, depth, seed))
+        return 0;
+
+    int success = 1;
+
+    while(success && ellerState.row != depth)
+        success = u_maze_eller_step(&ellerState, UINT32_MAX, callback, pUserData);
+
+    u_maze_eller_free(&ellerState);
+
+    return success;
+}
+
+int u_maze_eller_init(UMazeEllerState *this, uint32_t width, uint32_t depth, uint32_t seed) {
+    assert(this != NULL);
+    assert(width >= 1);
+
+    // Sets are ids in [0, width), because a row can never hold more sets than cells. They are merged with a disjoint set that is reset every row.
+    uint32_t *pMem = malloc((size_t)width * (4 * sizeof(uint32_t) + 2 * sizeof(uint8_t)));
+
+    if(pMem == NULL) {
+        memset(this, 0, sizeof(*this));
+        return 0;
+    }
+
+    this->width = width;
+    this->depth = depth;
+    this->row = 0;
+    u_random_seed(&this->random, seed);
+
+    this->pCellSets  = pMem;
+    this->pParents   = this->pCellSets  + width;
+    this->pLastCells = this->pParents   + width;
+    this->pFreeSets  = this->pLastCells + width;
+    this->pRanks     = (uint8_t*)(this->pFreeSets + width);
+    this->pCells     = this->pRanks + width;
+
+    for(uint32_t x = 0; x < width; x++)
+        this->pCellSets[x] = ELLER_NO_SET;
+
+    return 1;
+}
+
+int u_maze_eller_step(UMazeEllerState *this, uint32_t budget, UMazeRowCallback callback, void *pUserData) {
+    assert(this != NULL);
+    assert(callback != NULL);
+
+    uint64_t cellAmount = 0;
+
+    do {
+        if(this->row == this->depth)
+            return 1;
+
+        if(!ellerRow(this, callback, pUserData))
+            return 0;
+
+        cellAmount += this->width;
+    } while(cellAmount < budget);
+
+    return 1;
+}
+
+int u_maze_eller_step_timed(UMazeEllerState *this, uint32_t microseconds, UMazeRowCallback callback, void *pUserData) {
+    assert(this != NULL);
+    assert(callback != NULL);
+
+    const Uint64 startCounter = SDL_GetPerformanceCounter();
+    const Uint64 counterLimit = SDL_GetPerformanceFrequency() * microseconds / 1000000;
+
+    do {
+        if(this->row == this->depth)
+            return 1;
+
+        if(!ellerRow(this, callback, pUserData))
+            return 0;
+    } while(SDL_GetPerformanceCounter() - startCounter < counterLimit);
+
+    return 1;
+}
+
+void u_maze_eller_free(UMazeEllerState *this) {
+    assert(this != NULL);
+
+    free(this->pCellSets);
+
+    memset(this, 0, sizeof(*this));
+}
+
+int u_maze_cells_to_result(UMazeCompactGenResult *pMazeGenResult, const uint8_t *pCells, uint32_t width, uint32_t depth, int genVertexGrid) {
+    const uint32_t vertexAmount = width * depth;
+    uint32_t linkAmount = 0;
+
+    for(uint32_t v = 0; v < vertexAmount; v++)
+        linkAmount += (pCells[v] & U_MAZE_CELL_EAST) + ((pCells[v] & U_MAZE_CELL_SOUTH) >> 1);
+
+    // Mazes have random walls, so the arrays are filled without branches. Every slot is written and the cursor only moves past the ones that are used.
+    // That is why both arrays have room for a few more entries than they hold.
+    memset(pMazeGenResult, 0, sizeof(*pMazeGenResult));
+    pMazeGenResult->pLinks = malloc(((size_t)linkAmount + 2) * sizeof(UMazeCompactLink));
+
+    if(pMazeGenResult->pLinks == NULL)
+        return 0;
+
+    uint32_t cursor = 0;
+
+    for(uint32_t v = 0; v < vertexAmount; v++) {
+        UMazeCompactLink *pLink = &pMazeGenResult->pLinks[cursor];
+
+        pLink->vertexIndex[0] = v;
+        pLink->vertexIndex[1] = v + 1;
+        cursor += pCells[v] & U_MAZE_CELL_EAST;
+
+        pLink = &pMazeGenResult->pLinks[cursor];
+        pLink->vertexIndex[0] = v;
+        pLink->vertexIndex[1] = v + width;
+        cursor += (pCells[v] & U_MAZE_CELL_SOUTH) >> 1;
+    }
+    pMazeGenResult->linkAmount = linkAmount;
+
+    if(!genVertexGrid)
+        return 1;
+
+    // The offsets and the links share one allocation like the generators make them.
+    UMazeCompactData *pVertexMazeData = &pMazeGenResult->vertexMazeData;
+    uint32_t *pMem = malloc(((size_t)vertexAmount + 1 + 2 * (size_t)linkAmount + 4) * sizeof(uint32_t));
+
+    if(pMem == NULL) {
+        u_maze_compact_delete_result(pMazeGenResult);
+        return 0;
+    }
+
+    pVertexMazeData->width = width;
+    pVertexMazeData->vertexAmount = vertexAmount;
+    pVertexMazeData->linkAmount = 2 * linkAmount;
+    pVertexMazeData->pLinkOffsets = pMem;
+    pVertexMazeData->pVertexLinkArray = pMem + vertexAmount + 1;
+
+    // The openings of a cell and of its west and north neighbors are all of its links, so one pass in vertex order fills the CSR arrays.
+    // The neighbors are in the order +1, -1, +width, -width like the generators use.
+    uint32_t *pLinkOffsets = pVertexMazeData->pLinkOffsets;
+    uint32_t *pVertexLinkArray = pVertexMazeData->pVertexLinkArray;
+
+    cursor = 0;
+
+    for(uint32_t y = 0; y < depth; y++) {
+        const uint8_t *pRow = &pCells[(size_t)y * width];
+        const uint8_t *pNorthRow = y != 0 ? pRow - width : pRow; // The first row has no north links. Its own cells are masked out below.
+        const uint32_t northMask = y != 0 ? U_MAZE_CELL_SOUTH : 0;
+        const uint32_t rowStart = y * width;
+
+        for(uint32_t x = 0; x < width; x++) {
+            const uint32_t v = rowStart + x;
+            const uint32_t west = x != 0 ? pRow[x - 1] & U_MAZE_CELL_EAST : 0;
+
+            pLinkOffsets[v] = cursor;
+
+            pVertexLinkArray[cursor] = v + 1;
+            cursor += pRow[x] & U_MAZE_CELL_EAST;
+            pVertexLinkArray[cursor] = v - 1;
+            cursor += west;
+            pVertexLinkArray[cursor] = v + width;
+            cursor += (pRow[x] & U_MAZE_CELL_SOUTH) >> 1;
+            pVertexLinkArray[cursor] = v - width;
+            cursor += (pNorthRow[x] & northMask) >> 1;
+        }
+    }
+    pVertexMazeData->pLinkOffsets[vertexAmount] = cursor;
+
+    return 1;
+}
+
+static int allocCompactResult(UMazeCompactGenResult *pUMazeGenResult, uint32_t vertexAmount) {
+    pUMazeGenResult->linkAmount = 0;
+    pUMazeGenResult->pLinks = malloc((vertexAmount - 1) * sizeof(UMazeCompactLink));
+
+    pUMazeGenResult->vertexMazeData.pLinkOffsets = NULL;
+    pUMazeGenResult->vertexMazeData.pVertexLinkArray = NULL;
+
+    return pUMazeGenResult->pLinks != NULL;
+}
+
+static int primsWalk(UMazeCompactLink *pLinks, uint32_t *pLinkAmount, const UMazeCompactData *const pGraph, uint32_t vertexAmount, uint32_t width, URandom *pRandom) {
+    // Unlike u_maze_gen() the frontier grows on demand, because it rarely gets close to every link in the graph.
+    uint32_t linkArraySize = 0;
+    uint32_t linkArrayMaxSize = 1024;
+
+    UBitElement *pBitVisitedArray = calloc(1, U_BIT_ARRAY_SIZE(vertexAmount));
+    UMazeCompactLink *pLinkArray = malloc(linkArrayMaxSize * sizeof(UMazeCompactLink));
+
+    const uint32_t answerSize = vertexAmount - 1; // Amount of edges to be returned.
+    uint32_t answerIndex = 0;
+
+    if(pBitVisitedArray == NULL || pLinkArray == NULL) {
+        free(pBitVisitedArray);
+        free(pLinkArray);
+        return 0;
+    }
+
+    uint32_t vertexIndex = u_random_range(pRandom, vertexAmount);
+
+    while(1) {
+        U_BIT_ARRAY_SET(pBitVisitedArray, vertexIndex, 1);
+
+        // Without a graph the neighbors of the grid are computed in the same order as u_maze_compact_gen_full_sq_grid() stores them.
+        uint32_t neighbors[4];
+        const uint32_t *pNeighbors = neighbors;
+        uint32_t neighborAmount = 0;
+
+        if(pGraph != NULL) {
+            pNeighbors = &pGraph->pVertexLinkArray[pGraph->pLinkOffsets[vertexIndex]];
+            neighborAmount = pGraph->pLinkOffsets[vertexIndex + 1] - pGraph->pLinkOffsets[vertexIndex];
+        }
+        else {
+            const uint32_t x = vertexIndex % width;
+
+            if(x + 1 < width)
+                neighbors[neighborAmount++] = vertexIndex + 1;
+            if(x != 0)
+                neighbors[neighborAmount++] = vertexIndex - 1;
+            if(vertexAmount - vertexIndex > width)
+                neighbors[neighborAmount++] = vertexIndex + width;
+            if(vertexIndex >= width)
+                neighbors[neighborAmount++] = vertexIndex - width;
+        }
+
+        // Links to visited vertices are never pushed, which also skips the link back to the parent.
+        for(uint32_t i = 0; i < neighborAmount; i++) {
+            const uint32_t neighborIndex = pNeighbors[i];
+
+            if(U_BIT_ARRAY_GET(pBitVisitedArray, neighborIndex) != 0)
+                continue;
+
+            if(linkArraySize == linkArrayMaxSize) {
+                UMazeCompactLink *pNewLinkArray = realloc(pLinkArray, 2 * (size_t)linkArrayMaxSize * sizeof(UMazeCompactLink));
+
+                if(pNewLinkArray == NULL) {
+                    free(pBitVisitedArray);
+                    free(pLinkArray);
+                    return 0;
+                }
+
+                pLinkArray = pNewLinkArray;
+                linkArrayMaxSize *= 2;
+            }
+
+            pLinkArray[linkArraySize].vertexIndex[0] = vertexIndex;
+            pLinkArray[linkArraySize].vertexIndex[1] = neighborIndex;
+            linkArraySize++;
+        }
+
+        if(answerIndex == answerSize)
+            break;
+
+        // Pop random links until one of them reaches an unvisited vertex.
+        UMazeCompactLink link;
+        int found = 0;
+
+        while(linkArraySize != 0) {
+            const uint32_t linkIndex = u_random_range(pRandom, linkArraySize);
+
+            link = pLinkArray[linkIndex];
+
+            linkArraySize--;
+            pLinkArray[linkIndex] = pLinkArray[linkArraySize];
+
+            if(U_BIT_ARRAY_GET(pBitVisitedArray, link.vertexIndex[1]) == 0) {
+                found = 1;
+                break;
+            }
+        }
+
+        if(!found)
+            break;
+
+        pLinks[answerIndex] = link;
+        answerIndex++;
+
+        vertexIndex = link.vertexIndex[1];
+    }
+
+    free(pBitVisitedArray);
+    free(pLinkArray);
+
+    *pLinkAmount = answerIndex;
+
+    return 1;
+}
+
+static void buildCompactVertexGrid(UMazeCompactGenResult *pUMazeGenResult, uint32_t vertexAmount, uint32_t width) {
+    if(!allocCompactData(&pUMazeGenResult->vertexMazeData, vertexAmount, 2 * pUMazeGenResult->linkAmount))
+        return;
+
+    UMazeCompactData *pVertexMazeData = &pUMazeGenResult->vertexMazeData;
+    uint32_t *pLinkOffsets = pVertexMazeData->pLinkOffsets;
+
+    pVertexMazeData->width = width;
+
+    // Count the links of every vertex, then turn the counts into offsets.
+    memset(pLinkOffsets, 0, ((size_t)vertexAmount + 1) * sizeof(uint32_t));
+
+    for(uint32_t i = 0; i < pUMazeGenResult->linkAmount; i++) {
+        pLinkOffsets[pUMazeGenResult->pLinks[i].vertexIndex[0] + 1]++;
+        pLinkOffsets[pUMazeGenResult->pLinks[i].vertexIndex[1] + 1]++;
+    }
+
+    for(uint32_t i = 0; i < vertexAmount; i++)
+        pLinkOffsets[i + 1] += pLinkOffsets[i];
+
+    // Fill using the offsets as cursors. Afterwards each offset holds the start of the next vertex, so they are shifted back.
+    for(uint32_t i = 0; i < pUMazeGenResult->linkAmount; i++) {
+        const uint32_t index_0 = pUMazeGenResult->pLinks[i].vertexIndex[0];
+        const uint32_t index_1 = pUMazeGenResult->pLinks[i].vertexIndex[1];
+
+        pVertexMazeData->pVertexLinkArray[pLinkOffsets[index_0]++] = index_1;
+        pVertexMazeData->pVertexLinkArray[pLinkOffsets[index_1]++] = index_0;
+    }
+
+    for(uint32_t i = vertexAmount; i != 0; i--)
+        pLinkOffsets[i] = pLinkOffsets[i - 1];
+    pLinkOffsets[0] = 0;
+}
+
+static void seedStream(URandom *pRandom, uint32_t seed, uint32_t stream) {
+    // u_random_seed() spreads every bit of the 64-bit value, so each tile gets its own unrelated sequence without jumping tile index times.
+    u_random_seed(pRandom, ((uint64_t)seed << 32) | stream);
+}
+
+static uint32_t tileExtent(uint32_t gridExtent, uint32_t start, uint32_t tileSize) {
+    // Tiles on the right and bottom edges can be cut short.
+    if(gridExtent - start < tileSize)
+        return gridExtent - start;
+    return tileSize;
+}
+
+static int ellerRow(UMazeEllerState *this, UMazeRowCallback callback, void *pUserData) {
+    const uint32_t width = this->width;
+    const int lastRow = this->row + 1 == this->depth;
+
+    uint32_t *pCellSets  = this->pCellSets;
+    uint32_t *pParents   = this->pParents;
+    uint32_t *pLastCells = this->pLastCells;
+    uint32_t *pFreeSets  = this->pFreeSets;
+    uint8_t  *pRanks     = this->pRanks;
+    uint8_t  *pCells     = this->pCells;
+
+    // Give every cell that was not reached from the row above a set of its own.
+    memset(pCells, 0, width);
+
+    for(uint32_t x = 0; x < width; x++) {
+        if(pCellSets[x] < width)
+            pCells[pCellSets[x]] = 1;
+    }
+
+    uint32_t freeAmount = 0;
+
+    for(uint32_t id = width; id != 0; id--) {
+        if(pCells[id - 1] == 0)
+            pFreeSets[freeAmount++] = id - 1;
+    }
+
+    for(uint32_t x = 0; x < width; x++) {
+        if(pCellSets[x] >= width)
+            pCellSets[x] = pFreeSets[--freeAmount];
+
+        pParents[x] = x;
+        pRanks[x] = 0;
+    }
+
+    memset(pCells, 0, width);
+
+    // Join neighbors of different sets at random. The last row joins all of them.
+    for(uint32_t x = 0; x + 1 < width; x++) {
+        if(disjointSetFind(pParents, pCellSets[x]) == disjointSetFind(pParents, pCellSets[x + 1]))
+            continue;
+
+        if(lastRow || (u_random_next(&this->random) >> 63) != 0) {
+            disjointSetUnion(pParents, pRanks, pCellSets[x], pCellSets[x + 1]);
+            pCells[x] |= U_MAZE_CELL_EAST;
+        }
+    }
+
+    for(uint32_t x = 0; x < width; x++) {
+        pCellSets[x] = disjointSetFind(pParents, pCellSets[x]);
+        pLastCells[pCellSets[x]] = x;
+    }
+
+    if(!lastRow) {
+        // Every set opens south at least once, so that no set is cut off from the rows below.
+        // pRanks is free now, so it marks the sets that have opened.
+        memset(pRanks, 0, width);
+
+        for(uint32_t x = 0; x < width; x++) {
+            const uint32_t set = pCellSets[x];
+
+            if((u_random_next(&this->random) >> 63) != 0 || (pRanks[set] == 0 && pLastCells[set] == x)) {
+                pCells[x] |= U_MAZE_CELL_SOUTH;
+                pRanks[set] = 1;
+            }
+        }
+    }
+
+    const int success = callback(pUserData, this->row, pCells, width);
+
+    // Only cells that open south carry their set into the next row.
+    for(uint32_t x = 0; x < width; x++) {
+        if((pCells[x] & U_MAZE_CELL_SOUTH) == 0)
+            pCellSets[x] = ELLER_NO_SET;
+    }
+
+    this->row++;
+
+    return success;
+}
+
+static uint32_t disjointSetFind(uint32_t *pParents, uint32_t index) {
+    // Path halving.
+    while(pParents[index] != index) {
+        pParents[index] = pParents[pParents[index]];
+        index = pParents[index];
+    }
+    return index;
+}
+
+static int disjointSetUnion(uint32_t *pParents, uint8_t *pRanks, uint32_t index_0, uint32_t index_1) {
+    uint32_t root_0 = disjointSetFind(pParents, index_0);
+    uint32_t root_1 = disjointSetFind(pParents, index_1);
+
+    if(root_0 == root_1)
+        return 0;
+
+    if(pRanks[root_0] < pRanks[root_1]) {
+        const uint32_t swap = root_0;
+        root_0 = root_1;
+        root_1 = swap;
+    }
+
+    pParents[root_1] = root_0;
+
+    if(pRanks[root_0] == pRanks[root_1])
+        pRanks[root_0]++;
+
+    return 1;
+}
+
+static void genTileTask(void *pUserData, unsigned index) {
+    TiledGen *pTiledGen = pUserData;
+
+    const uint32_t x = (index % pTiledGen->tilesX) * pTiledGen->tileSize;
+    const uint32_t y = (index / pTiledGen->tilesX) * pTiledGen->tileSize;
+    const uint32_t tileWidth = tileExtent(pTiledGen->width, x, pTiledGen->tileSize);
+    const uint32_t tileDepth = tileExtent(pTiledGen->depth, y, pTiledGen->tileSize);
+
+    UMazeCompactLink *pLinks = &pTiledGen->pLinks[pTiledGen->pTileLinkOffsets[index]];
+    uint32_t linkAmount = 0;
+
+    // Each tile has its own random stream, so the maze does not depend on which thread made which tile.
+    URandom random;
+    seedStream(&random, pTiledGen->seed, index);
+
+    if(tileWidth * tileDepth > 1 && !primsWalk(pLinks, &linkAmount, NULL, tileWidth * tileDepth, tileWidth, &random)) {
+        pTiledGen->pTileLinkAmounts[index] = UINT32_MAX;
+        return;
+    }
+
+    // Turn the indexes of the tile into indexes of the whole grid.
+    for(uint32_t l = 0; l < linkAmount; l++) {
+        for(unsigned i = 0; i < 2; i++) {
+            const uint32_t local = pLinks[l].vertexIndex[i];
+
+            pLinks[l].vertexIndex[i] = (y + local / tileWidth) * pTiledGen->width + x + local % tileWidth;
+        }
+    }
+
+    pTiledGen->pTileLinkAmounts[index] = linkAmount;
+}
@@ -36,4 +36,159 @@ int u_maze_gen(UMazeGenResult *pMazeGenResult, const UMazeData *const pMazeData,
  */
 void u_maze_delete_result(UMazeGenResult *pMazeGenResult);
 
+/**
+ * This generates a grid in the compact layout.
+ * @note The links of every vertex are in the same order as u_maze_gen_full_sq_grid() makes them.
+ * @param pMazeData A pointer to the UMazeCompactData struct to be modified by this function.
+ * @param width The amount of vertices would the grid have in the width axis.
+ * @param depth The amount of vertices would the grid have in the depth axis. width * depth must be less than UINT32_MAX.
+ * @return 1 for success or 0 for failure.
+ */
+int u_maze_compact_gen_full_sq_grid(UMazeCompactData *pMazeData, uint32_t width, uint32_t depth);
+
+/**
+ * This function deletes the UMazeCompactData struct data.
+ * @param pMazeData The maze data to be deleted.
+ */
+void u_maze_compact_delete_data(UMazeCompactData *pMazeData);
+
+/**
+ * Find the grid position of a vertex in the compact layout.
+ * @param pMazeData The maze data that owns the vertex.
+ * @param vertexIndex The index of the vertex.
+ * @return The position with x being the column and y being the row.
+ */
+Vector2 u_maze_compact_position(const UMazeCompactData *const pMazeData, uint32_t vertexIndex);
+
+/**
+ * This method generates a maze from the compact layout. It is the same algorithm as u_maze_gen().
+ * @param pMazeGenResult The struct that would hold the generated maze if this function succeeds.
+ * @param pMazeData The nodes and connections to form a maze from. Basically the result of u_maze_compact_gen_full_sq_grid.
+ * @param seed The seed for the random number generator.
+ * @param genVertexGrid If one then pMazeGenResult will also have vertexMazeData allocated.
+ * @return 1 for success or 0 for failure.
+ */
+int u_maze_compact_gen(UMazeCompactGenResult *pMazeGenResult, const UMazeCompactData *const pMazeData, uint32_t seed, int genVertexGrid);
+
+/**
+ * This method generates a maze on a square grid without a source graph. The neighbors of every vertex are computed from width and depth.
+ * @note For the same seed the maze is the same as u_maze_compact_gen() with the result of u_maze_compact_gen_full_sq_grid().
+ * @param pMazeGenResult The struct that would hold the generated maze if this function succeeds. Its pSource is set to NULL.
+ * @param width The amount of vertices would the grid have in the width axis.
+ * @param depth The amount of vertices would the grid have in the depth axis. width * depth must be less than UINT32_MAX.
+ * @param seed The seed for the random number generator.
+ * @param genVertexGrid If one then pMazeGenResult will also have vertexMazeData allocated.
+ * @return 1 for success or 0 for failure.
+ */
+int u_maze_gen_sq_grid(UMazeCompactGenResult *pMazeGenResult, uint32_t width, uint32_t depth, uint32_t seed, int genVertexGrid);
+
+/**
+ * This method generates a maze on a square grid with every tile being made on a worker thread.
+ * @note Each tile gets a spanning tree from its own random stream. The tiles are then joined by randomized Kruskal over one random border link per pair of neighboring tiles, so the result is still a perfect maze.
+ * @note The maze only depends on the seed and tileSize. It is the same for any amount of threads.
+ * @param pMazeGenResult The struct that would hold the generated maze if this function succeeds. Its pSource is set to NULL.
+ * @param width The amount of vertices would the grid have in the width axis.
+ * @param depth The amount of vertices would the grid have in the depth axis. width * depth must be less than UINT32_MAX.
+ * @param tileSize The width and depth of a tile in vertices. U_MAZE_DEFAULT_TILE_SIZE keeps the visited bits of a tile in the cache.
+ * @param seed The seed for the random number generator.
+ * @param genVertexGrid If one then pMazeGenResult will also have vertexMazeData allocated.
+ * @return 1 for success or 0 for failure.
+ */
+int u_maze_gen_sq_grid_tiled(UMazeCompactGenResult *pMazeGenResult, uint32_t width, uint32_t depth, uint32_t tileSize, uint32_t seed, int genVertexGrid);
+
+/**
+ * This method generates a maze on a square grid with randomized Kruskal.
+ * @note Memory is 4 bytes per link for the shuffled link ids plus 5 bytes per vertex for the disjoint set, on top of the result. Time is O(links * a(vertices)).
+ * @note Unlike the frontier of u_maze_gen_sq_grid() its memory is known up front. The shuffle and the disjoint set access memory randomly, so it is slower on large grids.
+ * @param pMazeGenResult The struct that would hold the generated maze if this function succeeds. Its pSource is set to NULL.
+ * @param width The amount of vertices would the grid have in the width axis.
+ * @param depth The amount of vertices would the grid have in the depth axis. width * depth must be less than UINT32_MAX.
+ * @param seed The seed for the random number generator.
+ * @param genVertexGrid If one then pMazeGenResult will also have vertexMazeData allocated.
+ * @return 1 for success or 0 for failure.
+ */
+int u_maze_gen_sq_grid_kruskal(UMazeCompactGenResult *pMazeGenResult, uint32_t width, uint32_t depth, uint32_t seed, int genVertexGrid);
+
+/**
+ * This method generates a maze on a square grid with Wilson's loop erased random walk. Every spanning tree is equally likely.
+ * @note Memory is 1 byte and 1 bit per vertex on top of the result. Time is the expected cover time of a random walk, which is dominated by the first walks before the tree is large.
+ * @param pMazeGenResult The struct that would hold the generated maze if this function succeeds. Its pSource is set to NULL.
+ * @param width The amount of vertices would the grid have in the width axis.
+ * @param depth The amount of vertices would the grid have in the depth axis. width * depth must be less than UINT32_MAX.
+ * @param seed The seed for the random number generator.
+ * @param genVertexGrid If one then pMazeGenResult will also have vertexMazeData allocated.
+ * @return 1 for success or 0 for failure.
+ */
+int u_maze_gen_sq_grid_wilson(UMazeCompactGenResult *pMazeGenResult, uint32_t width, uint32_t depth, uint32_t seed, int genVertexGrid);
+
+/**
+ * This method streams a maze on a square grid one row at a time with Eller's algorithm.
+ * @note Only O(width) memory is used, so depth is only limited by what the callback does with the rows.
+ * @note The east opening of the last cell of a row and the south openings of the last row are never set.
+ * @param width The amount of cells in a row.
+ * @param depth The amount of rows.
+ * @param seed The seed for the random number generator.
+ * @param callback The function that receives each finished row.
+ * @param pUserData The pointer to pass to callback.
+ * @return 1 for success or 0 if the state could not be allocated or the callback stopped the generator.
+ */
+int u_maze_gen_eller(uint32_t width, uint32_t depth, uint32_t seed, UMazeRowCallback callback, void *pUserData);
+
+/**
+ * Start a maze that is made a few rows at a time by u_maze_eller_step() or u_maze_eller_step_timed(). It is the same maze that u_maze_gen_eller() streams for the same seed.
+ * @warning If this function succeeds you are responsiable for calling u_maze_eller_free().
+ * @param this The state to fill. It is cleared on failure.
+ * @param width The amount of cells in a row.
+ * @param depth The amount of rows.
+ * @param seed The seed for the random number generator.
+ * @return 1 for success or 0 if the state could not be allocated.
+ */
+int u_maze_eller_init(UMazeEllerState *this, uint32_t width, uint32_t depth, uint32_t seed);
+
+/**
+ * Make rows until at least budget cells are made. The rows given to the callback so far are final, so they can be used while the rest of the maze is not made yet.
+ * @note At least one row is made, unless the maze is done.
+ * @param this The state that was filled by u_maze_eller_init(). The maze is done when this->row is this->depth.
+ * @param budget The amount of cells to make in this call.
+ * @param callback The function that receives each finished row.
+ * @param pUserData The pointer to pass to callback.
+ * @return 1 for success or 0 if the callback stopped the generator.
+ */
+int u_maze_eller_step(UMazeEllerState *this, uint32_t budget, UMazeRowCallback callback, void *pUserData);
+
+/**
+ * Make rows until microseconds have passed. Use this to spend a fixed slice of every frame on a maze.
+ * @note At least one row is made, unless the maze is done. The time is checked between rows, so a wide row can go over the slice.
+ * @param this The state that was filled by u_maze_eller_init(). The maze is done when this->row is this->depth.
+ * @param microseconds The time to spend in this call.
+ * @param callback The function that receives each finished row.
+ * @param pUserData The pointer to pass to callback.
+ * @return 1 for success or 0 if the callback stopped the generator.
+ */
+int u_maze_eller_step_timed(UMazeEllerState *this, uint32_t microseconds, UMazeRowCallback callback, void *pUserData);
+
+/**
+ * Free the memory of the state. The state is cleared, so it is safe to call this twice.
+ * @param this The state that was filled by u_maze_eller_init().
+ */
+void u_maze_eller_free(UMazeEllerState *this);
+
+/**
+ * Turn the cell openings of a square grid maze into a compact result, like the ones the generators make.
+ * @warning If this function succeeds you are responsiable for calling u_maze_compact_delete_result().
+ * @param pMazeGenResult The struct that would hold the maze if this function succeeds. Its pSource is set to NULL.
+ * @param pCells width * depth bytes of U_MAZE_CELL_EAST and U_MAZE_CELL_SOUTH openings in row order. The last cell of a row must not open to the east and the last row must not open to the south.
+ * @param width The amount of cells in a row.
+ * @param depth The amount of rows. width * depth must be less than UINT32_MAX.
+ * @param genVertexGrid If one then pMazeGenResult will also have vertexMazeData allocated.
+ * @return 1 for success or 0 if memory ran out.
+ */
+int u_maze_cells_to_result(UMazeCompactGenResult *pMazeGenResult, const uint8_t *pCells, uint32_t width, uint32_t depth, int genVertexGrid);
+
+/**
+ * Deallocate the compact maze result.
+ * @param pMazeGenResult The result to be deleted.
+ */
+void u_maze_compact_delete_result(UMazeCompactGenResult *pMazeGenResult);
+
 #endif // U_MAZE_29
@@ -1,11 +1,28 @@
 #ifndef U_MAZE_DEF_29
 #define U_MAZE_DEF_29
 
+#include "u_random_def.h"
 #include "v_raymath.h"
 
 #include <stddef.h>
 #include <stdint.h>
 
+#define U_MAZE_DEFAULT_TILE_SIZE 256
+
+// The openings of a cell in a row of u_maze_gen_eller(). A cell has a wall on every side that is not open.
+#define U_MAZE_CELL_EAST  0x1
+#define U_MAZE_CELL_SOUTH 0x2
+
+/**
+ * Receives one row of a streamed maze.
+ * @param pUserData The pUserData given to the generator.
+ * @param row The index of the row. Rows arrive in order from zero.
+ * @param pCells width cells of U_MAZE_CELL_EAST and U_MAZE_CELL_SOUTH bits. The buffer is reused for the next row.
+ * @param width The amount of cells in the row.
+ * @return 1 to continue or 0 to stop the generator.
+ */
+typedef int (*UMazeRowCallback)(void *pUserData, uint32_t row, const uint8_t *pCells, uint32_t width);
+
 typedef struct UMazeVertexMetaData {
     Vector2 position;
 } UMazeVertexMetaData;
@@ -36,4 +53,43 @@ typedef struct UMazeGenResult {
     UMazeData vertexMazeData; // Can be empty
 } UMazeGenResult;
 
+// The compact layout stores 32-bit indexes and keeps the links of every vertex in one CSR array.
+// It does not store positions. They are derived from the vertex index and the width of the grid.
+
+typedef struct UMazeCompactLink {
+    uint32_t vertexIndex[2];
+} UMazeCompactLink;
+
+typedef struct UMazeCompactData {
+    uint32_t width; // Vertex index = y * width + x.
+    uint32_t vertexAmount;
+    uint32_t linkAmount;
+    uint32_t *pLinkOffsets; // vertexAmount + 1 offsets. The links of vertex v are from pLinkOffsets[v] to pLinkOffsets[v + 1] - 1.
+    uint32_t *pVertexLinkArray;
+} UMazeCompactData;
+
+typedef struct UMazeCompactGenResult {
+    const UMazeCompactData *pSource; // Reference. NULL if the maze was made by u_maze_gen_sq_grid().
+
+    uint32_t linkAmount; // Can be zero.
+    UMazeCompactLink *pLinks; // Can be NULL.
+
+    UMazeCompactData vertexMazeData; // Can be empty
+} UMazeCompactGenResult;
+
+// A maze that u_maze_eller_step() makes a few rows at a time. Only O(width) memory is held no matter the depth.
+typedef struct UMazeEllerState {
+    uint32_t width;
+    uint32_t depth;
+    uint32_t row; // The amount of rows given to the callback so far. The maze is done when this is depth.
+    URandom random;
+
+    uint32_t *pCellSets; // Owns the memory of every array below.
+    uint32_t *pParents;
+    uint32_t *pLastCells; // The last cell of every set in the current row.
+    uint32_t *pFreeSets;
+    uint8_t  *pRanks;
+    uint8_t  *pCells; // The openings of the current row. Doubles as the used flags of the set ids before a row is carved.
+} UMazeEllerState;
+
 #endif // U_MAZE_DEF_29
@@ -0,0 +1,240 @@
+#include "u_maze_file.h"
+
+#include "u_maze.h"
+
+#include "SDL_rwops.h"
+#include "SDL_log.h"
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct {
+    SDL_RWops *pWrite;
+    uint8_t *pPackedRow;
+    uint32_t nextRow;
+} EllerWriter;
+
+static void packRow(const uint8_t *pCells, uint32_t width, uint8_t *pPackedRow);
+static int writeEllerRow(void *pUserData, uint32_t row, const uint8_t *pCells, uint32_t width);
+static SDL_RWops* openMazeFile(const char *const pUTF8Path, UMazeFileHeader *pHeader, const char *const pFunctionName);
+
+int u_maze_file_write_eller(const char *const pUTF8Path, uint32_t width, uint32_t depth, uint32_t seed) {
+    EllerWriter writer;
+
+    writer.pPackedRow = malloc(U_MAZE_FILE_ROW_SIZE(width));
+    writer.nextRow = 0;
+
+    if(writer.pPackedRow == NULL)
+        return 0;
+
+    writer.pWrite = SDL_RWFromFile(pUTF8Path, "wb");
+
+    if(writer.pWrite == NULL) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "u_maze_file_write_eller: Cannot write \"%s\"", pUTF8Path);
+        free(writer.pPackedRow);
+        return 0;
+    }
+
+    UMazeFileHeader header = {0};
+    header.magic   = U_MAZE_FILE_MAGIC;
+    header.version = U_MAZE_FILE_VERSION;
+    header.width   = width;
+    header.depth   = depth;
+    header.seed    = seed;
+
+    int success = SDL_RWwrite(writer.pWrite, &header, sizeof(header), 1) == 1;
+
+    if(success)
+        success = u_maze_gen_eller(width, depth, seed, writeEllerRow, &writer);
+
+    SDL_RWclose(writer.pWrite);
+    free(writer.pPackedRow);
+
+    if(!success)
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "u_maze_file_write_eller: Failed to stream a %ux%u maze to \"%s\"", width, depth, pUTF8Path);
+
+    return success;
+}
+
+int u_maze_file_save(const char *const pUTF8Path, const UMazeCompactGenResult *const pMazeGenResult, uint32_t width, uint32_t depth, uint32_t seed) {
+    assert(pMazeGenResult != NULL);
+    assert(pMazeGenResult->linkAmount == 0 || pMazeGenResult->pLinks != NULL);
+
+    const uint64_t rowSize = U_MAZE_FILE_ROW_SIZE(width);
+    uint8_t *pPackedRows = calloc(rowSize * depth + 1, 1);
+
+    if(pPackedRows == NULL)
+        return 0;
+
+    // Every link is stored as an opening of the cell that is further to the west or the north.
+    for(uint32_t i = 0; i < pMazeGenResult->linkAmount; i++) {
+        uint32_t index_0 = pMazeGenResult->pLinks[i].vertexIndex[0];
+        uint32_t index_1 = pMazeGenResult->pLinks[i].vertexIndex[1];
+
+        if(index_0 > index_1) {
+            const uint32_t swap = index_0;
+            index_0 = index_1;
+            index_1 = swap;
+        }
+
+        const uint32_t x = index_0 % width;
+        const uint32_t y = index_0 / width;
+        unsigned opening;
+
+        if(index_1 == index_0 + 1 && x + 1 < width)
+            opening = U_MAZE_CELL_EAST;
+        else if(index_1 == index_0 + width && y + 1 < depth)
+            opening = U_MAZE_CELL_SOUTH;
+        else {
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "u_maze_file_save: Link %u to %u is not on a %ux%u grid", index_0, index_1, width, depth);
+            free(pPackedRows);
+            return 0;
+        }
+
+        pPackedRows[y * rowSize + x / 4] |= opening << (2 * (x % 4));
+    }
+
+    SDL_RWops *pWrite = SDL_RWFromFile(pUTF8Path, "wb");
+
+    if(pWrite == NULL) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "u_maze_file_save: Cannot write \"%s\"", pUTF8Path);
+        free(pPackedRows);
+        return 0;
+    }
+
+    UMazeFileHeader header = {0};
+    header.magic   = U_MAZE_FILE_MAGIC;
+    header.version = U_MAZE_FILE_VERSION;
+    header.width   = width;
+    header.depth   = depth;
+    header.seed    = seed;
+
+    int success = SDL_RWwrite(pWrite, &header, sizeof(header), 1) == 1;
+
+    if(success && depth != 0 && rowSize != 0)
+        success = SDL_RWwrite(pWrite, pPackedRows, rowSize * depth, 1) == 1;
+
+    SDL_RWclose(pWrite);
+    free(pPackedRows);
+
+    if(!success)
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "u_maze_file_save: Failed to write \"%s\"", pUTF8Path);
+
+    return success;
+}
+
+int u_maze_file_load(UMazeCompactGenResult *pMazeGenResult, UMazeFileHeader *pHeader, const char *const pUTF8Path, int genVertexGrid) {
+    UMazeFileHeader header;
+    SDL_RWops *pRead = openMazeFile(pUTF8Path, &header, "u_maze_file_load");
+
+    if(pRead == NULL)
+        return 0;
+
+    SDL_RWclose(pRead);
+
+    if(pHeader != NULL)
+        *pHeader = header;
+
+    return u_maze_file_load_rect(pMazeGenResult, NULL, pUTF8Path, 0, 0, header.width, header.depth, genVertexGrid);
+}
+
+int u_maze_file_load_rect(UMazeCompactGenResult *pMazeGenResult, UMazeFileHeader *pHeader, const char *const pUTF8Path, uint32_t x0, uint32_t y0, uint32_t width, uint32_t depth, int genVertexGrid) {
+    assert(pMazeGenResult != NULL);
+
+    memset(pMazeGenResult, 0, sizeof(*pMazeGenResult));
+
+    UMazeFileHeader header;
+    SDL_RWops *pRead = openMazeFile(pUTF8Path, &header, "u_maze_file_load_rect");
+
+    if(pRead == NULL)
+        return 0;
+
+    if(pHeader != NULL)
+        *pHeader = header;
+
+    if(width == 0 || depth == 0 || (uint64_t)x0 + width > header.width || (uint64_t)y0 + depth > header.depth || (uint64_t)width * depth >= UINT32_MAX) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "u_maze_file_load_rect: %ux%u at (%u, %u) is outside of the %ux%u maze in \"%s\"", width, depth, x0, y0, header.width, header.depth, pUTF8Path);
+        SDL_RWclose(pRead);
+        return 0;
+    }
+
+    // Only the bytes that hold the columns of the rectangle are read from each row.
+    const uint64_t rowSize = U_MAZE_FILE_ROW_SIZE(header.width);
+    const uint32_t shift = x0 % 4;
+    const uint64_t spanSize = U_MAZE_FILE_ROW_SIZE(shift + (uint64_t)width);
+
+    uint8_t *pSpan  = malloc(spanSize);
+    uint8_t *pCells = malloc((size_t)width * depth);
+
+    int success = pSpan != NULL && pCells != NULL;
+
+    for(uint32_t y = 0; success && y < depth; y++) {
+        const int64_t position = sizeof(header) + (y0 + (uint64_t)y) * rowSize + x0 / 4;
+
+        // Whole rows follow each other in the file, so only a rectangle that is narrower than the maze has to seek.
+        if(y == 0 || spanSize != rowSize)
+            success = SDL_RWseek(pRead, position, RW_SEEK_SET) == position;
+
+        if(success)
+            success = SDL_RWread(pRead, pSpan, spanSize, 1) == 1;
+
+        for(uint32_t x = 0; success && x < width; x++)
+            pCells[(size_t)y * width + x] = (pSpan[(shift + x) / 4] >> (2 * ((shift + x) % 4))) & 0x3;
+
+        if(success)
+            pCells[(size_t)y * width + width - 1] &= ~U_MAZE_CELL_EAST;
+    }
+
+    if(success) {
+        for(uint32_t x = 0; x < width; x++)
+            pCells[(size_t)(depth - 1) * width + x] &= ~U_MAZE_CELL_SOUTH;
+
+        success = u_maze_cells_to_result(pMazeGenResult, pCells, width, depth, genVertexGrid);
+    }
+    else
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "u_maze_file_load_rect: Failed to read \"%s\"", pUTF8Path);
+
+    SDL_RWclose(pRead);
+    free(pSpan);
+    free(pCells);
+
+    return success;
+}
+
+static void packRow(const uint8_t *pCells, uint32_t width, uint8_t *pPackedRow) {
+    memset(pPackedRow, 0, U_MAZE_FILE_ROW_SIZE(width));
+
+    for(uint32_t x = 0; x < width; x++)
+        pPackedRow[x / 4] |= (pCells[x] & 0x3) << (2 * (x % 4));
+}
+
+static int writeEllerRow(void *pUserData, uint32_t row, const uint8_t *pCells, uint32_t width) {
+    EllerWriter *pWriter = pUserData;
+
+    // The rows are stored without their index, so a row out of order would corrupt the file.
+    if(row != pWriter->nextRow)
+        return 0;
+    pWriter->nextRow++;
+
+    packRow(pCells, width, pWriter->pPackedRow);
+
+    return SDL_RWwrite(pWriter->pWrite, pWriter->pPackedRow, U_MAZE_FILE_ROW_SIZE(width), 1) == 1;
+}
+
+static SDL_RWops* openMazeFile(const char *const pUTF8Path, UMazeFileHeader *pHeader, const char *const pFunctionName) {
+    SDL_RWops *pRead = SDL_RWFromFile(pUTF8Path, "rb");
+
+    if(pRead == NULL) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s: Cannot read \"%s\"", pFunctionName, pUTF8Path);
+        return NULL;
+    }
+
+    if(SDL_RWread(pRead, pHeader, sizeof(*pHeader), 1) != 1 || pHeader->magic != U_MAZE_FILE_MAGIC || pHeader->version != U_MAZE_FILE_VERSION) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s: \"%s\" is not a version %u maze file", pFunctionName, pUTF8Path, U_MAZE_FILE_VERSION);
+        SDL_RWclose(pRead);
+        return NULL;
+    }
+
+    return pRead;
+}
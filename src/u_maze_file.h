@@ -0,0 +1,55 @@
+#ifndef U_MAZE_FILE_29
+#define U_MAZE_FILE_29
+
+#include "u_maze_def.h"
+#include "u_maze_file_def.h"
+
+/**
+ * Stream a maze made by u_maze_gen_eller() straight into a maze file. Only one packed row is held in memory at a time.
+ * @param pUTF8Path The path of the file to write. It is encoded with unicode.
+ * @param width The amount of cells in a row.
+ * @param depth The amount of rows.
+ * @param seed The seed for the random number generator. It is stored in the header.
+ * @return 1 if the whole maze was written. 0 if the file could not be written or the generator could not allocate its state.
+ */
+int u_maze_file_write_eller(const char *const pUTF8Path, uint32_t width, uint32_t depth, uint32_t seed);
+
+/**
+ * Write a generated square grid maze to a maze file. Only the openings are stored, 2 bits per cell.
+ * @param pUTF8Path The path of the file to write. It is encoded with unicode.
+ * @param pMazeGenResult The maze from u_maze_gen_sq_grid() or one of its variants. Only pLinks is read.
+ * @param width The amount of vertices in the width axis that the maze was generated with.
+ * @param depth The amount of vertices in the depth axis that the maze was generated with.
+ * @param seed The seed that the maze was generated with. It is only stored in the header.
+ * @return 1 if the file was written. 0 if a link does not join two neighbors of the grid or if the file could not be written.
+ */
+int u_maze_file_save(const char *const pUTF8Path, const UMazeCompactGenResult *const pMazeGenResult, uint32_t width, uint32_t depth, uint32_t seed);
+
+/**
+ * Read a whole maze file back into the form that the generators return.
+ * @warning If this function succeeds you are responsiable for calling u_maze_compact_delete_result().
+ * @param pMazeGenResult The struct that would hold the maze if this function succeeds. Its pSource is set to NULL.
+ * @param pHeader Returns the header of the file with the dimensions and the seed. Can be NULL.
+ * @param pUTF8Path The path of the maze file. It is encoded with unicode.
+ * @param genVertexGrid If one then pMazeGenResult will also have vertexMazeData allocated.
+ * @return 1 for success or 0 if the file could not be read, is not a maze file or memory ran out.
+ */
+int u_maze_file_load(UMazeCompactGenResult *pMazeGenResult, UMazeFileHeader *pHeader, const char *const pUTF8Path, int genVertexGrid);
+
+/**
+ * Read a rectangle of a maze file. Only the bytes of the rows in the rectangle are read.
+ * @note The vertices are numbered inside the rectangle, so vertex (x, y) of the file is vertex (y - y0) * width + (x - x0). Links that leave the rectangle are dropped.
+ * @warning If this function succeeds you are responsiable for calling u_maze_compact_delete_result().
+ * @param pMazeGenResult The struct that would hold the maze if this function succeeds. Its pSource is set to NULL.
+ * @param pHeader Returns the header of the file with the dimensions and the seed. Can be NULL.
+ * @param pUTF8Path The path of the maze file. It is encoded with unicode.
+ * @param x0 The first column of the rectangle.
+ * @param y0 The first row of the rectangle.
+ * @param width The amount of columns of the rectangle. It must be at least one.
+ * @param depth The amount of rows of the rectangle. It must be at least one.
+ * @param genVertexGrid If one then pMazeGenResult will also have vertexMazeData allocated.
+ * @return 1 for success or 0 if the file could not be read, is not a maze file, the rectangle is outside of the maze or memory ran out.
+ */
+int u_maze_file_load_rect(UMazeCompactGenResult *pMazeGenResult, UMazeFileHeader *pHeader, const char *const pUTF8Path, uint32_t x0, uint32_t y0, uint32_t width, uint32_t depth, int genVertexGrid);
+
+#endif // U_MAZE_FILE_29
@@ -0,0 +1,22 @@
+#ifndef U_MAZE_FILE_DEF_29
+#define U_MAZE_FILE_DEF_29
+
+#include <stdint.h>
+
+#define U_MAZE_FILE_MAGIC   0x315a4d55 // "UMZ1"
+#define U_MAZE_FILE_VERSION 1
+
+// A maze file is this header followed by depth rows. Each row is U_MAZE_FILE_ROW_SIZE(width) bytes.
+// A cell is 2 bits of U_MAZE_CELL_EAST and U_MAZE_CELL_SOUTH. Cell x of a row is at bit 2 * (x % 4) of byte x / 4.
+typedef struct UMazeFileHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t width;
+    uint32_t depth;
+    uint32_t seed;
+    uint32_t reserved[3];
+} UMazeFileHeader;
+
+#define U_MAZE_FILE_ROW_SIZE(width) (((uint64_t)(width) + 3) / 4)
+
+#endif // U_MAZE_FILE_DEF_29
@@ -0,0 +1,779 @@
+#include "u_path.h"
+
+#include "u_thread.h"
+
+#include "SDL_atomic.h"
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define NO_VERTEX UINT32_MAX
+
+typedef struct {
+    uint64_t *pKeys; // The cost estimate in the upper 32 bits and the node in the lower 32 bits.
+    uint32_t amount;
+    uint32_t capacity;
+} Heap;
+
+typedef struct {
+    // The vertices of one cluster.
+    uint32_t *pLocalDistances;
+    uint32_t *pLocalParents;
+    uint32_t *pLocalQueue;
+
+    // The nodes of the clusters of the start and the goal.
+    uint32_t *pStartCosts;
+    uint32_t *pGoalCosts;
+
+    // The abstract graph with the start and the goal as two extra nodes.
+    uint32_t *pCosts;
+    uint32_t *pParents;
+    uint32_t *pStamps;
+    uint32_t stamp;
+    uint32_t *pAbstractPath;
+    Heap heap;
+} Scratch;
+
+typedef struct {
+    UPathHPA *pHPA;
+    uint32_t *pEdgeCounts;
+    SDL_atomic_t failed;
+} BuildTask;
+
+typedef struct {
+    const UPathHPA *pHPA;
+    UPath *pPaths;
+    const uint32_t *pStarts;
+    const uint32_t *pGoals;
+    uint32_t amount;
+    uint32_t taskAmount;
+    SDL_atomic_t foundAmount;
+} BatchTask;
+
+static int heapPush(Heap *pHeap, uint32_t cost, uint32_t node);
+static uint32_t heapPop(Heap *pHeap, uint32_t *pCost);
+static uint32_t manhattan(uint32_t width, uint32_t vertex_0, uint32_t vertex_1);
+static uint32_t clusterOf(const UPathHPA *const this, uint32_t vertex);
+static uint32_t localIndexOf(const UPathHPA *const this, uint32_t cluster, uint32_t vertex);
+static uint32_t findNode(const UPathHPA *const this, uint32_t cluster, uint32_t vertex);
+static void localSearch(const UPathHPA *const this, Scratch *pScratch, uint32_t cluster, uint32_t source);
+static uint32_t writeLocalPath(const UPathHPA *const this, const Scratch *pScratch, uint32_t cluster, uint32_t target, uint32_t *pDestination);
+static int allocScratch(const UPathHPA *const this, Scratch *pScratch);
+static void freeScratch(Scratch *pScratch);
+static int findWithScratch(const UPathHPA *const this, Scratch *pScratch, UPath *pPath, uint32_t start, uint32_t goal);
+static void buildClusterRowTask(void *pUserData, unsigned index);
+static void batchTask(void *pUserData, unsigned index);
+
+int u_path_find(UPath *pPath, const UMazeCompactData *const pGraph, uint32_t start, uint32_t goal) {
+    assert(pPath != NULL);
+    assert(pGraph != NULL);
+
+    memset(pPath, 0, sizeof(*pPath));
+
+    if(start >= pGraph->vertexAmount || goal >= pGraph->vertexAmount)
+        return 0;
+
+    // A cost of zero means not reached, so every cost is stored plus one. calloc only touches the pages that the search does.
+    uint32_t *pCosts   = calloc(pGraph->vertexAmount, sizeof(uint32_t));
+    uint32_t *pParents = malloc(pGraph->vertexAmount * sizeof(uint32_t));
+    Heap heap = {0};
+
+    if(pCosts == NULL || pParents == NULL) {
+        free(pCosts);
+        free(pParents);
+        return 0;
+    }
+
+    int found = 0;
+
+    pCosts[start] = 1;
+    pParents[start] = NO_VERTEX;
+
+    if(heapPush(&heap, manhattan(pGraph->width, start, goal), start)) {
+        while(heap.amount != 0) {
+            uint32_t estimate;
+            const uint32_t vertex = heapPop(&heap, &estimate);
+
+            if(vertex == goal) {
+                found = 1;
+                break;
+            }
+
+            const uint32_t cost = pCosts[vertex];
+
+            // Skip the stale entries of vertices that were pushed again with a lower cost.
+            if(estimate != cost - 1 + manhattan(pGraph->width, vertex, goal))
+                continue;
+
+            for(uint32_t c = pGraph->pLinkOffsets[vertex]; c < pGraph->pLinkOffsets[vertex + 1]; c++) {
+                const uint32_t link = pGraph->pVertexLinkArray[c];
+
+                if(pCosts[link] != 0 && pCosts[link] <= cost + 1)
+                    continue;
+
+                pCosts[link] = cost + 1;
+                pParents[link] = vertex;
+
+                if(!heapPush(&heap, cost + manhattan(pGraph->width, link, goal), link)) {
+                    heap.amount = 0;
+                    break;
+                }
+            }
+        }
+    }
+
+    if(found) {
+        pPath->length = pCosts[goal];
+        pPath->pVertices = malloc(pPath->length * sizeof(uint32_t));
+
+        if(pPath->pVertices != NULL) {
+            uint32_t vertex = goal;
+
+            for(uint32_t i = pPath->length; i != 0; i--) {
+                pPath->pVertices[i - 1] = vertex;
+                vertex = pParents[vertex];
+            }
+        }
+        else {
+            pPath->length = 0;
+            found = 0;
+        }
+    }
+
+    free(heap.pKeys);
+    free(pCosts);
+    free(pParents);
+
+    return found;
+}
+
+int u_path_hpa_build(UPathHPA *this, const UMazeCompactData *const pGraph, uint32_t clusterSize) {
+    assert(this != NULL);
+    assert(pGraph != NULL);
+
+    memset(this, 0, sizeof(*this));
+
+    if(clusterSize == 0 || pGraph->width == 0 || pGraph->vertexAmount == 0)
+        return 0;
+
+    const uint32_t depth = (pGraph->vertexAmount + pGraph->width - 1) / pGraph->width;
+
+    this->pGraph = pGraph;
+    this->clusterSize  = clusterSize;
+    this->clustersWide = (pGraph->width + clusterSize - 1) / clusterSize;
+    this->clustersDeep = (depth + clusterSize - 1) / clusterSize;
+
+    const uint32_t clusterAmount = this->clustersWide * this->clustersDeep;
+
+    this->pClusterNodeOffsets = calloc(clusterAmount + 1, sizeof(uint32_t));
+
+    if(this->pClusterNodeOffsets == NULL)
+        return 0;
+
+    // Count the nodes of every cluster, then lay them out cluster by cluster. The vertices are visited in order, so each cluster is sorted.
+    for(uint32_t v = 0; v < pGraph->vertexAmount; v++) {
+        const uint32_t cluster = clusterOf(this, v);
+
+        for(uint32_t c = pGraph->pLinkOffsets[v]; c < pGraph->pLinkOffsets[v + 1]; c++) {
+            if(clusterOf(this, pGraph->pVertexLinkArray[c]) != cluster) {
+                this->pClusterNodeOffsets[cluster + 1]++;
+                break;
+            }
+        }
+    }
+
+    for(uint32_t i = 0; i < clusterAmount; i++) {
+        const uint32_t amount = this->pClusterNodeOffsets[i + 1];
+
+        if(amount > this->maxClusterNodes)
+            this->maxClusterNodes = amount;
+
+        this->pClusterNodeOffsets[i + 1] += this->pClusterNodeOffsets[i];
+    }
+
+    this->nodeAmount = this->pClusterNodeOffsets[clusterAmount];
+    this->pNodeVertices = malloc((this->nodeAmount + 1) * sizeof(uint32_t));
+    this->pEdgeOffsets  = calloc(this->nodeAmount + 1, sizeof(uint32_t));
+
+    if(this->pNodeVertices == NULL || this->pEdgeOffsets == NULL) {
+        u_path_hpa_free(this);
+        return 0;
+    }
+
+    for(uint32_t v = 0; v < pGraph->vertexAmount; v++) {
+        const uint32_t cluster = clusterOf(this, v);
+
+        for(uint32_t c = pGraph->pLinkOffsets[v]; c < pGraph->pLinkOffsets[v + 1]; c++) {
+            if(clusterOf(this, pGraph->pVertexLinkArray[c]) != cluster) {
+                this->pNodeVertices[this->pClusterNodeOffsets[cluster] + this->pEdgeOffsets[this->pClusterNodeOffsets[cluster]]++] = v;
+                break;
+            }
+        }
+    }
+
+    // Every node gets room for an edge to each other node of its cluster and for each of its links.
+    // The clusters are searched on worker threads and the edges are packed together afterwards.
+    uint32_t capacity = 0;
+
+    for(uint32_t cluster = 0; cluster < clusterAmount; cluster++) {
+        const uint32_t first = this->pClusterNodeOffsets[cluster];
+        const uint32_t last  = this->pClusterNodeOffsets[cluster + 1];
+
+        for(uint32_t n = first; n < last; n++) {
+            const uint32_t vertex = this->pNodeVertices[n];
+
+            this->pEdgeOffsets[n] = capacity;
+            capacity += (last - first - 1) + (pGraph->pLinkOffsets[vertex + 1] - pGraph->pLinkOffsets[vertex]);
+        }
+    }
+    this->pEdgeOffsets[this->nodeAmount] = capacity;
+
+    BuildTask buildTask = {0};
+    buildTask.pHPA = this;
+    buildTask.pEdgeCounts = calloc(this->nodeAmount + 1, sizeof(uint32_t));
+    this->pEdges = malloc((capacity + 1) * sizeof(UPathEdge));
+
+    if(buildTask.pEdgeCounts == NULL || this->pEdges == NULL) {
+        free(buildTask.pEdgeCounts);
+        u_path_hpa_free(this);
+        return 0;
+    }
+
+    u_thread_parallel_for(this->clustersDeep, buildClusterRowTask, &buildTask);
+
+    if(SDL_AtomicGet(&buildTask.failed)) {
+        free(buildTask.pEdgeCounts);
+        u_path_hpa_free(this);
+        return 0;
+    }
+
+    uint32_t edgeAmount = 0;
+
+    for(uint32_t n = 0; n < this->nodeAmount; n++) {
+        memmove(&this->pEdges[edgeAmount], &this->pEdges[this->pEdgeOffsets[n]], buildTask.pEdgeCounts[n] * sizeof(UPathEdge));
+
+        this->pEdgeOffsets[n] = edgeAmount;
+        edgeAmount += buildTask.pEdgeCounts[n];
+    }
+    this->pEdgeOffsets[this->nodeAmount] = edgeAmount;
+    this->edgeAmount = edgeAmount;
+
+    free(buildTask.pEdgeCounts);
+
+    UPathEdge *pEdges = realloc(this->pEdges, (edgeAmount + 1) * sizeof(UPathEdge));
+
+    if(pEdges != NULL)
+        this->pEdges = pEdges;
+
+    return 1;
+}
+
+void u_path_hpa_free(UPathHPA *this) {
+    assert(this != NULL);
+
+    free(this->pNodeVertices);
+    free(this->pClusterNodeOffsets);
+    free(this->pEdgeOffsets);
+    free(this->pEdges);
+
+    memset(this, 0, sizeof(*this));
+}
+
+int u_path_hpa_find(const UPathHPA *const this, UPath *pPath, uint32_t start, uint32_t goal) {
+    assert(this != NULL);
+    assert(pPath != NULL);
+
+    Scratch scratch;
+
+    memset(pPath, 0, sizeof(*pPath));
+
+    if(!allocScratch(this, &scratch))
+        return 0;
+
+    const int found = findWithScratch(this, &scratch, pPath, start, goal);
+
+    freeScratch(&scratch);
+
+    return found;
+}
+
+uint32_t u_path_hpa_find_batch(const UPathHPA *const this, UPath *pPaths, const uint32_t *pStarts, const uint32_t *pGoals, uint32_t amount) {
+    assert(this != NULL);
+    assert(amount == 0 || (pPaths != NULL && pStarts != NULL && pGoals != NULL));
+
+    BatchTask batchTaskData;
+
+    batchTaskData.pHPA    = this;
+    batchTaskData.pPaths  = pPaths;
+    batchTaskData.pStarts = pStarts;
+    batchTaskData.pGoals  = pGoals;
+    batchTaskData.amount  = amount;
+    SDL_AtomicSet(&batchTaskData.foundAmount, 0);
+
+    // One task per thread, so that every thread allocates its search memory once.
+    batchTaskData.taskAmount = u_thread_count();
+
+    if(batchTaskData.taskAmount > amount)
+        batchTaskData.taskAmount = amount;
+
+    u_thread_parallel_for(batchTaskData.taskAmount, batchTask, &batchTaskData);
+
+    return SDL_AtomicGet(&batchTaskData.foundAmount);
+}
+
+void u_path_delete(UPath *pPath) {
+    assert(pPath != NULL);
+
+    free(pPath->pVertices);
+
+    memset(pPath, 0, sizeof(*pPath));
+}
+
+static int heapPush(Heap *pHeap, uint32_t cost, uint32_t node) {
+    if(pHeap->amount == pHeap->capacity) {
+        const uint32_t capacity = pHeap->capacity == 0 ? 256 : 2 * pHeap->capacity;
+        uint64_t *pKeys = realloc(pHeap->pKeys, capacity * sizeof(uint64_t));
+
+        if(pKeys == NULL)
+            return 0;
+
+        pHeap->pKeys = pKeys;
+        pHeap->capacity = capacity;
+    }
+
+    const uint64_t key = ((uint64_t)cost << 32) | node;
+    uint32_t index = pHeap->amount++;
+
+    while(index != 0) {
+        const uint32_t parent = (index - 1) / 2;
+
+        if(pHeap->pKeys[parent] <= key)
+            break;
+
+        pHeap->pKeys[index] = pHeap->pKeys[parent];
+        index = parent;
+    }
+    pHeap->pKeys[index] = key;
+
+    return 1;
+}
+
+static uint32_t heapPop(Heap *pHeap, uint32_t *pCost) {
+    const uint64_t top  = pHeap->pKeys[0];
+    const uint64_t last = pHeap->pKeys[--pHeap->amount];
+    uint32_t index = 0;
+
+    for(;;) {
+        uint32_t child = 2 * index + 1;
+
+        if(child >= pHeap->amount)
+            break;
+
+        if(child + 1 < pHeap->amount && pHeap->pKeys[child + 1] < pHeap->pKeys[child])
+            child++;
+
+        if(last <= pHeap->pKeys[child])
+            break;
+
+        pHeap->pKeys[index] = pHeap->pKeys[child];
+        index = child;
+    }
+    if(pHeap->amount != 0)
+        pHeap->pKeys[index] = last;
+
+    *pCost = top >> 32;
+
+    return (uint32_t)top;
+}
+
+static uint32_t manhattan(uint32_t width, uint32_t vertex_0, uint32_t vertex_1) {
+    const uint32_t x_0 = vertex_0 % width, y_0 = vertex_0 / width;
+    const uint32_t x_1 = vertex_1 % width, y_1 = vertex_1 / width;
+
+    return (x_0 > x_1 ? x_0 - x_1 : x_1 - x_0) + (y_0 > y_1 ? y_0 - y_1 : y_1 - y_0);
+}
+
+static uint32_t clusterOf(const UPathHPA *const this, uint32_t vertex) {
+    const uint32_t x = vertex % this->pGraph->width;
+    const uint32_t y = vertex / this->pGraph->width;
+
+    return (y / this->clusterSize) * this->clustersWide + x / this->clusterSize;
+}
+
+static uint32_t localIndexOf(const UPathHPA *const this, uint32_t cluster, uint32_t vertex) {
+    const uint32_t x = vertex % this->pGraph->width - (cluster % this->clustersWide) * this->clusterSize;
+    const uint32_t y = vertex / this->pGraph->width - (cluster / this->clustersWide) * this->clusterSize;
+
+    return y * this->clusterSize + x;
+}
+
+static uint32_t findNode(const UPathHPA *const this, uint32_t cluster, uint32_t vertex) {
+    uint32_t low  = this->pClusterNodeOffsets[cluster];
+    uint32_t high = this->pClusterNodeOffsets[cluster + 1];
+
+    while(low < high) {
+        const uint32_t middle = low + (high - low) / 2;
+
+        if(this->pNodeVertices[middle] < vertex)
+            low = middle + 1;
+        else
+            high = middle;
+    }
+
+    if(low < this->pClusterNodeOffsets[cluster + 1] && this->pNodeVertices[low] == vertex)
+        return low;
+
+    return NO_VERTEX;
+}
+
+static void localSearch(const UPathHPA *const this, Scratch *pScratch, uint32_t cluster, uint32_t source) {
+    const UMazeCompactData *pGraph = this->pGraph;
+
+    // Every link is one step, so a breadth first search finds the shortest distances.
+    memset(pScratch->pLocalDistances, 0xff, this->clusterSize * this->clusterSize * sizeof(uint32_t));
+
+    uint32_t head = 0, tail = 0;
+    const uint32_t sourceIndex = localIndexOf(this, cluster, source);
+
+    pScratch->pLocalDistances[sourceIndex] = 0;
+    pScratch->pLocalParents[sourceIndex] = NO_VERTEX;
+    pScratch->pLocalQueue[tail++] = source;
+
+    while(head != tail) {
+        const uint32_t vertex = pScratch->pLocalQueue[head++];
+        const uint32_t distance = pScratch->pLocalDistances[localIndexOf(this, cluster, vertex)];
+
+        for(uint32_t c = pGraph->pLinkOffsets[vertex]; c < pGraph->pLinkOffsets[vertex + 1]; c++) {
+            const uint32_t link = pGraph->pVertexLinkArray[c];
+
+            if(clusterOf(this, link) != cluster)
+                continue;
+
+            const uint32_t linkIndex = localIndexOf(this, cluster, link);
+
+            if(pScratch->pLocalDistances[linkIndex] != NO_VERTEX)
+                continue;
+
+            pScratch->pLocalDistances[linkIndex] = distance + 1;
+            pScratch->pLocalParents[linkIndex] = vertex;
+            pScratch->pLocalQueue[tail++] = link;
+        }
+    }
+}
+
+static uint32_t writeLocalPath(const UPathHPA *const this, const Scratch *pScratch, uint32_t cluster, uint32_t target, uint32_t *pDestination) {
+    // pDestination[0] is the source that is already written. The path is walked back from the target.
+    const uint32_t distance = pScratch->pLocalDistances[localIndexOf(this, cluster, target)];
+    uint32_t vertex = target;
+
+    for(uint32_t i = distance; i != 0; i--) {
+        pDestination[i] = vertex;
+        vertex = pScratch->pLocalParents[localIndexOf(this, cluster, vertex)];
+    }
+
+    return distance;
+}
+
+static int allocScratch(const UPathHPA *const this, Scratch *pScratch) {
+    const uint32_t localAmount = this->clusterSize * this->clusterSize;
+    const uint32_t abstractAmount = this->nodeAmount + 2;
+
+    memset(pScratch, 0, sizeof(*pScratch));
+
+    pScratch->pLocalDistances = malloc(localAmount * sizeof(uint32_t));
+    pScratch->pLocalParents   = malloc(localAmount * sizeof(uint32_t));
+    pScratch->pLocalQueue     = malloc(localAmount * sizeof(uint32_t));
+    pScratch->pStartCosts     = malloc((this->maxClusterNodes + 1) * sizeof(uint32_t));
+    pScratch->pGoalCosts      = malloc((this->maxClusterNodes + 1) * sizeof(uint32_t));
+    pScratch->pCosts          = malloc(abstractAmount * sizeof(uint32_t));
+    pScratch->pParents        = malloc(abstractAmount * sizeof(uint32_t));
+    pScratch->pStamps         = calloc(abstractAmount, sizeof(uint32_t));
+    pScratch->pAbstractPath   = malloc(abstractAmount * sizeof(uint32_t));
+
+    if(pScratch->pLocalDistances == NULL || pScratch->pLocalParents == NULL || pScratch->pLocalQueue == NULL ||
+       pScratch->pStartCosts == NULL || pScratch->pGoalCosts == NULL ||
+       pScratch->pCosts == NULL || pScratch->pParents == NULL || pScratch->pStamps == NULL || pScratch->pAbstractPath == NULL) {
+        freeScratch(pScratch);
+        return 0;
+    }
+
+    return 1;
+}
+
+static void freeScratch(Scratch *pScratch) {
+    free(pScratch->pLocalDistances);
+    free(pScratch->pLocalParents);
+    free(pScratch->pLocalQueue);
+    free(pScratch->pStartCosts);
+    free(pScratch->pGoalCosts);
+    free(pScratch->pCosts);
+    free(pScratch->pParents);
+    free(pScratch->pStamps);
+    free(pScratch->pAbstractPath);
+    free(pScratch->heap.pKeys);
+
+    memset(pScratch, 0, sizeof(*pScratch));
+}
+
+static int findWithScratch(const UPathHPA *const this, Scratch *pScratch, UPath *pPath, uint32_t start, uint32_t goal) {
+    const UMazeCompactData *pGraph = this->pGraph;
+
+    memset(pPath, 0, sizeof(*pPath));
+
+    if(start >= pGraph->vertexAmount || goal >= pGraph->vertexAmount)
+        return 0;
+
+    const uint32_t startNode = this->nodeAmount;
+    const uint32_t goalNode  = this->nodeAmount + 1;
+    const uint32_t startCluster = clusterOf(this, start);
+    const uint32_t goalCluster  = clusterOf(this, goal);
+    const uint32_t startFirst = this->pClusterNodeOffsets[startCluster];
+    const uint32_t startLast  = this->pClusterNodeOffsets[startCluster + 1];
+    const uint32_t goalFirst  = this->pClusterNodeOffsets[goalCluster];
+    const uint32_t goalLast   = this->pClusterNodeOffsets[goalCluster + 1];
+
+    // Connect the start and the goal to the nodes of their clusters. In the same cluster they can also be joined directly.
+    uint32_t directCost = NO_VERTEX;
+
+    localSearch(this, pScratch, goalCluster, goal);
+
+    for(uint32_t n = goalFirst; n < goalLast; n++)
+        pScratch->pGoalCosts[n - goalFirst] = pScratch->pLocalDistances[localIndexOf(this, goalCluster, this->pNodeVertices[n])];
+
+    if(startCluster == goalCluster)
+        directCost = pScratch->pLocalDistances[localIndexOf(this, goalCluster, start)];
+
+    localSearch(this, pScratch, startCluster, start);
+
+    for(uint32_t n = startFirst; n < startLast; n++)
+        pScratch->pStartCosts[n - startFirst] = pScratch->pLocalDistances[localIndexOf(this, startCluster, this->pNodeVertices[n])];
+
+    // A* over the abstract graph. A stamp marks the costs that belong to this query, so nothing is cleared between queries.
+    pScratch->stamp++;
+
+    if(pScratch->stamp == 0) {
+        memset(pScratch->pStamps, 0, (this->nodeAmount + 2) * sizeof(uint32_t));
+        pScratch->stamp = 1;
+    }
+
+    const uint32_t stamp = pScratch->stamp;
+    Heap *pHeap = &pScratch->heap;
+
+    pHeap->amount = 0;
+
+    pScratch->pStamps[startNode] = stamp;
+    pScratch->pCosts[startNode] = 0;
+    pScratch->pParents[startNode] = NO_VERTEX;
+
+    if(!heapPush(pHeap, manhattan(pGraph->width, start, goal), startNode))
+        return 0;
+
+    int found = 0;
+
+    while(pHeap->amount != 0) {
+        uint32_t estimate;
+        const uint32_t node = heapPop(pHeap, &estimate);
+
+        if(node == goalNode) {
+            found = 1;
+            break;
+        }
+
+        const uint32_t vertex = node == startNode ? start : this->pNodeVertices[node];
+        const uint32_t cost = pScratch->pCosts[node];
+
+        if(estimate != cost + manhattan(pGraph->width, vertex, goal))
+            continue;
+
+        // The edges of the start and the goal are not stored in the abstract graph, so they are gathered here.
+        UPathEdge extraEdges[1];
+        uint32_t extraEdgeAmount = 0;
+        const UPathEdge *pEdges;
+        uint32_t edgeAmount;
+
+        if(node == startNode) {
+            pEdges = NULL;
+            edgeAmount = 0;
+
+            for(uint32_t n = startFirst; n < startLast; n++) {
+                const uint32_t startCost = pScratch->pStartCosts[n - startFirst];
+
+                if(startCost == NO_VERTEX)
+                    continue;
+
+                if(pScratch->pStamps[n] == stamp && pScratch->pCosts[n] <= startCost)
+                    continue;
+
+                pScratch->pStamps[n] = stamp;
+                pScratch->pCosts[n] = startCost;
+                pScratch->pParents[n] = startNode;
+
+                if(!heapPush(pHeap, startCost + manhattan(pGraph->width, this->pNodeVertices[n], goal), n))
+                    return 0;
+            }
+
+            if(directCost != NO_VERTEX) {
+                extraEdges[0].node = goalNode;
+                extraEdges[0].cost = directCost;
+                extraEdgeAmount = 1;
+            }
+        }
+        else {
+            pEdges = &this->pEdges[this->pEdgeOffsets[node]];
+            edgeAmount = this->pEdgeOffsets[node + 1] - this->pEdgeOffsets[node];
+
+            if(node >= goalFirst && node < goalLast && pScratch->pGoalCosts[node - goalFirst] != NO_VERTEX) {
+                extraEdges[0].node = goalNode;
+                extraEdges[0].cost = pScratch->pGoalCosts[node - goalFirst];
+                extraEdgeAmount = 1;
+            }
+        }
+
+        for(uint32_t e = 0; e < edgeAmount + extraEdgeAmount; e++) {
+            const UPathEdge *pEdge = e < edgeAmount ? &pEdges[e] : &extraEdges[e - edgeAmount];
+            const uint32_t linkCost = cost + pEdge->cost;
+
+            if(pScratch->pStamps[pEdge->node] == stamp && pScratch->pCosts[pEdge->node] <= linkCost)
+                continue;
+
+            pScratch->pStamps[pEdge->node] = stamp;
+            pScratch->pCosts[pEdge->node] = linkCost;
+            pScratch->pParents[pEdge->node] = node;
+
+            const uint32_t linkVertex = pEdge->node == goalNode ? goal : this->pNodeVertices[pEdge->node];
+
+            if(!heapPush(pHeap, linkCost + manhattan(pGraph->width, linkVertex, goal), pEdge->node))
+                return 0;
+        }
+    }
+
+    if(!found)
+        return 0;
+
+    // Collect the abstract path from the goal back to the start.
+    uint32_t abstractLength = 0;
+
+    for(uint32_t node = goalNode; node != NO_VERTEX; node = pScratch->pParents[node])
+        pScratch->pAbstractPath[abstractLength++] = node;
+
+    pPath->length = pScratch->pCosts[goalNode] + 1;
+    pPath->pVertices = malloc(pPath->length * sizeof(uint32_t));
+
+    if(pPath->pVertices == NULL) {
+        pPath->length = 0;
+        return 0;
+    }
+
+    // Refine every abstract step into the vertices between its two ends.
+    uint32_t position = 0;
+    pPath->pVertices[0] = start;
+
+    for(uint32_t i = abstractLength - 1; i != 0; i--) {
+        const uint32_t from = pScratch->pAbstractPath[i];
+        const uint32_t to   = pScratch->pAbstractPath[i - 1];
+        const uint32_t fromVertex = from == startNode ? start : this->pNodeVertices[from];
+        const uint32_t toVertex   = to   == goalNode  ? goal  : this->pNodeVertices[to];
+        const uint32_t fromCluster = clusterOf(this, fromVertex);
+
+        if(fromCluster != clusterOf(this, toVertex))
+            pPath->pVertices[++position] = toVertex;
+        else {
+            localSearch(this, pScratch, fromCluster, fromVertex);
+            position += writeLocalPath(this, pScratch, fromCluster, toVertex, &pPath->pVertices[position]);
+        }
+    }
+
+    assert(position + 1 == pPath->length);
+
+    return 1;
+}
+
+static void buildClusterRowTask(void *pUserData, unsigned index) {
+    BuildTask *pBuildTask = pUserData;
+    UPathHPA *this = pBuildTask->pHPA;
+    const UMazeCompactData *pGraph = this->pGraph;
+
+    Scratch scratch = {0};
+    const uint32_t localAmount = this->clusterSize * this->clusterSize;
+
+    scratch.pLocalDistances = malloc(localAmount * sizeof(uint32_t));
+    scratch.pLocalParents   = malloc(localAmount * sizeof(uint32_t));
+    scratch.pLocalQueue     = malloc(localAmount * sizeof(uint32_t));
+
+    if(scratch.pLocalDistances == NULL || scratch.pLocalParents == NULL || scratch.pLocalQueue == NULL) {
+        SDL_AtomicSet(&pBuildTask->failed, 1);
+        freeScratch(&scratch);
+        return;
+    }
+
+    for(uint32_t cluster = index * this->clustersWide; cluster < (index + 1) * this->clustersWide; cluster++) {
+        const uint32_t first = this->pClusterNodeOffsets[cluster];
+        const uint32_t last  = this->pClusterNodeOffsets[cluster + 1];
+
+        for(uint32_t n = first; n < last; n++) {
+            const uint32_t vertex = this->pNodeVertices[n];
+            UPathEdge *pEdges = &this->pEdges[this->pEdgeOffsets[n]];
+            uint32_t edgeAmount = 0;
+
+            // The links that leave the cluster end at a node of the next cluster.
+            for(uint32_t c = pGraph->pLinkOffsets[vertex]; c < pGraph->pLinkOffsets[vertex + 1]; c++) {
+                const uint32_t link = pGraph->pVertexLinkArray[c];
+                const uint32_t linkCluster = clusterOf(this, link);
+
+                if(linkCluster == cluster)
+                    continue;
+
+                pEdges[edgeAmount].node = findNode(this, linkCluster, link);
+                pEdges[edgeAmount].cost = 1;
+                edgeAmount++;
+            }
+
+            if(last - first > 1) {
+                localSearch(this, &scratch, cluster, vertex);
+
+                for(uint32_t other = first; other < last; other++) {
+                    if(other == n)
+                        continue;
+
+                    const uint32_t distance = scratch.pLocalDistances[localIndexOf(this, cluster, this->pNodeVertices[other])];
+
+                    if(distance == NO_VERTEX)
+                        continue;
+
+                    pEdges[edgeAmount].node = other;
+                    pEdges[edgeAmount].cost = distance;
+                    edgeAmount++;
+                }
+            }
+
+            pBuildTask->pEdgeCounts[n] = edgeAmount;
+        }
+    }
+
+    freeScratch(&scratch);
+}
+
+static void batchTask(void *pUserData, unsigned index) {
+    BatchTask *pBatchTask = pUserData;
+    const uint32_t first = (uint64_t)pBatchTask->amount *  index      / pBatchTask->taskAmount;
+    const uint32_t last  = (uint64_t)pBatchTask->amount * (index + 1) / pBatchTask->taskAmount;
+
+    Scratch scratch;
+    int allocated = allocScratch(pBatchTask->pHPA, &scratch);
+    int foundAmount = 0;
+
+    for(uint32_t i = first; i < last; i++) {
+        if(!allocated) {
+            memset(&pBatchTask->pPaths[i], 0, sizeof(UPath));
+            continue;
+        }
+
+        foundAmount += findWithScratch(pBatchTask->pHPA, &scratch, &pBatchTask->pPaths[i], pBatchTask->pStarts[i], pBatchTask->pGoals[i]);
+    }
+
+    if(allocated)
+        freeScratch(&scratch);
+
+    SDL_AtomicAdd(&pBatchTask->foundAmount, foundAmount);
+}
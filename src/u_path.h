@@ -0,0 +1,65 @@
+#ifndef U_PATH_29
+#define U_PATH_29
+
+#include "u_maze_def.h"
+#include "u_path_def.h"
+
+/**
+ * Find the shortest path between two vertices with A* over every vertex of the graph.
+ * @note This is the reference for u_path_hpa_find(). Its memory and time grow with the size of the graph, not of the path.
+ * @warning If this function returns 1 you are responsiable for calling u_path_delete().
+ * @param pPath The UPath to fill. It is cleared if there is no path.
+ * @param pGraph The graph with every vertex on a grid of pGraph->width. A vertexMazeData of u_maze_gen_sq_grid() works.
+ * @param start The vertex to start from.
+ * @param goal The vertex to end at.
+ * @return 1 if a path was found. 0 if there is no path or memory ran out.
+ */
+int u_path_find(UPath *pPath, const UMazeCompactData *const pGraph, uint32_t start, uint32_t goal);
+
+/**
+ * Build the abstract graph for hierarchical pathfinding (HPA*). The clusters are built on worker threads.
+ * @warning If this function succeeds you are responsiable for calling u_path_hpa_free(). pGraph must outlive this.
+ * @param this The UPathHPA to fill. It is cleared on failure.
+ * @param pGraph The graph with every vertex on a grid of pGraph->width.
+ * @param clusterSize The width and depth of a cluster in vertices. Use U_PATH_DEFAULT_CLUSTER_SIZE when unsure.
+ * @return 1 if the abstract graph is ready. 0 if memory ran out or clusterSize is zero.
+ */
+int u_path_hpa_build(UPathHPA *this, const UMazeCompactData *const pGraph, uint32_t clusterSize);
+
+/**
+ * Free the abstract graph.
+ * @param this The UPathHPA that was filled by u_path_hpa_build().
+ */
+void u_path_hpa_free(UPathHPA *this);
+
+/**
+ * Find the shortest path between two vertices. A* runs over the abstract graph, then every abstract step is refined into vertices inside its cluster.
+ * @note Only the clusters on the path are searched vertex by vertex. The path is as short as the one from u_path_find().
+ * @warning If this function returns 1 you are responsiable for calling u_path_delete().
+ * @param this The UPathHPA that was filled by u_path_hpa_build().
+ * @param pPath The UPath to fill. It is cleared if there is no path.
+ * @param start The vertex to start from.
+ * @param goal The vertex to end at.
+ * @return 1 if a path was found. 0 if there is no path or memory ran out.
+ */
+int u_path_hpa_find(const UPathHPA *const this, UPath *pPath, uint32_t start, uint32_t goal);
+
+/**
+ * Find many paths at once. The queries are split over worker threads and each thread reuses its search memory between queries.
+ * @warning You are responsiable for calling u_path_delete() on every UPath of pPaths.
+ * @param this The UPathHPA that was filled by u_path_hpa_build().
+ * @param pPaths An array of amount UPath to fill. A query without a path gets a cleared UPath.
+ * @param pStarts An array of amount vertices to start from.
+ * @param pGoals An array of amount vertices to end at.
+ * @param amount The amount of queries.
+ * @return The amount of queries that found a path.
+ */
+uint32_t u_path_hpa_find_batch(const UPathHPA *const this, UPath *pPaths, const uint32_t *pStarts, const uint32_t *pGoals, uint32_t amount);
+
+/**
+ * Free the vertices of a path.
+ * @param pPath The UPath that was filled by u_path_find(), u_path_hpa_find() or u_path_hpa_find_batch().
+ */
+void u_path_delete(UPath *pPath);
+
+#endif // U_PATH_29
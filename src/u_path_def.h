@@ -0,0 +1,41 @@
+#ifndef U_PATH_DEF_29
+#define U_PATH_DEF_29
+
+#include "u_maze_def.h"
+
+#include <stdint.h>
+
+#define U_PATH_DEFAULT_CLUSTER_SIZE 32
+
+typedef struct UPath {
+    uint32_t length;     // The amount of vertices from the start to the goal, both included. Zero if there is no path.
+    uint32_t *pVertices; // Can be NULL.
+} UPath;
+
+typedef struct UPathEdge {
+    uint32_t node;
+    uint32_t cost; // In links.
+} UPathEdge;
+
+// The abstract graph of hierarchical pathfinding. The grid is cut into clusters of clusterSize by clusterSize vertices.
+// Every vertex with a link that leaves its cluster is an abstract node. Nodes in the same cluster are joined by the length of the path between them inside the cluster,
+// and nodes on either side of a cluster border are joined by their link.
+
+typedef struct UPathHPA {
+    const UMazeCompactData *pGraph; // Reference
+
+    uint32_t clusterSize;
+    uint32_t clustersWide;
+    uint32_t clustersDeep;
+    uint32_t maxClusterNodes; // The most nodes that any one cluster has.
+
+    uint32_t nodeAmount;
+    uint32_t *pNodeVertices;       // The vertex of every node. The nodes of a cluster are next to each other and sorted by vertex.
+    uint32_t *pClusterNodeOffsets; // clustersWide * clustersDeep + 1 offsets into pNodeVertices.
+
+    uint32_t edgeAmount;
+    uint32_t *pEdgeOffsets; // nodeAmount + 1 offsets into pEdges.
+    UPathEdge *pEdges;
+} UPathHPA;
+
+#endif // U_PATH_DEF_29
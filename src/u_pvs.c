@@ -0,0 +1,504 @@
+#include "u_pvs.h"
+
+#include "u_thread.h"
+
+#include "SDL_atomic.h"
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+// The openings of a cell of the square grid.
+#define OPEN_POSITIVE_X 0x1
+#define OPEN_NEGATIVE_X 0x2
+#define OPEN_POSITIVE_Y 0x4
+#define OPEN_NEGATIVE_Y 0x8
+
+// Lines that only graze the end of an opening are kept, so rounding never hides a cell.
+#define SLACK 1e-9
+
+// The line v = m * u + c in the space of an octant, where the walk only goes toward +u and +v and 0 <= m <= 1.
+typedef struct {
+    double m;
+    double c;
+} Line;
+
+typedef struct {
+    Line *pLines;
+    size_t amount;
+    size_t capacity;
+} LineArray;
+
+typedef struct {
+    uint32_t i;             // The steps toward +u from the cell the walk started at. The steps toward +v are the level minus i.
+    uint32_t polygonStart;  // The lines that pass every opening on the way here are the convex polygon of pLines from here.
+    uint32_t polygonAmount;
+} Step;
+
+typedef struct {
+    Step *pSteps;
+    size_t amount;
+    size_t capacity;
+} StepArray;
+
+typedef struct {
+    int x;
+    int y;
+    uint8_t opening;
+} Move;
+
+typedef struct {
+    uint32_t *pVisible;
+    size_t visibleAmount;
+    size_t visibleCapacity;
+
+    // Every step of the walk goes one level further, so the walk only needs the current level and the next one.
+    StepArray levels[2];
+    LineArray polygons[2];
+
+    uint8_t *pData;
+    size_t dataAmount;
+    size_t dataCapacity;
+
+    uint32_t maxVisibleAmount;
+} TaskMemory;
+
+typedef struct {
+    UPvs *pPvs;
+    const uint8_t *pOpenings;
+    TaskMemory *pTaskMemory;
+    SDL_atomic_t failed;
+} BuildTask;
+
+static int reserve(void **ppArray, size_t *pCapacity, size_t amount, size_t elementSize);
+static uint8_t openingsOf(const UMazeCompactData *const pGraph, uint32_t vertex);
+static int walkOctant(TaskMemory *pMemory, const BuildTask *pBuild, uint32_t x, uint32_t y, const Move moves[2]);
+static int clipLines(LineArray *pTarget, const LineArray *pSource, uint32_t start, uint32_t amount, double a, double b, double d);
+static int mergeLines(LineArray *pLines, uint32_t start, uint32_t amount);
+static void buildTask(void *pUserData, unsigned index);
+
+int u_pvs_build(UPvs *this, const UMazeCompactData *const pGraph) {
+    assert(this != NULL);
+    assert(pGraph != NULL);
+
+    BuildTask build;
+
+    memset(this, 0, sizeof(*this));
+
+    if(pGraph->vertexAmount == 0 || pGraph->width == 0)
+        return 1;
+
+    this->width = pGraph->width;
+    this->cellAmount = pGraph->vertexAmount;
+
+    const unsigned taskAmount = (this->cellAmount + U_PVS_TASK_CELLS - 1) / U_PVS_TASK_CELLS;
+    uint8_t *pOpenings = malloc(this->cellAmount);
+
+    this->pOffsets = malloc(((size_t)this->cellAmount + 1) * sizeof(uint64_t));
+    build.pTaskMemory = calloc(taskAmount, sizeof(TaskMemory));
+
+    if(pOpenings == NULL || this->pOffsets == NULL || build.pTaskMemory == NULL) {
+        free(pOpenings);
+        free(build.pTaskMemory);
+        u_pvs_free(this);
+        return 0;
+    }
+
+    for(uint32_t v = 0; v < this->cellAmount; v++)
+        pOpenings[v] = openingsOf(pGraph, v);
+
+    build.pPvs = this;
+    build.pOpenings = pOpenings;
+    SDL_AtomicSet(&build.failed, 0);
+
+    u_thread_parallel_for(taskAmount, buildTask, &build);
+
+    // Every task made its offsets from the start of its own data, so the data of the tasks before it is added here.
+    uint64_t dataAmount = 0;
+
+    if(!SDL_AtomicGet(&build.failed)) {
+        for(unsigned t = 0; t < taskAmount; t++)
+            dataAmount += build.pTaskMemory[t].dataAmount;
+
+        this->pData = malloc(dataAmount + 1);
+    }
+
+    if(this->pData != NULL) {
+        const uint32_t lastCell = this->cellAmount;
+        uint64_t base = 0;
+
+        this->pOffsets[0] = 0;
+
+        for(unsigned t = 0; t < taskAmount; t++) {
+            const uint32_t first = t * U_PVS_TASK_CELLS;
+            const uint32_t last  = lastCell - first < U_PVS_TASK_CELLS ? lastCell : first + U_PVS_TASK_CELLS;
+            TaskMemory *pMemory = &build.pTaskMemory[t];
+
+            for(uint32_t v = first; v < last; v++)
+                this->pOffsets[v + 1] += base;
+
+            memcpy(this->pData + base, pMemory->pData, pMemory->dataAmount);
+            base += pMemory->dataAmount;
+
+            if(this->maxVisibleAmount < pMemory->maxVisibleAmount)
+                this->maxVisibleAmount = pMemory->maxVisibleAmount;
+        }
+    }
+
+    for(unsigned t = 0; t < taskAmount; t++) {
+        free(build.pTaskMemory[t].pVisible);
+        for(unsigned l = 0; l < 2; l++) {
+            free(build.pTaskMemory[t].levels[l].pSteps);
+            free(build.pTaskMemory[t].polygons[l].pLines);
+        }
+        free(build.pTaskMemory[t].pData);
+    }
+
+    free(build.pTaskMemory);
+    free(pOpenings);
+
+    if(this->pData == NULL) {
+        u_pvs_free(this);
+        return 0;
+    }
+
+    return 1;
+}
+
+void u_pvs_free(UPvs *this) {
+    free(this->pOffsets);
+    free(this->pData);
+
+    memset(this, 0, sizeof(*this));
+}
+
+uint32_t u_pvs_visible(const UPvs *const this, uint32_t cell, uint32_t *pCells) {
+    assert(this != NULL);
+    assert(cell < this->cellAmount);
+
+    const uint8_t *pByte = this->pData + this->pOffsets[cell];
+    const uint8_t *pEnd  = this->pData + this->pOffsets[cell + 1];
+    uint32_t amount = 0;
+    uint32_t previous = 0;
+
+    while(pByte != pEnd) {
+        uint32_t gap = 0;
+        unsigned shift = 0;
+
+        do {
+            gap |= (uint32_t)(*pByte & 0x7f) << shift;
+            shift += 7;
+        } while((*pByte++ & 0x80) != 0);
+
+        previous += gap;
+        pCells[amount++] = previous;
+    }
+
+    return amount;
+}
+
+static int reserve(void **ppArray, size_t *pCapacity, size_t amount, size_t elementSize) {
+    if(amount <= *pCapacity)
+        return 1;
+
+    size_t capacity = *pCapacity == 0 ? 64 : 2 * *pCapacity;
+
+    while(capacity < amount)
+        capacity *= 2;
+
+    void *pArray = realloc(*ppArray, capacity * elementSize);
+
+    if(pArray == NULL)
+        return 0;
+
+    *ppArray = pArray;
+    *pCapacity = capacity;
+
+    return 1;
+}
+
+static uint8_t openingsOf(const UMazeCompactData *const pGraph, uint32_t vertex) {
+    const uint32_t width = pGraph->width;
+    const uint32_t x = vertex % width;
+    uint8_t openings = 0;
+
+    // On a grid the difference between the indexes tells the direction of a link.
+    for(uint32_t c = pGraph->pLinkOffsets[vertex]; c < pGraph->pLinkOffsets[vertex + 1]; c++) {
+        const uint32_t link = pGraph->pVertexLinkArray[c];
+
+        if(x + 1 < width && link == vertex + 1)
+            openings |= OPEN_POSITIVE_X;
+        else if(x != 0 && link + 1 == vertex)
+            openings |= OPEN_NEGATIVE_X;
+        else if(link == vertex + width)
+            openings |= OPEN_POSITIVE_Y;
+        else
+            openings |= OPEN_NEGATIVE_Y;
+    }
+
+    return openings;
+}
+
+static int walkOctant(TaskMemory *pMemory, const BuildTask *pBuild, uint32_t x, uint32_t y, const Move moves[2]) {
+    const uint32_t width = pBuild->pPvs->width;
+    StepArray *pLevel = &pMemory->levels[0];
+    StepArray *pNextLevel = &pMemory->levels[1];
+    LineArray *pPolygons = &pMemory->polygons[0];
+    LineArray *pNextPolygons = &pMemory->polygons[1];
+
+    // The first cell is [0, 1] by [0, 1], so every line that leaves it has 0 <= m <= 1 and -1 <= c <= 1.
+    if(!reserve((void**)&pPolygons->pLines, &pPolygons->capacity, 4, sizeof(Line)) ||
+       !reserve((void**)&pLevel->pSteps, &pLevel->capacity, 1, sizeof(Step)))
+        return 0;
+
+    pPolygons->pLines[0] = (Line){0, -1};
+    pPolygons->pLines[1] = (Line){1, -1};
+    pPolygons->pLines[2] = (Line){1,  1};
+    pPolygons->pLines[3] = (Line){0,  1};
+    pPolygons->amount = 4;
+
+    pLevel->pSteps[0] = (Step){0, 0, 4};
+    pLevel->amount = 1;
+
+    // Every move adds one to i + j, so the cells of a level are on one diagonal and each is reached from at most two cells of the level before.
+    for(uint32_t level = 0; pLevel->amount != 0; level++) {
+        pNextLevel->amount = 0;
+        pNextPolygons->amount = 0;
+
+        if(!reserve((void**)&pMemory->pVisible, &pMemory->visibleCapacity, pMemory->visibleAmount + pLevel->amount, sizeof(uint32_t)) ||
+           !reserve((void**)&pNextLevel->pSteps, &pNextLevel->capacity, 2 * pLevel->amount, sizeof(Step)))
+            return 0;
+
+        for(size_t s = 0; s < pLevel->amount; s++) {
+            const Step step = pLevel->pSteps[s];
+            const uint32_t j = level - step.i;
+            const uint32_t cell = (y + step.i * moves[0].y + j * moves[1].y) * width + (x + step.i * moves[0].x + j * moves[1].x);
+
+            pMemory->pVisible[pMemory->visibleAmount++] = cell;
+
+            // Going to +v first keeps the next level sorted by i, so two ways into the same cell are always next to each other.
+            for(int k = 1; k >= 0; k--) {
+                if((pBuild->pOpenings[cell] & moves[k].opening) == 0)
+                    continue;
+
+                const double u = step.i;
+                const double v = j;
+                const uint32_t start = pNextPolygons->amount;
+                int amount;
+
+                // Going to +u passes the opening u = i + 1 with j <= v <= j + 1. Going to +v passes the opening v = j + 1 with i <= u <= i + 1.
+                if(k == 0) {
+                    amount = clipLines(pNextPolygons, pPolygons, step.polygonStart, step.polygonAmount, -(u + 1), -1, -v);
+
+                    if(amount > 0)
+                        amount = clipLines(pNextPolygons, pNextPolygons, start, amount, u + 1, 1, v + 1);
+                }
+                else {
+                    amount = clipLines(pNextPolygons, pPolygons, step.polygonStart, step.polygonAmount, u, 1, v + 1);
+
+                    if(amount > 0)
+                        amount = clipLines(pNextPolygons, pNextPolygons, start, amount, -(u + 1), -1, -(v + 1));
+                }
+
+                if(amount < 0)
+                    return 0;
+
+                // Only the last clip is kept. It moves down over the first clip so the polygons stay packed.
+                const size_t last = pNextPolygons->amount - amount;
+
+                memmove(&pNextPolygons->pLines[start], &pNextPolygons->pLines[last], amount * sizeof(Line));
+                pNextPolygons->amount = start + amount;
+
+                if(amount == 0)
+                    continue;
+
+                const uint32_t i = step.i + (k == 0);
+                Step *pLast = pNextLevel->amount != 0 ? &pNextLevel->pSteps[pNextLevel->amount - 1] : NULL;
+
+                // A cell that is reached two ways keeps the convex hull of both polygons. It holds every line of either way, so no cell is lost, and only loops in the graph ever do this.
+                if(pLast != NULL && pLast->i == i) {
+                    amount = mergeLines(pNextPolygons, pLast->polygonStart, pLast->polygonAmount + amount);
+
+                    if(amount < 0)
+                        return 0;
+
+                    pLast->polygonAmount = amount;
+                    continue;
+                }
+
+                pNextLevel->pSteps[pNextLevel->amount++] = (Step){i, start, amount};
+            }
+        }
+
+        StepArray *pSwapLevel = pLevel;
+        LineArray *pSwapPolygons = pPolygons;
+
+        pLevel = pNextLevel;
+        pNextLevel = pSwapLevel;
+        pPolygons = pNextPolygons;
+        pNextPolygons = pSwapPolygons;
+    }
+
+    return 1;
+}
+
+static int clipLines(LineArray *pTarget, const LineArray *pSource, uint32_t start, uint32_t amount, double a, double b, double d) {
+    // Keep the part of the polygon where a * m + b * c <= d. A convex polygon gains at most one corner from this.
+    if(!reserve((void**)&pTarget->pLines, &pTarget->capacity, pTarget->amount + amount + 1, sizeof(Line)))
+        return -1;
+
+    const Line *pIn = &pSource->pLines[start];
+    Line *pOut = &pTarget->pLines[pTarget->amount];
+    uint32_t outAmount = 0;
+
+    // Each edge goes from the corner before it to the current corner, so the side of every corner is only computed once.
+    Line previous = pIn[amount - 1];
+    double previousSide = a * previous.m + b * previous.c - d - SLACK;
+
+    for(uint32_t n = 0; n < amount; n++) {
+        const Line current = pIn[n];
+        const double currentSide = a * current.m + b * current.c - d - SLACK;
+
+        if((previousSide < 0 && currentSide > 0) || (previousSide > 0 && currentSide < 0)) {
+            const double t = previousSide / (previousSide - currentSide);
+
+            pOut[outAmount++] = (Line){previous.m + t * (current.m - previous.m), previous.c + t * (current.c - previous.c)};
+        }
+
+        if(currentSide <= 0)
+            pOut[outAmount++] = current;
+
+        previous = current;
+        previousSide = currentSide;
+    }
+
+    pTarget->amount += outAmount;
+
+    return outAmount;
+}
+
+static int mergeLines(LineArray *pLines, uint32_t start, uint32_t amount) {
+    // Andrew's monotone chain over the corners of both polygons. The hull is built after them and then moved down over them.
+    if(!reserve((void**)&pLines->pLines, &pLines->capacity, (size_t)start + 3 * amount + 1, sizeof(Line)))
+        return -1;
+
+    Line *pCorners = &pLines->pLines[start];
+    Line *pHull = pCorners + amount;
+    uint32_t hullAmount = 0;
+
+    for(uint32_t n = 1; n < amount; n++) {
+        const Line corner = pCorners[n];
+        uint32_t k = n;
+
+        for(; k != 0 && (pCorners[k - 1].m > corner.m || (pCorners[k - 1].m == corner.m && pCorners[k - 1].c > corner.c)); k--)
+            pCorners[k] = pCorners[k - 1];
+
+        pCorners[k] = corner;
+    }
+
+    for(unsigned pass = 0; pass < 2; pass++) {
+        const uint32_t lowerAmount = hullAmount;
+
+        for(uint32_t n = 0; n < amount; n++) {
+            const Line corner = pCorners[pass == 0 ? n : amount - 1 - n];
+
+            while(hullAmount >= lowerAmount + 2) {
+                const Line o = pHull[hullAmount - 2];
+                const Line p = pHull[hullAmount - 1];
+
+                if((p.m - o.m) * (corner.c - o.c) - (p.c - o.c) * (corner.m - o.m) > 0)
+                    break;
+
+                hullAmount--;
+            }
+
+            pHull[hullAmount++] = corner;
+        }
+
+        // The last corner of each chain is the first of the other.
+        hullAmount--;
+    }
+
+    // Corners that are all the same point leave no edge, but that one line still passes.
+    if(hullAmount == 0)
+        pHull[hullAmount++] = pCorners[0];
+
+    memmove(pCorners, pHull, hullAmount * sizeof(Line));
+    pLines->amount = start + hullAmount;
+
+    return hullAmount;
+}
+
+static void buildTask(void *pUserData, unsigned index) {
+    BuildTask *pBuild = pUserData;
+    UPvs *pPvs = pBuild->pPvs;
+    TaskMemory *pMemory = &pBuild->pTaskMemory[index];
+
+    const uint32_t first = index * U_PVS_TASK_CELLS;
+    const uint32_t last  = pPvs->cellAmount - first < U_PVS_TASK_CELLS ? pPvs->cellAmount : first + U_PVS_TASK_CELLS;
+
+    for(uint32_t v = first; v < last; v++) {
+        if(SDL_AtomicGet(&pBuild->failed))
+            return;
+
+        const uint32_t x = v % pPvs->width;
+        const uint32_t y = v / pPvs->width;
+
+        pMemory->visibleAmount = 0;
+
+        // Mirroring x and y and swapping them turns every octant into the one where lines go toward +u and +v with a slope from 0 to 1.
+        for(unsigned octant = 0; octant < 8; octant++) {
+            const Move xMove = (octant & 1) ? (Move){-1, 0, OPEN_NEGATIVE_X} : (Move){1, 0, OPEN_POSITIVE_X};
+            const Move yMove = (octant & 2) ? (Move){0, -1, OPEN_NEGATIVE_Y} : (Move){0, 1, OPEN_POSITIVE_Y};
+            const Move moves[2] = {(octant & 4) ? yMove : xMove, (octant & 4) ? xMove : yMove};
+
+            if(!walkOctant(pMemory, pBuild, x, y, moves)) {
+                SDL_AtomicSet(&pBuild->failed, 1);
+                return;
+            }
+        }
+
+        // The sets are a few dozen cells, where an insertion sort is faster than qsort().
+        for(size_t n = 1; n < pMemory->visibleAmount; n++) {
+            const uint32_t cell = pMemory->pVisible[n];
+            size_t k = n;
+
+            for(; k != 0 && pMemory->pVisible[k - 1] > cell; k--)
+                pMemory->pVisible[k] = pMemory->pVisible[k - 1];
+
+            pMemory->pVisible[k] = cell;
+        }
+
+        // Every cell can be reached by more than one octant, so the sorted cells are coded once each.
+        if(!reserve((void**)&pMemory->pData, &pMemory->dataCapacity, pMemory->dataAmount + 5 * pMemory->visibleAmount, sizeof(uint8_t))) {
+            SDL_AtomicSet(&pBuild->failed, 1);
+            return;
+        }
+
+        uint32_t previous = 0;
+        uint32_t visibleAmount = 0;
+
+        for(size_t n = 0; n < pMemory->visibleAmount; n++) {
+            const uint32_t cell = pMemory->pVisible[n];
+
+            if(n != 0 && cell == previous)
+                continue;
+
+            uint32_t gap = cell - previous;
+
+            while(gap >= 0x80) {
+                pMemory->pData[pMemory->dataAmount++] = (gap & 0x7f) | 0x80;
+                gap >>= 7;
+            }
+            pMemory->pData[pMemory->dataAmount++] = gap;
+
+            previous = cell;
+            visibleAmount++;
+        }
+
+        if(pMemory->maxVisibleAmount < visibleAmount)
+            pMemory->maxVisibleAmount = visibleAmount;
+
+        pPvs->pOffsets[v + 1] = pMemory->dataAmount;
+    }
+}
@@ -0,0 +1,34 @@
+#ifndef U_PVS_29
+#define U_PVS_29
+
+#include "u_maze_def.h"
+#include "u_pvs_def.h"
+
+/**
+ * Find for every cell of a square grid maze the cells that can be seen from anywhere inside of it.
+ * @note A cell sees another if a straight line passes through the openings between them in order. The walls are treated as thin and the openings as wide as a whole side of a cell, which only sees more than the real corridors, so the sets are conservative.
+ * Every cell walks out through its openings in eight octants. Each step cuts the lines that still pass by the opening it goes through, and a walk stops once no line is left. So the work per cell follows how far it can see and not the size of the maze.
+ * @note The cells are split into tasks of U_PVS_TASK_CELLS that run on worker threads. The sets are the same for any amount of threads.
+ * @warning If this function succeeds you are responsiable for calling u_pvs_free().
+ * @param this The UPvs to fill. It is cleared on failure.
+ * @param pGraph The vertexMazeData of a square grid maze. The links of a vertex must go to grid neighbors.
+ * @return 1 if every cell has its set. 0 if memory ran out.
+ */
+int u_pvs_build(UPvs *this, const UMazeCompactData *const pGraph);
+
+/**
+ * Free the visible sets.
+ * @param this The UPvs that was filled by u_pvs_build().
+ */
+void u_pvs_free(UPvs *this);
+
+/**
+ * Decode the visible set of a cell. The renderer only needs to draw these cells when the camera is in cell.
+ * @param this The UPvs that was filled by u_pvs_build().
+ * @param cell The cell to look from.
+ * @param pCells Returns the visible cells in increasing order. It must have room for this->maxVisibleAmount cells. cell itself is always included.
+ * @return The amount of cells written to pCells.
+ */
+uint32_t u_pvs_visible(const UPvs *const this, uint32_t cell, uint32_t *pCells);
+
+#endif // U_PVS_29
@@ -0,0 +1,18 @@
+#ifndef U_PVS_DEF_29
+#define U_PVS_DEF_29
+
+#include <stdint.h>
+
+// The amount of cells in one task of u_pvs_build(). Every task keeps the visible sets of its cells until they are gathered.
+#define U_PVS_TASK_CELLS 1024
+
+typedef struct UPvs {
+    uint32_t width;
+    uint32_t cellAmount;
+    uint32_t maxVisibleAmount; // The size of the largest visible set. u_pvs_visible() never writes more cells than this.
+
+    uint64_t *pOffsets; // cellAmount + 1 offsets into pData. The visible set of a cell is between its offset and the next.
+    uint8_t  *pData;    // Every visible set is the gaps between its sorted cell indexes. 7 bits per byte, the high bit is set on every byte of a gap but the last.
+} UPvs;
+
+#endif // U_PVS_DEF_29
@@ -0,0 +1,193 @@
+#include "u_random.h"
+
+#include "u_simd.h"
+
+#include <assert.h>
+#include <string.h>
+
+#if defined(U_SIMD)
+#define PACK_AMOUNT (U_RANDOM_LANES / PACK_U64_WIDTH)
+
+static inline PackU64 stepPack(PackU64 *s);
+#endif
+
+// The amount of numbers u_random_fill_range() draws before reducing them.
+#define U_RANDOM_RANGE_CHUNK 64
+
+static const uint64_t JUMP[4]      = {0x180ec6d33cfd0aba, 0xd5a61266f0c9392c, 0xa9582618e03fc9aa, 0x39abdc4529b1661c};
+static const uint64_t LONG_JUMP[4] = {0x76e15d3efefdcbbf, 0xc5004e441c522fb3, 0x77710069854ee241, 0x39109bb02acbe635};
+
+static void jumpBy(URandom *this, const uint64_t polynomial[4]);
+static uint64_t laneNext(URandomLanes *this, unsigned lane);
+
+void u_random_seed(URandom *this, uint64_t seed) {
+    assert(this != NULL);
+
+    // SplitMix64 never gives the same number twice in four steps, so at most one word is zero.
+    for(unsigned i = 0; i < 4; i++) {
+        uint64_t z = (seed += 0x9e3779b97f4a7c15);
+
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+
+        this->state[i] = z ^ (z >> 31);
+    }
+}
+
+void u_random_jump(URandom *this) {
+    assert(this != NULL);
+
+    jumpBy(this, JUMP);
+}
+
+void u_random_long_jump(URandom *this) {
+    assert(this != NULL);
+
+    jumpBy(this, LONG_JUMP);
+}
+
+void u_random_lanes_init(URandomLanes *this, URandom *pSource) {
+    assert(this != NULL);
+    assert(pSource != NULL);
+
+    for(unsigned l = 0; l < U_RANDOM_LANES; l++) {
+        for(unsigned w = 0; w < 4; w++)
+            this->state[w][l] = pSource->state[w];
+
+        u_random_jump(pSource);
+    }
+}
+
+void u_random_fill(URandomLanes *this, uint64_t *pDestination, size_t amount) {
+    assert(this != NULL);
+    assert(amount == 0 || pDestination != NULL);
+
+    uint64_t results[U_RANDOM_LANES];
+    size_t i = 0;
+
+#if defined(U_SIMD)
+    PackU64 s[4][PACK_AMOUNT];
+
+    for(unsigned w = 0; w < 4; w++) {
+        for(unsigned p = 0; p < PACK_AMOUNT; p++)
+            s[w][p] = PACK_U64_LOAD(&this->state[w][PACK_U64_WIDTH * p]);
+    }
+
+    // The last step writes to results, so that a partial step can be copied out.
+    for(; i < amount; i += U_RANDOM_LANES) {
+        uint64_t *pResults = i + U_RANDOM_LANES <= amount ? &pDestination[i] : results;
+
+        for(unsigned p = 0; p < PACK_AMOUNT; p++) {
+            PackU64 words[4] = {s[0][p], s[1][p], s[2][p], s[3][p]};
+
+            PACK_U64_STORE(&pResults[PACK_U64_WIDTH * p], stepPack(words));
+
+            for(unsigned w = 0; w < 4; w++)
+                s[w][p] = words[w];
+        }
+    }
+
+    for(unsigned w = 0; w < 4; w++) {
+        for(unsigned p = 0; p < PACK_AMOUNT; p++)
+            PACK_U64_STORE(&this->state[w][PACK_U64_WIDTH * p], s[w][p]);
+    }
+#else
+    // Stepping the lanes side by side from locals still overlaps their dependency chains.
+    URandom lanes[U_RANDOM_LANES];
+
+    for(unsigned l = 0; l < U_RANDOM_LANES; l++) {
+        for(unsigned w = 0; w < 4; w++)
+            lanes[l].state[w] = this->state[w][l];
+    }
+
+    for(; i < amount; i += U_RANDOM_LANES) {
+        uint64_t *pResults = i + U_RANDOM_LANES <= amount ? &pDestination[i] : results;
+
+        for(unsigned l = 0; l < U_RANDOM_LANES; l++)
+            pResults[l] = u_random_next(&lanes[l]);
+    }
+
+    for(unsigned l = 0; l < U_RANDOM_LANES; l++) {
+        for(unsigned w = 0; w < 4; w++)
+            this->state[w][l] = lanes[l].state[w];
+    }
+#endif
+
+    if(i != amount) {
+        i -= U_RANDOM_LANES;
+        memcpy(&pDestination[i], results, (amount - i) * sizeof(uint64_t));
+    }
+}
+
+void u_random_fill_range(URandomLanes *this, uint32_t *pDestination, size_t amount, uint32_t range) {
+    assert(this != NULL);
+    assert(amount == 0 || pDestination != NULL);
+    assert(range != 0);
+
+    const uint32_t threshold = -range % range;
+    uint64_t results[U_RANDOM_RANGE_CHUNK];
+
+    for(size_t i = 0; i < amount; i += U_RANDOM_RANGE_CHUNK) {
+        const size_t chunkAmount = amount - i < U_RANDOM_RANGE_CHUNK ? amount - i : U_RANDOM_RANGE_CHUNK;
+
+        u_random_fill(this, results, chunkAmount);
+
+        for(size_t c = 0; c < chunkAmount; c++) {
+            uint64_t product = (results[c] >> 32) * range;
+
+            while((uint32_t)product < threshold)
+                product = (laneNext(this, c % U_RANDOM_LANES) >> 32) * range;
+
+            pDestination[i + c] = product >> 32;
+        }
+    }
+}
+
+static void jumpBy(URandom *this, const uint64_t polynomial[4]) {
+    uint64_t jumped[4] = {0, 0, 0, 0};
+
+    for(unsigned i = 0; i < 4; i++) {
+        for(unsigned b = 0; b < 64; b++) {
+            if(polynomial[i] & ((uint64_t)1 << b)) {
+                for(unsigned w = 0; w < 4; w++)
+                    jumped[w] ^= this->state[w];
+            }
+            u_random_next(this);
+        }
+    }
+
+    memcpy(this->state, jumped, sizeof(jumped));
+}
+
+static uint64_t laneNext(URandomLanes *this, unsigned lane) {
+    URandom random;
+
+    for(unsigned w = 0; w < 4; w++)
+        random.state[w] = this->state[w][lane];
+
+    const uint64_t result = u_random_next(&random);
+
+    for(unsigned w = 0; w < 4; w++)
+        this->state[w][lane] = random.state[w];
+
+    return result;
+}
+
+#if defined(U_SIMD)
+static inline PackU64 stepPack(PackU64 *s) {
+    // x * 5 and x * 9 are shifts and adds, because none of these instruction sets multiply 64-bit lanes.
+    const PackU64 scrambled = PACK_U64_ADD(PACK_U64_SHL(s[1], 2), s[1]);
+    const PackU64 rotated   = PACK_U64_ROTL(scrambled, 7);
+    const PackU64 result    = PACK_U64_ADD(PACK_U64_SHL(rotated, 3), rotated);
+    const PackU64 t         = PACK_U64_SHL(s[1], 17);
+
+    s[2] = PACK_U64_XOR(s[2], s[0]);
+    s[3] = PACK_U64_XOR(s[3], s[1]);
+    s[1] = PACK_U64_XOR(s[1], s[2]);
+    s[0] = PACK_U64_XOR(s[0], s[3]);
+    s[2] = PACK_U64_XOR(s[2], t);
+    s[3] = PACK_U64_ROTL(s[3], 45);
+
+    return result;
+}
+#endif
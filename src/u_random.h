@@ -1,6 +1,9 @@
 #ifndef U_RANDOM_29
 #define U_RANDOM_29
 
+#include "u_random_def.h"
+
+#include <stddef.h>
 #include <stdint.h>
 
 /**
@@ -21,4 +24,92 @@ static inline uint32_t u_random_xorshift32(uint32_t *pSeed) {
     return n;
 }
 
+/**
+ * Generate a random number with xoshiro256**. The period is 2^256 - 1.
+ * @warning Do not use this for cryptography. It is only to be used for gameplay or world generation purposes.
+ * @param this The generator that was seeded by u_random_seed(). It will be modified.
+ * @return 64 random bits.
+ */
+static inline uint64_t u_random_next(URandom *this) {
+    uint64_t *s = this->state;
+    const uint64_t scrambled = s[1] * 5;
+    const uint64_t result = ((scrambled << 7) | (scrambled >> 57)) * 9;
+    const uint64_t t = s[1] << 17;
+
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = (s[3] << 45) | (s[3] >> 19);
+
+    return result;
+}
+
+/**
+ * Generate an unbiased random number below range with Lemire's multiply and shift. Unlike % range it needs no division, except for the rare rejection.
+ * @param this The generator that was seeded by u_random_seed(). It will be modified.
+ * @param range The amount of values that can be returned. Must be at least one.
+ * @return A number from zero to range - 1.
+ */
+static inline uint32_t u_random_range(URandom *this, uint32_t range) {
+    uint64_t product = (u_random_next(this) >> 32) * range;
+
+    // Only the lowest (2^32 % range) fractions are too many. They are below range, so the modulo is only computed when it could matter.
+    if((uint32_t)product < range) {
+        const uint32_t threshold = -range % range;
+
+        while((uint32_t)product < threshold)
+            product = (u_random_next(this) >> 32) * range;
+    }
+
+    return product >> 32;
+}
+
+/**
+ * Seed a generator. The seed is spread over the 256 bits of state with SplitMix64.
+ * @param this The generator to seed.
+ * @param seed Any value. Equal seeds give equal sequences.
+ */
+void u_random_seed(URandom *this, uint64_t seed);
+
+/**
+ * Advance the generator by 2^128 steps. Calling this between handing out copies gives 2^128 non-overlapping streams, one for each thread.
+ * @param this The generator that was seeded by u_random_seed(). It will be modified.
+ */
+void u_random_jump(URandom *this);
+
+/**
+ * Advance the generator by 2^192 steps. Use this to make 2^64 starting points that u_random_jump() can split further.
+ * @param this The generator that was seeded by u_random_seed(). It will be modified.
+ */
+void u_random_long_jump(URandom *this);
+
+/**
+ * Make U_RANDOM_LANES streams for the batch functions. Lane l starts at pSource and is jumped l times.
+ * @param this The lanes to set up.
+ * @param pSource The generator that was seeded by u_random_seed(). It is jumped U_RANDOM_LANES times, so it can be used again without overlap.
+ */
+void u_random_lanes_init(URandomLanes *this, URandom *pSource);
+
+/**
+ * Fill an array with random numbers. Every lane is stepped at once with AVX2, SSE2 or NEON when the compiler targets them.
+ * @note Element i comes from lane i % U_RANDOM_LANES. The result is the same with or without SIMD.
+ * If amount is not a multiple of U_RANDOM_LANES the remaining numbers of the last step are dropped.
+ * @param this The lanes that were set up by u_random_lanes_init(). They will be modified.
+ * @param pDestination The array to write amount numbers to.
+ * @param amount The amount of numbers.
+ */
+void u_random_fill(URandomLanes *this, uint64_t *pDestination, size_t amount);
+
+/**
+ * Fill an array with unbiased random numbers below range. The lanes are stepped like u_random_fill() and each number is reduced like u_random_range().
+ * @note A rejected number is drawn again from its own lane, so the result is the same with or without SIMD.
+ * @param this The lanes that were set up by u_random_lanes_init(). They will be modified.
+ * @param pDestination The array to write amount numbers to.
+ * @param amount The amount of numbers.
+ * @param range The amount of values that can be written. Must be at least one.
+ */
+void u_random_fill_range(URandomLanes *this, uint32_t *pDestination, size_t amount, uint32_t range);
+
 #endif // U_RANDOM_29
@@ -0,0 +1,19 @@
+#ifndef U_RANDOM_DEF_29
+#define U_RANDOM_DEF_29
+
+#include <stdint.h>
+
+// The amount of xoshiro256** generators that u_random_fill() steps side by side.
+#define U_RANDOM_LANES 4
+
+// The state of one xoshiro256** generator. It must not be all zeros, u_random_seed() makes sure of that.
+typedef struct URandom {
+    uint64_t state[4];
+} URandom;
+
+// U_RANDOM_LANES generators that are 2^128 steps apart. Word w of lane l is state[w][l], so a word of every lane can be loaded at once.
+typedef struct URandomLanes {
+    uint64_t state[4][U_RANDOM_LANES];
+} URandomLanes;
+
+#endif // U_RANDOM_DEF_29
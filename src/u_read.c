@@ -1,11 +1,30 @@
 #include "u_read.h"
 
+#include "u_simd.h"
+#include "u_thread.h"
+
 #include "SDL_rwops.h"
 #include "SDL_log.h"
 
 #define QOI_IMPLEMENTATION
 #include "qoi.h"
 
+#include <string.h>
+
+typedef struct {
+    const char *const *ppUTF8Paths; // Read by the tasks when ppData is null.
+    const uint8_t *const *ppData;
+    const int64_t *pDataSizes;
+    qoi_desc *pDescs;
+    void *const *ppDestinations;
+    const size_t *pDestinationSizes;
+    int *pResults;
+} QOIBatch;
+
+static int readQOIHeader(const uint8_t *pData, qoi_desc *pDesc);
+static inline void fillPixels(uint8_t *pDestination, uint32_t pixel, size_t amount);
+static void decodeQOITask(void *pUserData, unsigned index);
+
 uint8_t* u_read_file(const char *const pUTF8Path, int64_t *pSizeOfFile) {
     *pSizeOfFile = 0;
 
@@ -58,9 +77,260 @@ void* u_read_qoi(const char *const pUTF8Path, qoi_desc *pDesc, int channels) {
     if(pData == NULL)
         return NULL;
 
-    void *pPixelData = qoi_decode(pData, fileSize, pDesc, channels);
+    void *pPixelData = NULL;
+
+    // The faster decoder only outputs 4 channels.
+    if(channels == 4 && fileSize >= QOI_HEADER_SIZE && readQOIHeader(pData, pDesc)) {
+        size_t pixelsSize = 4 * (size_t)pDesc->width * pDesc->height;
+
+        pPixelData = malloc(pixelsSize);
+
+        if(pPixelData != NULL && !u_read_qoi_decode(pData, fileSize, pDesc, pPixelData, pixelsSize)) {
+            free(pPixelData);
+            pPixelData = NULL;
+        }
+    }
+    else
+        pPixelData = qoi_decode(pData, fileSize, pDesc, channels);
 
     free(pData);
 
     return pPixelData;
 }
+
+int u_read_qoi_info(const char *const pUTF8Path, qoi_desc *pDesc) {
+    uint8_t header[QOI_HEADER_SIZE];
+
+    SDL_RWops* pRead = SDL_RWFromFile(pUTF8Path, "r");
+
+    if(pRead == NULL) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "u_read_qoi_info: Cannot open image \"%s\" due to %s", pUTF8Path, SDL_GetError());
+        return 0;
+    }
+
+    if(SDL_RWread(pRead, header, sizeof(header), 1) != 1) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "u_read_qoi_info: Failed to read header for \"%s\".", pUTF8Path);
+        SDL_RWclose(pRead);
+        return 0;
+    }
+
+    SDL_RWclose(pRead);
+
+    if(!readQOIHeader(header, pDesc)) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "u_read_qoi_info: \"%s\" is not a valid QOI image.", pUTF8Path);
+        return 0;
+    }
+
+    return 1;
+}
+
+int u_read_qoi_decode(const uint8_t *pData, int64_t size, qoi_desc *pDesc, void *pPixels, size_t pixelsSize) {
+    if(size < QOI_HEADER_SIZE + (int64_t)sizeof(qoi_padding) || !readQOIHeader(pData, pDesc))
+        return 0;
+
+    const size_t pixelAmount = (size_t)pDesc->width * pDesc->height;
+
+    if(4 * pixelAmount > pixelsSize)
+        return 0;
+
+    qoi_rgba_t index[64];
+    memset(index, 0, sizeof(index));
+
+    qoi_rgba_t px;
+    px.rgba.r = 0;
+    px.rgba.g = 0;
+    px.rgba.b = 0;
+    px.rgba.a = 255;
+
+    const uint8_t *pByte = pData + QOI_HEADER_SIZE;
+    const uint8_t *const pChunksEnd = pData + size - sizeof(qoi_padding);
+    uint8_t *pDestination = pPixels;
+    size_t position = 0;
+
+    while(position < pixelAmount) {
+        // Like qoi_decode() a truncated stream repeats the last pixel.
+        if(pByte >= pChunksEnd) {
+            fillPixels(pDestination + 4 * position, px.v, pixelAmount - position);
+            break;
+        }
+
+        const int b1 = *pByte++;
+
+        if(b1 == QOI_OP_RGB) {
+            px.rgba.r = pByte[0];
+            px.rgba.g = pByte[1];
+            px.rgba.b = pByte[2];
+            pByte += 3;
+        }
+        else if(b1 == QOI_OP_RGBA) {
+            px.rgba.r = pByte[0];
+            px.rgba.g = pByte[1];
+            px.rgba.b = pByte[2];
+            px.rgba.a = pByte[3];
+            pByte += 4;
+        }
+        else {
+            switch(b1 & QOI_MASK_2) {
+                case QOI_OP_INDEX:
+                    px = index[b1];
+                    break;
+                case QOI_OP_DIFF:
+                    px.rgba.r += ((b1 >> 4) & 0x03) - 2;
+                    px.rgba.g += ((b1 >> 2) & 0x03) - 2;
+                    px.rgba.b += ( b1       & 0x03) - 2;
+                    break;
+                case QOI_OP_LUMA:
+                {
+                    const int b2 = *pByte++;
+                    const int vg = (b1 & 0x3f) - 32;
+
+                    px.rgba.r += vg - 8 + ((b2 >> 4) & 0x0f);
+                    px.rgba.g += vg;
+                    px.rgba.b += vg - 8 +  (b2       & 0x0f);
+                    break;
+                }
+                default: // QOI_OP_RUN
+                {
+                    // A run repeats the previous pixel, which is already in the index.
+                    size_t run = (b1 & 0x3f) + 1;
+
+                    if(run > pixelAmount - position)
+                        run = pixelAmount - position;
+
+                    fillPixels(pDestination + 4 * position, px.v, run);
+                    position += run;
+                    continue;
+                }
+            }
+        }
+
+        index[QOI_COLOR_HASH(px) % 64] = px;
+
+        memcpy(pDestination + 4 * position, &px.v, 4);
+        position++;
+    }
+
+    return 1;
+}
+
+int u_read_qoi_batch(const char *const *ppUTF8Paths, unsigned amount, qoi_desc *pDescs, void *const *ppDestinations, const size_t *pDestinationSizes) {
+    int *pResults = malloc(sizeof(int) * amount);
+
+    if(pResults == NULL)
+        return 0;
+
+    QOIBatch batch;
+    batch.ppUTF8Paths = ppUTF8Paths;
+    batch.ppData = NULL;
+    batch.pDataSizes = NULL;
+    batch.pDescs = pDescs;
+    batch.ppDestinations = ppDestinations;
+    batch.pDestinationSizes = pDestinationSizes;
+    batch.pResults = pResults;
+
+    u_thread_parallel_for(amount, decodeQOITask, &batch);
+
+    int result = 1;
+
+    for(unsigned i = 0; i < amount; i++) {
+        if(!pResults[i]) {
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "u_read_qoi_batch: Failed to decode \"%s\".", ppUTF8Paths[i]);
+            result = 0;
+        }
+    }
+
+    free(pResults);
+
+    return result;
+}
+
+int u_read_qoi_decode_batch(const uint8_t *const *ppData, const int64_t *pDataSizes, unsigned amount, qoi_desc *pDescs, void *const *ppDestinations, const size_t *pDestinationSizes) {
+    int *pResults = malloc(sizeof(int) * amount);
+
+    if(pResults == NULL)
+        return 0;
+
+    QOIBatch batch;
+    batch.ppUTF8Paths = NULL;
+    batch.ppData = ppData;
+    batch.pDataSizes = pDataSizes;
+    batch.pDescs = pDescs;
+    batch.ppDestinations = ppDestinations;
+    batch.pDestinationSizes = pDestinationSizes;
+    batch.pResults = pResults;
+
+    u_thread_parallel_for(amount, decodeQOITask, &batch);
+
+    int result = 1;
+
+    for(unsigned i = 0; i < amount; i++) {
+        if(!pResults[i]) {
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "u_read_qoi_decode_batch: Failed to decode image %u.", i);
+            result = 0;
+        }
+    }
+
+    free(pResults);
+
+    return result;
+}
+
+static int readQOIHeader(const uint8_t *pData, qoi_desc *pDesc) {
+    int p = 0;
+    unsigned int headerMagic = qoi_read_32(pData, &p);
+
+    pDesc->width      = qoi_read_32(pData, &p);
+    pDesc->height     = qoi_read_32(pData, &p);
+    pDesc->channels   = pData[p++];
+    pDesc->colorspace = pData[p++];
+
+    return !(
+        pDesc->width == 0 || pDesc->height == 0 ||
+        pDesc->channels < 3 || pDesc->channels > 4 ||
+        pDesc->colorspace > 1 ||
+        headerMagic != QOI_MAGIC ||
+        pDesc->height >= QOI_PIXELS_MAX / pDesc->width);
+}
+
+static inline void fillPixels(uint8_t *pDestination, uint32_t pixel, size_t amount) {
+#if defined(U_SIMD_AVX2) || defined(U_SIMD_SSE2)
+    const __m128i quad = _mm_set1_epi32((int)pixel);
+
+    for(; amount >= 4; amount -= 4) {
+        _mm_storeu_si128((__m128i*)pDestination, quad);
+        pDestination += 16;
+    }
+#elif defined(U_SIMD_NEON)
+    const uint32x4_t quad = vdupq_n_u32(pixel);
+
+    for(; amount >= 4; amount -= 4) {
+        vst1q_u8(pDestination, vreinterpretq_u8_u32(quad));
+        pDestination += 16;
+    }
+#endif
+    for(; amount != 0; amount--) {
+        memcpy(pDestination, &pixel, 4);
+        pDestination += 4;
+    }
+}
+
+static void decodeQOITask(void *pUserData, unsigned index) {
+    QOIBatch *pBatch = pUserData;
+    int64_t fileSize;
+
+    if(pBatch->ppData != NULL) {
+        pBatch->pResults[index] = u_read_qoi_decode(pBatch->ppData[index], pBatch->pDataSizes[index], &pBatch->pDescs[index], pBatch->ppDestinations[index], pBatch->pDestinationSizes[index]);
+        return;
+    }
+
+    pBatch->pResults[index] = 0;
+
+    uint8_t *pData = u_read_file(pBatch->ppUTF8Paths[index], &fileSize);
+
+    if(pData == NULL)
+        return;
+
+    pBatch->pResults[index] = u_read_qoi_decode(pData, fileSize, &pBatch->pDescs[index], pBatch->ppDestinations[index], pBatch->pDestinationSizes[index]);
+
+    free(pData);
+}
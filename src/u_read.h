@@ -1,6 +1,7 @@
 #ifndef READ_UTILITY_29
 #define READ_UTILITY_29
 
+#include <stddef.h>
 #include <stdint.h>
 
 #define QOI_NO_STDIO // Use u_qoi_read instead.
@@ -25,4 +26,46 @@ uint8_t* u_read_file(const char *const pUTF8Path, int64_t *pSizeOfFile);
  */
 void* u_read_qoi(const char *const pUTF8Path, qoi_desc *pDesc, int channels);
 
+/**
+ * Read only the header of a QOI file.
+ * @param pUTF8Path The path to where the image file is. It is encoded with unicode.
+ * @param pDesc Returns a qoi descriptor with width, height, channels and encoding type
+ * @return 1 if the header is valid. 0 if the file cannot be read or is not a QOI image.
+ */
+int u_read_qoi_info(const char *const pUTF8Path, qoi_desc *pDesc);
+
+/**
+ * Decode a QOI image in memory into 4 channel pixels without allocating anything. This gives the same pixels as qoi_decode().
+ * @param pData The QOI file data.
+ * @param size The size of pData in bytes.
+ * @param pDesc Returns a qoi descriptor with width, height, channels and encoding type
+ * @param pPixels The buffer where the pixels would be written to. It can be mapped Vulkan memory.
+ * @param pixelsSize The size of pPixels in bytes. It must be at least 4 * width * height.
+ * @return 1 if the image has been decoded. 0 if the header is invalid or the image does not fit into pPixels.
+ */
+int u_read_qoi_decode(const uint8_t *pData, int64_t size, qoi_desc *pDesc, void *pPixels, size_t pixelsSize);
+
+/**
+ * Read and decode multiple QOI files on worker threads. Every file is decoded straight into its destination.
+ * @param ppUTF8Paths The paths to the image files.
+ * @param amount The amount of paths.
+ * @param pDescs Returns a qoi descriptor for every path.
+ * @param ppDestinations The buffer where the pixels of each path would be written to. Each one is given to u_read_qoi_decode().
+ * @param pDestinationSizes The size of each destination in bytes.
+ * @return 1 if every image has been decoded. 0 if at least one failed.
+ */
+int u_read_qoi_batch(const char *const *ppUTF8Paths, unsigned amount, qoi_desc *pDescs, void *const *ppDestinations, const size_t *pDestinationSizes);
+
+/**
+ * Decode multiple QOI images that are already in memory on worker threads. Every image is decoded straight into its destination.
+ * @param ppData The QOI file data of each image.
+ * @param pDataSizes The size of each file data in bytes.
+ * @param amount The amount of images.
+ * @param pDescs Returns a qoi descriptor for every image.
+ * @param ppDestinations The buffer where the pixels of each image would be written to. Each one is given to u_read_qoi_decode().
+ * @param pDestinationSizes The size of each destination in bytes.
+ * @return 1 if every image has been decoded. 0 if at least one failed.
+ */
+int u_read_qoi_decode_batch(const uint8_t *const *ppData, const int64_t *pDataSizes, unsigned amount, qoi_desc *pDescs, void *const *ppDestinations, const size_t *pDestinationSizes);
+
 #endif // READ_UTILITY_29
@@ -0,0 +1,88 @@
+#ifndef U_SIMD_29
+#define U_SIMD_29
+
+// The widest vector instructions that the compiler targets. Without any of them no pack is defined, so code that uses packs needs a scalar path under #if !defined(U_SIMD).
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define U_SIMD_AVX2
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define U_SIMD_SSE2
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#define U_SIMD_NEON
+#endif
+
+#if defined(U_SIMD_AVX2) || defined(U_SIMD_SSE2) || defined(U_SIMD_NEON)
+#define U_SIMD
+#endif
+
+// A PackU64 holds PACK_U64_WIDTH unsigned 64-bit integers, and a PackF32 holds PACK_F32_WIDTH floats.
+// PACK_F32_SELECT_GT(x, y, a, b) takes the lanes of a where x > y and the lanes of b elsewhere.
+#if defined(U_SIMD_AVX2)
+typedef __m256i PackU64;
+#define PACK_U64_WIDTH 4
+#define PACK_U64_LOAD(pSource)             _mm256_loadu_si256((const __m256i*)(pSource))
+#define PACK_U64_STORE(pDestination, pack) _mm256_storeu_si256((__m256i*)(pDestination), (pack))
+#define PACK_U64_ADD(a, b)                 _mm256_add_epi64((a), (b))
+#define PACK_U64_XOR(a, b)                 _mm256_xor_si256((a), (b))
+#define PACK_U64_OR(a, b)                  _mm256_or_si256((a), (b))
+#define PACK_U64_SHL(a, k)                 _mm256_slli_epi64((a), (k))
+#define PACK_U64_SHR(a, k)                 _mm256_srli_epi64((a), (k))
+
+typedef __m256 PackF32;
+#define PACK_F32_WIDTH 8
+#define PACK_F32_LOAD(pSource)             _mm256_loadu_ps((pSource))
+#define PACK_F32_STORE(pDestination, pack) _mm256_storeu_ps((pDestination), (pack))
+#define PACK_F32_SET(value)                _mm256_set1_ps((value))
+#define PACK_F32_ADD(a, b)                 _mm256_add_ps((a), (b))
+#define PACK_F32_MUL(a, b)                 _mm256_mul_ps((a), (b))
+#define PACK_F32_MAX(a, b)                 _mm256_max_ps((a), (b))
+#define PACK_F32_SELECT_GT(x, y, a, b)     _mm256_blendv_ps((b), (a), _mm256_cmp_ps((x), (y), _CMP_GT_OQ))
+#elif defined(U_SIMD_SSE2)
+typedef __m128i PackU64;
+#define PACK_U64_WIDTH 2
+#define PACK_U64_LOAD(pSource)             _mm_loadu_si128((const __m128i*)(pSource))
+#define PACK_U64_STORE(pDestination, pack) _mm_storeu_si128((__m128i*)(pDestination), (pack))
+#define PACK_U64_ADD(a, b)                 _mm_add_epi64((a), (b))
+#define PACK_U64_XOR(a, b)                 _mm_xor_si128((a), (b))
+#define PACK_U64_OR(a, b)                  _mm_or_si128((a), (b))
+#define PACK_U64_SHL(a, k)                 _mm_slli_epi64((a), (k))
+#define PACK_U64_SHR(a, k)                 _mm_srli_epi64((a), (k))
+
+typedef __m128 PackF32;
+#define PACK_F32_WIDTH 4
+#define PACK_F32_LOAD(pSource)             _mm_loadu_ps((pSource))
+#define PACK_F32_STORE(pDestination, pack) _mm_storeu_ps((pDestination), (pack))
+#define PACK_F32_SET(value)                _mm_set1_ps((value))
+#define PACK_F32_ADD(a, b)                 _mm_add_ps((a), (b))
+#define PACK_F32_MUL(a, b)                 _mm_mul_ps((a), (b))
+#define PACK_F32_MAX(a, b)                 _mm_max_ps((a), (b))
+#define PACK_F32_SELECT_GT(x, y, a, b)     _mm_or_ps(_mm_and_ps(_mm_cmpgt_ps((x), (y)), (a)), _mm_andnot_ps(_mm_cmpgt_ps((x), (y)), (b)))
+#elif defined(U_SIMD_NEON)
+typedef uint64x2_t PackU64;
+#define PACK_U64_WIDTH 2
+#define PACK_U64_LOAD(pSource)             vld1q_u64((const uint64_t*)(pSource))
+#define PACK_U64_STORE(pDestination, pack) vst1q_u64((uint64_t*)(pDestination), (pack))
+#define PACK_U64_ADD(a, b)                 vaddq_u64((a), (b))
+#define PACK_U64_XOR(a, b)                 veorq_u64((a), (b))
+#define PACK_U64_OR(a, b)                  vorrq_u64((a), (b))
+#define PACK_U64_SHL(a, k)                 vshlq_n_u64((a), (k))
+#define PACK_U64_SHR(a, k)                 vshrq_n_u64((a), (k))
+
+typedef float32x4_t PackF32;
+#define PACK_F32_WIDTH 4
+#define PACK_F32_LOAD(pSource)             vld1q_f32((pSource))
+#define PACK_F32_STORE(pDestination, pack) vst1q_f32((pDestination), (pack))
+#define PACK_F32_SET(value)                vdupq_n_f32((value))
+#define PACK_F32_ADD(a, b)                 vaddq_f32((a), (b))
+#define PACK_F32_MUL(a, b)                 vmulq_f32((a), (b))
+#define PACK_F32_MAX(a, b)                 vmaxq_f32((a), (b))
+#define PACK_F32_SELECT_GT(x, y, a, b)     vbslq_f32(vcgtq_f32((x), (y)), (a), (b))
+#endif
+
+#if defined(U_SIMD)
+#define PACK_U64_ROTL(a, k) PACK_U64_OR(PACK_U64_SHL((a), (k)), PACK_U64_SHR((a), 64 - (k)))
+#endif
+
+#endif // U_SIMD_29
@@ -0,0 +1,67 @@
+#include "u_thread.h"
+
+#include "SDL_atomic.h"
+#include "SDL_cpuinfo.h"
+#include "SDL_error.h"
+#include "SDL_log.h"
+#include "SDL_thread.h"
+
+#define MAX_THREADS 32
+
+typedef struct {
+    UThreadTask task;
+    void *pUserData;
+    unsigned taskAmount;
+    SDL_atomic_t nextIndex;
+} ParallelFor;
+
+static int workerMain(void *pData);
+
+unsigned u_thread_count(void) {
+    int cpuCount = SDL_GetCPUCount();
+
+    if(cpuCount < 1)
+        return 1;
+    if(cpuCount > MAX_THREADS)
+        return MAX_THREADS;
+
+    return cpuCount;
+}
+
+void u_thread_parallel_for(unsigned taskAmount, UThreadTask task, void *pUserData) {
+    ParallelFor parallelFor;
+    parallelFor.task = task;
+    parallelFor.pUserData = pUserData;
+    parallelFor.taskAmount = taskAmount;
+    SDL_AtomicSet(&parallelFor.nextIndex, 0);
+
+    SDL_Thread *pThreads[MAX_THREADS];
+    unsigned threadAmount = u_thread_count();
+
+    if(threadAmount > taskAmount)
+        threadAmount = taskAmount;
+
+    // The calling thread is one of the workers.
+    for(unsigned i = 1; i < threadAmount; i++) {
+        pThreads[i] = SDL_CreateThread(workerMain, "u_thread_worker", &parallelFor);
+
+        if(pThreads[i] == NULL)
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "u_thread_parallel_for: SDL_CreateThread failed due to %s", SDL_GetError());
+    }
+
+    workerMain(&parallelFor);
+
+    for(unsigned i = 1; i < threadAmount; i++) {
+        if(pThreads[i] != NULL)
+            SDL_WaitThread(pThreads[i], NULL);
+    }
+}
+
+static int workerMain(void *pData) {
+    ParallelFor *pParallelFor = pData;
+
+    for(unsigned index = SDL_AtomicAdd(&pParallelFor->nextIndex, 1); index < pParallelFor->taskAmount; index = SDL_AtomicAdd(&pParallelFor->nextIndex, 1))
+        pParallelFor->task(pParallelFor->pUserData, index);
+
+    return 0;
+}
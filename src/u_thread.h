@@ -0,0 +1,26 @@
+#ifndef U_THREAD_29
+#define U_THREAD_29
+
+/**
+ * A unit of work for u_thread_parallel_for().
+ * @param pUserData The pUserData given to u_thread_parallel_for().
+ * @param index The index of the task from zero to taskAmount - 1.
+ */
+typedef void (*UThreadTask)(void *pUserData, unsigned index);
+
+/**
+ * @return The amount of worker threads that should be used. It is at least one.
+ */
+unsigned u_thread_count(void);
+
+/**
+ * Run a task for every index on worker threads and wait for all of them to finish.
+ * @note The calling thread works on the tasks as well. If no threads could be created then every task runs on the calling thread.
+ * @warning Tasks may run in any order and at the same time, so they must not write to shared data without their own synchronization.
+ * @param taskAmount The amount of tasks to run.
+ * @param task The function to call for each index.
+ * @param pUserData The pointer to pass to every task.
+ */
+void u_thread_parallel_for(unsigned taskAmount, UThreadTask task, void *pUserData);
+
+#endif // U_THREAD_29
@@ -40,11 +40,13 @@ int u_vector_scale(UVector *pVector, size_t size) {
 
         pReallocBuffer = realloc(pVector->pBuffer, newCapacitySize * pVector->elementSize);
 
-        if(pReallocBuffer != NULL)
+        if(pReallocBuffer != NULL) {
+            pVector->capacity = newCapacitySize;
+            pVector->pBuffer  = pReallocBuffer;
+        }
+        else if(size > pVector->capacity)
             return 0; // Operation failed.
-
-        pVector->capacity = newCapacitySize;
-        pVector->pBuffer  = pReallocBuffer;
+        // Otherwise the old buffer is kept, because the smaller size still fits in it.
     }
 
     pVector->size = size;
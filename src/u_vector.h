@@ -22,7 +22,7 @@ void u_vector_free(UVector *pVector);
 /**
  * @param pVector The vector to become free. Must be a pointer to UVector.
  * @param size The new size of which hopefully rescales pVector.
- * @return If the resizing operation had failed then return 0. Otherwise it would return 1.
+ * @return If the resizing operation had failed then return 0. Otherwise it would return 1. Shrinking never fails.
  */
 int u_vector_scale(UVector *pVector, size_t size);
 
@@ -17,6 +17,18 @@ const VkVertexInputAttributeDescription V_BUFFER_VertexInputAttributeDescription
     {       2,       0,    VK_FORMAT_R32G32_SFLOAT, offsetof(VBufferVertex, texCoord)}
 };
 
+const VkVertexInputBindingDescription V_BUFFER_CompressedVertexBindingDescription = {
+//  binding,                          stride,                   inputRate
+          0, sizeof(VBufferCompressedVertex), VK_VERTEX_INPUT_RATE_VERTEX
+};
+
+const VkVertexInputAttributeDescription V_BUFFER_CompressedVertexInputAttributeDescriptions[3] = {
+//   location, binding,                        format,                                     offset
+    {       0,       0, VK_FORMAT_R16G16B16A16_SNORM, offsetof(VBufferCompressedVertex,      pos)},
+    {       1,       0,     VK_FORMAT_R8G8B8A8_UNORM, offsetof(VBufferCompressedVertex,    color)},
+    {       2,       0,        VK_FORMAT_R16G16_UNORM, offsetof(VBufferCompressedVertex, texCoord)}
+};
+
 VEngineResult v_buffer_alloc(Context *this, VkDeviceSize size, VkBufferUsageFlags usageFlags, VkMemoryPropertyFlags propertyFlags, VkBuffer *pBuffer, VkDeviceMemory *pBufferMemory) {
     VkResult result;
 
@@ -388,7 +400,7 @@ VEngineResult v_buffer_transition_image_layout(Context *this, VkImage image, VkF
     RETURN_RESULT_CODE(VE_SUCCESS, 0)
 }
 
-VEngineResult v_buffer_copy_to_image(Context *this, VkBuffer buffer, VkImage image, uint32_t width, uint32_t height, VkDeviceSize primeImageSize, uint32_t mipLevels) {
+VEngineResult v_buffer_copy_to_image(Context *this, VkBuffer buffer, VkImage image, uint32_t width, uint32_t height, VkDeviceSize primeImageSize, uint32_t mipLevels, const VkDeviceSize *pMipOffsets) {
     VEngineResult engineResult;
 
     VkCommandBuffer commandBuffer;
@@ -421,6 +433,9 @@ VEngineResult v_buffer_copy_to_image(Context *this, VkBuffer buffer, VkImage ima
     for(uint32_t m = 0; m < mipLevels; m++) {
         bufferImageCopy.imageSubresource.mipLevel = m;
 
+        if(pMipOffsets != NULL)
+            bufferImageCopy.bufferOffset = pMipOffsets[m];
+
         vkCmdCopyBufferToImage(
             commandBuffer,
             buffer,
@@ -434,6 +449,12 @@ VEngineResult v_buffer_copy_to_image(Context *this, VkBuffer buffer, VkImage ima
         bufferImageCopy.imageExtent.width /= 2;
         bufferImageCopy.imageExtent.height /= 2;
 
+        // Non square images reach a dimension of one before the other.
+        if(bufferImageCopy.imageExtent.width == 0)
+            bufferImageCopy.imageExtent.width = 1;
+        if(bufferImageCopy.imageExtent.height == 0)
+            bufferImageCopy.imageExtent.height = 1;
+
         currentImageSize /= 4;
     }
 
@@ -445,6 +466,131 @@ VEngineResult v_buffer_copy_to_image(Context *this, VkBuffer buffer, VkImage ima
     RETURN_RESULT_CODE(VE_SUCCESS, 0)
 }
 
+VkBool32 v_buffer_can_generate_mipmaps(Context *this, VkFormat format) {
+    const VkFormatFeatureFlags features = VK_FORMAT_FEATURE_BLIT_SRC_BIT | VK_FORMAT_FEATURE_BLIT_DST_BIT | VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT;
+
+    if(v_buffer_find_supported_format(this, &format, 1, VK_IMAGE_TILING_OPTIMAL, features) == VK_FORMAT_UNDEFINED)
+        return VK_FALSE;
+
+    return VK_TRUE;
+}
+
+VEngineResult v_buffer_generate_mipmaps(Context *this, VkImage image, VkFormat format, uint32_t width, uint32_t height, uint32_t mipLevels) {
+    VEngineResult engineResult;
+
+    if(v_buffer_can_generate_mipmaps(this, format) != VK_TRUE) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "VkFormat %i does not support linear blitting", format);
+        RETURN_RESULT_CODE(VE_GENERATE_MIPMAPS_FAILURE, 0)
+    }
+
+    VkCommandBuffer commandBuffer;
+
+    engineResult = v_buffer_begin_1_time_cb(this, &commandBuffer);
+    if(engineResult.type != VE_SUCCESS) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "v_buffer_begin_1_time_cb had failed with %i", engineResult.point);
+        RETURN_RESULT_CODE(VE_GENERATE_MIPMAPS_FAILURE, 1)
+    }
+
+    VkImageMemoryBarrier imageMemoryBarrier = {0};
+    imageMemoryBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    imageMemoryBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    imageMemoryBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    imageMemoryBarrier.image = image;
+    imageMemoryBarrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    imageMemoryBarrier.subresourceRange.levelCount = 1;
+    imageMemoryBarrier.subresourceRange.baseArrayLayer = 0;
+    imageMemoryBarrier.subresourceRange.layerCount = 1;
+
+    int32_t mipWidth  = width;
+    int32_t mipHeight = height;
+
+    for(uint32_t m = 1; m < mipLevels; m++) {
+        // The previous level was just written to, so it has to become a blit source.
+        imageMemoryBarrier.subresourceRange.baseMipLevel = m - 1;
+        imageMemoryBarrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        imageMemoryBarrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+        imageMemoryBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        imageMemoryBarrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+
+        vkCmdPipelineBarrier(
+            commandBuffer,
+            VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+            0,
+            0, NULL,
+            0, NULL,
+            1, &imageMemoryBarrier
+        );
+
+        VkImageBlit imageBlit = {0};
+        imageBlit.srcOffsets[1].x = mipWidth;
+        imageBlit.srcOffsets[1].y = mipHeight;
+        imageBlit.srcOffsets[1].z = 1;
+        imageBlit.srcSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        imageBlit.srcSubresource.mipLevel = m - 1;
+        imageBlit.srcSubresource.baseArrayLayer = 0;
+        imageBlit.srcSubresource.layerCount = 1;
+
+        if(mipWidth > 1)
+            mipWidth /= 2;
+        if(mipHeight > 1)
+            mipHeight /= 2;
+
+        imageBlit.dstOffsets[1].x = mipWidth;
+        imageBlit.dstOffsets[1].y = mipHeight;
+        imageBlit.dstOffsets[1].z = 1;
+        imageBlit.dstSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        imageBlit.dstSubresource.mipLevel = m;
+        imageBlit.dstSubresource.baseArrayLayer = 0;
+        imageBlit.dstSubresource.layerCount = 1;
+
+        vkCmdBlitImage(
+            commandBuffer,
+            image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+            image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+            1, &imageBlit,
+            VK_FILTER_LINEAR
+        );
+
+        // The previous level is done.
+        imageMemoryBarrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+        imageMemoryBarrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        imageMemoryBarrier.srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+        imageMemoryBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+
+        vkCmdPipelineBarrier(
+            commandBuffer,
+            VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+            0,
+            0, NULL,
+            0, NULL,
+            1, &imageMemoryBarrier
+        );
+    }
+
+    // The last level was never used as a blit source.
+    imageMemoryBarrier.subresourceRange.baseMipLevel = mipLevels - 1;
+    imageMemoryBarrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    imageMemoryBarrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    imageMemoryBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    imageMemoryBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+
+    vkCmdPipelineBarrier(
+        commandBuffer,
+        VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+        0,
+        0, NULL,
+        0, NULL,
+        1, &imageMemoryBarrier
+    );
+
+    engineResult = v_buffer_end_1_time_cb(this, &commandBuffer);
+    if(engineResult.type != VE_SUCCESS) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "v_buffer_end_1_time_cb had failed with %i", engineResult.point);
+        RETURN_RESULT_CODE(VE_GENERATE_MIPMAPS_FAILURE, 2)
+    }
+    RETURN_RESULT_CODE(VE_SUCCESS, 0)
+}
+
 VEngineResult v_buffer_alloc_image_view(Context *this, VkImage image, VkFormat format, VkImageViewCreateFlags createFlags, VkImageAspectFlags aspectFlags, VkImageView *pImageView, uint32_t mipLevels) {
     VkImageViewCreateInfo imageViewCreateInfo;
     imageViewCreateInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
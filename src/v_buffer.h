@@ -113,11 +113,33 @@ VEngineResult v_buffer_transition_image_layout(Context *this, VkImage image, VkF
  * @param image An image where the buffer would be copied to.
  * @param width The width of the image in pixel units.
  * @param height The height of the image in pixel units.
- * @param primeImageSize The size of the first image in the mip map.
+ * @param primeImageSize The size of the first image in the mip map. Only used if pMipOffsets is NULL.
  * @param mipLevels The amount of mipmap levels that the mipmap in the buffer has. If the image has no mipmaps then set this to one.
+ * @param pMipOffsets The byte offset of every mip level in buffer. This is needed for block compressed formats. If NULL then the levels are assumed to be tightly packed 4 byte texels.
  * @return A VEngineResult. If its type is VE_SUCCESS then the image has been copied to the image. If VE_COPY_BUFFER_TO_IMAGE_FAILURE then Vulkan had found a problem.
  */
-VEngineResult v_buffer_copy_to_image(Context *this, VkBuffer buffer, VkImage image, uint32_t width, uint32_t height, VkDeviceSize primeImageSize, uint32_t mipLevels);
+VEngineResult v_buffer_copy_to_image(Context *this, VkBuffer buffer, VkImage image, uint32_t width, uint32_t height, VkDeviceSize primeImageSize, uint32_t mipLevels, const VkDeviceSize *pMipOffsets);
+
+/**
+ * @warning Make sure that v_init() is called first.
+ * @param this The primary Context of the program.
+ * @param format The format of the image that needs mipmaps.
+ * @return VK_TRUE if v_buffer_generate_mipmaps() can be used with the format. Otherwise VK_FALSE.
+ */
+VkBool32 v_buffer_can_generate_mipmaps(Context *this, VkFormat format);
+
+/**
+ * This function fills every mip level of an image by blitting each level into the next one with linear filtering.
+ * @warning Make sure that v_init() is called first. The image must have VK_IMAGE_USAGE_TRANSFER_SRC_BIT and VK_IMAGE_USAGE_TRANSFER_DST_BIT, all of its levels must be in VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL and level zero must be filled.
+ * @param this The primary Context of the program.
+ * @param image The image to fill the mip levels of. Every level ends up in VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL.
+ * @param format The format of the image. @note Check it with v_buffer_can_generate_mipmaps() first.
+ * @param width The width of the image in pixel units.
+ * @param height The height of the image in pixel units.
+ * @param mipLevels The amount of mipmap levels that the image has.
+ * @return A VEngineResult. If its type is VE_SUCCESS then the mip levels are filled. If VE_GENERATE_MIPMAPS_FAILURE then a problem occured. If point is zero then the format cannot be blitted with linear filtering.
+ */
+VEngineResult v_buffer_generate_mipmaps(Context *this, VkImage image, VkFormat format, uint32_t width, uint32_t height, uint32_t mipLevels);
 
 /**
  * This function allocates an image view.
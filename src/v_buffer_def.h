@@ -9,15 +9,26 @@ typedef struct {
     Vector2 texCoord;
 } VBufferVertex;
 
+// The positions are signed normalized and multiplied by VBufferPushConstantObject::positionScale in the vertex shader.
+typedef struct {
+    int16_t  pos[4];
+    uint8_t  color[4];
+    uint16_t texCoord[2];
+} VBufferCompressedVertex;
+
 typedef struct {
     Vector4 color;
 } VBufferUniformBufferObject;
 
 typedef struct {
     Matrix matrix;
+    uint32_t textureIndex; // The texture slot given by v_texture_register().
+    float positionScale;   // Only read by pipelines with V_PIPELINE_COMPRESSED_VERTEX.
 } VBufferPushConstantObject;
 
 extern const VkVertexInputBindingDescription   V_BUFFER_VertexBindingDescription;
 extern const VkVertexInputAttributeDescription V_BUFFER_VertexInputAttributeDescriptions[3];
+extern const VkVertexInputBindingDescription   V_BUFFER_CompressedVertexBindingDescription;
+extern const VkVertexInputAttributeDescription V_BUFFER_CompressedVertexInputAttributeDescriptions[3];
 
 #endif // V_BUFFER_DEFINE_29
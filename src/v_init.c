@@ -1,15 +1,21 @@
 #include "v_init.h"
 
 #include "context.h"
+#include "u_cache.h"
 #include "u_config.h"
+#include "u_ktx2.h"
 #include "u_read.h"
-#include "u_maze.h"
 #include "u_vector.h"
 #include "v_buffer.h"
+#include "v_maze.h"
+#include "v_maze_gpu.h"
 #include "v_model.h"
+#include "v_pipeline.h"
 #include "v_render.h"
 #include "v_results.h"
 #include "v_raymath.h"
+#include "v_texture.h"
+#include "v_world.h"
 
 #include <assert.h>
 #include <string.h>
@@ -32,17 +38,22 @@ static int hasRequiredExtensions(VkPhysicalDevice physicalDevice, const char * c
 static VEngineResult querySwapChainCapabilities(VkPhysicalDevice physicalDevice, VkSurfaceKHR surface, SwapChainCapabilities **ppSwapChainCapabilities);
 static VEngineResult initInstance(Context *this);
 static VEngineResult findPhysicalDevice(Context *this, const char * const* ppRequiredExtensions, uint32_t requiredExtensionsAmount);
+static uint32_t findBindlessLimit(Context *this, const VkPhysicalDeviceFeatures *pSupportedFeatures);
 static VEngineResult allocateLogicalDevice(Context *this, const char * const* ppRequiredExtensions, uint32_t requiredExtensionsAmount);
 static VEngineResult allocateSwapChain(Context *this);
 static VEngineResult allocateSwapChainImageViews(Context *this);
 static VEngineResult createRenderPass(Context *this);
-static VkShaderModule allocateShaderModule(Context *this, uint8_t* data, size_t size);
 static VEngineResult allocateDescriptorSetLayout(Context *this);
-static VEngineResult allocateGraphicsPipeline(Context *this);
 static VEngineResult allocateFrameBuffers(Context *this);
 static VEngineResult allocateCommandPool(Context *this);
 static VEngineResult allocateColorResources(Context *this);
 static VEngineResult allocateDepthResources(Context *this);
+static VEngineResult uploadTextureImage(Context *this, VkBuffer stagingBuffer, uint32_t width, uint32_t height, VkDeviceSize primeImageSize, const VkDeviceSize *pMipOffsets, VkBool32 generateMipmaps);
+static VkBool32 isTextureFormatUsable(Context *this, VkFormat format);
+static VEngineResult allocateKTX2TextureImage(Context *this, const char *const pPath);
+static void downsampleRGBA8(const uint8_t *pSource, uint32_t sourceWidth, uint32_t sourceHeight, uint8_t *pDestination);
+static VEngineResult allocateGeneratedTextureImage(Context *this, const uint8_t *pBasePixels, uint32_t width, uint32_t height);
+static VEngineResult allocateQOITextureImage(Context *this);
 static VEngineResult allocateTextureImage(Context *this);
 static VEngineResult allocateTextureImageView(Context *this);
 static VEngineResult allocateDefaultTextureSampler(Context *this);
@@ -95,7 +106,7 @@ VEngineResult v_init_alloc(Context *this) {
     if( returnCode.type < 0 )
         return returnCode;
 
-    returnCode = allocateGraphicsPipeline(this);
+    returnCode = v_pipeline_alloc(this);
     if( returnCode.type < 0 )
         return returnCode;
 
@@ -135,11 +146,31 @@ VEngineResult v_init_alloc(Context *this) {
     if( returnCode.type < 0 )
         return returnCode;
 
+    returnCode = v_buffer_alloc_builtin_uniform(this);
+    if( returnCode.type < 0 )
+        return returnCode;
+
+    returnCode = allocateDescriptorPool(this);
+    if( returnCode.type < 0 )
+        return returnCode;
+
+    returnCode = allocateDescriptorSets(this);
+    if( returnCode.type < 0 )
+        return returnCode;
+
+    returnCode = v_texture_register(this, this->vk.texture.imageView, this->vk.defaultTextureSampler, &this->vk.texture.index);
+    if( returnCode.type < 0 )
+        return returnCode;
+
     returnCode = v_model_load(this, "model.glb", &this->vk.modelAmount, &this->vk.pModels);
     if( returnCode.type < 0 )
         return returnCode;
 
-    VModelData *pMazeIndexes[16] = { NULL };
+    // Start the variants that the models need now. They are drawn with a fallback until they finish.
+    for(uint32_t i = 0; i < this->vk.modelAmount; i++)
+        v_pipeline_compile_async(this, this->vk.pModels[i].pipelineVariant);
+
+    VModelData *pMazeIndexes[V_MAZE_PIECE_AMOUNT] = { NULL };
 
     for(uint32_t i = 0; i < this->vk.modelAmount; i++) {
         size_t lengthOfName = strlen(this->vk.pModels[i].name);
@@ -158,90 +189,33 @@ VEngineResult v_init_alloc(Context *this) {
         printf("Model name = %s. Length = %zu decodedIndex = %i\n", this->vk.pModels[i].name, lengthOfName, decodedIndex);
     }
 
-    UMazeData mazeData = {0};
-    u_maze_gen_full_sq_grid(&mazeData, 4, 5);
-    UMazeGenResult mazeGenResult = {0};
-    u_maze_gen(&mazeGenResult, &mazeData, 555, 1);
-
-    size_t mazePieceAmounts[16] = { 0 };
-
-    for(size_t v = 0; v < mazeGenResult.vertexMazeData.vertexAmount; v++) {
-        UMazeVertex *pVertex = &mazeGenResult.vertexMazeData.pVertices[v];
-
-        unsigned bitfield = 0;
-
-        for(size_t c = 0; c < mazeGenResult.vertexMazeData.pVertices[v].linkAmount; c++) {
-            if(pVertex->metadata.position.x < mazeGenResult.vertexMazeData.pVertices[pVertex->pVertexLinkIndexes[c]].metadata.position.x)
-                bitfield |= 0b1000;
-            else
-            if(pVertex->metadata.position.x > mazeGenResult.vertexMazeData.pVertices[pVertex->pVertexLinkIndexes[c]].metadata.position.x)
-                bitfield |= 0b0100;
-
-            if(pVertex->metadata.position.y < mazeGenResult.vertexMazeData.pVertices[pVertex->pVertexLinkIndexes[c]].metadata.position.y)
-                bitfield |= 0b0010;
-            else
-            if(pVertex->metadata.position.y > mazeGenResult.vertexMazeData.pVertices[pVertex->pVertexLinkIndexes[c]].metadata.position.y)
-                bitfield |= 0b0001;
-        }
-
-        bitfield = bitfield ^ 0b1111;
-
-        mazePieceAmounts[bitfield]++;
-
-        printf("V: %zu B: 0x%x\n", v, bitfield);
-    }
-
-    this->vk.modelArrayAmount = (sizeof(mazePieceAmounts) / sizeof(mazePieceAmounts[0]));
+    this->vk.modelArrayAmount = V_MAZE_PIECE_AMOUNT;
+    this->vk.pVModelArray = malloc(sizeof(VModelArray) * V_MAZE_PIECE_AMOUNT);
 
-    this->vk.pVModelArray = malloc( sizeof(VModelArray) * (sizeof(mazePieceAmounts) / sizeof(mazePieceAmounts[0])) );
-
-    for(unsigned i = 0; i < sizeof(mazePieceAmounts) / sizeof(mazePieceAmounts[0]); i++) {
+    for(unsigned i = 0; i < V_MAZE_PIECE_AMOUNT; i++) {
         this->vk.pVModelArray[i].pModelData = pMazeIndexes[i];
-        this->vk.pVModelArray[i].instanceVector = u_vector_alloc(sizeof(VBufferPushConstantObject), mazePieceAmounts[i]);
-
-        mazePieceAmounts[i] = 0;
+        this->vk.pVModelArray[i].instanceVector = u_vector_alloc(sizeof(VBufferPushConstantObject), 0);
     }
 
-    for(size_t v = 0; v < mazeGenResult.vertexMazeData.vertexAmount; v++) {
-        UMazeVertex *pVertex = &mazeGenResult.vertexMazeData.pVertices[v];
+    if(this->config.current.worldMode) {
+        // The world streams its chunks into the model arrays from v_world_update().
+        v_world_init(this, 555);
 
-        unsigned bitfield = 0;
-
-        for(size_t c = 0; c < mazeGenResult.vertexMazeData.pVertices[v].linkAmount; c++) {
-            if(pVertex->metadata.position.x < mazeGenResult.vertexMazeData.pVertices[pVertex->pVertexLinkIndexes[c]].metadata.position.x)
-                bitfield |= 0b1000;
-            else
-            if(pVertex->metadata.position.x > mazeGenResult.vertexMazeData.pVertices[pVertex->pVertexLinkIndexes[c]].metadata.position.x)
-                bitfield |= 0b0100;
-
-            if(pVertex->metadata.position.y < mazeGenResult.vertexMazeData.pVertices[pVertex->pVertexLinkIndexes[c]].metadata.position.y)
-                bitfield |= 0b0010;
-            else
-            if(pVertex->metadata.position.y > mazeGenResult.vertexMazeData.pVertices[pVertex->pVertexLinkIndexes[c]].metadata.position.y)
-                bitfield |= 0b0001;
-        }
-        bitfield = bitfield ^ 0b1111;
-
-        VBufferPushConstantObject *pPushConst = this->vk.pVModelArray[bitfield].instanceVector.pBuffer;
-        pPushConst[mazePieceAmounts[bitfield]].matrix = MatrixTranslate(2 * pVertex->metadata.position.x, 2 * pVertex->metadata.position.y, -3);
-
-        mazePieceAmounts[bitfield]++;
+        RETURN_RESULT_CODE(VE_SUCCESS, 0)
     }
 
-    u_maze_delete_result(&mazeGenResult);
-    u_maze_delete_data(&mazeData);
+    if(this->config.current.gpuMazeSize != 0) {
+        // The whole maze is generated and instanced on the GPU now. v_render draws it with indirect draws.
+        returnCode = v_maze_gpu_alloc(this, this->config.current.gpuMazeSize, this->config.current.gpuMazeSize, 555);
 
-    returnCode = v_buffer_alloc_builtin_uniform(this);
-    if( returnCode.type < 0 )
-        return returnCode;
+        if(returnCode.type == VE_SUCCESS)
+            RETURN_RESULT_CODE(VE_SUCCESS, 0)
 
-    returnCode = allocateDescriptorPool(this);
-    if( returnCode.type < 0 )
-        return returnCode;
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "v_init_alloc: The GPU maze failed at point %u. The maze is streamed from the CPU instead", returnCode.point);
+    }
 
-    returnCode = allocateDescriptorSets(this);
-    if( returnCode.type < 0 )
-        return returnCode;
+    // The maze grows a few rows every frame from v_maze_stream_update().
+    v_maze_stream_init(this, 4, 5, 555);
 
     RETURN_RESULT_CODE(VE_SUCCESS, 0)
 }
@@ -257,6 +231,7 @@ void v_init_dealloc(Context *this) {
     vkFreeMemory(this->vk.device, this->vk.texture.imageMemory, NULL);
     vkDestroyDescriptorPool(this->vk.device, this->vk.descriptorPool, NULL);
     vkDestroyDescriptorSetLayout(this->vk.device, this->vk.descriptorSetLayout, NULL);
+    vkDestroyDescriptorSetLayout(this->vk.device, this->vk.instanceDescriptorSetLayout, NULL);
 
     if(this->vk.pQueueFamilyProperties != NULL)
         free(this->vk.pQueueFamilyProperties);
@@ -276,6 +251,13 @@ void v_init_dealloc(Context *this) {
         }
         free(this->vk.pModels);
     }
+    if(this->config.current.worldMode)
+        v_world_free(this);
+    else {
+        v_maze_gpu_free(this);
+        v_maze_stream_free(this);
+    }
+
     if(this->vk.pVModelArray != NULL) {
         for(unsigned i = 0; i < this->vk.modelArrayAmount; i++) {
             u_vector_free(&this->vk.pVModelArray[i].instanceVector);
@@ -283,8 +265,7 @@ void v_init_dealloc(Context *this) {
         free(this->vk.pVModelArray);
     }
     vkDestroyCommandPool(this->vk.device, this->vk.commandPool, NULL);
-    vkDestroyPipeline(this->vk.device, this->vk.graphicsPipeline, NULL);
-    vkDestroyPipelineLayout(this->vk.device, this->vk.pipelineLayout, NULL);
+    v_pipeline_free(this);
     vkDestroyRenderPass(this->vk.device, this->vk.renderPass, NULL);
     vkDestroyDevice(this->vk.device, NULL);
     vkDestroySurfaceKHR(this->vk.instance, this->vk.surface, NULL);
@@ -467,6 +448,15 @@ static VEngineResult initInstance(Context *this) {
     applicationInfo.engineVersion = 0;
     applicationInfo.apiVersion = VK_API_VERSION_1_0;
 
+    // Vulkan 1.1 is needed to query descriptor indexing support, but a 1.0 loader would reject it.
+    PFN_vkEnumerateInstanceVersion enumerateInstanceVersion = (PFN_vkEnumerateInstanceVersion)vkGetInstanceProcAddr(NULL, "vkEnumerateInstanceVersion");
+    uint32_t instanceVersion = VK_API_VERSION_1_0;
+
+    if(enumerateInstanceVersion != NULL && enumerateInstanceVersion(&instanceVersion) == VK_SUCCESS && instanceVersion >= VK_API_VERSION_1_1)
+        applicationInfo.apiVersion = VK_API_VERSION_1_1;
+
+    this->vk.apiVersion = applicationInfo.apiVersion;
+
     unsigned int extensionCount = 0;
     const char **ppExtensionNames = NULL;
     if(!SDL_Vulkan_GetInstanceExtensions(this->pWindow, &extensionCount, ppExtensionNames)) {
@@ -644,6 +634,60 @@ static VEngineResult findPhysicalDevice(Context *this, const char * const* ppReq
     RETURN_RESULT_CODE(VE_SUCCESS, 0)
 }
 
+static uint32_t findBindlessLimit(Context *this, const VkPhysicalDeviceFeatures *pSupportedFeatures) {
+    const char *const descriptorIndexingExtension[] = {VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME};
+
+    VkPhysicalDeviceProperties physicalDeviceProperties;
+    vkGetPhysicalDeviceProperties(this->vk.physicalDevice, &physicalDeviceProperties);
+
+    if(this->vk.apiVersion < VK_API_VERSION_1_1 || physicalDeviceProperties.apiVersion < VK_API_VERSION_1_1)
+        return 0;
+
+    if(pSupportedFeatures->shaderSampledImageArrayDynamicIndexing != VK_TRUE || !hasRequiredExtensions(this->vk.physicalDevice, descriptorIndexingExtension, 1))
+        return 0;
+
+    VkPhysicalDeviceDescriptorIndexingFeaturesEXT descriptorIndexingFeatures = {0};
+    descriptorIndexingFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES_EXT;
+
+    VkPhysicalDeviceFeatures2 physicalDeviceFeatures2 = {0};
+    physicalDeviceFeatures2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+    physicalDeviceFeatures2.pNext = &descriptorIndexingFeatures;
+
+    vkGetPhysicalDeviceFeatures2(this->vk.physicalDevice, &physicalDeviceFeatures2);
+
+    if(descriptorIndexingFeatures.runtimeDescriptorArray != VK_TRUE ||
+       descriptorIndexingFeatures.descriptorBindingPartiallyBound != VK_TRUE ||
+       descriptorIndexingFeatures.descriptorBindingSampledImageUpdateAfterBind != VK_TRUE ||
+       descriptorIndexingFeatures.descriptorBindingUpdateUnusedWhilePending != VK_TRUE)
+        return 0;
+
+    VkPhysicalDeviceDescriptorIndexingPropertiesEXT descriptorIndexingProperties = {0};
+    descriptorIndexingProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_PROPERTIES_EXT;
+
+    VkPhysicalDeviceProperties2 physicalDeviceProperties2 = {0};
+    physicalDeviceProperties2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+    physicalDeviceProperties2.pNext = &descriptorIndexingProperties;
+
+    vkGetPhysicalDeviceProperties2(this->vk.physicalDevice, &physicalDeviceProperties2);
+
+    // A combined image sampler counts against both the sampler and the sampled image limits.
+    const uint32_t limits[] = {
+        descriptorIndexingProperties.maxPerStageDescriptorUpdateAfterBindSamplers,
+        descriptorIndexingProperties.maxPerStageDescriptorUpdateAfterBindSampledImages,
+        descriptorIndexingProperties.maxDescriptorSetUpdateAfterBindSamplers,
+        descriptorIndexingProperties.maxDescriptorSetUpdateAfterBindSampledImages,
+        descriptorIndexingProperties.maxUpdateAfterBindDescriptorsInAllPools / MAX_FRAMES_IN_FLIGHT - 1}; // One uniform buffer per set is also allocated.
+
+    uint32_t limit = MAX_BINDLESS_TEXTURES;
+
+    for(unsigned i = 0; i < sizeof(limits) / sizeof(limits[0]); i++) {
+        if(limits[i] < limit)
+            limit = limits[i];
+    }
+
+    return limit;
+}
+
 static VEngineResult allocateLogicalDevice(Context *this, const char * const* ppRequiredExtensions, uint32_t requiredExtensionsAmount) {
     this->vk.device = NULL;
 
@@ -681,11 +725,62 @@ static VEngineResult allocateLogicalDevice(Context *this, const char * const* pp
     SDL_Log( "Queue Family index %i selected for GRAPHICS_FAMILY_INDEX", deviceQueueCreateInfos[GRAPHICS_FAMILY_INDEX].queueFamilyIndex);
     SDL_Log( "Queue Family index %i selected for PRESENT_FAMILY_INDEX",  deviceQueueCreateInfos[ PRESENT_FAMILY_INDEX].queueFamilyIndex);
 
+    VkPhysicalDeviceFeatures supportedFeatures;
+    vkGetPhysicalDeviceFeatures(this->vk.physicalDevice, &supportedFeatures);
+
+    // Block compressed formats can only be used when their feature is enabled.
     VkPhysicalDeviceFeatures physicalDeviceFeatures = {0};
+    physicalDeviceFeatures.textureCompressionBC       = supportedFeatures.textureCompressionBC;
+    physicalDeviceFeatures.textureCompressionETC2     = supportedFeatures.textureCompressionETC2;
+    physicalDeviceFeatures.textureCompressionASTC_LDR = supportedFeatures.textureCompressionASTC_LDR;
+
+    // The indirect draws of the GPU maze start at the instances of their piece.
+    physicalDeviceFeatures.drawIndirectFirstInstance = supportedFeatures.drawIndirectFirstInstance;
+
+    const char **ppExtensions = malloc(sizeof(char*) * (requiredExtensionsAmount + 1));
+    uint32_t extensionsAmount = requiredExtensionsAmount;
+
+    if(ppExtensions == NULL) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "ppExtensions failed to allocate %i names!", requiredExtensionsAmount + 1);
+        RETURN_RESULT_CODE(VE_ALLOC_LOGICAL_DEVICE_FAILURE, 1)
+    }
+
+    for(uint32_t i = 0; i < requiredExtensionsAmount; i++)
+        ppExtensions[i] = ppRequiredExtensions[i];
+
+    // Bindless textures need a partially bound array of samplers that can be written while it is bound.
+    VkPhysicalDeviceDescriptorIndexingFeaturesEXT descriptorIndexingFeatures = {0};
+    descriptorIndexingFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES_EXT;
+
+    this->vk.bindless.enabled = VK_FALSE;
+    this->vk.bindless.limit   = findBindlessLimit(this, &supportedFeatures);
+    this->vk.bindless.amount  = 0;
+
+    if(this->vk.bindless.limit > 1) {
+        this->vk.bindless.enabled = VK_TRUE;
+
+        physicalDeviceFeatures.shaderSampledImageArrayDynamicIndexing = VK_TRUE;
+
+        descriptorIndexingFeatures.runtimeDescriptorArray                       = VK_TRUE;
+        descriptorIndexingFeatures.descriptorBindingPartiallyBound              = VK_TRUE;
+        descriptorIndexingFeatures.descriptorBindingSampledImageUpdateAfterBind = VK_TRUE;
+        descriptorIndexingFeatures.descriptorBindingUpdateUnusedWhilePending    = VK_TRUE;
+
+        ppExtensions[extensionsAmount] = VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME;
+        extensionsAmount++;
+    }
+    else
+        this->vk.bindless.limit = 1;
+
+    SDL_Log( "Bindless textures %s with %i slots", this->vk.bindless.enabled ? "enabled" : "disabled", this->vk.bindless.limit);
 
     VkDeviceCreateInfo deviceCreateInfo = {0};
     deviceCreateInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
-    deviceCreateInfo.pNext = NULL;
+
+    if(this->vk.bindless.enabled)
+        deviceCreateInfo.pNext = &descriptorIndexingFeatures;
+    else
+        deviceCreateInfo.pNext = NULL;
 
     deviceCreateInfo.pQueueCreateInfos    = deviceQueueCreateInfos;
 
@@ -696,17 +791,22 @@ static VEngineResult allocateLogicalDevice(Context *this, const char * const* pp
 
     deviceCreateInfo.pEnabledFeatures = &physicalDeviceFeatures;
 
-    deviceCreateInfo.ppEnabledExtensionNames = ppRequiredExtensions;
-    deviceCreateInfo.enabledExtensionCount = requiredExtensionsAmount;
+    deviceCreateInfo.ppEnabledExtensionNames = ppExtensions;
+    deviceCreateInfo.enabledExtensionCount = extensionsAmount;
 
     deviceCreateInfo.enabledLayerCount = 0;
 
     result = vkCreateDevice(this->vk.physicalDevice, &deviceCreateInfo, NULL, &this->vk.device);
+
+    free(ppExtensions);
+
     if(result != VK_SUCCESS) {
         SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Failed to create rendering device returned %i", result);
         RETURN_RESULT_CODE(VE_ALLOC_LOGICAL_DEVICE_FAILURE, 0)
     }
 
+    this->vk.enabledFeatures = physicalDeviceFeatures;
+
     vkGetDeviceQueue(this->vk.device, deviceQueueCreateInfos[GRAPHICS_FAMILY_INDEX].queueFamilyIndex, 0, &this->vk.graphicsQueue);
     vkGetDeviceQueue(this->vk.device, deviceQueueCreateInfos[ PRESENT_FAMILY_INDEX].queueFamilyIndex, 0, &this->vk.presentationQueue);
 
@@ -996,14 +1096,31 @@ static VEngineResult allocateDescriptorSetLayout(Context *this) {
 
     descriptorSetBindings[1].binding = 1;
     descriptorSetBindings[1].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-    descriptorSetBindings[1].descriptorCount = 1;
+    descriptorSetBindings[1].descriptorCount = this->vk.bindless.limit;
     descriptorSetBindings[1].stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
     descriptorSetBindings[1].pImmutableSamplers = NULL;
 
+    // Only the texture array can be updated after it is bound. Its unregistered slots are left empty.
+    VkDescriptorBindingFlagsEXT descriptorBindingFlags[2];
+    descriptorBindingFlags[0] = 0;
+    descriptorBindingFlags[1] = VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT_EXT | VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT_EXT | VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT_EXT;
+
+    VkDescriptorSetLayoutBindingFlagsCreateInfoEXT descriptorSetLayoutBindingFlagsCreateInfo = {0};
+    descriptorSetLayoutBindingFlagsCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO_EXT;
+    descriptorSetLayoutBindingFlagsCreateInfo.bindingCount = sizeof(descriptorBindingFlags) / sizeof(descriptorBindingFlags[0]);
+    descriptorSetLayoutBindingFlagsCreateInfo.pBindingFlags = descriptorBindingFlags;
+
     VkDescriptorSetLayoutCreateInfo descriptorSetLayoutCreateInfo;
     descriptorSetLayoutCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
-    descriptorSetLayoutCreateInfo.pNext = 0;
-    descriptorSetLayoutCreateInfo.flags = 0;
+
+    if(this->vk.bindless.enabled) {
+        descriptorSetLayoutCreateInfo.pNext = &descriptorSetLayoutBindingFlagsCreateInfo;
+        descriptorSetLayoutCreateInfo.flags = VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT_EXT;
+    }
+    else {
+        descriptorSetLayoutCreateInfo.pNext = 0;
+        descriptorSetLayoutCreateInfo.flags = 0;
+    }
     descriptorSetLayoutCreateInfo.bindingCount = sizeof(descriptorSetBindings) / sizeof(descriptorSetBindings[0]);
     descriptorSetLayoutCreateInfo.pBindings = descriptorSetBindings;
 
@@ -1014,242 +1131,30 @@ static VEngineResult allocateDescriptorSetLayout(Context *this) {
         RETURN_RESULT_CODE(VE_DESCRIPTOR_SET_LAYOUT_FAILURE, 0)
     }
 
-    RETURN_RESULT_CODE(VE_SUCCESS, 0)
-}
-
-static VkShaderModule allocateShaderModule(Context *this, uint8_t* data, size_t size) {
-    VkShaderModuleCreateInfo shaderModuleCreateInfo = {0};
-    VkShaderModule shaderModule = NULL;
-    VkResult result;
-
-    shaderModuleCreateInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
-    shaderModuleCreateInfo.codeSize = size;
-    shaderModuleCreateInfo.pCode = (const uint32_t*)(data);
-
-    result = vkCreateShaderModule(this->vk.device, &shaderModuleCreateInfo, NULL, &shaderModule);
-
-    if(result != VK_SUCCESS) {
-        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Shader Module Failed to allocate %i", result);
-
-        if(shaderModule != NULL)
-            vkDestroyShaderModule(this->vk.device, shaderModule, NULL);
-
-        shaderModule = NULL;
-    }
-
-    return shaderModule;
-}
-
-static VEngineResult allocateGraphicsPipeline(Context *this) {
-    int64_t vertexShaderCodeLength;
-    uint8_t* pVertexShaderCode = u_read_file("hello_world_vert.spv", &vertexShaderCodeLength);
-
-    if(pVertexShaderCode == NULL) {
-        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Failed to load vertex shader code");
-        RETURN_RESULT_CODE(VE_ALLOC_GRAPH_PIPELINE_FAILURE, 0)
-    }
-
-    int64_t fragmentShaderCodeLength;
-    uint8_t* pFragmentShaderCode = u_read_file("hello_world_frag.spv", &fragmentShaderCodeLength);
-
-    if(pFragmentShaderCode == NULL) {
-        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Failed to load fragment shader code");
-        free(pVertexShaderCode);
-        RETURN_RESULT_CODE(VE_ALLOC_GRAPH_PIPELINE_FAILURE, 1)
-    }
-
-    VkShaderModule   vertexShaderModule = allocateShaderModule(this, pVertexShaderCode,   vertexShaderCodeLength);
-    VkShaderModule fragmentShaderModule = allocateShaderModule(this, pFragmentShaderCode, fragmentShaderCodeLength);
-
-    free(pVertexShaderCode);
-    free(pFragmentShaderCode);
-
-    if(vertexShaderModule == NULL) {
-        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Vulkan failed to parse vertex shader code!");
-
-        vkDestroyShaderModule(this->vk.device, fragmentShaderModule, NULL);
-
-        RETURN_RESULT_CODE(VE_ALLOC_GRAPH_PIPELINE_FAILURE, 2)
-    }
-    else if(fragmentShaderModule == NULL) {
-        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Vulkan failed to parse fragment shader code!");
-
-        vkDestroyShaderModule(this->vk.device, vertexShaderModule, NULL);
-
-        RETURN_RESULT_CODE(VE_ALLOC_GRAPH_PIPELINE_FAILURE, 3)
-    }
-
-    VkPipelineShaderStageCreateInfo pipelineShaderStageCreateInfos[2] = { {0}, {0} };
-    const unsigned   VERTEX_INDEX = 0;
-    const unsigned FRAGMENT_INDEX = 1;
-
-    pipelineShaderStageCreateInfos[VERTEX_INDEX].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
-    pipelineShaderStageCreateInfos[VERTEX_INDEX].stage = VK_SHADER_STAGE_VERTEX_BIT;
-    pipelineShaderStageCreateInfos[VERTEX_INDEX].module = vertexShaderModule;
-    pipelineShaderStageCreateInfos[VERTEX_INDEX].pName = "main";
-    // pipelineShaderStageCreateInfos[VERTEX_INDEX].pSpecializationInfo = NULL; // This allows the specification of constraints
-
-    pipelineShaderStageCreateInfos[FRAGMENT_INDEX].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
-    pipelineShaderStageCreateInfos[FRAGMENT_INDEX].stage = VK_SHADER_STAGE_FRAGMENT_BIT;
-    pipelineShaderStageCreateInfos[FRAGMENT_INDEX].module = fragmentShaderModule;
-    pipelineShaderStageCreateInfos[FRAGMENT_INDEX].pName = "main";
-    // pipelineShaderStageCreateInfos[FRAGMENT_INDEX].pSpecializationInfo = NULL; // This allows the specification of constraints
-
-    VkPipelineVertexInputStateCreateInfo pipelineVertexInputStateCreateInfo = {0};
-    pipelineVertexInputStateCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
-    pipelineVertexInputStateCreateInfo.vertexBindingDescriptionCount = 1;
-    pipelineVertexInputStateCreateInfo.pVertexBindingDescriptions = &V_BUFFER_VertexBindingDescription;
-    pipelineVertexInputStateCreateInfo.vertexAttributeDescriptionCount = sizeof(V_BUFFER_VertexInputAttributeDescriptions) / sizeof(V_BUFFER_VertexInputAttributeDescriptions[0]);
-    pipelineVertexInputStateCreateInfo.pVertexAttributeDescriptions = V_BUFFER_VertexInputAttributeDescriptions;
-
-    VkPipelineInputAssemblyStateCreateInfo pipelineInputAssemblyStateCreateInfo = {0};
-    pipelineInputAssemblyStateCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
-    pipelineInputAssemblyStateCreateInfo.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
-    pipelineInputAssemblyStateCreateInfo.primitiveRestartEnable = VK_FALSE;
-
-    VkViewport viewport = {0};
-    viewport.x = 0.0f;
-    viewport.y = 0.0f;
-    viewport.width  = (float) this->vk.swapExtent.width;
-    viewport.height = (float) this->vk.swapExtent.height;
-    viewport.minDepth = 0.0f;
-    viewport.maxDepth = 1.0f;
-
-    VkRect2D scissor = {0};
-    scissor.offset.x = 0.0f;
-    scissor.offset.y = 0.0f;
-    scissor.extent = this->vk.swapExtent;
-
-    VkDynamicState dynamicStates[] = {VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR};
-
-    VkPipelineDynamicStateCreateInfo pipelineDynamicStateInfo = {0};
-    pipelineDynamicStateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
-    pipelineDynamicStateInfo.dynamicStateCount = sizeof(dynamicStates) / sizeof(dynamicStates[0]);
-    pipelineDynamicStateInfo.pDynamicStates = dynamicStates;
-
-    VkPipelineViewportStateCreateInfo pipelineViewportStateCreateInfo = {0};
-    pipelineViewportStateCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
-    pipelineViewportStateCreateInfo.viewportCount =  1;
-    pipelineViewportStateCreateInfo.pViewports    = &viewport;
-    pipelineViewportStateCreateInfo.scissorCount  =  1;
-    pipelineViewportStateCreateInfo.pScissors     = &scissor;
-
-    VkPipelineRasterizationStateCreateInfo pipelineRasterizationStateCreateInfo = {0};
-    pipelineRasterizationStateCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
-    pipelineRasterizationStateCreateInfo.depthClampEnable = VK_FALSE; // No shadows for this pipeline.
-    pipelineRasterizationStateCreateInfo.rasterizerDiscardEnable = VK_FALSE; // Please do not discard everything.
-    pipelineRasterizationStateCreateInfo.polygonMode = VK_POLYGON_MODE_FILL; // VK_POLYGON_MODE_LINE and VK_POLYGON_MODE_POINT.
-    pipelineRasterizationStateCreateInfo.lineWidth = 1.0f; // One pixel lines please.
-    pipelineRasterizationStateCreateInfo.cullMode = VK_CULL_MODE_BACK_BIT;//VK_CULL_MODE_BACK_BIT;
-    pipelineRasterizationStateCreateInfo.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
-    pipelineRasterizationStateCreateInfo.depthBiasEnable = VK_FALSE;
-    pipelineRasterizationStateCreateInfo.depthBiasConstantFactor = 0.0f; // OPTIONAL
-    pipelineRasterizationStateCreateInfo.depthBiasClamp = 0.0f; // OPTIONAL
-    pipelineRasterizationStateCreateInfo.depthBiasSlopeFactor = 0.0f; // OPTIONAL
-
-    VkPipelineMultisampleStateCreateInfo pipelineMultisampleStateCreateInfo = {0};
-    pipelineMultisampleStateCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
-    pipelineMultisampleStateCreateInfo.sampleShadingEnable = VK_FALSE;
-    pipelineMultisampleStateCreateInfo.rasterizationSamples = this->vk.mmaa.samples;
-    pipelineMultisampleStateCreateInfo.minSampleShading = 1.0f; // OPTIONAL
-    pipelineMultisampleStateCreateInfo.pSampleMask = NULL; // OPTIONAL
-    pipelineMultisampleStateCreateInfo.alphaToCoverageEnable = VK_FALSE; // OPTIONAL
-    pipelineMultisampleStateCreateInfo.alphaToOneEnable = VK_FALSE; // OPTIONAL
-
-    VkPipelineDepthStencilStateCreateInfo pipelineDepthStencilStateCreateInfo = {0};
-    pipelineDepthStencilStateCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
-    pipelineDepthStencilStateCreateInfo.depthTestEnable = VK_TRUE;
-    pipelineDepthStencilStateCreateInfo.depthWriteEnable = VK_TRUE;
-    pipelineDepthStencilStateCreateInfo.depthCompareOp = VK_COMPARE_OP_GREATER_OR_EQUAL;
-    pipelineDepthStencilStateCreateInfo.depthBoundsTestEnable = VK_FALSE;
-    pipelineDepthStencilStateCreateInfo.minDepthBounds = 0.0f;
-    pipelineDepthStencilStateCreateInfo.maxDepthBounds = 1.0f;
-    pipelineDepthStencilStateCreateInfo.stencilTestEnable = VK_FALSE;
-    // pipelineDepthStencilStateCreateInfo.front = {}; // Optional
-    // pipelineDepthStencilStateCreateInfo.back = {};  // Optional
-
-    VkPipelineColorBlendAttachmentState pipelineColorBlendAttachmentState = {0};
-    pipelineColorBlendAttachmentState.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
-    pipelineColorBlendAttachmentState.blendEnable = VK_FALSE;
-    pipelineColorBlendAttachmentState.srcColorBlendFactor = VK_BLEND_FACTOR_ONE;
-    pipelineColorBlendAttachmentState.dstColorBlendFactor = VK_BLEND_FACTOR_ZERO;
-    pipelineColorBlendAttachmentState.colorBlendOp = VK_BLEND_OP_ADD;
-    pipelineColorBlendAttachmentState.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
-    pipelineColorBlendAttachmentState.dstAlphaBlendFactor = VK_BLEND_FACTOR_ZERO;
-    pipelineColorBlendAttachmentState.alphaBlendOp = VK_BLEND_OP_ADD;
-
-    VkPipelineColorBlendStateCreateInfo pipelineColorBlendStateCreateInfo = {0};
-    pipelineColorBlendStateCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
-    pipelineColorBlendStateCreateInfo.logicOpEnable = VK_FALSE;
-    pipelineColorBlendStateCreateInfo.logicOp = VK_LOGIC_OP_COPY; // OPTIONAL
-    pipelineColorBlendStateCreateInfo.attachmentCount = 1;
-    pipelineColorBlendStateCreateInfo.pAttachments = &pipelineColorBlendAttachmentState;
-    pipelineColorBlendStateCreateInfo.blendConstants[0] = 0.0f; // OPTIONAL
-    pipelineColorBlendStateCreateInfo.blendConstants[1] = 0.0f; // OPTIONAL
-    pipelineColorBlendStateCreateInfo.blendConstants[2] = 0.0f; // OPTIONAL
-    pipelineColorBlendStateCreateInfo.blendConstants[3] = 0.0f; // OPTIONAL
-
-    // Here is where uniforms should go.
-    VkPipelineLayoutCreateInfo pipelineLayoutInfo = {0};
-    pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
-    pipelineLayoutInfo.setLayoutCount = 1;
-    pipelineLayoutInfo.pSetLayouts = &this->vk.descriptorSetLayout;
-
-    VkPushConstantRange pushConstant = {0};
-    pushConstant.offset = 0;
-    pushConstant.size = sizeof(VBufferPushConstantObject);
-    pushConstant.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
-
-    pipelineLayoutInfo.pushConstantRangeCount = 1; // OPTIONAL
-    pipelineLayoutInfo.pPushConstantRanges = &pushConstant; // OPTIONAL
-
-    VkResult result = vkCreatePipelineLayout(this->vk.device, &pipelineLayoutInfo, NULL, &this->vk.pipelineLayout);
-
-    if(result != VK_SUCCESS) {
-        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Pipeline Layout creation failed with result: %i", result);
-
-        vkDestroyShaderModule(this->vk.device,   vertexShaderModule, NULL);
-        vkDestroyShaderModule(this->vk.device, fragmentShaderModule, NULL);
-
-        RETURN_RESULT_CODE(VE_ALLOC_GRAPH_PIPELINE_FAILURE, 4)
-    }
-
-    VkGraphicsPipelineCreateInfo graphicsPipelineCreateInfo = {0};
-
-    graphicsPipelineCreateInfo.sType      = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
-    graphicsPipelineCreateInfo.stageCount = sizeof(pipelineShaderStageCreateInfos) / sizeof(pipelineShaderStageCreateInfos[0]);
-    graphicsPipelineCreateInfo.pStages    = pipelineShaderStageCreateInfos;
+    // The instance buffer that maze_gen.comp writes. It is part of the pipeline layout even when no GPU maze is made.
+    VkDescriptorSetLayoutBinding instanceSetBinding = {0};
+    instanceSetBinding.binding = 0;
+    instanceSetBinding.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    instanceSetBinding.descriptorCount = 1;
+    instanceSetBinding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+    instanceSetBinding.pImmutableSamplers = NULL;
 
-    graphicsPipelineCreateInfo.pVertexInputState   = &pipelineVertexInputStateCreateInfo;
-    graphicsPipelineCreateInfo.pInputAssemblyState = &pipelineInputAssemblyStateCreateInfo;
-    graphicsPipelineCreateInfo.pViewportState      = &pipelineViewportStateCreateInfo;
-    graphicsPipelineCreateInfo.pRasterizationState = &pipelineRasterizationStateCreateInfo;
-    graphicsPipelineCreateInfo.pMultisampleState   = &pipelineMultisampleStateCreateInfo;
-    graphicsPipelineCreateInfo.pDepthStencilState  = &pipelineDepthStencilStateCreateInfo; // OPTIONAL
-    graphicsPipelineCreateInfo.pColorBlendState    = &pipelineColorBlendStateCreateInfo;
-    graphicsPipelineCreateInfo.pDynamicState       = &pipelineDynamicStateInfo;
+    VkDescriptorSetLayoutCreateInfo instanceSetLayoutCreateInfo = {0};
+    instanceSetLayoutCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    instanceSetLayoutCreateInfo.bindingCount = 1;
+    instanceSetLayoutCreateInfo.pBindings = &instanceSetBinding;
 
-    graphicsPipelineCreateInfo.layout = this->vk.pipelineLayout;
-
-    graphicsPipelineCreateInfo.renderPass = this->vk.renderPass;
-    graphicsPipelineCreateInfo.subpass    = 0;
-
-    graphicsPipelineCreateInfo.basePipelineHandle = VK_NULL_HANDLE; // OPTIONAL
-    graphicsPipelineCreateInfo.basePipelineIndex  = -1; // OPTIONAL
-
-    result = vkCreateGraphicsPipelines(this->vk.device, VK_NULL_HANDLE, 1, &graphicsPipelineCreateInfo, NULL, &this->vk.graphicsPipeline);
-
-    vkDestroyShaderModule(this->vk.device,   vertexShaderModule, NULL);
-    vkDestroyShaderModule(this->vk.device, fragmentShaderModule, NULL);
+    result = vkCreateDescriptorSetLayout(this->vk.device, &instanceSetLayoutCreateInfo, NULL, &this->vk.instanceDescriptorSetLayout);
 
     if(result != VK_SUCCESS) {
-        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "vkCreateGraphicsPipelines creation failed with result: %i", result);
-        RETURN_RESULT_CODE(VE_ALLOC_GRAPH_PIPELINE_FAILURE, 5)
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "allocateDescriptorSetLayout() Failed to allocate the instance set layout %i", result);
+        RETURN_RESULT_CODE(VE_DESCRIPTOR_SET_LAYOUT_FAILURE, 1)
     }
 
     RETURN_RESULT_CODE(VE_SUCCESS, 0)
 }
 
+
 static VEngineResult allocateFrameBuffers(Context *this) {
     VkResult result;
 
@@ -1379,99 +1284,415 @@ static uint32_t getMipLevel(uint32_t width, uint32_t height) {
     if(width > height)
         dimension =  width;
 
-    for(unsigned i = 0; i < 32; i++) {
-        if(dimension <= (1 << i))
-            return i + 1;
+    // floor(log2(dimension)) + 1, so the smallest level is 1 pixel wide.
+    uint32_t levels = 1;
+    while(dimension > 1) {
+        dimension >>= 1;
+        levels++;
     }
-    return 1;
+    return levels;
 }
 
-static VEngineResult allocateTextureImage(Context *this) {
-    qoi_desc QOIdescription;
-    qoi_desc mipQOIdescription;
-    const char FILENAME[] = "test_texture_%i.qoi";
-    char filename[64];
+static VEngineResult uploadTextureImage(Context *this, VkBuffer stagingBuffer, uint32_t width, uint32_t height, VkDeviceSize primeImageSize, const VkDeviceSize *pMipOffsets, VkBool32 generateMipmaps) {
+    VkImageUsageFlags usage = VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
 
-    snprintf(filename, sizeof(filename) / sizeof(filename[0]), FILENAME, 0);
+    // Each level is blitted from the one before it.
+    if(generateMipmaps)
+        usage |= VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
 
-    void *pPixels = u_read_qoi(filename, &QOIdescription, 4);
+    VEngineResult engineResult = v_buffer_alloc_image(this, width, height, this->vk.texture.mipLevels, VK_SAMPLE_COUNT_1_BIT, this->vk.texture.format, VK_IMAGE_TILING_OPTIMAL, usage, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, &this->vk.texture.image, &this->vk.texture.imageMemory);
 
-    VkDeviceSize firstImageSizeSq = 4 * QOIdescription.width * QOIdescription.height;
-    VkDeviceSize mipmapSizeSq = firstImageSizeSq + firstImageSizeSq / 3;
+    if(engineResult.type != VE_SUCCESS) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "v_buffer_alloc_image had failed with %i", engineResult.point);
+        RETURN_RESULT_CODE(VE_ALLOC_TEXTURE_IMAGE_FAILURE, 2)
+    }
 
-    if(pPixels == NULL) {
-        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Could not read file with name \"%s\"", FILENAME);
-        RETURN_RESULT_CODE(VE_ALLOC_TEXTURE_IMAGE_FAILURE, 0)
+    engineResult = v_buffer_transition_image_layout(this, this->vk.texture.image, this->vk.texture.format, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, this->vk.texture.mipLevels);
+    if(engineResult.type != VE_SUCCESS) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "v_buffer_transition_image_layout had failed with %i", engineResult.point);
+        RETURN_RESULT_CODE(VE_ALLOC_TEXTURE_IMAGE_FAILURE, 3)
+    }
+
+    engineResult = v_buffer_copy_to_image(this, stagingBuffer, this->vk.texture.image, width, height, primeImageSize, generateMipmaps ? 1 : this->vk.texture.mipLevels, pMipOffsets);
+    if(engineResult.type != VE_SUCCESS) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "v_buffer_copy_to_image had failed with %i", engineResult.point);
+        RETURN_RESULT_CODE(VE_ALLOC_TEXTURE_IMAGE_FAILURE, 4)
+    }
+
+    if(generateMipmaps) {
+        engineResult = v_buffer_generate_mipmaps(this, this->vk.texture.image, this->vk.texture.format, width, height, this->vk.texture.mipLevels);
+        if(engineResult.type != VE_SUCCESS) {
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "v_buffer_generate_mipmaps had failed with %i", engineResult.point);
+            RETURN_RESULT_CODE(VE_ALLOC_TEXTURE_IMAGE_FAILURE, 10)
+        }
+        RETURN_RESULT_CODE(VE_SUCCESS, 0)
+    }
+
+    engineResult = v_buffer_transition_image_layout(this, this->vk.texture.image, this->vk.texture.format, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, this->vk.texture.mipLevels);
+    if(engineResult.type != VE_SUCCESS) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "v_buffer_transition_image_layout had failed with %i", engineResult.point);
+        RETURN_RESULT_CODE(VE_ALLOC_TEXTURE_IMAGE_FAILURE, 5)
+    }
+
+    RETURN_RESULT_CODE(VE_SUCCESS, 0)
+}
+
+static VkBool32 isTextureFormatUsable(Context *this, VkFormat format) {
+    if(format >= VK_FORMAT_BC1_RGB_UNORM_BLOCK && format <= VK_FORMAT_BC7_SRGB_BLOCK && this->vk.enabledFeatures.textureCompressionBC != VK_TRUE)
+        return VK_FALSE;
+    if(format >= VK_FORMAT_ETC2_R8G8B8_UNORM_BLOCK && format <= VK_FORMAT_ETC2_R8G8B8A8_SRGB_BLOCK && this->vk.enabledFeatures.textureCompressionETC2 != VK_TRUE)
+        return VK_FALSE;
+    if(format >= VK_FORMAT_ASTC_4x4_UNORM_BLOCK && format <= VK_FORMAT_ASTC_4x4_SRGB_BLOCK && this->vk.enabledFeatures.textureCompressionASTC_LDR != VK_TRUE)
+        return VK_FALSE;
+
+    if(v_buffer_find_supported_format(this, &format, 1, VK_IMAGE_TILING_OPTIMAL, VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT | VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT) == VK_FORMAT_UNDEFINED)
+        return VK_FALSE;
+
+    return VK_TRUE;
+}
+
+static VEngineResult allocateKTX2TextureImage(Context *this, const char *const pPath) {
+    UKTX2Data ktx2;
+
+    if(!u_ktx2_read(&ktx2, pPath)) {
+        RETURN_RESULT_CODE(VE_ALLOC_TEXTURE_IMAGE_FAILURE, 6)
+    }
+
+    VkFormat format = ktx2.vkFormat;
+    int transcode = 0;
+
+    if(isTextureFormatUsable(this, format) != VK_TRUE) {
+        format = u_ktx2_transcode_format(ktx2.vkFormat);
+
+        if(format == VK_FORMAT_UNDEFINED) {
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "\"%s\" uses VkFormat %i which the device cannot sample and which has no CPU decoder", pPath, ktx2.vkFormat);
+            u_ktx2_free(&ktx2);
+            RETURN_RESULT_CODE(VE_ALLOC_TEXTURE_IMAGE_FAILURE, 7)
+        }
+
+        SDL_Log("VkFormat %i is not supported by the device. \"%s\" will be decoded to VkFormat %i", ktx2.vkFormat, pPath, format);
+        transcode = 1;
+    }
+
+    VkDeviceSize mipOffsets[U_KTX2_MAX_LEVELS];
+    VkDeviceSize stagingSize = 0;
+    uint32_t width, height;
+    size_t byteLength;
+
+    for(uint32_t l = 0; l < ktx2.levelCount; l++) {
+        u_ktx2_get_level(&ktx2, l, &width, &height, &byteLength);
+
+        mipOffsets[l] = stagingSize;
+
+        if(transcode)
+            stagingSize += 4 * width * height;
+        else
+            stagingSize += byteLength;
+
+        // Buffer offsets must be a multiple of the texel block size, which is at most 16 bytes.
+        stagingSize = (stagingSize + 15) & ~((VkDeviceSize)15);
     }
 
     VkBuffer stagingBuffer;
     VkDeviceMemory stagingBufferMemory;
 
-    VEngineResult engineResult = v_buffer_alloc(this, mipmapSizeSq, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, &stagingBuffer, &stagingBufferMemory);
+    VEngineResult engineResult = v_buffer_alloc(this, stagingSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, &stagingBuffer, &stagingBufferMemory);
 
     if(engineResult.type != VE_SUCCESS) {
-        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Failed to make staging buffer for allocateTextureImage");
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Failed to make staging buffer for allocateKTX2TextureImage");
+        u_ktx2_free(&ktx2);
+        RETURN_RESULT_CODE(VE_ALLOC_TEXTURE_IMAGE_FAILURE, 8)
+    }
+
+    uint8_t *pData;
+    vkMapMemory(this->vk.device, stagingBufferMemory, 0, stagingSize, 0, (void**)&pData);
+    if(transcode) {
+        const uint32_t cacheOptions[] = {format, ktx2.levelCount};
+        uint64_t cacheKey = u_cache_key(ktx2.pFileData, ktx2.fileSize, cacheOptions, sizeof(cacheOptions));
+
+        if(!u_cache_read(&this->cache, cacheKey, pData, stagingSize)) {
+            // Transcode into host memory, because staging memory can be very slow to read back for the cache.
+            uint8_t *pTranscoded = calloc(1, stagingSize);
+            uint8_t *pTarget = pTranscoded != NULL ? pTranscoded : pData;
+
+            for(uint32_t l = 0; l < ktx2.levelCount; l++)
+                u_ktx2_transcode_rgba8(&ktx2, l, pTarget + mipOffsets[l]);
+
+            if(pTranscoded != NULL) {
+                memcpy(pData, pTranscoded, stagingSize);
+                u_cache_store(&this->cache, cacheKey, pTranscoded, stagingSize);
+                free(pTranscoded);
+            }
+        }
+    }
+    else {
+        for(uint32_t l = 0; l < ktx2.levelCount; l++) {
+            const uint8_t *pLevel = u_ktx2_get_level(&ktx2, l, NULL, NULL, &byteLength);
+
+            memcpy(pData + mipOffsets[l], pLevel, byteLength);
+        }
+    }
+    vkUnmapMemory(this->vk.device, stagingBufferMemory);
+
+    this->vk.texture.format = format;
+    this->vk.texture.mipLevels = ktx2.levelCount;
+
+    VkBool32 generateMipmaps = VK_FALSE;
+
+    if(ktx2.levelCount == 1 && this->config.current.generateMipmaps != 0 && v_buffer_can_generate_mipmaps(this, format) == VK_TRUE) {
+        this->vk.texture.mipLevels = getMipLevel(ktx2.pixelWidth, ktx2.pixelHeight);
+        generateMipmaps = VK_TRUE;
+    }
+
+    engineResult = uploadTextureImage(this, stagingBuffer, ktx2.pixelWidth, ktx2.pixelHeight, 0, mipOffsets, generateMipmaps);
+
+    u_ktx2_free(&ktx2);
+    vkDestroyBuffer(this->vk.device, stagingBuffer, NULL);
+    vkFreeMemory(this->vk.device, stagingBufferMemory, NULL);
+
+    return engineResult;
+}
+
+static void downsampleRGBA8(const uint8_t *pSource, uint32_t sourceWidth, uint32_t sourceHeight, uint8_t *pDestination) {
+    uint32_t width  = sourceWidth  > 1 ? sourceWidth  / 2 : 1;
+    uint32_t height = sourceHeight > 1 ? sourceHeight / 2 : 1;
+
+    for(uint32_t y = 0; y < height; y++) {
+        // Clamp the second row and column so that odd and one pixel sizes do not read past the source.
+        const uint8_t *pRow0 = pSource + 4 * sourceWidth * (2 * y);
+        const uint8_t *pRow1 = pSource + 4 * sourceWidth * (2 * y + 1 < sourceHeight ? 2 * y + 1 : 2 * y);
+
+        for(uint32_t x = 0; x < width; x++) {
+            uint32_t x0 = 4 * (2 * x);
+            uint32_t x1 = 4 * (2 * x + 1 < sourceWidth ? 2 * x + 1 : 2 * x);
+
+            for(uint32_t c = 0; c < 4; c++)
+                pDestination[4 * (y * width + x) + c] = (pRow0[x0 + c] + pRow0[x1 + c] + pRow1[x0 + c] + pRow1[x1 + c] + 2) / 4;
+        }
+    }
+}
+
+static VEngineResult allocateGeneratedTextureImage(Context *this, const uint8_t *pBasePixels, uint32_t width, uint32_t height) {
+    this->vk.texture.mipLevels = getMipLevel(width, height);
+
+    // Only the base level is uploaded when the GPU can blit the rest. Otherwise the chain is made on the CPU.
+    VkBool32 blitMipmaps = v_buffer_can_generate_mipmaps(this, this->vk.texture.format);
+    uint32_t stagedLevels = blitMipmaps ? 1 : this->vk.texture.mipLevels;
+
+    VkDeviceSize mipOffsets[32];
+    VkDeviceSize stagingSize = 0;
+
+    for(uint32_t m = 0; m < stagedLevels; m++) {
+        uint32_t mipWidth  = width  >> m;
+        uint32_t mipHeight = height >> m;
+
+        mipOffsets[m] = stagingSize;
+        stagingSize += 4 * (VkDeviceSize)(mipWidth == 0 ? 1 : mipWidth) * (mipHeight == 0 ? 1 : mipHeight);
+    }
+
+    uint8_t *pChain = malloc(stagingSize);
+
+    if(pChain == NULL) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Failed to allocate %li bytes for the mip chain", (long)stagingSize);
+        RETURN_RESULT_CODE(VE_ALLOC_TEXTURE_IMAGE_FAILURE, 9)
+    }
+
+    memcpy(pChain, pBasePixels, 4 * (size_t)width * height);
+
+    for(uint32_t m = 1; m < stagedLevels; m++) {
+        uint32_t mipWidth  = width  >> (m - 1);
+        uint32_t mipHeight = height >> (m - 1);
+
+        downsampleRGBA8(pChain + mipOffsets[m - 1], mipWidth == 0 ? 1 : mipWidth, mipHeight == 0 ? 1 : mipHeight, pChain + mipOffsets[m]);
+    }
+
+    VkBuffer stagingBuffer;
+    VkDeviceMemory stagingBufferMemory;
+
+    VEngineResult engineResult = v_buffer_alloc(this, stagingSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, &stagingBuffer, &stagingBufferMemory);
+
+    if(engineResult.type != VE_SUCCESS) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Failed to make staging buffer for allocateGeneratedTextureImage");
+        free(pChain);
         RETURN_RESULT_CODE(VE_ALLOC_TEXTURE_IMAGE_FAILURE, 1)
     }
 
+    void* data;
+    vkMapMemory(this->vk.device, stagingBufferMemory, 0, stagingSize, 0, &data);
+    memcpy(data, pChain, stagingSize);
+    vkUnmapMemory(this->vk.device, stagingBufferMemory);
+
+    free(pChain);
+
+    engineResult = uploadTextureImage(this, stagingBuffer, width, height, 0, mipOffsets, blitMipmaps);
+
+    vkDestroyBuffer(this->vk.device, stagingBuffer, NULL);
+    vkFreeMemory(this->vk.device, stagingBufferMemory, NULL);
+
+    return engineResult;
+}
+
+static VEngineResult allocateQOITextureImage(Context *this) {
+    qoi_desc QOIdescription;
+    const char FILENAME[] = "test_texture_%i.qoi";
+    char filenames[32][64];
+
+    snprintf(filenames[0], sizeof(filenames[0]) / sizeof(filenames[0][0]), FILENAME, 0);
+
+    this->vk.texture.format = VK_FORMAT_R8G8B8A8_SRGB;
+
+    if(this->config.current.generateMipmaps != 0) {
+        void *pPixels = u_read_qoi(filenames[0], &QOIdescription, 4);
+
+        if(pPixels == NULL) {
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Could not read file with name \"%s\"", filenames[0]);
+            RETURN_RESULT_CODE(VE_ALLOC_TEXTURE_IMAGE_FAILURE, 0)
+        }
+
+        VEngineResult engineResult = allocateGeneratedTextureImage(this, pPixels, QOIdescription.width, QOIdescription.height);
+
+        free(pPixels);
+
+        return engineResult;
+    }
+
+    if(!u_read_qoi_info(filenames[0], &QOIdescription)) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Could not read file with name \"%s\"", filenames[0]);
+        RETURN_RESULT_CODE(VE_ALLOC_TEXTURE_IMAGE_FAILURE, 0)
+    }
+
     uint32_t mipLevel = getMipLevel(QOIdescription.width, QOIdescription.height);
     this->vk.texture.mipLevels = mipLevel;
 
-    mipQOIdescription = QOIdescription;
+    const char *ppPaths[32];
+    void *ppDestinations[32];
+    size_t destinationSizes[32];
+    qoi_desc mipQOIdescriptions[32];
+    VkDeviceSize mipOffsets[32];
+    VkDeviceSize stagingSize = 0;
 
-    void* data;
-    vkMapMemory(this->vk.device, stagingBufferMemory, 0, mipmapSizeSq, 0, &data);
     for(uint32_t m = 0; m < mipLevel; m++) {
-        VkDeviceSize imageSizeSq = 4 * mipQOIdescription.width * mipQOIdescription.height;
+        uint32_t mipWidth  = QOIdescription.width  >> m;
+        uint32_t mipHeight = QOIdescription.height >> m;
 
-        memcpy(data, pPixels, (size_t)imageSizeSq);
+        snprintf(filenames[m], sizeof(filenames[m]) / sizeof(filenames[m][0]), FILENAME, m);
+        ppPaths[m] = filenames[m];
 
-        data += imageSizeSq;
+        destinationSizes[m] = 4 * (size_t)(mipWidth == 0 ? 1 : mipWidth) * (mipHeight == 0 ? 1 : mipHeight);
+        mipOffsets[m] = stagingSize;
+        stagingSize += destinationSizes[m];
+    }
 
-        free(pPixels);
+    // Every level file is read once. It is hashed, so that an edit to any of them gives a different key, and only decoded from memory on a miss.
+    uint8_t *ppFiles[32];
+    int64_t fileSizes[32];
+    uint64_t cacheKey = 0;
+    uint32_t fileAmount;
 
-        if(m + 1 == mipLevel)
-            break;
+    for(fileAmount = 0; fileAmount < mipLevel; fileAmount++) {
+        ppFiles[fileAmount] = u_read_file(ppPaths[fileAmount], &fileSizes[fileAmount]);
 
-        snprintf(filename, sizeof(filename) / sizeof(filename[0]), FILENAME, m + 1);
+        if(ppFiles[fileAmount] == NULL)
+            break;
 
-        pPixels = u_read_qoi(filename, &mipQOIdescription, 4);
+        cacheKey = u_cache_hash(ppFiles[fileAmount], fileSizes[fileAmount], cacheKey);
     }
-    vkUnmapMemory(this->vk.device, stagingBufferMemory);
 
-    engineResult = v_buffer_alloc_image(this, QOIdescription.width, QOIdescription.height, this->vk.texture.mipLevels, VK_SAMPLE_COUNT_1_BIT, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, &this->vk.texture.image, &this->vk.texture.imageMemory);
+    if(fileAmount != mipLevel) {
+        for(uint32_t m = 0; m < fileAmount; m++)
+            free(ppFiles[m]);
 
-    if(engineResult.type != VE_SUCCESS) {
-        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "v_buffer_alloc_image had failed with %i", engineResult.point);
-        RETURN_RESULT_CODE(VE_ALLOC_TEXTURE_IMAGE_FAILURE, 2)
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Could not read file with name \"%s\"", filenames[fileAmount]);
+        RETURN_RESULT_CODE(VE_ALLOC_TEXTURE_IMAGE_FAILURE, 12)
     }
 
-    engineResult = v_buffer_transition_image_layout(this, this->vk.texture.image, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, this->vk.texture.mipLevels);
+    const uint32_t cacheOptions[] = {this->vk.texture.format, mipLevel, QOIdescription.width, QOIdescription.height};
+    cacheKey = u_cache_key(&cacheKey, sizeof(cacheKey), cacheOptions, sizeof(cacheOptions));
+
+    VkBuffer stagingBuffer;
+    VkDeviceMemory stagingBufferMemory;
+
+    VEngineResult engineResult = v_buffer_alloc(this, stagingSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, &stagingBuffer, &stagingBufferMemory);
+
     if(engineResult.type != VE_SUCCESS) {
-        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "v_buffer_transition_image_layout had failed with %i", engineResult.point);
-        RETURN_RESULT_CODE(VE_ALLOC_TEXTURE_IMAGE_FAILURE, 3)
+        for(uint32_t m = 0; m < mipLevel; m++)
+            free(ppFiles[m]);
+
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Failed to make staging buffer for allocateTextureImage");
+        RETURN_RESULT_CODE(VE_ALLOC_TEXTURE_IMAGE_FAILURE, 1)
     }
 
-    engineResult = v_buffer_copy_to_image(this, stagingBuffer, this->vk.texture.image, QOIdescription.width, QOIdescription.height, firstImageSizeSq, this->vk.texture.mipLevels);
-    if(engineResult.type != VE_SUCCESS) {
-        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "v_buffer_copy_to_image had failed with %i", engineResult.point);
-        RETURN_RESULT_CODE(VE_ALLOC_TEXTURE_IMAGE_FAILURE, 4)
+    uint8_t *pData;
+    vkMapMemory(this->vk.device, stagingBufferMemory, 0, stagingSize, 0, (void**)&pData);
+
+    int decoded = u_cache_read(&this->cache, cacheKey, pData, stagingSize);
+
+    if(!decoded) {
+        for(uint32_t m = 0; m < mipLevel; m++)
+            ppDestinations[m] = pData + mipOffsets[m];
+
+        // Every level is decoded on its own worker thread straight into the staging memory.
+        decoded = u_read_qoi_decode_batch((const uint8_t *const *)ppFiles, fileSizes, mipLevel, mipQOIdescriptions, ppDestinations, destinationSizes);
+
+        for(uint32_t m = 0; decoded && m < mipLevel; m++) {
+            if(4 * (size_t)mipQOIdescriptions[m].width * mipQOIdescriptions[m].height != destinationSizes[m]) {
+                SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "\"%s\" has the wrong size for mip level %i", filenames[m], m);
+                decoded = 0;
+            }
+        }
+
+        if(decoded)
+            u_cache_store(&this->cache, cacheKey, pData, stagingSize);
     }
 
-    engineResult = v_buffer_transition_image_layout(this, this->vk.texture.image, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, this->vk.texture.mipLevels);
-    if(engineResult.type != VE_SUCCESS) {
-        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "v_buffer_transition_image_layout had failed with %i", engineResult.point);
-        RETURN_RESULT_CODE(VE_ALLOC_TEXTURE_IMAGE_FAILURE, 5)
+    for(uint32_t m = 0; m < mipLevel; m++)
+        free(ppFiles[m]);
+
+    vkUnmapMemory(this->vk.device, stagingBufferMemory);
+
+    if(!decoded) {
+        vkDestroyBuffer(this->vk.device, stagingBuffer, NULL);
+        vkFreeMemory(this->vk.device, stagingBufferMemory, NULL);
+        RETURN_RESULT_CODE(VE_ALLOC_TEXTURE_IMAGE_FAILURE, 11)
     }
 
+    engineResult = uploadTextureImage(this, stagingBuffer, QOIdescription.width, QOIdescription.height, 0, mipOffsets, VK_FALSE);
+
     vkDestroyBuffer(this->vk.device, stagingBuffer, NULL);
     vkFreeMemory(this->vk.device, stagingBufferMemory, NULL);
 
-    RETURN_RESULT_CODE(VE_SUCCESS, 0)
+    return engineResult;
+}
+
+static VEngineResult allocateTextureImage(Context *this) {
+    const char *const pKTX2Path = "test_texture.ktx2";
+    VEngineResult engineResult;
+
+    // The KTX2 texture is optional, so only try it when the file exists.
+    SDL_RWops *pKTX2File = SDL_RWFromFile(pKTX2Path, "rb");
+
+    if(pKTX2File != NULL) {
+        SDL_RWclose(pKTX2File);
+
+        engineResult = allocateKTX2TextureImage(this, pKTX2Path);
+    }
+    else {
+        engineResult.type  = VE_ALLOC_TEXTURE_IMAGE_FAILURE;
+        engineResult.point = 6;
+    }
+
+    // Only fall back when no Vulkan objects were made for the KTX2 texture.
+    if(engineResult.type == VE_ALLOC_TEXTURE_IMAGE_FAILURE && (engineResult.point == 6 || engineResult.point == 7)) {
+        SDL_Log("Falling back to the QOI mip chain for the texture");
+
+        engineResult = allocateQOITextureImage(this);
+    }
+
+    return engineResult;
 }
 
 static VEngineResult allocateTextureImageView(Context *this) {
-    VEngineResult engineResult = v_buffer_alloc_image_view(this, this->vk.texture.image, VK_FORMAT_R8G8B8A8_SRGB, 0, VK_IMAGE_ASPECT_COLOR_BIT, &this->vk.texture.imageView, this->vk.texture.mipLevels);
+    VEngineResult engineResult = v_buffer_alloc_image_view(this, this->vk.texture.image, this->vk.texture.format, 0, VK_IMAGE_ASPECT_COLOR_BIT, &this->vk.texture.imageView, this->vk.texture.mipLevels);
 
     if(engineResult.type != VE_SUCCESS) {
         SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "v_buffer_alloc_image_view failed for allocate returned %i", engineResult.point);
@@ -1569,10 +1790,14 @@ static VEngineResult allocateDescriptorPool(Context *this) {
     descriptorPoolSizes[0].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
     descriptorPoolSizes[0].descriptorCount = MAX_FRAMES_IN_FLIGHT;
     descriptorPoolSizes[1].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-    descriptorPoolSizes[1].descriptorCount = MAX_FRAMES_IN_FLIGHT;
+    descriptorPoolSizes[1].descriptorCount = MAX_FRAMES_IN_FLIGHT * this->vk.bindless.limit;
 
     VkDescriptorPoolCreateInfo descriptorPoolCreateInfo = {0};
     descriptorPoolCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+
+    if(this->vk.bindless.enabled)
+        descriptorPoolCreateInfo.flags = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT_EXT;
+
     descriptorPoolCreateInfo.poolSizeCount = sizeof(descriptorPoolSizes) / sizeof(descriptorPoolSizes[0]);
     descriptorPoolCreateInfo.pPoolSizes = descriptorPoolSizes;
     descriptorPoolCreateInfo.maxSets = MAX_FRAMES_IN_FLIGHT;
@@ -1600,12 +1825,8 @@ static VEngineResult allocateDescriptorSets(Context *this) {
     descriptorBufferInfo.offset = 0;
     descriptorBufferInfo.range = sizeof(VBufferUniformBufferObject);
 
-    VkDescriptorImageInfo descriptorImageInfo;
-    descriptorImageInfo.sampler = this->vk.defaultTextureSampler;
-    descriptorImageInfo.imageView = this->vk.texture.imageView;
-    descriptorImageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-
-    VkWriteDescriptorSet writeDescriptorSets[2] = {{0}, {0}};
+    // The textures at binding 1 are written by v_texture_register().
+    VkWriteDescriptorSet writeDescriptorSets[1] = {{0}};
     writeDescriptorSets[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
     writeDescriptorSets[0].dstBinding = 0;
     writeDescriptorSets[0].dstArrayElement = 0;
@@ -1613,13 +1834,6 @@ static VEngineResult allocateDescriptorSets(Context *this) {
     writeDescriptorSets[0].descriptorCount = 1;
     writeDescriptorSets[0].pBufferInfo = &descriptorBufferInfo;
 
-    writeDescriptorSets[1].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-    writeDescriptorSets[1].dstBinding = 1;
-    writeDescriptorSets[1].dstArrayElement = 0;
-    writeDescriptorSets[1].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-    writeDescriptorSets[1].descriptorCount = 1;
-    writeDescriptorSets[1].pImageInfo = &descriptorImageInfo;
-
     for(uint32_t i = MAX_FRAMES_IN_FLIGHT; i != 0; i--) {
         result = vkAllocateDescriptorSets(this->vk.device, &descriptorSetAllocateInfo, &this->vk.frames[i - 1].descriptorSet);
 
@@ -1631,9 +1845,8 @@ static VEngineResult allocateDescriptorSets(Context *this) {
         descriptorBufferInfo.buffer = this->vk.frames[i - 1].uniformBuffer;
 
         writeDescriptorSets[0].dstSet = this->vk.frames[i - 1].descriptorSet;
-        writeDescriptorSets[1].dstSet = this->vk.frames[i - 1].descriptorSet;
 
-        vkUpdateDescriptorSets(this->vk.device, 2, writeDescriptorSets, 0, NULL);
+        vkUpdateDescriptorSets(this->vk.device, sizeof(writeDescriptorSets) / sizeof(writeDescriptorSets[0]), writeDescriptorSets, 0, NULL);
     }
     RETURN_RESULT_CODE(VE_SUCCESS, 0)
 }
@@ -0,0 +1,776 @@
+#include "v_maze.h"
+
+#include "u_maze.h"
+#include "u_pvs.h"
+#include "u_thread.h"
+#include "u_vector.h"
+#include "v_buffer.h"
+#include "v_pipeline_def.h"
+
+#include "SDL_timer.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Cell ranges per worker thread. More ranges than threads keep the threads busy when some ranges are slower.
+#define RANGES_PER_THREAD 4
+
+typedef struct {
+    VMazeMeshSet *pMeshSet;
+    const UMazeCompactData *pVertexMazeData;
+    uint32_t depth;
+} MeshBuild;
+
+// A cell is 3 blocks wide. These are the offsets of the edges of its blocks from the center of the cell.
+static const float BLOCK_EDGES[3] = {-V_MAZE_MESH_CELL_SIZE / 2, -V_MAZE_MESH_CORRIDOR_SIZE / 2, V_MAZE_MESH_CORRIDOR_SIZE / 2};
+
+static void buildCell(const VMazeInstanceBuild *pBuild, size_t index, uint32_t *pX, uint32_t *pY);
+static void buildRange(const VMazeInstanceBuild *pBuild, unsigned task, size_t *pFirst, size_t *pLast);
+static void classifyTask(void *pUserData, unsigned index);
+static void scatterTask(void *pUserData, unsigned index);
+static int writeModelArrays(VModelArray *pModelArrays, VMazeInstanceBuild *pBuild, int replace);
+static int appendRow(void *pUserData, uint32_t row, const uint8_t *pCells, uint32_t width);
+static void finishStream(Context *this);
+static int finishMain(void *pData);
+static void collectStream(Context *this);
+static void uploadRegions(Context *this);
+static int uploadRegion(Context *this, const VMazeMesh *pMesh, VModelData *pModel, uint32_t r);
+static void freeUploads(Context *this);
+static void cullCells(Context *this);
+static int fillInstances(Context *this, const uint32_t *pCells, uint32_t cellAmount);
+static void showRegions(VMazeStream *pStream, const uint32_t *pCells, uint32_t cellAmount);
+static void meshRegionTask(void *pUserData, unsigned index);
+static void emitQuad(VMazeMesh *pMesh, const Vector3 corners[4], const Vector2 texCoords[4]);
+
+unsigned v_maze_cell_piece(const uint8_t *pRow, const uint8_t *pAboveRow, uint32_t x) {
+    unsigned bitfield = 0;
+
+    if((pRow[x] & U_MAZE_CELL_EAST) != 0)
+        bitfield |= 0b1000;
+    if(x != 0 && (pRow[x - 1] & U_MAZE_CELL_EAST) != 0)
+        bitfield |= 0b0100;
+    if((pRow[x] & U_MAZE_CELL_SOUTH) != 0)
+        bitfield |= 0b0010;
+    if(pAboveRow != NULL && (pAboveRow[x] & U_MAZE_CELL_SOUTH) != 0)
+        bitfield |= 0b0001;
+
+    return bitfield ^ 0b1111;
+}
+
+int v_maze_instances_classify(VMazeInstanceBuild *this) {
+    memset(this->pieceAmounts, 0, sizeof(this->pieceAmounts));
+
+    this->cellAmount = this->pCellIndexes != NULL ? this->cellIndexAmount : (size_t)this->cellsWide * this->cellsDeep;
+    this->taskAmount = (this->cellAmount + V_MAZE_INSTANCE_TASK_CELLS - 1) / V_MAZE_INSTANCE_TASK_CELLS;
+
+    if(this->taskAmount > u_thread_count() * RANGES_PER_THREAD)
+        this->taskAmount = u_thread_count() * RANGES_PER_THREAD;
+    if(this->taskAmount == 0)
+        this->taskAmount = 1;
+
+    this->pPieces      = malloc(this->cellAmount + 1);
+    this->pTaskCursors = calloc(this->taskAmount, sizeof(this->pTaskCursors[0]));
+
+    if(this->pPieces == NULL || this->pTaskCursors == NULL) {
+        v_maze_instances_free(this);
+        return 0;
+    }
+
+    u_thread_parallel_for(this->taskAmount, classifyTask, this);
+
+    // Turn the counts into write positions. The ranges of a piece follow each other, so the instances stay in the order of the cells.
+    for(unsigned p = 0; p < V_MAZE_PIECE_AMOUNT; p++) {
+        for(unsigned t = 0; t < this->taskAmount; t++) {
+            const size_t amount = this->pTaskCursors[t][p];
+
+            this->pTaskCursors[t][p] = this->pieceAmounts[p];
+            this->pieceAmounts[p] += amount;
+        }
+    }
+
+    return 1;
+}
+
+void v_maze_instances_scatter(VMazeInstanceBuild *this, VBufferPushConstantObject *const ppDestinations[V_MAZE_PIECE_AMOUNT]) {
+    memcpy(this->ppDestinations, ppDestinations, sizeof(this->ppDestinations));
+
+    u_thread_parallel_for(this->taskAmount, scatterTask, this);
+
+    v_maze_instances_free(this);
+}
+
+void v_maze_instances_free(VMazeInstanceBuild *this) {
+    free(this->pPieces);
+    free(this->pTaskCursors);
+
+    this->pPieces = NULL;
+    this->pTaskCursors = NULL;
+}
+
+int v_maze_stream_init(Context *this, uint32_t width, uint32_t depth, uint32_t seed) {
+    VMazeStream *pStream = &this->mazeStream;
+
+    memset(pStream, 0, sizeof(*pStream));
+
+    if((uint64_t)width * depth >= UINT32_MAX)
+        return 0;
+
+    pStream->width = width;
+    pStream->depth = depth;
+    pStream->textureIndex = this->vk.texture.index;
+    pStream->cameraCell = UINT32_MAX;
+
+    // Every row is kept, so that the whole maze can be meshed once it is done. That is a byte per cell next to the instance of every cell.
+    pStream->pCells = malloc((size_t)width * depth);
+
+    if(pStream->pCells == NULL)
+        return 0;
+
+    if(!u_maze_eller_init(&pStream->ellerState, width, depth, seed)) {
+        v_maze_stream_free(this);
+        return 0;
+    }
+
+    return 1;
+}
+
+void v_maze_stream_update(Context *this) {
+    VMazeStream *pStream = &this->mazeStream;
+
+    if(pStream->ellerState.pCellSets == NULL) {
+        if(SDL_AtomicGet(&pStream->finishStatus) == V_MAZE_FINISH_DONE)
+            collectStream(this);
+
+        if(pStream->pUploadedModels != NULL)
+            uploadRegions(this);
+
+        if(pStream->pVisibleCells != NULL)
+            cullCells(this);
+        return;
+    }
+
+    if(!u_maze_eller_step_timed(&pStream->ellerState, V_MAZE_STREAM_MICROSECONDS, appendRow, this)) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "v_maze_stream_update: Out of memory at row %u of %u", pStream->ellerState.row, pStream->ellerState.depth);
+        v_maze_stream_free(this);
+        return;
+    }
+
+    if(pStream->ellerState.row == pStream->ellerState.depth) {
+        u_maze_eller_free(&pStream->ellerState);
+        finishStream(this);
+    }
+}
+
+void v_maze_stream_free(Context *this) {
+    VMazeStream *pStream = &this->mazeStream;
+
+    // The finish thread reads the cells.
+    if(pStream->pFinishThread != NULL) {
+        SDL_WaitThread(pStream->pFinishThread, NULL);
+        pStream->pFinishThread = NULL;
+    }
+    SDL_AtomicSet(&pStream->finishStatus, V_MAZE_FINISH_NONE);
+    freeUploads(this);
+
+    u_maze_eller_free(&pStream->ellerState);
+    free(pStream->pCells);
+
+    pStream->pCells = NULL;
+
+    u_pvs_free(&pStream->pvs);
+    free(pStream->pVisibleCells);
+    pStream->pVisibleCells = NULL;
+
+    for(uint32_t r = 0; r < pStream->regionModelAmount; r++) {
+        vkDestroyBuffer(this->vk.device, pStream->pRegionModels[r].buffer, NULL);
+        vkFreeMemory(this->vk.device, pStream->pRegionModels[r].bufferMemory, NULL);
+    }
+    free(pStream->pRegionModels);
+    free(pStream->pRegionsVisible);
+
+    pStream->regionModelAmount = 0;
+    pStream->pRegionModels = NULL;
+    pStream->pRegionsVisible = NULL;
+}
+
+int v_maze_mesh_build(VMazeMeshSet *this, const UMazeCompactData *const pVertexMazeData) {
+    MeshBuild build;
+
+    memset(this, 0, sizeof(*this));
+
+    if(pVertexMazeData->vertexAmount == 0 || pVertexMazeData->width == 0)
+        return 1;
+
+    build.pMeshSet = this;
+    build.pVertexMazeData = pVertexMazeData;
+    build.depth = pVertexMazeData->vertexAmount / pVertexMazeData->width;
+
+    this->regionsWide = (pVertexMazeData->width + V_MAZE_MESH_REGION_SIZE - 1) / V_MAZE_MESH_REGION_SIZE;
+    this->regionsDeep = (build.depth            + V_MAZE_MESH_REGION_SIZE - 1) / V_MAZE_MESH_REGION_SIZE;
+    this->pRegions = calloc((size_t)this->regionsWide * this->regionsDeep, sizeof(VMazeMesh));
+
+    if(this->pRegions == NULL) {
+        memset(this, 0, sizeof(*this));
+        return 0;
+    }
+
+    u_thread_parallel_for(this->regionsWide * this->regionsDeep, meshRegionTask, &build);
+
+    // Every region has at least the floor of its cells, so an empty region ran out of memory.
+    for(uint32_t r = 0; r < this->regionsWide * this->regionsDeep; r++) {
+        if(this->pRegions[r].pVertices == NULL) {
+            v_maze_mesh_free(this);
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+void v_maze_mesh_free(VMazeMeshSet *this) {
+    if(this->pRegions != NULL) {
+        for(uint32_t r = 0; r < this->regionsWide * this->regionsDeep; r++)
+            free(this->pRegions[r].pVertices);
+
+        free(this->pRegions);
+    }
+
+    memset(this, 0, sizeof(*this));
+}
+
+static void buildCell(const VMazeInstanceBuild *pBuild, size_t index, uint32_t *pX, uint32_t *pY) {
+    if(pBuild->pCellIndexes != NULL) {
+        *pX = pBuild->pCellIndexes[index] % pBuild->stride;
+        *pY = pBuild->pCellIndexes[index] / pBuild->stride;
+    }
+    else {
+        *pX = pBuild->firstX + index % pBuild->cellsWide;
+        *pY = pBuild->firstY + index / pBuild->cellsWide;
+    }
+}
+
+static void buildRange(const VMazeInstanceBuild *pBuild, unsigned task, size_t *pFirst, size_t *pLast) {
+    *pFirst = (uint64_t)pBuild->cellAmount *  task      / pBuild->taskAmount;
+    *pLast  = (uint64_t)pBuild->cellAmount * (task + 1) / pBuild->taskAmount;
+}
+
+static void classifyTask(void *pUserData, unsigned index) {
+    VMazeInstanceBuild *pBuild = pUserData;
+    size_t *pCounts = pBuild->pTaskCursors[index];
+
+    size_t first, last;
+    buildRange(pBuild, index, &first, &last);
+
+    for(size_t i = first; i < last; i++) {
+        uint32_t x, y;
+        buildCell(pBuild, i, &x, &y);
+
+        const uint8_t *pRow = &pBuild->pCells[(size_t)y * pBuild->stride];
+        const unsigned piece = v_maze_cell_piece(pRow, y != 0 ? pRow - pBuild->stride : NULL, x);
+
+        pBuild->pPieces[i] = piece;
+        pCounts[piece]++;
+    }
+}
+
+static void scatterTask(void *pUserData, unsigned index) {
+    VMazeInstanceBuild *pBuild = pUserData;
+    size_t *pCursors = pBuild->pTaskCursors[index];
+
+    size_t first, last;
+    buildRange(pBuild, index, &first, &last);
+
+    for(size_t i = first; i < last; i++) {
+        uint32_t x, y;
+        buildCell(pBuild, i, &x, &y);
+
+        const uint8_t piece = pBuild->pPieces[i];
+        VBufferPushConstantObject *pInstance = &pBuild->ppDestinations[piece][pCursors[piece]++];
+
+        pInstance->matrix = MatrixTranslate(2 * (pBuild->originX + x), 2 * (pBuild->originY + y), -3);
+        pInstance->textureIndex = pBuild->textureIndex;
+    }
+}
+
+static int writeModelArrays(VModelArray *pModelArrays, VMazeInstanceBuild *pBuild, int replace) {
+    if(!v_maze_instances_classify(pBuild))
+        return 0;
+
+    size_t oldSizes[V_MAZE_PIECE_AMOUNT];
+    size_t newSizes[V_MAZE_PIECE_AMOUNT];
+
+    // Only grow until every vector fits, so that a failure leaves every instance in place.
+    for(unsigned p = 0; p < V_MAZE_PIECE_AMOUNT; p++) {
+        oldSizes[p] = pModelArrays[p].instanceVector.size;
+        newSizes[p] = (replace ? 0 : oldSizes[p]) + pBuild->pieceAmounts[p];
+
+        if(newSizes[p] > oldSizes[p] && !u_vector_scale(&pModelArrays[p].instanceVector, newSizes[p])) {
+            for(unsigned i = 0; i < p; i++)
+                u_vector_scale(&pModelArrays[i].instanceVector, oldSizes[i]);
+
+            v_maze_instances_free(pBuild);
+            return 0;
+        }
+    }
+
+    VBufferPushConstantObject *ppDestinations[V_MAZE_PIECE_AMOUNT];
+
+    for(unsigned p = 0; p < V_MAZE_PIECE_AMOUNT; p++)
+        ppDestinations[p] = (VBufferPushConstantObject*)pModelArrays[p].instanceVector.pBuffer + newSizes[p] - pBuild->pieceAmounts[p];
+
+    v_maze_instances_scatter(pBuild, ppDestinations);
+
+    // Shrinking never fails.
+    for(unsigned p = 0; p < V_MAZE_PIECE_AMOUNT; p++) {
+        if(newSizes[p] < oldSizes[p])
+            u_vector_scale(&pModelArrays[p].instanceVector, newSizes[p]);
+    }
+
+    return 1;
+}
+
+static int appendRow(void *pUserData, uint32_t row, const uint8_t *pCells, uint32_t width) {
+    Context *this = pUserData;
+    VMazeStream *pStream = &this->mazeStream;
+
+    memcpy(&pStream->pCells[(size_t)row * width], pCells, width);
+
+    VMazeInstanceBuild build = {0};
+    build.pCells = pStream->pCells;
+    build.stride = width;
+    build.firstY = row;
+    build.cellsWide = width;
+    build.cellsDeep = 1;
+    build.textureIndex = pStream->textureIndex;
+
+    return writeModelArrays(this->vk.pVModelArray, &build, 0);
+}
+
+static void finishStream(Context *this) {
+    VMazeStream *pStream = &this->mazeStream;
+
+    pStream->buildMeshes = this->config.current.greedyMesh;
+
+    SDL_AtomicSet(&pStream->finishStatus, V_MAZE_FINISH_RUNNING);
+
+    pStream->pFinishThread = SDL_CreateThread(finishMain, "v_maze_finish", pStream);
+
+    if(pStream->pFinishThread == NULL) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "v_maze_stream_update: SDL_CreateThread failed due to %s. The maze is finished in this frame", SDL_GetError());
+        finishMain(pStream);
+    }
+}
+
+static int finishMain(void *pData) {
+    VMazeStream *pStream = pData;
+    UMazeCompactGenResult maze;
+
+    if(u_maze_cells_to_result(&maze, pStream->pCells, pStream->width, pStream->depth, 1)) {
+        u_pvs_build(&pStream->pvs, &maze.vertexMazeData);
+
+        if(pStream->buildMeshes)
+            v_maze_mesh_build(&pStream->meshSet, &maze.vertexMazeData);
+
+        u_maze_compact_delete_result(&maze);
+    }
+
+    SDL_AtomicSet(&pStream->finishStatus, V_MAZE_FINISH_DONE);
+    return 0;
+}
+
+static void collectStream(Context *this) {
+    VMazeStream *pStream = &this->mazeStream;
+
+    if(pStream->pFinishThread != NULL) {
+        SDL_WaitThread(pStream->pFinishThread, NULL);
+        pStream->pFinishThread = NULL;
+    }
+    SDL_AtomicSet(&pStream->finishStatus, V_MAZE_FINISH_NONE);
+
+    if(pStream->pvs.pOffsets != NULL) {
+        pStream->pVisibleCells = malloc(sizeof(uint32_t) * pStream->pvs.maxVisibleAmount);
+
+        if(pStream->pVisibleCells == NULL)
+            u_pvs_free(&pStream->pvs);
+    }
+
+    if(pStream->pVisibleCells == NULL)
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "v_maze_stream_update: Out of memory for the visible sets of the maze. Every cell stays drawn");
+
+    if(!pStream->buildMeshes)
+        return;
+
+    if(pStream->meshSet.pRegions != NULL)
+        pStream->pUploadedModels = calloc((size_t)pStream->meshSet.regionsWide * pStream->meshSet.regionsDeep, sizeof(VModelData));
+
+    if(pStream->pUploadedModels == NULL) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "v_maze_stream_update: Out of memory for the maze meshes. It stays instanced");
+        v_maze_mesh_free(&pStream->meshSet);
+    }
+}
+
+static void uploadRegions(Context *this) {
+    VMazeStream *pStream = &this->mazeStream;
+    const uint32_t regionAmount = pStream->meshSet.regionsWide * pStream->meshSet.regionsDeep;
+
+    const Uint64 startCounter = SDL_GetPerformanceCounter();
+    const Uint64 counterLimit = SDL_GetPerformanceFrequency() * V_MAZE_STREAM_MICROSECONDS / 1000000;
+
+    // At least one region is uploaded every frame.
+    do {
+        const uint32_t r = pStream->uploadedRegionAmount;
+
+        if(!uploadRegion(this, &pStream->meshSet.pRegions[r], &pStream->pUploadedModels[r], r)) {
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "v_maze_stream_update: The maze meshes could not be uploaded. It stays instanced");
+            freeUploads(this);
+            return;
+        }
+
+        pStream->uploadedRegionAmount++;
+    } while(pStream->uploadedRegionAmount != regionAmount && SDL_GetPerformanceCounter() - startCounter < counterLimit);
+
+    if(pStream->uploadedRegionAmount != regionAmount)
+        return;
+
+    // Every region is uploaded, so the meshes replace the instances in one frame.
+    pStream->regionModelAmount = regionAmount;
+    pStream->regionsWide = pStream->meshSet.regionsWide;
+    pStream->pRegionModels = pStream->pUploadedModels;
+
+    pStream->uploadedRegionAmount = 0;
+    pStream->pUploadedModels = NULL;
+    v_maze_mesh_free(&pStream->meshSet);
+
+    // Every region is drawn until the camera is looked up. Without this array every region is always drawn.
+    pStream->pRegionsVisible = malloc(regionAmount);
+
+    if(pStream->pRegionsVisible != NULL)
+        memset(pStream->pRegionsVisible, 1, regionAmount);
+
+    // The camera is looked up again, so that only the regions it can see are drawn.
+    pStream->cameraCell = UINT32_MAX;
+}
+
+static int uploadRegion(Context *this, const VMazeMesh *pMesh, VModelData *pModel, uint32_t r) {
+    // A model buffer holds the indexes first and the vertices after them.
+    const size_t indexSize  = sizeof(uint16_t) * pMesh->indexAmount;
+    const size_t vertexSize = sizeof(VBufferVertex) * pMesh->vertexAmount;
+    uint8_t *pData = malloc(indexSize + vertexSize);
+
+    if(pData == NULL)
+        return 0;
+
+    memcpy(pData, pMesh->pIndices, indexSize);
+    memcpy(pData + indexSize, pMesh->pVertices, vertexSize);
+
+    VEngineResult engineResult = v_buffer_alloc_static(this, pData, indexSize + vertexSize, &pModel->buffer, VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, &pModel->bufferMemory);
+
+    free(pData);
+
+    if(engineResult.type != VE_SUCCESS)
+        return 0;
+
+    snprintf(pModel->name, sizeof(pModel->name), "maze region %u", r);
+    pModel->vertexAmount = pMesh->indexAmount;
+    pModel->vertexOffset = indexSize;
+    pModel->indexType = VK_INDEX_TYPE_UINT16;
+    pModel->pipelineVariant = V_PIPELINE_TEXTURED | V_PIPELINE_VERTEX_COLOR;
+    pModel->positionScale = 1.0f;
+
+    return 1;
+}
+
+static void freeUploads(Context *this) {
+    VMazeStream *pStream = &this->mazeStream;
+
+    for(uint32_t r = 0; r < pStream->uploadedRegionAmount; r++) {
+        vkDestroyBuffer(this->vk.device, pStream->pUploadedModels[r].buffer, NULL);
+        vkFreeMemory(this->vk.device, pStream->pUploadedModels[r].bufferMemory, NULL);
+    }
+    free(pStream->pUploadedModels);
+
+    pStream->uploadedRegionAmount = 0;
+    pStream->pUploadedModels = NULL;
+    v_maze_mesh_free(&pStream->meshSet);
+}
+
+static void cullCells(Context *this) {
+    VMazeStream *pStream = &this->mazeStream;
+    const uint32_t cellAmount = pStream->width * pStream->depth;
+
+    // The model view translates by position, so the camera is at -position. Cells are two units apart.
+    const float x = floorf(-this->position.x / 2.0f + 0.5f);
+    const float y = floorf(-this->position.y / 2.0f + 0.5f);
+
+    uint32_t cell = cellAmount;
+
+    if(x >= 0.0f && y >= 0.0f && x < (float)pStream->width && y < (float)pStream->depth)
+        cell = (uint32_t)y * pStream->width + (uint32_t)x;
+
+    if(cell == pStream->cameraCell)
+        return;
+
+    // Outside of the maze nothing limits what can be seen, so every cell is drawn.
+    const uint32_t *pCells = NULL;
+    uint32_t visibleAmount = cellAmount;
+
+    if(cell != cellAmount) {
+        visibleAmount = u_pvs_visible(&pStream->pvs, cell, pStream->pVisibleCells);
+        pCells = pStream->pVisibleCells;
+    }
+
+    if(pStream->pRegionsVisible != NULL)
+        showRegions(pStream, pCells, visibleAmount);
+    else if(!fillInstances(this, pCells, visibleAmount)) {
+        // The instances of the last cell stay, and the cell is looked up again next frame.
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "v_maze_stream_update: Out of memory for the instances of %u cells", visibleAmount);
+        return;
+    }
+
+    pStream->cameraCell = cell;
+}
+
+static int fillInstances(Context *this, const uint32_t *pCells, uint32_t cellAmount) {
+    VMazeStream *pStream = &this->mazeStream;
+
+    VMazeInstanceBuild build = {0};
+    build.pCells = pStream->pCells;
+    build.stride = pStream->width;
+    build.cellsWide = pStream->width;
+    build.cellsDeep = pStream->depth;
+    build.pCellIndexes = pCells;
+    build.cellIndexAmount = cellAmount;
+    build.textureIndex = pStream->textureIndex;
+
+    return writeModelArrays(this->vk.pVModelArray, &build, 1);
+}
+
+static void showRegions(VMazeStream *pStream, const uint32_t *pCells, uint32_t cellAmount) {
+    if(pCells == NULL) {
+        memset(pStream->pRegionsVisible, 1, pStream->regionModelAmount);
+        return;
+    }
+
+    memset(pStream->pRegionsVisible, 0, pStream->regionModelAmount);
+
+    for(uint32_t i = 0; i < cellAmount; i++) {
+        const uint32_t x = pCells[i] % pStream->width / V_MAZE_MESH_REGION_SIZE;
+        const uint32_t y = pCells[i] / pStream->width / V_MAZE_MESH_REGION_SIZE;
+
+        pStream->pRegionsVisible[y * pStream->regionsWide + x] = 1;
+    }
+}
+
+static void meshRegionTask(void *pUserData, unsigned index) {
+    MeshBuild *pBuild = pUserData;
+    const UMazeCompactData *pVertexMazeData = pBuild->pVertexMazeData;
+    const uint32_t width = pVertexMazeData->width;
+
+    const uint32_t firstX = (index % pBuild->pMeshSet->regionsWide) * V_MAZE_MESH_REGION_SIZE;
+    const uint32_t firstY = (index / pBuild->pMeshSet->regionsWide) * V_MAZE_MESH_REGION_SIZE;
+    const uint32_t cellsWide = width        - firstX < V_MAZE_MESH_REGION_SIZE ? width        - firstX : V_MAZE_MESH_REGION_SIZE;
+    const uint32_t cellsDeep = pBuild->depth - firstY < V_MAZE_MESH_REGION_SIZE ? pBuild->depth - firstY : V_MAZE_MESH_REGION_SIZE;
+    const uint32_t blocksWide = 3 * cellsWide;
+    const uint32_t blocksDeep = 3 * cellsDeep;
+
+    // Open blocks are the centers plus one side block per link end, so the floor has at most 3 * cells + perimeter rectangles and the walls 6 * cells + perimeter quads.
+    const uint32_t cellAmount = cellsWide * cellsDeep;
+    const uint32_t maxQuads = 12 * cellAmount + 6 * (cellsWide + cellsDeep);
+
+    VMazeMesh mesh = {0};
+    uint8_t *pOpen = malloc(2 * (size_t)blocksWide * blocksDeep + ((size_t)blocksWide + blocksDeep + 2) * sizeof(float));
+
+    mesh.pVertices = malloc((size_t)4 * maxQuads * sizeof(VBufferVertex));
+    mesh.pIndices  = malloc((size_t)6 * maxQuads * sizeof(uint16_t));
+
+    if(pOpen == NULL || mesh.pVertices == NULL || mesh.pIndices == NULL) {
+        free(pOpen);
+        free(mesh.pVertices);
+        free(mesh.pIndices);
+        return;
+    }
+
+    uint8_t *pUsed = pOpen + (size_t)blocksWide * blocksDeep;
+    float *pLinesX = (float*)(pUsed + (size_t)blocksWide * blocksDeep);
+    float *pLinesY = pLinesX + blocksWide + 1;
+
+    for(uint32_t k = 0; k <= blocksWide; k++)
+        pLinesX[k] = (firstX + k / 3) * V_MAZE_MESH_CELL_SIZE + BLOCK_EDGES[k % 3];
+    for(uint32_t k = 0; k <= blocksDeep; k++)
+        pLinesY[k] = (firstY + k / 3) * V_MAZE_MESH_CELL_SIZE + BLOCK_EDGES[k % 3];
+
+    memset(pOpen, 0, 2 * (size_t)blocksWide * blocksDeep);
+
+    for(uint32_t cy = 0; cy < cellsDeep; cy++) {
+        for(uint32_t cx = 0; cx < cellsWide; cx++) {
+            const uint32_t x = firstX + cx;
+            const uint32_t v = (firstY + cy) * width + x;
+            uint8_t *pCenter = &pOpen[(3 * cy + 1) * blocksWide + 3 * cx + 1];
+
+            pCenter[0] = 1;
+
+            for(uint32_t c = pVertexMazeData->pLinkOffsets[v]; c < pVertexMazeData->pLinkOffsets[v + 1]; c++) {
+                const uint32_t link = pVertexMazeData->pVertexLinkArray[c];
+
+                if(x + 1 < width && link == v + 1)
+                    pCenter[1] = 1;
+                else if(x != 0 && link + 1 == v)
+                    pCenter[-1] = 1;
+                else if(link == v + width)
+                    pCenter[blocksWide] = 1;
+                else
+                    pCenter[-(int32_t)blocksWide] = 1;
+            }
+        }
+    }
+
+    const float floorZ = V_MAZE_MESH_FLOOR_Z;
+    const float ceilingZ = V_MAZE_MESH_FLOOR_Z + V_MAZE_MESH_WALL_HEIGHT;
+
+    // Grow every unused open block into the widest run, then into as many rows as the whole run fits. The ceiling is the same rectangles facing down.
+    for(uint32_t by = 0; by < blocksDeep; by++) {
+        for(uint32_t bx = 0; bx < blocksWide; bx++) {
+            const size_t start = (size_t)by * blocksWide;
+
+            if(pOpen[start + bx] == 0 || pUsed[start + bx] != 0)
+                continue;
+
+            uint32_t endX = bx + 1;
+            while(endX < blocksWide && pOpen[start + endX] != 0 && pUsed[start + endX] == 0)
+                endX++;
+
+            uint32_t endY = by + 1;
+            for(; endY < blocksDeep; endY++) {
+                const size_t row = (size_t)endY * blocksWide;
+                uint32_t i = bx;
+
+                while(i < endX && pOpen[row + i] != 0 && pUsed[row + i] == 0)
+                    i++;
+
+                if(i != endX)
+                    break;
+            }
+
+            for(uint32_t y = by; y < endY; y++)
+                memset(&pUsed[(size_t)y * blocksWide + bx], 1, endX - bx);
+
+            const float x0 = pLinesX[bx], x1 = pLinesX[endX];
+            const float y0 = pLinesY[by], y1 = pLinesY[endY];
+            const Vector2 texCoords[4] = {
+                {x0 / V_MAZE_MESH_CELL_SIZE, y0 / V_MAZE_MESH_CELL_SIZE}, {x1 / V_MAZE_MESH_CELL_SIZE, y0 / V_MAZE_MESH_CELL_SIZE},
+                {x1 / V_MAZE_MESH_CELL_SIZE, y1 / V_MAZE_MESH_CELL_SIZE}, {x0 / V_MAZE_MESH_CELL_SIZE, y1 / V_MAZE_MESH_CELL_SIZE}};
+            const Vector3 floorCorners[4]   = {{x0, y0, floorZ},   {x1, y0, floorZ},   {x1, y1, floorZ},   {x0, y1, floorZ}};
+            const Vector3 ceilingCorners[4] = {{x0, y0, ceilingZ}, {x0, y1, ceilingZ}, {x1, y1, ceilingZ}, {x1, y0, ceilingZ}};
+            const Vector2 ceilingTexCoords[4] = {texCoords[0], texCoords[3], texCoords[2], texCoords[1]};
+
+            emitQuad(&mesh, floorCorners, texCoords);
+            emitQuad(&mesh, ceilingCorners, ceilingTexCoords);
+        }
+    }
+
+    // A wall is wherever an open block meets a solid one. It faces the open block. Runs of blocks along the same line facing the same way are one quad.
+    // The edges of the region never have walls, because the blocks on both sides of a cell border are either both open or both solid.
+    for(uint32_t k = 1; k < blocksWide; k++) {
+        uint32_t by = 0;
+
+        while(by < blocksDeep) {
+            const int side = pOpen[(size_t)by * blocksWide + k - 1] - pOpen[(size_t)by * blocksWide + k];
+            uint32_t endY = by + 1;
+
+            while(endY < blocksDeep && pOpen[(size_t)endY * blocksWide + k - 1] - pOpen[(size_t)endY * blocksWide + k] == side)
+                endY++;
+
+            if(side != 0) {
+                const float x = pLinesX[k], y0 = pLinesY[by], y1 = pLinesY[endY];
+                const float u0 = y0 / V_MAZE_MESH_CELL_SIZE, u1 = y1 / V_MAZE_MESH_CELL_SIZE;
+
+                if(side < 0) {
+                    const Vector3 corners[4]   = {{x, y0, floorZ}, {x, y1, floorZ}, {x, y1, ceilingZ}, {x, y0, ceilingZ}};
+                    const Vector2 texCoords[4] = {{u0, 1}, {u1, 1}, {u1, 0}, {u0, 0}};
+
+                    emitQuad(&mesh, corners, texCoords);
+                }
+                else {
+                    const Vector3 corners[4]   = {{x, y1, floorZ}, {x, y0, floorZ}, {x, y0, ceilingZ}, {x, y1, ceilingZ}};
+                    const Vector2 texCoords[4] = {{u1, 1}, {u0, 1}, {u0, 0}, {u1, 0}};
+
+                    emitQuad(&mesh, corners, texCoords);
+                }
+            }
+
+            by = endY;
+        }
+    }
+
+    for(uint32_t k = 1; k < blocksDeep; k++) {
+        const uint8_t *pBelow = &pOpen[(size_t)(k - 1) * blocksWide];
+        const uint8_t *pAbove = &pOpen[(size_t)k * blocksWide];
+        uint32_t bx = 0;
+
+        while(bx < blocksWide) {
+            const int side = pBelow[bx] - pAbove[bx];
+            uint32_t endX = bx + 1;
+
+            while(endX < blocksWide && pBelow[endX] - pAbove[endX] == side)
+                endX++;
+
+            if(side != 0) {
+                const float y = pLinesY[k], x0 = pLinesX[bx], x1 = pLinesX[endX];
+                const float u0 = x0 / V_MAZE_MESH_CELL_SIZE, u1 = x1 / V_MAZE_MESH_CELL_SIZE;
+
+                if(side > 0) {
+                    const Vector3 corners[4]   = {{x0, y, floorZ}, {x1, y, floorZ}, {x1, y, ceilingZ}, {x0, y, ceilingZ}};
+                    const Vector2 texCoords[4] = {{u0, 1}, {u1, 1}, {u1, 0}, {u0, 0}};
+
+                    emitQuad(&mesh, corners, texCoords);
+                }
+                else {
+                    const Vector3 corners[4]   = {{x1, y, floorZ}, {x0, y, floorZ}, {x0, y, ceilingZ}, {x1, y, ceilingZ}};
+                    const Vector2 texCoords[4] = {{u1, 1}, {u0, 1}, {u0, 0}, {u1, 0}};
+
+                    emitQuad(&mesh, corners, texCoords);
+                }
+            }
+
+            bx = endX;
+        }
+    }
+
+    free(pOpen);
+
+    // Move the mesh into one buffer of the exact size.
+    VMazeMesh *pRegion = &pBuild->pMeshSet->pRegions[index];
+    const size_t vertexSize = (size_t)mesh.vertexAmount * sizeof(VBufferVertex);
+
+    pRegion->pVertices = malloc(vertexSize + (size_t)mesh.indexAmount * sizeof(uint16_t));
+
+    if(pRegion->pVertices != NULL) {
+        pRegion->pIndices = (uint16_t*)((uint8_t*)pRegion->pVertices + vertexSize);
+        pRegion->vertexAmount = mesh.vertexAmount;
+        pRegion->indexAmount = mesh.indexAmount;
+
+        memcpy(pRegion->pVertices, mesh.pVertices, vertexSize);
+        memcpy(pRegion->pIndices, mesh.pIndices, (size_t)mesh.indexAmount * sizeof(uint16_t));
+    }
+
+    free(mesh.pVertices);
+    free(mesh.pIndices);
+}
+
+static void emitQuad(VMazeMesh *pMesh, const Vector3 corners[4], const Vector2 texCoords[4]) {
+    const uint16_t first = pMesh->vertexAmount;
+    const uint16_t quadIndexes[6] = {0, 1, 2, 0, 2, 3};
+
+    for(unsigned i = 0; i < 4; i++) {
+        VBufferVertex *pVertex = &pMesh->pVertices[pMesh->vertexAmount++];
+
+        pVertex->pos = corners[i];
+        pVertex->color = (Vector3){1.0f, 1.0f, 1.0f};
+        pVertex->texCoord = texCoords[i];
+    }
+
+    for(unsigned i = 0; i < 6; i++)
+        pMesh->pIndices[pMesh->indexAmount++] = first + quadIndexes[i];
+}
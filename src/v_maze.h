@@ -0,0 +1,89 @@
+#ifndef V_MAZE_29
+#define V_MAZE_29
+
+#include "context.h"
+#include "u_maze_def.h"
+#include "v_maze_def.h"
+#include "v_model_def.h"
+
+/**
+ * Find the piece of a cell from the openings of its row and of the row above it.
+ * @note The west and north openings of a cell are the east opening of its west neighbor and the south opening of the cell above it.
+ * @param pRow The U_MAZE_CELL_EAST and U_MAZE_CELL_SOUTH openings of the row of the cell.
+ * @param pAboveRow The openings of the row above. NULL if the cell is in the first row.
+ * @param x The column of the cell. The first column has no west opening.
+ * @return The piece of the cell, from 0 to V_MAZE_PIECE_AMOUNT - 1.
+ */
+unsigned v_maze_cell_piece(const uint8_t *pRow, const uint8_t *pAboveRow, uint32_t x);
+
+/**
+ * Classify the cells of a build into their pieces in one parallel pass. Every task counts its own pieces.
+ * @warning If this function succeeds you are responsiable for calling v_maze_instances_scatter() or v_maze_instances_free().
+ * @param this The build with its input fields set. pieceAmounts is filled.
+ * @return 1 for success or 0 if memory ran out.
+ */
+int v_maze_instances_classify(VMazeInstanceBuild *this);
+
+/**
+ * Write the instance of every classified cell in parallel and free the build. The instances of a piece are in the order of the cells.
+ * @param this The build that was classified by v_maze_instances_classify().
+ * @param ppDestinations Where the instances of each piece are written. Destination p must have room for this->pieceAmounts[p] instances.
+ */
+void v_maze_instances_scatter(VMazeInstanceBuild *this, VBufferPushConstantObject *const ppDestinations[V_MAZE_PIECE_AMOUNT]);
+
+/**
+ * Free a classified build without writing its instances.
+ * @param this The build that was classified by v_maze_instances_classify().
+ */
+void v_maze_instances_free(VMazeInstanceBuild *this);
+
+/**
+ * Start streaming a maze into the instance vectors. Nothing is appended until v_maze_stream_update() is called.
+ * @warning this->vk.pVModelArray must already hold V_MAZE_PIECE_AMOUNT model arrays in piece order.
+ * @param this The primary Context of the program.
+ * @param width The amount of cells in a row.
+ * @param depth The amount of rows.
+ * @param seed The seed of the maze.
+ * @return 1 for success or 0 if the state could not be allocated.
+ */
+int v_maze_stream_init(Context *this, uint32_t width, uint32_t depth, uint32_t seed);
+
+/**
+ * Generate the next rows of the streamed maze for V_MAZE_STREAM_MICROSECONDS and append their instances. Rows are final once they are appended, so the maze grows without any instance being moved.
+ * @note Call this once a frame before the command buffer is recorded. The generator is freed when the maze is done.
+ * If maze:greedy_mesh is set the whole maze is then greedy meshed on a worker thread, and its regions are uploaded for V_MAZE_STREAM_MICROSECONDS every frame.
+ * Once every region is uploaded they become this->mazeStream.pRegionModels, which v_render draws instead of the instances.
+ * @note Once the maze is done its visible sets are built on a worker thread, and every cell stays drawn until they are ready. From then on only the cells that can be seen from the cell of the camera are kept in the instance vectors, or only their regions are drawn when the maze is meshed. Every cell is drawn while the camera is outside of the maze.
+ * @param this The primary Context of the program.
+ */
+void v_maze_stream_update(Context *this);
+
+/**
+ * Free the state of the streamed maze, its visible sets and the buffers of its region meshes. The instances that were appended stay.
+ * @note This waits for the worker thread of the visible sets and the meshes if it is still running.
+ * @warning The device must be idle when there are region meshes.
+ * @param this The primary Context of the program.
+ */
+void v_maze_stream_free(Context *this);
+
+/**
+ * Build the walls, floor and ceiling of a square grid maze as merged quads instead of one piece per cell.
+ * @note Every cell is split into 3 by 3 blocks. The middle is open, a side block is open where the cell links that way and the corners are solid.
+ * Open blocks are merged greedily into floor and ceiling rectangles, and walls only exist where an open block meets a solid one.
+ * So there are no faces between solid blocks and no seams between the floors of linked cells. The regions are built in parallel.
+ * @note The cell at (x, y) is centered on (2x, 2y) like the instanced pieces. The floor is at V_MAZE_MESH_FLOOR_Z and the walls rise toward +z.
+ * The texture coordinates are planar in world units, so merged quads tile the texture with the repeating sampler.
+ * @warning If this function succeeds you are responsiable for calling v_maze_mesh_free().
+ * @param this The VMazeMeshSet to fill. It is cleared on failure.
+ * @param pVertexMazeData The vertexMazeData of a square grid maze. The links of a vertex must go to grid neighbors.
+ * @return 1 if every region has its mesh. 0 if memory ran out.
+ */
+int v_maze_mesh_build(VMazeMeshSet *this, const UMazeCompactData *const pVertexMazeData);
+
+/**
+ * Free the meshes of every region.
+ * @param this The VMazeMeshSet that was filled by v_maze_mesh_build().
+ */
+void v_maze_mesh_free(VMazeMeshSet *this);
+
+#endif // V_MAZE_29
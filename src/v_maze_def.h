@@ -0,0 +1,130 @@
+#ifndef V_MAZE_DEF_29
+#define V_MAZE_DEF_29
+
+#include "SDL_atomic.h"
+#include "SDL_thread.h"
+#include <vulkan/vulkan.h>
+
+#include "u_maze_def.h"
+#include "u_pvs_def.h"
+#include "v_buffer_def.h"
+#include "v_model_def.h"
+
+// A piece is the four walls of a cell. Bit 0b1000 is the wall to +x, 0b0100 to -x, 0b0010 to +y and 0b0001 to -y.
+#define V_MAZE_PIECE_AMOUNT 16
+
+#define V_MAZE_STREAM_MICROSECONDS 2000 // The time v_maze_stream_update() spends on the maze every frame.
+
+// The least amount of cells a task of v_maze_instances_classify() works on. Smaller builds run on the calling thread.
+#define V_MAZE_INSTANCE_TASK_CELLS 4096
+
+// The width and depth of a mesh region in cells. A region has at most 48 * (cells + width) vertices, so 32 is the largest power of two that fits 16-bit indexes.
+#define V_MAZE_MESH_REGION_SIZE 32
+
+// The sizes of the maze meshes. A cell is 2 units wide like the instanced pieces, and its corridor is 1.6 units wide.
+#define V_MAZE_MESH_CELL_SIZE      2.0f
+#define V_MAZE_MESH_CORRIDOR_SIZE  1.6f
+#define V_MAZE_MESH_WALL_HEIGHT    2.8f
+#define V_MAZE_MESH_FLOOR_Z       -3.0f
+
+// The geometry of one region of a maze.
+typedef struct VMazeMesh {
+    uint32_t vertexAmount;
+    uint32_t indexAmount;
+    VBufferVertex *pVertices; // Owns the memory of pIndices too.
+    uint16_t *pIndices; // A triangle list. Front faces are counter clockwise.
+} VMazeMesh;
+
+typedef struct VMazeMeshSet {
+    uint32_t regionsWide;
+    uint32_t regionsDeep;
+    VMazeMesh *pRegions; // Region (x, y) is at y * regionsWide + x. It holds the cells from V_MAZE_MESH_REGION_SIZE * x and V_MAZE_MESH_REGION_SIZE * y.
+} VMazeMeshSet;
+
+typedef enum VMazeFinishStatus {
+    V_MAZE_FINISH_NONE    = 0,
+    V_MAZE_FINISH_RUNNING = 1, // A worker thread owns pvs and meshSet.
+    V_MAZE_FINISH_DONE    = 2  // pvs and meshSet are ready to be collected. Either is empty if memory ran out.
+} VMazeFinishStatus;
+
+// A maze that is generated and appended to the instance vectors a few rows every frame.
+typedef struct VMazeStream {
+    UMazeEllerState ellerState; // Empty when there is nothing left to stream.
+    uint32_t width;
+    uint32_t depth;
+    uint8_t *pCells; // The openings of every row streamed so far. The south openings of a row are the north openings of the next row.
+    uint32_t textureIndex;
+
+    uint32_t regionModelAmount;
+    uint32_t regionsWide;
+    VModelData *pRegionModels; // The greedy meshes of the regions, made once the maze is done if maze:greedy_mesh is set. They are drawn instead of the instances.
+    uint8_t *pRegionsVisible;  // One byte per region mesh. Only the regions that are not 0 are drawn.
+
+    SDL_Thread *pFinishThread; // Builds the visible sets and the region meshes once the maze is done, so that no frame waits on them.
+    SDL_atomic_t finishStatus; // VMazeFinishStatus
+    int buildMeshes; // maze:greedy_mesh when the maze was done. The finish thread does not read the config.
+
+    VMazeMeshSet meshSet; // The region meshes from the finish thread. A few of them are uploaded every frame.
+    uint32_t uploadedRegionAmount;
+    VModelData *pUploadedModels; // The regions uploaded so far. They become pRegionModels once every region is uploaded.
+
+    UPvs pvs; // The visible sets of the cells, built once the maze is done.
+    uint32_t *pVisibleCells; // Room for pvs.maxVisibleAmount cells.
+    uint32_t cameraCell; // The cell the instances were last filtered for. width * depth if the camera was outside of the maze, UINT32_MAX if they were never filtered.
+} VMazeStream;
+
+// Turns the cells of a grid of openings into instances of their pieces with v_maze_instances_classify() and v_maze_instances_scatter().
+typedef struct VMazeInstanceBuild {
+    const uint8_t *pCells; // The U_MAZE_CELL_EAST and U_MAZE_CELL_SOUTH openings. Row y starts at pCells + y * stride, and row 0 has no row above it.
+    uint32_t stride;
+
+    uint32_t firstX; // The rectangle of cells to build in grid coordinates. Only used when pCellIndexes is NULL.
+    uint32_t firstY;
+    uint32_t cellsWide;
+    uint32_t cellsDeep;
+
+    const uint32_t *pCellIndexes; // When not NULL only these cells are built. Cell i is at (i % stride, i / stride).
+    uint32_t cellIndexAmount;
+
+    float originX; // Added to the grid coordinates of a cell before they become its position. Cells are two units apart.
+    float originY;
+    uint32_t textureIndex;
+
+    size_t pieceAmounts[V_MAZE_PIECE_AMOUNT]; // The amount of cells of every piece. Filled by v_maze_instances_classify().
+
+    // Internal to v_maze.c.
+    size_t cellAmount;
+    unsigned taskAmount;
+    uint8_t *pPieces;
+    size_t (*pTaskCursors)[V_MAZE_PIECE_AMOUNT]; // The piece counts of every task, and later where each task writes.
+    VBufferPushConstantObject *ppDestinations[V_MAZE_PIECE_AMOUNT];
+} VMazeInstanceBuild;
+
+#define V_MAZE_GPU_TILE_SIZE  8  // TILE_SIZE of maze_gen.comp. Its first pass builds one tile of cells per invocation.
+#define V_MAZE_GPU_GROUP_SIZE 64 // local_size_x of maze_gen.comp.
+
+// The bindings of maze_gen.comp.
+typedef enum VMazeGpuBuffer {
+    V_MAZE_GPU_CELLS     = 0, // A uint of U_MAZE_CELL_EAST and U_MAZE_CELL_SOUTH openings per cell.
+    V_MAZE_GPU_TILES     = 1, // The union-find forest of the tiles that merges them into one maze.
+    V_MAZE_GPU_PIECES    = 2, // The amount of cells of every piece.
+    V_MAZE_GPU_INSTANCES = 3, // A vec2 position per cell, grouped by piece. Binding 0 of set 1 for the V_PIPELINE_GPU_INSTANCED variants.
+    V_MAZE_GPU_DRAWS     = 4, // A VkDrawIndexedIndirectCommand per piece, followed by a VkDrawIndirectCommand per piece.
+    V_MAZE_GPU_BUFFER_AMOUNT
+} VMazeGpuBuffer;
+
+#define V_MAZE_GPU_INDEXED_DRAW_OFFSET(piece) (sizeof(VkDrawIndexedIndirectCommand) * (piece))
+#define V_MAZE_GPU_DRAW_OFFSET(piece) (sizeof(VkDrawIndexedIndirectCommand) * V_MAZE_PIECE_AMOUNT + sizeof(VkDrawIndirectCommand) * (piece))
+
+// A maze that is generated and instanced by maze_gen.comp. Its cells and instances never leave device memory.
+typedef struct VMazeGpu {
+    uint32_t width;
+    uint32_t depth;
+    uint32_t textureIndex;
+    VkBuffer buffers[V_MAZE_GPU_BUFFER_AMOUNT];
+    VkDeviceMemory bufferMemories[V_MAZE_GPU_BUFFER_AMOUNT];
+    VkDescriptorPool descriptorPool;
+    VkDescriptorSet instanceDescriptorSet; // VK_NULL_HANDLE if there is no GPU maze.
+} VMazeGpu;
+
+#endif // V_MAZE_DEF_29
@@ -0,0 +1,466 @@
+#include "v_maze_gpu.h"
+
+#include "u_read.h"
+#include "v_buffer.h"
+#include "v_model.h"
+#include "v_pipeline.h"
+
+#include "SDL_log.h"
+#include "SDL_timer.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+// The passes of maze_gen.comp. They have to match its PASS_ defines.
+typedef enum {
+    PASS_TILES   = 0,
+    PASS_ROOTS   = 1,
+    PASS_CHOOSE  = 2,
+    PASS_HOOK    = 3,
+    PASS_COUNT   = 4,
+    PASS_OFFSETS = 5,
+    PASS_SCATTER = 6
+} Pass;
+
+// The push constants of maze_gen.comp.
+typedef struct {
+    uint32_t width;
+    uint32_t depth;
+    uint32_t seed;
+    uint32_t pass;
+} PassConstants;
+
+// Every Vulkan device can dispatch at least this many groups to x.
+#define MAX_GROUPS_WIDE 65535
+
+// The objects that only live while the maze is generated.
+typedef struct {
+    VkShaderModule shaderModule;
+    VkDescriptorSetLayout descriptorSetLayout;
+    VkPipelineLayout pipelineLayout;
+    VkPipeline pipeline;
+} Generator;
+
+static int canGenerate(Context *this, uint32_t width, uint32_t depth, const VkDeviceSize *pBufferSizes);
+static VEngineResult allocateGenerator(Context *this, Generator *pGenerator);
+static void freeGenerator(Context *this, Generator *pGenerator);
+static VEngineResult allocateDescriptorSets(Context *this, const Generator *pGenerator, const VkDeviceSize *pBufferSizes, VkDescriptorSet *pGeneratorSet);
+static void recordPass(VkCommandBuffer commandBuffer, const Generator *pGenerator, PassConstants *pConstants, Pass pass, uint32_t invocationAmount);
+
+VEngineResult v_maze_gpu_alloc(Context *this, uint32_t width, uint32_t depth, uint32_t seed) {
+    VMazeGpu *pMazeGpu = &this->mazeGpu;
+
+    memset(pMazeGpu, 0, sizeof(*pMazeGpu));
+
+    if(width < 2 || depth < 2 || (uint64_t)width * depth >= UINT32_MAX) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "v_maze_gpu_alloc: %ux%u cells cannot be generated", width, depth);
+        RETURN_RESULT_CODE(VE_ALLOC_MAZE_GPU_FAILURE, 0)
+    }
+
+    const uint32_t tileAmount = ((width + V_MAZE_GPU_TILE_SIZE - 1) / V_MAZE_GPU_TILE_SIZE) * ((depth + V_MAZE_GPU_TILE_SIZE - 1) / V_MAZE_GPU_TILE_SIZE);
+    const uint32_t cellAmount = width * depth;
+
+    VkDeviceSize bufferSizes[V_MAZE_GPU_BUFFER_AMOUNT];
+    bufferSizes[V_MAZE_GPU_CELLS]     = sizeof(uint32_t) * (VkDeviceSize)cellAmount;
+    bufferSizes[V_MAZE_GPU_TILES]     = 3 * sizeof(uint32_t) * (VkDeviceSize)tileAmount;
+    bufferSizes[V_MAZE_GPU_PIECES]    = 2 * sizeof(uint32_t) * V_MAZE_PIECE_AMOUNT;
+    bufferSizes[V_MAZE_GPU_INSTANCES] = 2 * sizeof(float) * (VkDeviceSize)cellAmount;
+    bufferSizes[V_MAZE_GPU_DRAWS]     = V_MAZE_GPU_DRAW_OFFSET(V_MAZE_PIECE_AMOUNT);
+
+    if(!canGenerate(this, width, depth, bufferSizes))
+        RETURN_RESULT_CODE(VE_ALLOC_MAZE_GPU_FAILURE, 1)
+
+    const VkBufferUsageFlags bufferUsages[V_MAZE_GPU_BUFFER_AMOUNT] = {
+        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT
+    };
+
+    for(unsigned b = 0; b < V_MAZE_GPU_BUFFER_AMOUNT; b++) {
+        VEngineResult returnCode = v_buffer_alloc(this, bufferSizes[b], bufferUsages[b], VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, &pMazeGpu->buffers[b], &pMazeGpu->bufferMemories[b]);
+
+        if(returnCode.type != VE_SUCCESS) {
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "v_maze_gpu_alloc: buffer %u of %lu bytes failed to allocate", b, (unsigned long)bufferSizes[b]);
+            v_maze_gpu_free(this);
+            RETURN_RESULT_CODE(VE_ALLOC_MAZE_GPU_FAILURE, 2)
+        }
+    }
+
+    Generator generator;
+    VEngineResult returnCode = allocateGenerator(this, &generator);
+
+    if(returnCode.type != VE_SUCCESS) {
+        v_maze_gpu_free(this);
+        return returnCode;
+    }
+
+    VkDescriptorSet generatorSet;
+    returnCode = allocateDescriptorSets(this, &generator, bufferSizes, &generatorSet);
+
+    if(returnCode.type != VE_SUCCESS) {
+        freeGenerator(this, &generator);
+        v_maze_gpu_free(this);
+        return returnCode;
+    }
+
+    // The draws start with the sizes of the pieces. maze_gen.comp fills in where their instances are.
+    VkDrawIndexedIndirectCommand indexedDraws[V_MAZE_PIECE_AMOUNT];
+    VkDrawIndirectCommand draws[V_MAZE_PIECE_AMOUNT];
+    uint8_t drawData[V_MAZE_GPU_DRAW_OFFSET(V_MAZE_PIECE_AMOUNT)];
+
+    memset(indexedDraws, 0, sizeof(indexedDraws));
+    memset(draws, 0, sizeof(draws));
+
+    for(unsigned p = 0; p < V_MAZE_PIECE_AMOUNT && p < this->vk.modelArrayAmount; p++) {
+        const VModelData *pModelData = this->vk.pVModelArray[p].pModelData;
+
+        if(pModelData == NULL)
+            continue;
+
+        indexedDraws[p].indexCount = pModelData->vertexAmount;
+        draws[p].vertexCount = pModelData->vertexAmount;
+    }
+
+    memcpy(drawData, indexedDraws, sizeof(indexedDraws));
+    memcpy(drawData + V_MAZE_GPU_DRAW_OFFSET(0), draws, sizeof(draws));
+
+    const Uint64 startCounter = SDL_GetPerformanceCounter();
+
+    VkCommandBuffer commandBuffer;
+    returnCode = v_buffer_begin_1_time_cb(this, &commandBuffer);
+
+    if(returnCode.type != VE_SUCCESS) {
+        freeGenerator(this, &generator);
+        v_maze_gpu_free(this);
+        RETURN_RESULT_CODE(VE_ALLOC_MAZE_GPU_FAILURE, 3)
+    }
+
+    vkCmdUpdateBuffer(commandBuffer, pMazeGpu->buffers[V_MAZE_GPU_DRAWS], 0, sizeof(drawData), drawData);
+    vkCmdFillBuffer(commandBuffer, pMazeGpu->buffers[V_MAZE_GPU_PIECES], 0, VK_WHOLE_SIZE, 0);
+
+    VkMemoryBarrier memoryBarrier = {0};
+    memoryBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    memoryBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    memoryBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1, &memoryBarrier, 0, NULL, 0, NULL);
+
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, generator.pipeline);
+    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, generator.pipelineLayout, 0, 1, &generatorSet, 0, NULL);
+
+    PassConstants constants;
+    constants.width = width;
+    constants.depth = depth;
+    constants.seed  = seed;
+
+    recordPass(commandBuffer, &generator, &constants, PASS_TILES, tileAmount);
+
+    // Every round joins each tree of tiles to at least one other tree, so the amount of trees at least halves.
+    for(uint32_t trees = tileAmount; trees > 1; trees = (trees + 1) / 2) {
+        recordPass(commandBuffer, &generator, &constants, PASS_ROOTS,  tileAmount);
+        recordPass(commandBuffer, &generator, &constants, PASS_CHOOSE, tileAmount);
+        recordPass(commandBuffer, &generator, &constants, PASS_HOOK,   tileAmount);
+    }
+
+    recordPass(commandBuffer, &generator, &constants, PASS_COUNT,   cellAmount);
+    recordPass(commandBuffer, &generator, &constants, PASS_OFFSETS, 1);
+    recordPass(commandBuffer, &generator, &constants, PASS_SCATTER, cellAmount);
+
+    memoryBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    memoryBarrier.dstAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_SHADER_READ_BIT;
+
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT, 0, 1, &memoryBarrier, 0, NULL, 0, NULL);
+
+    returnCode = v_buffer_end_1_time_cb(this, &commandBuffer);
+
+    freeGenerator(this, &generator);
+
+    if(returnCode.type != VE_SUCCESS) {
+        v_maze_gpu_free(this);
+        RETURN_RESULT_CODE(VE_ALLOC_MAZE_GPU_FAILURE, 4)
+    }
+
+    SDL_Log("Maze of %ux%u cells generated on the GPU in %lu us", width, depth, (unsigned long)((SDL_GetPerformanceCounter() - startCounter) * 1000000 / SDL_GetPerformanceFrequency()));
+
+    pMazeGpu->width  = width;
+    pMazeGpu->depth  = depth;
+    pMazeGpu->textureIndex = this->vk.texture.index;
+
+    // The pieces are not drawn until these are ready.
+    for(unsigned p = 0; p < V_MAZE_PIECE_AMOUNT && p < this->vk.modelArrayAmount; p++) {
+        if(this->vk.pVModelArray[p].pModelData != NULL)
+            v_pipeline_compile_async(this, this->vk.pVModelArray[p].pModelData->pipelineVariant | V_PIPELINE_GPU_INSTANCED);
+    }
+
+    RETURN_RESULT_CODE(VE_SUCCESS, 0)
+}
+
+void v_maze_gpu_draw_record(Context *this, VkCommandBuffer commandBuffer, VkPipeline *pBoundPipeline) {
+    if(this->mazeGpu.instanceDescriptorSet == VK_NULL_HANDLE)
+        return;
+
+    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, this->vk.pipelineLayout, 1, 1, &this->mazeGpu.instanceDescriptorSet, 0, NULL);
+
+    for(unsigned p = 0; p < V_MAZE_PIECE_AMOUNT && p < this->vk.modelArrayAmount; p++) {
+        VModelData *pModelData = this->vk.pVModelArray[p].pModelData;
+
+        if(pModelData == NULL)
+            continue;
+
+        const uint32_t variant = pModelData->pipelineVariant | V_PIPELINE_GPU_INSTANCED;
+
+        if(!v_pipeline_is_ready(this, variant)) {
+            v_pipeline_compile_async(this, variant);
+            continue;
+        }
+
+        VkPipeline pipeline = v_pipeline_get(this, variant);
+
+        if(pipeline != *pBoundPipeline) {
+            vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
+            *pBoundPipeline = pipeline;
+        }
+
+        v_model_draw_indirect_record(this, commandBuffer, pModelData, this->mazeGpu.textureIndex, this->mazeGpu.buffers[V_MAZE_GPU_DRAWS], V_MAZE_GPU_INDEXED_DRAW_OFFSET(p), V_MAZE_GPU_DRAW_OFFSET(p));
+    }
+}
+
+void v_maze_gpu_free(Context *this) {
+    VMazeGpu *pMazeGpu = &this->mazeGpu;
+
+    // The descriptor sets are freed with their pool.
+    vkDestroyDescriptorPool(this->vk.device, pMazeGpu->descriptorPool, NULL);
+
+    for(unsigned b = 0; b < V_MAZE_GPU_BUFFER_AMOUNT; b++) {
+        vkDestroyBuffer(this->vk.device, pMazeGpu->buffers[b], NULL);
+        vkFreeMemory(this->vk.device, pMazeGpu->bufferMemories[b], NULL);
+    }
+
+    memset(pMazeGpu, 0, sizeof(*pMazeGpu));
+}
+
+static int canGenerate(Context *this, uint32_t width, uint32_t depth, const VkDeviceSize *pBufferSizes) {
+    if((this->vk.pQueueFamilyProperties[this->vk.graphicsQueueFamilyIndex].queueFlags & VK_QUEUE_COMPUTE_BIT) == 0) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "v_maze_gpu_alloc: the graphics queue cannot run compute shaders");
+        return 0;
+    }
+
+    if(!this->vk.enabledFeatures.drawIndirectFirstInstance) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "v_maze_gpu_alloc: drawIndirectFirstInstance is not supported");
+        return 0;
+    }
+
+    if(this->vk.pipelines.gpuInstancedShaderModule == NULL) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "v_maze_gpu_alloc: maze_gpu_vert.spv is not loaded");
+        return 0;
+    }
+
+    VkPhysicalDeviceProperties physicalDeviceProperties;
+    vkGetPhysicalDeviceProperties(this->vk.physicalDevice, &physicalDeviceProperties);
+
+    for(unsigned b = 0; b < V_MAZE_GPU_BUFFER_AMOUNT; b++) {
+        if(pBufferSizes[b] > physicalDeviceProperties.limits.maxStorageBufferRange) {
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "v_maze_gpu_alloc: %ux%u cells need %lu bytes in buffer %u, but storage buffers are limited to %u bytes", width, depth, (unsigned long)pBufferSizes[b], b, physicalDeviceProperties.limits.maxStorageBufferRange);
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+static VEngineResult allocateGenerator(Context *this, Generator *pGenerator) {
+    VkResult result;
+
+    memset(pGenerator, 0, sizeof(*pGenerator));
+
+    int64_t shaderCodeLength;
+    uint8_t* pShaderCode = u_read_file("maze_gen_comp.spv", &shaderCodeLength);
+
+    if(pShaderCode == NULL) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "v_maze_gpu_alloc: Failed to load maze_gen_comp.spv");
+        RETURN_RESULT_CODE(VE_ALLOC_MAZE_GPU_FAILURE, 5)
+    }
+
+    VkShaderModuleCreateInfo shaderModuleCreateInfo = {0};
+    shaderModuleCreateInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+    shaderModuleCreateInfo.codeSize = shaderCodeLength;
+    shaderModuleCreateInfo.pCode = (const uint32_t*)(pShaderCode);
+
+    result = vkCreateShaderModule(this->vk.device, &shaderModuleCreateInfo, NULL, &pGenerator->shaderModule);
+
+    free(pShaderCode);
+
+    if(result != VK_SUCCESS) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "v_maze_gpu_alloc: vkCreateShaderModule failed with %i", result);
+        pGenerator->shaderModule = VK_NULL_HANDLE;
+        RETURN_RESULT_CODE(VE_ALLOC_MAZE_GPU_FAILURE, 6)
+    }
+
+    VkDescriptorSetLayoutBinding descriptorSetBindings[V_MAZE_GPU_BUFFER_AMOUNT];
+
+    for(unsigned b = 0; b < V_MAZE_GPU_BUFFER_AMOUNT; b++) {
+        descriptorSetBindings[b].binding = b;
+        descriptorSetBindings[b].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        descriptorSetBindings[b].descriptorCount = 1;
+        descriptorSetBindings[b].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+        descriptorSetBindings[b].pImmutableSamplers = NULL;
+    }
+
+    VkDescriptorSetLayoutCreateInfo descriptorSetLayoutCreateInfo = {0};
+    descriptorSetLayoutCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    descriptorSetLayoutCreateInfo.bindingCount = V_MAZE_GPU_BUFFER_AMOUNT;
+    descriptorSetLayoutCreateInfo.pBindings = descriptorSetBindings;
+
+    result = vkCreateDescriptorSetLayout(this->vk.device, &descriptorSetLayoutCreateInfo, NULL, &pGenerator->descriptorSetLayout);
+
+    if(result != VK_SUCCESS) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "v_maze_gpu_alloc: vkCreateDescriptorSetLayout failed with %i", result);
+        pGenerator->descriptorSetLayout = VK_NULL_HANDLE;
+        freeGenerator(this, pGenerator);
+        RETURN_RESULT_CODE(VE_ALLOC_MAZE_GPU_FAILURE, 7)
+    }
+
+    VkPushConstantRange pushConstant = {0};
+    pushConstant.offset = 0;
+    pushConstant.size = sizeof(PassConstants);
+    pushConstant.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+
+    VkPipelineLayoutCreateInfo pipelineLayoutInfo = {0};
+    pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipelineLayoutInfo.setLayoutCount = 1;
+    pipelineLayoutInfo.pSetLayouts = &pGenerator->descriptorSetLayout;
+    pipelineLayoutInfo.pushConstantRangeCount = 1;
+    pipelineLayoutInfo.pPushConstantRanges = &pushConstant;
+
+    result = vkCreatePipelineLayout(this->vk.device, &pipelineLayoutInfo, NULL, &pGenerator->pipelineLayout);
+
+    if(result != VK_SUCCESS) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "v_maze_gpu_alloc: vkCreatePipelineLayout failed with %i", result);
+        pGenerator->pipelineLayout = VK_NULL_HANDLE;
+        freeGenerator(this, pGenerator);
+        RETURN_RESULT_CODE(VE_ALLOC_MAZE_GPU_FAILURE, 8)
+    }
+
+    VkComputePipelineCreateInfo computePipelineCreateInfo = {0};
+    computePipelineCreateInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+    computePipelineCreateInfo.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    computePipelineCreateInfo.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+    computePipelineCreateInfo.stage.module = pGenerator->shaderModule;
+    computePipelineCreateInfo.stage.pName = "main";
+    computePipelineCreateInfo.layout = pGenerator->pipelineLayout;
+    computePipelineCreateInfo.basePipelineHandle = VK_NULL_HANDLE;
+    computePipelineCreateInfo.basePipelineIndex = -1;
+
+    result = vkCreateComputePipelines(this->vk.device, VK_NULL_HANDLE, 1, &computePipelineCreateInfo, NULL, &pGenerator->pipeline);
+
+    if(result != VK_SUCCESS) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "v_maze_gpu_alloc: vkCreateComputePipelines failed with %i", result);
+        pGenerator->pipeline = VK_NULL_HANDLE;
+        freeGenerator(this, pGenerator);
+        RETURN_RESULT_CODE(VE_ALLOC_MAZE_GPU_FAILURE, 9)
+    }
+
+    RETURN_RESULT_CODE(VE_SUCCESS, 0)
+}
+
+static void freeGenerator(Context *this, Generator *pGenerator) {
+    vkDestroyPipeline(this->vk.device, pGenerator->pipeline, NULL);
+    vkDestroyPipelineLayout(this->vk.device, pGenerator->pipelineLayout, NULL);
+    vkDestroyDescriptorSetLayout(this->vk.device, pGenerator->descriptorSetLayout, NULL);
+    vkDestroyShaderModule(this->vk.device, pGenerator->shaderModule, NULL);
+
+    memset(pGenerator, 0, sizeof(*pGenerator));
+}
+
+static VEngineResult allocateDescriptorSets(Context *this, const Generator *pGenerator, const VkDeviceSize *pBufferSizes, VkDescriptorSet *pGeneratorSet) {
+    VMazeGpu *pMazeGpu = &this->mazeGpu;
+    VkResult result;
+
+    // One set for the generator and one set for the instances that v_render reads.
+    VkDescriptorPoolSize descriptorPoolSize = {0};
+    descriptorPoolSize.type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    descriptorPoolSize.descriptorCount = V_MAZE_GPU_BUFFER_AMOUNT + 1;
+
+    VkDescriptorPoolCreateInfo descriptorPoolCreateInfo = {0};
+    descriptorPoolCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    descriptorPoolCreateInfo.poolSizeCount = 1;
+    descriptorPoolCreateInfo.pPoolSizes = &descriptorPoolSize;
+    descriptorPoolCreateInfo.maxSets = 2;
+
+    result = vkCreateDescriptorPool(this->vk.device, &descriptorPoolCreateInfo, NULL, &pMazeGpu->descriptorPool);
+
+    if(result != VK_SUCCESS) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "v_maze_gpu_alloc: vkCreateDescriptorPool failed with %i", result);
+        pMazeGpu->descriptorPool = VK_NULL_HANDLE;
+        RETURN_RESULT_CODE(VE_ALLOC_MAZE_GPU_FAILURE, 10)
+    }
+
+    const VkDescriptorSetLayout setLayouts[2] = {pGenerator->descriptorSetLayout, this->vk.instanceDescriptorSetLayout};
+    VkDescriptorSet descriptorSets[2];
+
+    VkDescriptorSetAllocateInfo descriptorSetAllocateInfo = {0};
+    descriptorSetAllocateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    descriptorSetAllocateInfo.descriptorPool = pMazeGpu->descriptorPool;
+    descriptorSetAllocateInfo.descriptorSetCount = 2;
+    descriptorSetAllocateInfo.pSetLayouts = setLayouts;
+
+    result = vkAllocateDescriptorSets(this->vk.device, &descriptorSetAllocateInfo, descriptorSets);
+
+    if(result != VK_SUCCESS) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "v_maze_gpu_alloc: vkAllocateDescriptorSets failed with %i", result);
+        RETURN_RESULT_CODE(VE_ALLOC_MAZE_GPU_FAILURE, 11)
+    }
+
+    VkDescriptorBufferInfo descriptorBufferInfos[V_MAZE_GPU_BUFFER_AMOUNT];
+    VkWriteDescriptorSet writeDescriptorSets[V_MAZE_GPU_BUFFER_AMOUNT + 1];
+
+    memset(writeDescriptorSets, 0, sizeof(writeDescriptorSets));
+
+    for(unsigned b = 0; b < V_MAZE_GPU_BUFFER_AMOUNT; b++) {
+        descriptorBufferInfos[b].buffer = pMazeGpu->buffers[b];
+        descriptorBufferInfos[b].offset = 0;
+        descriptorBufferInfos[b].range  = pBufferSizes[b];
+
+        writeDescriptorSets[b].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        writeDescriptorSets[b].dstSet = descriptorSets[0];
+        writeDescriptorSets[b].dstBinding = b;
+        writeDescriptorSets[b].dstArrayElement = 0;
+        writeDescriptorSets[b].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        writeDescriptorSets[b].descriptorCount = 1;
+        writeDescriptorSets[b].pBufferInfo = &descriptorBufferInfos[b];
+    }
+
+    // maze_gpu.vert reads the same instances at binding 0 of set 1.
+    writeDescriptorSets[V_MAZE_GPU_BUFFER_AMOUNT] = writeDescriptorSets[V_MAZE_GPU_INSTANCES];
+    writeDescriptorSets[V_MAZE_GPU_BUFFER_AMOUNT].dstSet = descriptorSets[1];
+    writeDescriptorSets[V_MAZE_GPU_BUFFER_AMOUNT].dstBinding = 0;
+
+    vkUpdateDescriptorSets(this->vk.device, V_MAZE_GPU_BUFFER_AMOUNT + 1, writeDescriptorSets, 0, NULL);
+
+    *pGeneratorSet = descriptorSets[0];
+    pMazeGpu->instanceDescriptorSet = descriptorSets[1];
+
+    RETURN_RESULT_CODE(VE_SUCCESS, 0)
+}
+
+static void recordPass(VkCommandBuffer commandBuffer, const Generator *pGenerator, PassConstants *pConstants, Pass pass, uint32_t invocationAmount) {
+    pConstants->pass = pass;
+
+    vkCmdPushConstants(commandBuffer, pGenerator->pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(*pConstants), pConstants);
+
+    // Larger passes are folded into rows of groups. maze_gen.comp flattens them back into one index.
+    const uint32_t groupAmount = (invocationAmount + V_MAZE_GPU_GROUP_SIZE - 1) / V_MAZE_GPU_GROUP_SIZE;
+    const uint32_t groupsWide  = groupAmount < MAX_GROUPS_WIDE ? groupAmount : MAX_GROUPS_WIDE;
+
+    vkCmdDispatch(commandBuffer, groupsWide, (groupAmount + groupsWide - 1) / groupsWide, 1);
+
+    // Every pass reads what the one before it wrote.
+    VkMemoryBarrier memoryBarrier = {0};
+    memoryBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    memoryBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    memoryBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1, &memoryBarrier, 0, NULL, 0, NULL);
+}
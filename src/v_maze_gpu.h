@@ -0,0 +1,37 @@
+#ifndef V_MAZE_GPU_29
+#define V_MAZE_GPU_29
+
+#include "context.h"
+#include "v_maze_def.h"
+#include "v_results.h"
+
+/**
+ * Generate a maze with maze_gen.comp and instance its pieces into device memory. Nothing is read back to the CPU.
+ * @note Every tile of V_MAZE_GPU_TILE_SIZE cells becomes a random spanning tree, then the tiles are merged by rounds of parallel union-find until the maze is one tree.
+ * @note This waits for the GPU to finish. The V_PIPELINE_GPU_INSTANCED variants of the pieces start compiling afterwards.
+ * @warning Make sure that the pieces are in this->vk.pVModelArray and that the pipeline layout is made first.
+ * @param this The primary Context of the program. this->mazeGpu is responsiable for the buffers and the descriptor sets.
+ * @param width The amount of cells to +x. At least 2.
+ * @param depth The amount of cells to +y. At least 2.
+ * @param seed The seed of the maze.
+ * @return A VEngineResult. If its type is VE_SUCCESS then v_render draws the maze. If VE_ALLOC_MAZE_GPU_FAILURE then the device cannot run the generator or a resource could not be made, and nothing is left allocated.
+ */
+VEngineResult v_maze_gpu_alloc(Context *this, uint32_t width, uint32_t depth, uint32_t seed);
+
+/**
+ * Record the indirect draws of the pieces of the GPU maze. Nothing is recorded if there is no GPU maze.
+ * @note A piece is skipped until its V_PIPELINE_GPU_INSTANCED variant is ready, because the fallbacks cannot place its instances.
+ * @param this The primary Context of the program.
+ * @param commandBuffer The command buffer inside the render pass. Set 0 must already be bound.
+ * @param pBoundPipeline The pipeline that is bound to commandBuffer. It is updated when another pipeline is bound.
+ */
+void v_maze_gpu_draw_record(Context *this, VkCommandBuffer commandBuffer, VkPipeline *pBoundPipeline);
+
+/**
+ * Free the buffers and the descriptor sets of the GPU maze.
+ * @warning Make sure that the device is idle first.
+ * @param this The primary Context of the program.
+ */
+void v_maze_gpu_free(Context *this);
+
+#endif // V_MAZE_GPU_29
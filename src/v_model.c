@@ -4,19 +4,72 @@
 #include "cgltf.h"
 #include "SDL_log.h"
 
+#include "u_cache.h"
 #include "u_read.h"
 #include "context.h"
+#include "v_pipeline_def.h"
+
+typedef struct {
+    char name[32];
+    uint32_t vertexAmount;
+    uint32_t indexType;
+    uint32_t pipelineVariant;
+    float    positionScale;
+    uint64_t vertexOffset;
+    uint64_t bufferSize; // The index and vertex bytes that follow this record, padded to 8 bytes.
+} ModelCacheRecord;
+
+// Anything that changes how a glTF file is turned into buffers belongs in here.
+typedef struct {
+    uint32_t vertexSize;
+    uint32_t compactIndices;
+    uint32_t compressVertices;
+    uint32_t recordSize;
+} ModelCacheOptions;
 
 static void* cgltfAllocFunc(void* user, cgltf_size size);
 static void cgltfFreeFunc(void* user, void* ptr);
 static cgltf_result cgltfFileRead(const struct cgltf_memory_options* memory_options, const struct cgltf_file_options* file_options, const char* path, cgltf_size* size, void** data);
 static void cgltfFileRelease(const struct cgltf_memory_options* memory_options, const struct cgltf_file_options* file_options, void* data);
 static cgltf_data* cgltfReadFile(const char *const pUTF8Filepath, cgltf_result *pCGLTFResult);
+static int appendCacheRecord(uint8_t **ppBlob, size_t *pBlobSize, const VModelData *pModelData, const void *pBuffer, uint64_t bufferSize);
+static VEngineResult loadCachedModels(Context *this, const uint8_t *pBlob, uint64_t blobSize, unsigned *pModelAmount, VModelData **ppVModelData);
+static int canCompressVertices(const VBufferVertex *pVertices, cgltf_size vertexAmount);
+static float compressVertices(VBufferVertex *pVertices, cgltf_size vertexAmount);
 
 VEngineResult v_model_load(Context *this, const char *const pUTF8Filepath, unsigned *pModelAmount, VModelData **ppVModelData) {
     *pModelAmount = 0;
     *ppVModelData = NULL;
 
+    // The whole file is hashed, so a cache hit skips glTF parsing, unpacking and interleaving.
+    int64_t sourceSize;
+    uint8_t *pSource = u_read_file(pUTF8Filepath, &sourceSize);
+    uint64_t cacheKey = 0;
+    int hasCacheKey = pSource != NULL;
+
+    if(hasCacheKey) {
+        ModelCacheOptions cacheOptions = {0};
+        cacheOptions.vertexSize       = sizeof(VBufferVertex);
+        cacheOptions.compactIndices   = 1;
+        cacheOptions.compressVertices = this->config.current.compressVertices;
+        cacheOptions.recordSize       = sizeof(ModelCacheRecord);
+
+        cacheKey = u_cache_key(pSource, sourceSize, &cacheOptions, sizeof(cacheOptions));
+        free(pSource);
+
+        uint64_t cachedSize;
+        uint8_t *pCached = u_cache_load(&this->cache, cacheKey, &cachedSize);
+
+        if(pCached != NULL) {
+            VEngineResult cachedResult = loadCachedModels(this, pCached, cachedSize, pModelAmount, ppVModelData);
+
+            free(pCached);
+
+            if(cachedResult.type == VE_SUCCESS)
+                return cachedResult;
+        }
+    }
+
     cgltf_result result;
     cgltf_data *pModel = cgltfReadFile(pUTF8Filepath, &result);
 
@@ -39,12 +92,17 @@ VEngineResult v_model_load(Context *this, const char *const pUTF8Filepath, unsig
 
     // TODO Find cleaner and more stable loading algorithm.
 
+    // The derived buffers of every mesh are gathered for the cache. It starts with the amount of meshes.
+    size_t blobSize = sizeof(uint64_t);
+    uint8_t *pBlob = calloc(1, blobSize);
+
     VModelData *pVModel = malloc(sizeof(VModelData) * pModel->meshes_count );
 
     if(pVModel == NULL) {
         SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "This glTF file has no buffers!");
         cgltf_free(pModel);
         free(pVModel);
+        free(pBlob);
         RETURN_RESULT_CODE(VE_LOAD_MODEL_FAILURE, 3)
     }
 
@@ -161,6 +219,15 @@ VEngineResult v_model_load(Context *this, const char *const pUTF8Filepath, unsig
                 case cgltf_component_type_r_32u:
                     SDL_Log("This model has component_type = cgltf_component_type_r_32u");
 
+                    // Halve the index buffer when every vertex can be reached with 16 bits.
+                    if(vertexAmount <= 0x10000) {
+                        SDL_Log("This model only has %li vertices. It will be converted to 16u", vertexAmount);
+
+                        indexComponentSize = cgltf_component_size(cgltf_component_type_r_16u);
+                        indexType = VK_INDEX_TYPE_UINT16;
+                        break;
+                    }
+
                     indexComponentSize = cgltf_component_size(cgltf_component_type_r_32u);
                     indexType = VK_INDEX_TYPE_UINT32;
                     break;
@@ -228,6 +295,24 @@ VEngineResult v_model_load(Context *this, const char *const pUTF8Filepath, unsig
             }
         }
 
+        pVModel[mesh_index].pipelineVariant = 0;
+        pVModel[mesh_index].positionScale   = 1.0f;
+
+        if(pTexCoordAttribute != NULL)
+            pVModel[mesh_index].pipelineVariant |= V_PIPELINE_TEXTURED;
+
+        if(pColorAttribute != NULL)
+            pVModel[mesh_index].pipelineVariant |= V_PIPELINE_VERTEX_COLOR;
+
+        cgltf_size vertexBufferSize = sizeof(VBufferVertex) * vertexAmount;
+
+        if(this->config.current.compressVertices && canCompressVertices(pInterlacedBuffer, vertexAmount)) {
+            pVModel[mesh_index].positionScale = compressVertices(pInterlacedBuffer, vertexAmount);
+            pVModel[mesh_index].pipelineVariant |= V_PIPELINE_COMPRESSED_VERTEX;
+
+            vertexBufferSize = sizeof(VBufferCompressedVertex) * vertexAmount;
+        }
+
         if(pIndices != NULL)
             pVModel[mesh_index].vertexAmount = pIndices->count;
         else
@@ -235,16 +320,30 @@ VEngineResult v_model_load(Context *this, const char *const pUTF8Filepath, unsig
 
         pVModel[mesh_index].vertexOffset = indexBufferSize;
 
-        v_buffer_alloc_static(this, pIndexedBuffer, indexBufferSize + sizeof(VBufferVertex) * vertexAmount, &pVModel[mesh_index].buffer, VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, &pVModel[mesh_index].bufferMemory);
+        if(pIndices == NULL)
+            pVModel[mesh_index].indexType = VK_INDEX_TYPE_UINT16;
+
+        v_buffer_alloc_static(this, pIndexedBuffer, indexBufferSize + vertexBufferSize, &pVModel[mesh_index].buffer, VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, &pVModel[mesh_index].bufferMemory);
+
+        if(pBlob != NULL && !appendCacheRecord(&pBlob, &blobSize, &pVModel[mesh_index], pIndexedBuffer, indexBufferSize + vertexBufferSize)) {
+            free(pBlob);
+            pBlob = NULL;
+        }
 
         free(pLoadBuffer);
 
         (*pModelAmount)++;
     }
 
+    // Only store files where every mesh was loaded, because a skipped mesh leaves a gap in pVModel.
+    if(pBlob != NULL && hasCacheKey && *pModelAmount == pModel->meshes_count)
+        u_cache_store(&this->cache, cacheKey, pBlob, blobSize);
+
     cgltf_free(pModel);
     *ppVModelData = pVModel;
 
+    free(pBlob);
+
     RETURN_RESULT_CODE(VE_SUCCESS, 0)
 }
 
@@ -261,9 +360,10 @@ void v_model_draw_record(Context *this, VkCommandBuffer commandBuffer, VModelDat
 
     for(unsigned i = 0; i < numInstances; i++) {
         pushConstantObject = pPushConstantObjects[i];
+        pushConstantObject.positionScale = pModelData->positionScale;
         pushConstantObject.matrix = MatrixTranspose(MatrixMultiply(MatrixMultiply(pushConstantObject.matrix, this->modelView), MatrixVulkanPerspective(45.0 * DEG2RAD, this->vk.swapExtent.width / (float) this->vk.swapExtent.height, 0.125f, 100.0f)));
 
-        vkCmdPushConstants(commandBuffer, this->vk.pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(pushConstantObject), &pushConstantObject);
+        vkCmdPushConstants(commandBuffer, this->vk.pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(pushConstantObject), &pushConstantObject);
 
         if(pModelData->vertexOffset != 0)
             vkCmdDrawIndexed(commandBuffer, pModelData->vertexAmount, 1, 0, 0, 0);
@@ -272,6 +372,30 @@ void v_model_draw_record(Context *this, VkCommandBuffer commandBuffer, VModelDat
     }
 }
 
+void v_model_draw_indirect_record(Context *this, VkCommandBuffer commandBuffer, VModelData *pModelData, uint32_t textureIndex, VkBuffer drawBuffer, VkDeviceSize indexedDrawOffset, VkDeviceSize drawOffset) {
+    VBufferPushConstantObject pushConstantObject;
+
+    VkBuffer vertexBuffers[] = {pModelData->buffer};
+    VkDeviceSize offsets[] = {pModelData->vertexOffset};
+
+    vkCmdBindVertexBuffers(commandBuffer, 0, 1, vertexBuffers, offsets);
+
+    if(pModelData->vertexOffset != 0)
+        vkCmdBindIndexBuffer(commandBuffer, pModelData->buffer, 0, pModelData->indexType);
+
+    // The vertex shader places every instance, so only the view and the projection are pushed.
+    pushConstantObject.textureIndex = textureIndex;
+    pushConstantObject.positionScale = pModelData->positionScale;
+    pushConstantObject.matrix = MatrixTranspose(MatrixMultiply(this->modelView, MatrixVulkanPerspective(45.0 * DEG2RAD, this->vk.swapExtent.width / (float) this->vk.swapExtent.height, 0.125f, 100.0f)));
+
+    vkCmdPushConstants(commandBuffer, this->vk.pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(pushConstantObject), &pushConstantObject);
+
+    if(pModelData->vertexOffset != 0)
+        vkCmdDrawIndexedIndirect(commandBuffer, drawBuffer, indexedDrawOffset, 1, 0);
+    else
+        vkCmdDrawIndirect(commandBuffer, drawBuffer, drawOffset, 1, 0);
+}
+
 static cgltf_data* cgltfReadFile(const char *const pUTF8Filepath, cgltf_result *pCGLTFResult) {
     cgltf_options options = {0};
     options.memory.alloc_func = cgltfAllocFunc;
@@ -325,3 +449,137 @@ static cgltf_result cgltfFileRead(const struct cgltf_memory_options* memoryOptio
 static void cgltfFileRelease(const struct cgltf_memory_options* memoryOptions, const struct cgltf_file_options* fileOptions, void* data) {
     cgltfFreeFunc(NULL, data);
 }
+
+static int appendCacheRecord(uint8_t **ppBlob, size_t *pBlobSize, const VModelData *pModelData, const void *pBuffer, uint64_t bufferSize) {
+    ModelCacheRecord record = {0};
+    uint64_t paddedSize = (bufferSize + 7) & ~(uint64_t)7;
+
+    uint8_t *pBlob = realloc(*ppBlob, *pBlobSize + sizeof(record) + paddedSize);
+
+    if(pBlob == NULL)
+        return 0;
+
+    memcpy(record.name, pModelData->name, sizeof(record.name));
+    record.vertexAmount = pModelData->vertexAmount;
+    record.indexType    = pModelData->indexType;
+    record.pipelineVariant = pModelData->pipelineVariant;
+    record.positionScale   = pModelData->positionScale;
+    record.vertexOffset = pModelData->vertexOffset;
+    record.bufferSize   = bufferSize;
+
+    memcpy(pBlob + *pBlobSize, &record, sizeof(record));
+    memcpy(pBlob + *pBlobSize + sizeof(record), pBuffer, bufferSize);
+    memset(pBlob + *pBlobSize + sizeof(record) + bufferSize, 0, paddedSize - bufferSize);
+
+    (*(uint64_t*)pBlob)++;
+
+    *ppBlob = pBlob;
+    *pBlobSize += sizeof(record) + paddedSize;
+    return 1;
+}
+
+static VEngineResult loadCachedModels(Context *this, const uint8_t *pBlob, uint64_t blobSize, unsigned *pModelAmount, VModelData **ppVModelData) {
+    uint64_t meshAmount;
+    uint64_t offset = sizeof(meshAmount);
+    ModelCacheRecord record;
+
+    if(blobSize < sizeof(meshAmount))
+        RETURN_RESULT_CODE(VE_LOAD_MODEL_FAILURE, 4)
+
+    memcpy(&meshAmount, pBlob, sizeof(meshAmount));
+
+    // Check every record before any Vulkan buffer is made.
+    for(uint64_t m = 0; m < meshAmount; m++) {
+        if(blobSize - offset < sizeof(record))
+            RETURN_RESULT_CODE(VE_LOAD_MODEL_FAILURE, 4)
+
+        memcpy(&record, pBlob + offset, sizeof(record));
+        offset += sizeof(record);
+
+        if(record.pipelineVariant >= V_PIPELINE_VARIANT_AMOUNT || record.vertexOffset > record.bufferSize || blobSize - offset < ((record.bufferSize + 7) & ~(uint64_t)7))
+            RETURN_RESULT_CODE(VE_LOAD_MODEL_FAILURE, 4)
+
+        offset += (record.bufferSize + 7) & ~(uint64_t)7;
+    }
+
+    if(meshAmount == 0 || offset != blobSize)
+        RETURN_RESULT_CODE(VE_LOAD_MODEL_FAILURE, 4)
+
+    VModelData *pVModel = malloc(sizeof(VModelData) * meshAmount);
+
+    if(pVModel == NULL)
+        RETURN_RESULT_CODE(VE_LOAD_MODEL_FAILURE, 5)
+
+    offset = sizeof(meshAmount);
+
+    for(uint64_t m = 0; m < meshAmount; m++) {
+        memcpy(&record, pBlob + offset, sizeof(record));
+        offset += sizeof(record);
+
+        memcpy(pVModel[m].name, record.name, sizeof(pVModel[m].name));
+        pVModel[m].name[sizeof(pVModel[m].name) - 1] = '\0';
+        pVModel[m].vertexAmount = record.vertexAmount;
+        pVModel[m].indexType    = record.indexType;
+        pVModel[m].pipelineVariant = record.pipelineVariant;
+        pVModel[m].positionScale   = record.positionScale;
+        pVModel[m].vertexOffset = record.vertexOffset;
+
+        v_buffer_alloc_static(this, pBlob + offset, record.bufferSize, &pVModel[m].buffer, VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, &pVModel[m].bufferMemory);
+
+        offset += (record.bufferSize + 7) & ~(uint64_t)7;
+    }
+
+    SDL_Log("Loaded %lu meshes from the asset cache", (unsigned long)meshAmount);
+
+    *pModelAmount = meshAmount;
+    *ppVModelData = pVModel;
+
+    RETURN_RESULT_CODE(VE_SUCCESS, 0)
+}
+
+static int canCompressVertices(const VBufferVertex *pVertices, cgltf_size vertexAmount) {
+    // Texture coordinates are stored as unsigned normalized, so repeating textures cannot be compressed.
+    for(cgltf_size v = 0; v < vertexAmount; v++) {
+        if(pVertices[v].texCoord.x < 0.0f || pVertices[v].texCoord.x > 1.0f || pVertices[v].texCoord.y < 0.0f || pVertices[v].texCoord.y > 1.0f)
+            return 0;
+    }
+    return 1;
+}
+
+static float compressVertices(VBufferVertex *pVertices, cgltf_size vertexAmount) {
+    float scale = 0.0f;
+
+    for(cgltf_size v = 0; v < vertexAmount; v++) {
+        scale = fmaxf(scale, fabsf(pVertices[v].pos.x));
+        scale = fmaxf(scale, fabsf(pVertices[v].pos.y));
+        scale = fmaxf(scale, fabsf(pVertices[v].pos.z));
+    }
+
+    if(scale == 0.0f)
+        scale = 1.0f;
+
+    // VBufferCompressedVertex is half the size of VBufferVertex, so vertex v is written before it could overlap an unread vertex.
+    VBufferCompressedVertex *pCompressed = (VBufferCompressedVertex*)pVertices;
+
+    for(cgltf_size v = 0; v < vertexAmount; v++) {
+        const VBufferVertex vertex = pVertices[v];
+        VBufferCompressedVertex compressed;
+
+        compressed.pos[0] = (int16_t)lroundf(vertex.pos.x / scale * 32767.0f);
+        compressed.pos[1] = (int16_t)lroundf(vertex.pos.y / scale * 32767.0f);
+        compressed.pos[2] = (int16_t)lroundf(vertex.pos.z / scale * 32767.0f);
+        compressed.pos[3] = 32767;
+
+        compressed.color[0] = (uint8_t)lroundf(fminf(fmaxf(vertex.color.x, 0.0f), 1.0f) * 255.0f);
+        compressed.color[1] = (uint8_t)lroundf(fminf(fmaxf(vertex.color.y, 0.0f), 1.0f) * 255.0f);
+        compressed.color[2] = (uint8_t)lroundf(fminf(fmaxf(vertex.color.z, 0.0f), 1.0f) * 255.0f);
+        compressed.color[3] = 255;
+
+        compressed.texCoord[0] = (uint16_t)lroundf(vertex.texCoord.x * 65535.0f);
+        compressed.texCoord[1] = (uint16_t)lroundf(vertex.texCoord.y * 65535.0f);
+
+        pCompressed[v] = compressed;
+    }
+
+    return scale;
+}
@@ -9,4 +9,6 @@ VEngineResult v_model_load(Context *this, const char *const pUTF8Filepath, unsig
 
 void v_model_draw_record(Context *this, VkCommandBuffer commandBuffer, VModelData *pModelData, unsigned numInstances, VBufferPushConstantObject *pPushConstantObjects);
 
+void v_model_draw_indirect_record(Context *this, VkCommandBuffer commandBuffer, VModelData *pModelData, uint32_t textureIndex, VkBuffer drawBuffer, VkDeviceSize indexedDrawOffset, VkDeviceSize drawOffset);
+
 #endif // V_MODEL_29
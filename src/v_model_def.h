@@ -12,6 +12,8 @@ typedef struct VModelData {
     uint32_t vertexAmount;
     VkDeviceSize vertexOffset;
     VkIndexType indexType;
+    uint32_t pipelineVariant; // The VPipelineVariantFlags that this model is drawn with.
+    float positionScale; // Scales the positions of VBufferCompressedVertex back to model space.
     VkBuffer buffer;
     VkDeviceMemory bufferMemory;
 } VModelData;
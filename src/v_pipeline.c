@@ -0,0 +1,447 @@
+#include "v_pipeline.h"
+
+#include "u_read.h"
+
+#include "SDL_error.h"
+#include "SDL_log.h"
+#include "SDL_thread.h"
+#include "SDL_timer.h"
+
+#include <stddef.h>
+#include <stdlib.h>
+
+// The constant_id of each field matches its index in SPECIALIZATION_MAP_ENTRIES.
+typedef struct {
+    VkBool32 textured;
+    VkBool32 vertexColor;
+    VkBool32 compressedVertex;
+} SpecializationData;
+
+static const VkSpecializationMapEntry SPECIALIZATION_MAP_ENTRIES[] = {
+//  constantID,                                 offset,             size
+    {        0, offsetof(SpecializationData,         textured), sizeof(VkBool32)},
+    {        1, offsetof(SpecializationData,      vertexColor), sizeof(VkBool32)},
+    {        2, offsetof(SpecializationData, compressedVertex), sizeof(VkBool32)}
+};
+
+typedef struct {
+    Context *pContext;
+    uint32_t variant;
+} CompileTask;
+
+static VkShaderModule allocateShaderModule(Context *this, uint8_t* data, size_t size);
+static VEngineResult createPipeline(Context *this, uint32_t variant, VkPipeline *pPipeline);
+static VEngineResult compileVariant(Context *this, uint32_t variant);
+static int compileWorkerMain(void *pData);
+
+VEngineResult v_pipeline_alloc(Context *this) {
+    int64_t vertexShaderCodeLength;
+    uint8_t* pVertexShaderCode = u_read_file("hello_world_vert.spv", &vertexShaderCodeLength);
+
+    if(pVertexShaderCode == NULL) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Failed to load vertex shader code");
+        RETURN_RESULT_CODE(VE_ALLOC_GRAPH_PIPELINE_FAILURE, 0)
+    }
+
+    int64_t fragmentShaderCodeLength;
+    uint8_t* pFragmentShaderCode;
+
+    if(this->vk.bindless.enabled)
+        pFragmentShaderCode = u_read_file("hello_world_bindless_frag.spv", &fragmentShaderCodeLength);
+    else
+        pFragmentShaderCode = u_read_file("hello_world_frag.spv", &fragmentShaderCodeLength);
+
+    if(pFragmentShaderCode == NULL) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Failed to load fragment shader code");
+        free(pVertexShaderCode);
+        RETURN_RESULT_CODE(VE_ALLOC_GRAPH_PIPELINE_FAILURE, 1)
+    }
+
+    VkShaderModule   vertexShaderModule = allocateShaderModule(this, pVertexShaderCode,   vertexShaderCodeLength);
+    VkShaderModule fragmentShaderModule = allocateShaderModule(this, pFragmentShaderCode, fragmentShaderCodeLength);
+
+    free(pVertexShaderCode);
+    free(pFragmentShaderCode);
+
+    if(vertexShaderModule == NULL) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Vulkan failed to parse vertex shader code!");
+
+        vkDestroyShaderModule(this->vk.device, fragmentShaderModule, NULL);
+
+        RETURN_RESULT_CODE(VE_ALLOC_GRAPH_PIPELINE_FAILURE, 2)
+    }
+    else if(fragmentShaderModule == NULL) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Vulkan failed to parse fragment shader code!");
+
+        vkDestroyShaderModule(this->vk.device, vertexShaderModule, NULL);
+
+        RETURN_RESULT_CODE(VE_ALLOC_GRAPH_PIPELINE_FAILURE, 3)
+    }
+
+    // Only the GPU maze needs this stage, so the engine still runs without it.
+    int64_t gpuInstancedShaderCodeLength;
+    uint8_t* pGpuInstancedShaderCode = u_read_file("maze_gpu_vert.spv", &gpuInstancedShaderCodeLength);
+    VkShaderModule gpuInstancedShaderModule = NULL;
+
+    if(pGpuInstancedShaderCode != NULL) {
+        gpuInstancedShaderModule = allocateShaderModule(this, pGpuInstancedShaderCode, gpuInstancedShaderCodeLength);
+        free(pGpuInstancedShaderCode);
+    }
+
+    if(gpuInstancedShaderModule == NULL)
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "maze_gpu_vert.spv could not be loaded. The maze cannot be drawn from the GPU");
+
+    // Here is where uniforms should go.
+    const VkDescriptorSetLayout setLayouts[] = {this->vk.descriptorSetLayout, this->vk.instanceDescriptorSetLayout};
+
+    VkPipelineLayoutCreateInfo pipelineLayoutInfo = {0};
+    pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipelineLayoutInfo.setLayoutCount = sizeof(setLayouts) / sizeof(setLayouts[0]);
+    pipelineLayoutInfo.pSetLayouts = setLayouts;
+
+    VkPushConstantRange pushConstant = {0};
+    pushConstant.offset = 0;
+    pushConstant.size = sizeof(VBufferPushConstantObject);
+    pushConstant.stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
+
+    pipelineLayoutInfo.pushConstantRangeCount = 1; // OPTIONAL
+    pipelineLayoutInfo.pPushConstantRanges = &pushConstant; // OPTIONAL
+
+    VkResult result = vkCreatePipelineLayout(this->vk.device, &pipelineLayoutInfo, NULL, &this->vk.pipelineLayout);
+
+    if(result != VK_SUCCESS) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Pipeline Layout creation failed with result: %i", result);
+
+        vkDestroyShaderModule(this->vk.device,   vertexShaderModule, NULL);
+        vkDestroyShaderModule(this->vk.device, fragmentShaderModule, NULL);
+        vkDestroyShaderModule(this->vk.device, gpuInstancedShaderModule, NULL);
+
+        RETURN_RESULT_CODE(VE_ALLOC_GRAPH_PIPELINE_FAILURE, 4)
+    }
+
+    // Every variant is specialized from these modules, so they are kept until v_pipeline_free().
+    this->vk.pipelines.vertexShaderModule       = vertexShaderModule;
+    this->vk.pipelines.fragmentShaderModule     = fragmentShaderModule;
+    this->vk.pipelines.gpuInstancedShaderModule = gpuInstancedShaderModule;
+
+    // The fallbacks are made now because they are drawn with while the other variants compile.
+    const uint32_t fallbackVariants[] = {V_PIPELINE_DEFAULT_VARIANT, V_PIPELINE_DEFAULT_VARIANT | V_PIPELINE_COMPRESSED_VERTEX};
+
+    for(uint32_t i = 0; i < sizeof(fallbackVariants) / sizeof(fallbackVariants[0]); i++) {
+        VEngineResult returnCode = compileVariant(this, fallbackVariants[i]);
+
+        if(returnCode.type < 0)
+            return returnCode;
+    }
+
+    RETURN_RESULT_CODE(VE_SUCCESS, 0)
+}
+
+void v_pipeline_compile_async(Context *this, uint32_t variant) {
+    if(variant >= V_PIPELINE_VARIANT_AMOUNT) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "v_pipeline_compile_async: 0x%x is not a pipeline variant", variant);
+        return;
+    }
+
+    // Only the first request of a variant starts a worker.
+    if(!SDL_AtomicCAS(&this->vk.pipelines.status[variant], V_PIPELINE_STATUS_EMPTY, V_PIPELINE_STATUS_COMPILING))
+        return;
+
+    CompileTask *pTask = malloc(sizeof(CompileTask));
+
+    if(pTask != NULL) {
+        pTask->pContext = this;
+        pTask->variant  = variant;
+
+        this->vk.pipelines.pCompileThreads[variant] = SDL_CreateThread(compileWorkerMain, "v_pipeline_compile", pTask);
+
+        if(this->vk.pipelines.pCompileThreads[variant] != NULL)
+            return;
+
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "v_pipeline_compile_async: SDL_CreateThread failed due to %s", SDL_GetError());
+        free(pTask);
+    }
+
+    // Without a worker the variant is compiled on this thread instead.
+    compileVariant(this, variant);
+}
+
+int v_pipeline_is_ready(Context *this, uint32_t variant) {
+    if(variant >= V_PIPELINE_VARIANT_AMOUNT)
+        return 0;
+
+    return SDL_AtomicGet(&this->vk.pipelines.status[variant]) == V_PIPELINE_STATUS_READY;
+}
+
+VkPipeline v_pipeline_get(Context *this, uint32_t variant) {
+    if(variant >= V_PIPELINE_VARIANT_AMOUNT) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "v_pipeline_get: 0x%x is not a pipeline variant", variant);
+        return this->vk.pipelines.variants[V_PIPELINE_DEFAULT_VARIANT];
+    }
+
+    // SDL_AtomicGet is a full barrier, so variants[variant] is visible once the status reads as ready.
+    if(v_pipeline_is_ready(this, variant))
+        return this->vk.pipelines.variants[variant];
+
+    v_pipeline_compile_async(this, variant);
+
+    // Counted once per variant, because a variant that is still compiling is drawn with a fallback every frame.
+    this->vk.pipelines.stats.fallbackVariants |= 1u << variant;
+
+    // The fallback has to read the same vertex format as the variant.
+    return this->vk.pipelines.variants[V_PIPELINE_DEFAULT_VARIANT | (variant & V_PIPELINE_COMPRESSED_VERTEX)];
+}
+
+static VEngineResult createPipeline(Context *this, uint32_t variant, VkPipeline *pPipeline) {
+    if((variant & V_PIPELINE_GPU_INSTANCED) != 0 && this->vk.pipelines.gpuInstancedShaderModule == NULL) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "createPipeline: variant 0x%x needs maze_gpu_vert.spv", variant);
+        *pPipeline = VK_NULL_HANDLE;
+        RETURN_RESULT_CODE(VE_ALLOC_GRAPH_PIPELINE_FAILURE, 6)
+    }
+
+    SpecializationData specializationData;
+    specializationData.textured         = (variant & V_PIPELINE_TEXTURED)          != 0;
+    specializationData.vertexColor      = (variant & V_PIPELINE_VERTEX_COLOR)      != 0;
+    specializationData.compressedVertex = (variant & V_PIPELINE_COMPRESSED_VERTEX) != 0;
+
+    // Both stages get every constant. A stage ignores the constant IDs that it does not declare.
+    VkSpecializationInfo specializationInfo;
+    specializationInfo.mapEntryCount = sizeof(SPECIALIZATION_MAP_ENTRIES) / sizeof(SPECIALIZATION_MAP_ENTRIES[0]);
+    specializationInfo.pMapEntries = SPECIALIZATION_MAP_ENTRIES;
+    specializationInfo.dataSize = sizeof(specializationData);
+    specializationInfo.pData = &specializationData;
+
+    VkPipelineShaderStageCreateInfo pipelineShaderStageCreateInfos[2] = { {0}, {0} };
+    const unsigned   VERTEX_INDEX = 0;
+    const unsigned FRAGMENT_INDEX = 1;
+
+    pipelineShaderStageCreateInfos[VERTEX_INDEX].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    pipelineShaderStageCreateInfos[VERTEX_INDEX].stage = VK_SHADER_STAGE_VERTEX_BIT;
+    if((variant & V_PIPELINE_GPU_INSTANCED) != 0)
+        pipelineShaderStageCreateInfos[VERTEX_INDEX].module = this->vk.pipelines.gpuInstancedShaderModule;
+    else
+        pipelineShaderStageCreateInfos[VERTEX_INDEX].module = this->vk.pipelines.vertexShaderModule;
+    pipelineShaderStageCreateInfos[VERTEX_INDEX].pName = "main";
+    pipelineShaderStageCreateInfos[VERTEX_INDEX].pSpecializationInfo = &specializationInfo;
+
+    pipelineShaderStageCreateInfos[FRAGMENT_INDEX].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    pipelineShaderStageCreateInfos[FRAGMENT_INDEX].stage = VK_SHADER_STAGE_FRAGMENT_BIT;
+    pipelineShaderStageCreateInfos[FRAGMENT_INDEX].module = this->vk.pipelines.fragmentShaderModule;
+    pipelineShaderStageCreateInfos[FRAGMENT_INDEX].pName = "main";
+    pipelineShaderStageCreateInfos[FRAGMENT_INDEX].pSpecializationInfo = &specializationInfo;
+
+    VkPipelineVertexInputStateCreateInfo pipelineVertexInputStateCreateInfo = {0};
+    pipelineVertexInputStateCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+    pipelineVertexInputStateCreateInfo.vertexBindingDescriptionCount = 1;
+
+    if((variant & V_PIPELINE_COMPRESSED_VERTEX) != 0) {
+        pipelineVertexInputStateCreateInfo.pVertexBindingDescriptions = &V_BUFFER_CompressedVertexBindingDescription;
+        pipelineVertexInputStateCreateInfo.vertexAttributeDescriptionCount = sizeof(V_BUFFER_CompressedVertexInputAttributeDescriptions) / sizeof(V_BUFFER_CompressedVertexInputAttributeDescriptions[0]);
+        pipelineVertexInputStateCreateInfo.pVertexAttributeDescriptions = V_BUFFER_CompressedVertexInputAttributeDescriptions;
+    }
+    else {
+        pipelineVertexInputStateCreateInfo.pVertexBindingDescriptions = &V_BUFFER_VertexBindingDescription;
+        pipelineVertexInputStateCreateInfo.vertexAttributeDescriptionCount = sizeof(V_BUFFER_VertexInputAttributeDescriptions) / sizeof(V_BUFFER_VertexInputAttributeDescriptions[0]);
+        pipelineVertexInputStateCreateInfo.pVertexAttributeDescriptions = V_BUFFER_VertexInputAttributeDescriptions;
+    }
+
+    VkPipelineInputAssemblyStateCreateInfo pipelineInputAssemblyStateCreateInfo = {0};
+    pipelineInputAssemblyStateCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
+    pipelineInputAssemblyStateCreateInfo.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+    pipelineInputAssemblyStateCreateInfo.primitiveRestartEnable = VK_FALSE;
+
+    VkViewport viewport = {0};
+    viewport.x = 0.0f;
+    viewport.y = 0.0f;
+    viewport.width  = (float) this->vk.swapExtent.width;
+    viewport.height = (float) this->vk.swapExtent.height;
+    viewport.minDepth = 0.0f;
+    viewport.maxDepth = 1.0f;
+
+    VkRect2D scissor = {0};
+    scissor.offset.x = 0.0f;
+    scissor.offset.y = 0.0f;
+    scissor.extent = this->vk.swapExtent;
+
+    VkDynamicState dynamicStates[] = {VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR};
+
+    VkPipelineDynamicStateCreateInfo pipelineDynamicStateInfo = {0};
+    pipelineDynamicStateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+    pipelineDynamicStateInfo.dynamicStateCount = sizeof(dynamicStates) / sizeof(dynamicStates[0]);
+    pipelineDynamicStateInfo.pDynamicStates = dynamicStates;
+
+    VkPipelineViewportStateCreateInfo pipelineViewportStateCreateInfo = {0};
+    pipelineViewportStateCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
+    pipelineViewportStateCreateInfo.viewportCount =  1;
+    pipelineViewportStateCreateInfo.pViewports    = &viewport;
+    pipelineViewportStateCreateInfo.scissorCount  =  1;
+    pipelineViewportStateCreateInfo.pScissors     = &scissor;
+
+    VkPipelineRasterizationStateCreateInfo pipelineRasterizationStateCreateInfo = {0};
+    pipelineRasterizationStateCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
+    pipelineRasterizationStateCreateInfo.depthClampEnable = VK_FALSE; // No shadows for this pipeline.
+    pipelineRasterizationStateCreateInfo.rasterizerDiscardEnable = VK_FALSE; // Please do not discard everything.
+    pipelineRasterizationStateCreateInfo.polygonMode = VK_POLYGON_MODE_FILL; // VK_POLYGON_MODE_LINE and VK_POLYGON_MODE_POINT.
+    pipelineRasterizationStateCreateInfo.lineWidth = 1.0f; // One pixel lines please.
+    pipelineRasterizationStateCreateInfo.cullMode = VK_CULL_MODE_BACK_BIT;//VK_CULL_MODE_BACK_BIT;
+    pipelineRasterizationStateCreateInfo.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
+    pipelineRasterizationStateCreateInfo.depthBiasEnable = VK_FALSE;
+    pipelineRasterizationStateCreateInfo.depthBiasConstantFactor = 0.0f; // OPTIONAL
+    pipelineRasterizationStateCreateInfo.depthBiasClamp = 0.0f; // OPTIONAL
+    pipelineRasterizationStateCreateInfo.depthBiasSlopeFactor = 0.0f; // OPTIONAL
+
+    VkPipelineMultisampleStateCreateInfo pipelineMultisampleStateCreateInfo = {0};
+    pipelineMultisampleStateCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
+    pipelineMultisampleStateCreateInfo.sampleShadingEnable = VK_FALSE;
+    pipelineMultisampleStateCreateInfo.rasterizationSamples = this->vk.mmaa.samples;
+    pipelineMultisampleStateCreateInfo.minSampleShading = 1.0f; // OPTIONAL
+    pipelineMultisampleStateCreateInfo.pSampleMask = NULL; // OPTIONAL
+    pipelineMultisampleStateCreateInfo.alphaToCoverageEnable = VK_FALSE; // OPTIONAL
+    pipelineMultisampleStateCreateInfo.alphaToOneEnable = VK_FALSE; // OPTIONAL
+
+    VkPipelineDepthStencilStateCreateInfo pipelineDepthStencilStateCreateInfo = {0};
+    pipelineDepthStencilStateCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
+    pipelineDepthStencilStateCreateInfo.depthTestEnable = VK_TRUE;
+    pipelineDepthStencilStateCreateInfo.depthWriteEnable = VK_TRUE;
+    pipelineDepthStencilStateCreateInfo.depthCompareOp = VK_COMPARE_OP_GREATER_OR_EQUAL;
+    pipelineDepthStencilStateCreateInfo.depthBoundsTestEnable = VK_FALSE;
+    pipelineDepthStencilStateCreateInfo.minDepthBounds = 0.0f;
+    pipelineDepthStencilStateCreateInfo.maxDepthBounds = 1.0f;
+    pipelineDepthStencilStateCreateInfo.stencilTestEnable = VK_FALSE;
+    // pipelineDepthStencilStateCreateInfo.front = {}; // Optional
+    // pipelineDepthStencilStateCreateInfo.back = {};  // Optional
+
+    VkPipelineColorBlendAttachmentState pipelineColorBlendAttachmentState = {0};
+    pipelineColorBlendAttachmentState.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
+    pipelineColorBlendAttachmentState.blendEnable = VK_FALSE;
+    pipelineColorBlendAttachmentState.srcColorBlendFactor = VK_BLEND_FACTOR_ONE;
+    pipelineColorBlendAttachmentState.dstColorBlendFactor = VK_BLEND_FACTOR_ZERO;
+    pipelineColorBlendAttachmentState.colorBlendOp = VK_BLEND_OP_ADD;
+    pipelineColorBlendAttachmentState.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+    pipelineColorBlendAttachmentState.dstAlphaBlendFactor = VK_BLEND_FACTOR_ZERO;
+    pipelineColorBlendAttachmentState.alphaBlendOp = VK_BLEND_OP_ADD;
+
+    VkPipelineColorBlendStateCreateInfo pipelineColorBlendStateCreateInfo = {0};
+    pipelineColorBlendStateCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
+    pipelineColorBlendStateCreateInfo.logicOpEnable = VK_FALSE;
+    pipelineColorBlendStateCreateInfo.logicOp = VK_LOGIC_OP_COPY; // OPTIONAL
+    pipelineColorBlendStateCreateInfo.attachmentCount = 1;
+    pipelineColorBlendStateCreateInfo.pAttachments = &pipelineColorBlendAttachmentState;
+    pipelineColorBlendStateCreateInfo.blendConstants[0] = 0.0f; // OPTIONAL
+    pipelineColorBlendStateCreateInfo.blendConstants[1] = 0.0f; // OPTIONAL
+    pipelineColorBlendStateCreateInfo.blendConstants[2] = 0.0f; // OPTIONAL
+    pipelineColorBlendStateCreateInfo.blendConstants[3] = 0.0f; // OPTIONAL
+
+    VkGraphicsPipelineCreateInfo graphicsPipelineCreateInfo = {0};
+
+    graphicsPipelineCreateInfo.sType      = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+    graphicsPipelineCreateInfo.stageCount = sizeof(pipelineShaderStageCreateInfos) / sizeof(pipelineShaderStageCreateInfos[0]);
+    graphicsPipelineCreateInfo.pStages    = pipelineShaderStageCreateInfos;
+
+    graphicsPipelineCreateInfo.pVertexInputState   = &pipelineVertexInputStateCreateInfo;
+    graphicsPipelineCreateInfo.pInputAssemblyState = &pipelineInputAssemblyStateCreateInfo;
+    graphicsPipelineCreateInfo.pViewportState      = &pipelineViewportStateCreateInfo;
+    graphicsPipelineCreateInfo.pRasterizationState = &pipelineRasterizationStateCreateInfo;
+    graphicsPipelineCreateInfo.pMultisampleState   = &pipelineMultisampleStateCreateInfo;
+    graphicsPipelineCreateInfo.pDepthStencilState  = &pipelineDepthStencilStateCreateInfo; // OPTIONAL
+    graphicsPipelineCreateInfo.pColorBlendState    = &pipelineColorBlendStateCreateInfo;
+    graphicsPipelineCreateInfo.pDynamicState       = &pipelineDynamicStateInfo;
+
+    graphicsPipelineCreateInfo.layout = this->vk.pipelineLayout;
+
+    graphicsPipelineCreateInfo.renderPass = this->vk.renderPass;
+    graphicsPipelineCreateInfo.subpass    = 0;
+
+    graphicsPipelineCreateInfo.basePipelineHandle = VK_NULL_HANDLE; // OPTIONAL
+    graphicsPipelineCreateInfo.basePipelineIndex  = -1; // OPTIONAL
+
+    VkResult result = vkCreateGraphicsPipelines(this->vk.device, VK_NULL_HANDLE, 1, &graphicsPipelineCreateInfo, NULL, pPipeline);
+
+    if(result != VK_SUCCESS) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "vkCreateGraphicsPipelines creation failed for variant 0x%x with result: %i", variant, result);
+        *pPipeline = VK_NULL_HANDLE;
+        RETURN_RESULT_CODE(VE_ALLOC_GRAPH_PIPELINE_FAILURE, 5)
+    }
+
+    RETURN_RESULT_CODE(VE_SUCCESS, 0)
+}
+
+void v_pipeline_free(Context *this) {
+    // A pipeline that is still compiling cannot be destroyed, so wait for every worker first.
+    for(uint32_t i = 0; i < V_PIPELINE_VARIANT_AMOUNT; i++) {
+        if(this->vk.pipelines.pCompileThreads[i] != NULL)
+            SDL_WaitThread(this->vk.pipelines.pCompileThreads[i], NULL);
+        this->vk.pipelines.pCompileThreads[i] = NULL;
+    }
+
+    for(uint32_t i = 0; i < V_PIPELINE_VARIANT_AMOUNT; i++) {
+        if(this->vk.pipelines.stats.compileMicroseconds[i] != 0)
+            SDL_Log("Pipeline variant 0x%x took %lu us to compile", i, (unsigned long)this->vk.pipelines.stats.compileMicroseconds[i]);
+        if((this->vk.pipelines.stats.fallbackVariants & (1u << i)) != 0)
+            SDL_Log("Pipeline variant 0x%x was drawn with a fallback before it was ready", i);
+
+        vkDestroyPipeline(this->vk.device, this->vk.pipelines.variants[i], NULL);
+        this->vk.pipelines.variants[i] = VK_NULL_HANDLE;
+        SDL_AtomicSet(&this->vk.pipelines.status[i], V_PIPELINE_STATUS_EMPTY);
+    }
+
+    vkDestroyShaderModule(this->vk.device, this->vk.pipelines.vertexShaderModule,   NULL);
+    vkDestroyShaderModule(this->vk.device, this->vk.pipelines.fragmentShaderModule, NULL);
+    vkDestroyShaderModule(this->vk.device, this->vk.pipelines.gpuInstancedShaderModule, NULL);
+    vkDestroyPipelineLayout(this->vk.device, this->vk.pipelineLayout, NULL);
+}
+
+static VkShaderModule allocateShaderModule(Context *this, uint8_t* data, size_t size) {
+    VkShaderModuleCreateInfo shaderModuleCreateInfo = {0};
+    VkShaderModule shaderModule = NULL;
+    VkResult result;
+
+    shaderModuleCreateInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+    shaderModuleCreateInfo.codeSize = size;
+    shaderModuleCreateInfo.pCode = (const uint32_t*)(data);
+
+    result = vkCreateShaderModule(this->vk.device, &shaderModuleCreateInfo, NULL, &shaderModule);
+
+    if(result != VK_SUCCESS) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Shader Module Failed to allocate %i", result);
+
+        if(shaderModule != NULL)
+            vkDestroyShaderModule(this->vk.device, shaderModule, NULL);
+
+        shaderModule = NULL;
+    }
+
+    return shaderModule;
+}
+
+static VEngineResult compileVariant(Context *this, uint32_t variant) {
+    VkPipeline pipeline;
+    Uint64 startCounter = SDL_GetPerformanceCounter();
+
+    VEngineResult returnCode = createPipeline(this, variant, &pipeline);
+
+    if(returnCode.type < 0) {
+        SDL_AtomicSet(&this->vk.pipelines.status[variant], V_PIPELINE_STATUS_FAILED);
+        return returnCode;
+    }
+
+    Uint64 elapsedCounter = SDL_GetPerformanceCounter() - startCounter;
+
+    this->vk.pipelines.stats.compileMicroseconds[variant] = (elapsedCounter * 1000000) / SDL_GetPerformanceFrequency();
+    this->vk.pipelines.variants[variant] = pipeline;
+
+    // Publish the pipeline last. The render thread only reads variants[variant] after it sees this.
+    SDL_AtomicSet(&this->vk.pipelines.status[variant], V_PIPELINE_STATUS_READY);
+
+    SDL_Log("Pipeline variant 0x%x made in %lu us", variant, (unsigned long)this->vk.pipelines.stats.compileMicroseconds[variant]);
+
+    return returnCode;
+}
+
+static int compileWorkerMain(void *pData) {
+    CompileTask task = *(CompileTask*)pData;
+
+    free(pData);
+
+    return compileVariant(task.pContext, task.variant).type;
+}
@@ -0,0 +1,49 @@
+#ifndef V_PIPELINE_29
+#define V_PIPELINE_29
+
+#include "context.h"
+#include "v_results.h"
+#include "v_pipeline_def.h"
+
+/**
+ * Load the shader modules, make the pipeline layout that every pipeline variant shares and compile the fallback pipelines.
+ * @note The fallbacks are V_PIPELINE_DEFAULT_VARIANT with and without V_PIPELINE_COMPRESSED_VERTEX. They are compiled on this thread.
+ * @note maze_gpu_vert.spv is optional. Without it every V_PIPELINE_GPU_INSTANCED variant fails to compile.
+ * @warning Make sure that the render pass and both descriptor set layouts are made first.
+ * @param this The primary Context of the program.
+ * @return A VEngineResult. If its type is VE_SUCCESS then pipeline variants can be made. If VE_ALLOC_GRAPH_PIPELINE_FAILURE then the shaders, the layout or a fallback could not be made.
+ */
+VEngineResult v_pipeline_alloc(Context *this);
+
+/**
+ * Start compiling a pipeline variant on a worker thread. Nothing happens if the variant was already requested.
+ * @note If no thread could be made then the variant is compiled on the calling thread.
+ * @param this The primary Context of the program.
+ * @param variant The VPipelineVariantFlags of the pipeline.
+ */
+void v_pipeline_compile_async(Context *this, uint32_t variant);
+
+/**
+ * @param this The primary Context of the program.
+ * @param variant The VPipelineVariantFlags of the pipeline.
+ * @return 1 if the pipeline of the variant is compiled and can be bound. 0 if otherwise.
+ */
+int v_pipeline_is_ready(Context *this, uint32_t variant);
+
+/**
+ * Get the pipeline to draw a variant with. This never waits for a compilation.
+ * @note If the variant is not ready then its compilation is started and the fallback with the same vertex format is returned.
+ * @warning The fallbacks do not read the instances of V_PIPELINE_GPU_INSTANCED, so check those variants with v_pipeline_is_ready() first.
+ * @param this The primary Context of the program.
+ * @param variant The VPipelineVariantFlags of the pipeline.
+ * @return The pipeline. It belongs to the cache so do not destroy it.
+ */
+VkPipeline v_pipeline_get(Context *this, uint32_t variant);
+
+/**
+ * Wait for the compiling variants, log the compile times and destroy every cached pipeline variant, the shader modules and the pipeline layout.
+ * @param this The primary Context of the program.
+ */
+void v_pipeline_free(Context *this);
+
+#endif // V_PIPELINE_29
@@ -0,0 +1,29 @@
+#ifndef V_PIPELINE_DEF_29
+#define V_PIPELINE_DEF_29
+
+#include <stdint.h>
+
+// Each flag turns on a specialization constant of the shaders. Together they are the key of a pipeline variant.
+typedef enum VPipelineVariantFlags {
+    V_PIPELINE_TEXTURED          = 0x1, // Multiply by the texture at VBufferPushConstantObject::textureIndex.
+    V_PIPELINE_VERTEX_COLOR      = 0x2, // Multiply by the color of the vertices.
+    V_PIPELINE_COMPRESSED_VERTEX = 0x4, // Read VBufferCompressedVertex instead of VBufferVertex.
+    V_PIPELINE_GPU_INSTANCED     = 0x8  // Use maze_gpu.vert, which places the instances that maze_gen.comp wrote. There is no fallback for it.
+} VPipelineVariantFlags;
+
+#define V_PIPELINE_VARIANT_AMOUNT 16
+#define V_PIPELINE_DEFAULT_VARIANT (V_PIPELINE_TEXTURED | V_PIPELINE_VERTEX_COLOR)
+
+typedef enum VPipelineStatus {
+    V_PIPELINE_STATUS_EMPTY     = 0,
+    V_PIPELINE_STATUS_COMPILING = 1,
+    V_PIPELINE_STATUS_READY     = 2,
+    V_PIPELINE_STATUS_FAILED    = 3  // The fallback is drawn with for the rest of the program.
+} VPipelineStatus;
+
+typedef struct VPipelineStats {
+    uint64_t compileMicroseconds[V_PIPELINE_VARIANT_AMOUNT]; // Zero if the variant was never made.
+    uint32_t fallbackVariants; // Bit i is set once variant i has been drawn with a fallback because it was not ready.
+} VPipelineStats;
+
+#endif // V_PIPELINE_DEF_29
@@ -2,7 +2,11 @@
 
 #include "context.h"
 #include "v_init.h"
+#include "v_maze_gpu.h"
 #include "v_model.h"
+#include "v_pipeline.h"
+
+static void recordModel(Context *this, VkCommandBuffer commandBuffer, VModelData *pModelData, unsigned numInstances, VBufferPushConstantObject *pPushConstantObjects, VkPipeline *pBoundPipeline);
 
 VEngineResult v_render_frame(Context *this, float delta) {
     const uint64_t TIME_OUT_NS = 25000000;
@@ -134,8 +138,6 @@ VEngineResult v_render_record_command_buffer(Context *this, VkCommandBuffer comm
 
     vkCmdBeginRenderPass(commandBuffer, &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
 
-    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, this->vk.graphicsPipeline);
-
     VkViewport viewport;
     viewport.x = 0.0f;
     viewport.y = 0.0f;
@@ -153,9 +155,33 @@ VEngineResult v_render_record_command_buffer(Context *this, VkCommandBuffer comm
 
     vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, this->vk.pipelineLayout, 0, 1, &this->vk.frames[this->vk.currentFrame].descriptorSet, 0, NULL);
 
-    for(unsigned m = 0; m < this->vk.modelArrayAmount; m++) {
-        if(this->vk.pVModelArray[m].pModelData != NULL)
-            v_model_draw_record(this, commandBuffer, this->vk.pVModelArray[m].pModelData, this->vk.pVModelArray[m].instanceVector.size, this->vk.pVModelArray[m].instanceVector.pBuffer);
+    VkPipeline boundPipeline = VK_NULL_HANDLE;
+
+    if(this->mazeGpu.instanceDescriptorSet != VK_NULL_HANDLE)
+        v_maze_gpu_draw_record(this, commandBuffer, &boundPipeline);
+    else if(this->mazeStream.regionModelAmount != 0) {
+        // The greedy meshes of the maze replace its instanced pieces. They are already in world space.
+        VBufferPushConstantObject regionInstance;
+        regionInstance.matrix = MatrixIdentity();
+        regionInstance.textureIndex = this->mazeStream.textureIndex;
+
+        for(uint32_t r = 0; r < this->mazeStream.regionModelAmount; r++) {
+            // Regions without a cell that the camera can see are culled by the visible sets.
+            if(this->mazeStream.pRegionsVisible != NULL && this->mazeStream.pRegionsVisible[r] == 0)
+                continue;
+
+            recordModel(this, commandBuffer, &this->mazeStream.pRegionModels[r], 1, &regionInstance, &boundPipeline);
+        }
+    }
+    else {
+        for(unsigned m = 0; m < this->vk.modelArrayAmount; m++) {
+            VModelData *pModelData = this->vk.pVModelArray[m].pModelData;
+
+            if(pModelData == NULL)
+                continue;
+
+            recordModel(this, commandBuffer, pModelData, this->vk.pVModelArray[m].instanceVector.size, this->vk.pVModelArray[m].instanceVector.pBuffer, &boundPipeline);
+        }
     }
 
     vkCmdEndRenderPass(commandBuffer);
@@ -167,3 +193,15 @@ VEngineResult v_render_record_command_buffer(Context *this, VkCommandBuffer comm
     }
     RETURN_RESULT_CODE(VE_SUCCESS, 0)
 }
+
+static void recordModel(Context *this, VkCommandBuffer commandBuffer, VModelData *pModelData, unsigned numInstances, VBufferPushConstantObject *pPushConstantObjects, VkPipeline *pBoundPipeline) {
+    VkPipeline pipeline = v_pipeline_get(this, pModelData->pipelineVariant);
+
+    // Models that share a variant are drawn without binding the pipeline again.
+    if(pipeline != *pBoundPipeline) {
+        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
+        *pBoundPipeline = pipeline;
+    }
+
+    v_model_draw_record(this, commandBuffer, pModelData, numInstances, pPushConstantObjects);
+}
@@ -36,7 +36,10 @@ typedef enum {
     VE_ALLOC_DEFAULT_SAMPLER_FAILURE = -30,
     VE_ALLOC_DEPTH_BUFFER_FAILURE    = -31,
     VE_LOAD_MODEL_FAILURE            = -32,
-    VE_ALLOC_COLOR_BUFFER_FAILURE    = -33
+    VE_ALLOC_COLOR_BUFFER_FAILURE    = -33,
+    VE_GENERATE_MIPMAPS_FAILURE      = -34,
+    VE_REGISTER_TEXTURE_FAILURE      = -35,
+    VE_ALLOC_MAZE_GPU_FAILURE        = -36
 } VEngineResultType;
 
 typedef struct {
@@ -0,0 +1,33 @@
+#include "v_texture.h"
+
+VEngineResult v_texture_register(Context *this, VkImageView imageView, VkSampler sampler, uint32_t *pTextureIndex) {
+    if(this->vk.bindless.amount >= this->vk.bindless.limit) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "v_texture_register: all %u texture slots are taken", this->vk.bindless.limit);
+        RETURN_RESULT_CODE(VE_REGISTER_TEXTURE_FAILURE, 0)
+    }
+
+    VkDescriptorImageInfo descriptorImageInfo;
+    descriptorImageInfo.sampler = sampler;
+    descriptorImageInfo.imageView = imageView;
+    descriptorImageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+    VkWriteDescriptorSet writeDescriptorSets[MAX_FRAMES_IN_FLIGHT] = {{0}};
+
+    for(uint32_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
+        writeDescriptorSets[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        writeDescriptorSets[i].dstSet = this->vk.frames[i].descriptorSet;
+        writeDescriptorSets[i].dstBinding = 1;
+        writeDescriptorSets[i].dstArrayElement = this->vk.bindless.amount;
+        writeDescriptorSets[i].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        writeDescriptorSets[i].descriptorCount = 1;
+        writeDescriptorSets[i].pImageInfo = &descriptorImageInfo;
+    }
+
+    // Slots that are not registered yet are never read, so the partially bound array can be written while in flight.
+    vkUpdateDescriptorSets(this->vk.device, MAX_FRAMES_IN_FLIGHT, writeDescriptorSets, 0, NULL);
+
+    *pTextureIndex = this->vk.bindless.amount;
+    this->vk.bindless.amount++;
+
+    RETURN_RESULT_CODE(VE_SUCCESS, 0)
+}
@@ -0,0 +1,19 @@
+#ifndef V_TEXTURE_29
+#define V_TEXTURE_29
+
+#include "context.h"
+#include "v_results.h"
+
+/**
+ * Write a texture into the next free slot of the texture array at binding 1 for every frame in flight.
+ * @note When bindless is enabled the array is update after bind, so this can be called while the descriptor sets are bound. Otherwise only one texture can be registered.
+ * @warning Make sure that v_init() had allocated the descriptor sets first. The image view and the sampler must outlive the descriptor sets.
+ * @param this The primary Context of the program.
+ * @param imageView The image view in VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL to sample from.
+ * @param sampler The sampler to sample imageView with.
+ * @param pTextureIndex Returns the slot for VBufferPushConstantObject::textureIndex.
+ * @return A VEngineResult. If its type is VE_SUCCESS then the texture is registered. If VE_REGISTER_TEXTURE_FAILURE then every slot is already taken.
+ */
+VEngineResult v_texture_register(Context *this, VkImageView imageView, VkSampler sampler, uint32_t *pTextureIndex);
+
+#endif // V_TEXTURE_29
@@ -0,0 +1,318 @@
+#include "v_world.h"
+
+#include "u_maze.h"
+#include "u_thread.h"
+#include "u_vector.h"
+#include "v_maze.h"
+
+#include "SDL_log.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+static uint32_t hashChunk(uint32_t seed, int32_t x, int32_t y, uint32_t salt);
+static void findCameraChunk(const Context *this, int32_t *pX, int32_t *pY);
+static VWorldChunk* findChunk(Context *this, int32_t x, int32_t y);
+static int isOutside(const VWorldChunk *pChunk, int32_t cameraX, int32_t cameraY, int32_t radius);
+static void startChunk(Context *this, int32_t x, int32_t y);
+static int generateChunkMain(void *pData);
+static int appendChunk(Context *this, VWorldChunk *pChunk);
+static void evictChunk(Context *this, VWorldChunk *pChunk);
+
+void v_world_init(Context *this, uint32_t seed) {
+    memset(&this->world, 0, sizeof(this->world));
+
+    this->world.seed = seed;
+}
+
+void v_world_update(Context *this) {
+    int32_t cameraX, cameraY;
+
+    findCameraChunk(this, &cameraX, &cameraY);
+
+    unsigned generatingAmount = 0;
+
+    // Finish and evict chunks first, so that their slots can be reused this frame.
+    for(unsigned i = 0; i < V_WORLD_MAX_CHUNKS; i++) {
+        VWorldChunk *pChunk = &this->world.chunks[i];
+        int status = SDL_AtomicGet(&pChunk->status);
+
+        if(status == V_WORLD_CHUNK_GENERATING) {
+            generatingAmount++;
+            continue;
+        }
+
+        if(pChunk->pThread != NULL) {
+            SDL_WaitThread(pChunk->pThread, NULL);
+            pChunk->pThread = NULL;
+        }
+
+        if(status == V_WORLD_CHUNK_FAILED) {
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "v_world_update: Chunk (%i, %i) could not be generated", pChunk->x, pChunk->y);
+            SDL_AtomicSet(&pChunk->status, V_WORLD_CHUNK_EMPTY);
+        }
+        else if(status == V_WORLD_CHUNK_GENERATED) {
+            // The camera could have left before the worker was done.
+            if(!isOutside(pChunk, cameraX, cameraY, V_WORLD_EVICT_RADIUS)) {
+                // The chunk stays generated, so that it is appended again next frame.
+                if(!appendChunk(this, pChunk)) {
+                    SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "v_world_update: Out of memory for the instances of chunk (%i, %i)", pChunk->x, pChunk->y);
+                    continue;
+                }
+                SDL_AtomicSet(&pChunk->status, V_WORLD_CHUNK_LOADED);
+            }
+            else
+                SDL_AtomicSet(&pChunk->status, V_WORLD_CHUNK_EMPTY);
+
+            free(pChunk->pInstances);
+            pChunk->pInstances = NULL;
+        }
+        else if(status == V_WORLD_CHUNK_LOADED && isOutside(pChunk, cameraX, cameraY, V_WORLD_EVICT_RADIUS)) {
+            evictChunk(this, pChunk);
+            SDL_AtomicSet(&pChunk->status, V_WORLD_CHUNK_EMPTY);
+        }
+    }
+
+    // Start the missing chunks from the nearest ring outwards, with no more workers than there are cores.
+    const unsigned maxWorkers = u_thread_count();
+
+    for(int32_t ring = 0; ring <= V_WORLD_LOAD_RADIUS; ring++) {
+        for(int32_t y = cameraY - ring; y <= cameraY + ring; y++) {
+            for(int32_t x = cameraX - ring; x <= cameraX + ring; x++) {
+                if(abs(x - cameraX) != ring && abs(y - cameraY) != ring)
+                    continue;
+
+                if(generatingAmount >= maxWorkers)
+                    return;
+
+                if(findChunk(this, x, y) != NULL)
+                    continue;
+
+                startChunk(this, x, y);
+                generatingAmount++;
+            }
+        }
+    }
+}
+
+void v_world_free(Context *this) {
+    for(unsigned i = 0; i < V_WORLD_MAX_CHUNKS; i++) {
+        VWorldChunk *pChunk = &this->world.chunks[i];
+
+        if(pChunk->pThread != NULL)
+            SDL_WaitThread(pChunk->pThread, NULL);
+        pChunk->pThread = NULL;
+
+        free(pChunk->pInstances);
+        pChunk->pInstances = NULL;
+
+        SDL_AtomicSet(&pChunk->status, V_WORLD_CHUNK_EMPTY);
+    }
+
+    SDL_Log("World: %lu chunks generated, %lu chunks evicted", (unsigned long)this->world.stats.chunksGenerated, (unsigned long)this->world.stats.chunksEvicted);
+}
+
+static uint32_t hashChunk(uint32_t seed, int32_t x, int32_t y, uint32_t salt) {
+    uint32_t n = seed ^ ((uint32_t)x * 0x9e3779b9) ^ ((uint32_t)y * 0x85ebca6b) ^ (salt * 0xc2b2ae35);
+
+    n ^= n >> 16;
+    n *= 0x7feb352d;
+    n ^= n >> 15;
+    n *= 0x846ca68b;
+    n ^= n >> 16;
+
+    return n;
+}
+
+static void findCameraChunk(const Context *this, int32_t *pX, int32_t *pY) {
+    // The model view translates by position, so the camera is at -position. Cells are two units apart.
+    *pX = floorf((-this->position.x / 2.0f + 0.5f) / V_WORLD_CHUNK_SIZE);
+    *pY = floorf((-this->position.y / 2.0f + 0.5f) / V_WORLD_CHUNK_SIZE);
+}
+
+static VWorldChunk* findChunk(Context *this, int32_t x, int32_t y) {
+    for(unsigned i = 0; i < V_WORLD_MAX_CHUNKS; i++) {
+        VWorldChunk *pChunk = &this->world.chunks[i];
+
+        if(SDL_AtomicGet(&pChunk->status) != V_WORLD_CHUNK_EMPTY && pChunk->x == x && pChunk->y == y)
+            return pChunk;
+    }
+    return NULL;
+}
+
+static int isOutside(const VWorldChunk *pChunk, int32_t cameraX, int32_t cameraY, int32_t radius) {
+    return abs(pChunk->x - cameraX) > radius || abs(pChunk->y - cameraY) > radius;
+}
+
+static void startChunk(Context *this, int32_t x, int32_t y) {
+    VWorldChunk *pChunk = NULL;
+
+    for(unsigned i = 0; i < V_WORLD_MAX_CHUNKS && pChunk == NULL; i++) {
+        if(SDL_AtomicGet(&this->world.chunks[i].status) == V_WORLD_CHUNK_EMPTY && this->world.chunks[i].pThread == NULL)
+            pChunk = &this->world.chunks[i];
+    }
+
+    if(pChunk == NULL)
+        return;
+
+    pChunk->x = x;
+    pChunk->y = y;
+    pChunk->seed = this->world.seed;
+    pChunk->textureIndex = this->vk.texture.index;
+    pChunk->pInstances = NULL;
+
+    SDL_AtomicSet(&pChunk->status, V_WORLD_CHUNK_GENERATING);
+
+    this->world.stats.chunksGenerated++;
+
+    pChunk->pThread = SDL_CreateThread(generateChunkMain, "v_world_chunk", pChunk);
+
+    if(pChunk->pThread == NULL) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "v_world_update: SDL_CreateThread failed due to %s", SDL_GetError());
+
+        // The chunk is still made, just on this thread. It is appended next frame.
+        generateChunkMain(pChunk);
+    }
+}
+
+static int generateChunkMain(void *pData) {
+    VWorldChunk *pChunk = pData;
+    const uint32_t SIZE = V_WORLD_CHUNK_SIZE;
+
+    UMazeCompactGenResult mazeGenResult = {0};
+
+    // The inside of every chunk is its own maze. Only the seed of the world and the chunk coordinates decide it.
+    if(!u_maze_gen_sq_grid(&mazeGenResult, SIZE, SIZE, hashChunk(pChunk->seed, pChunk->x, pChunk->y, 2) | 1, 0)) {
+        u_maze_compact_delete_result(&mazeGenResult);
+        SDL_AtomicSet(&pChunk->status, V_WORLD_CHUNK_FAILED);
+        return 0;
+    }
+
+    // The openings of the chunk with an extra column to the west and an extra row to the north for the openings of the neighboring chunks.
+    // So the cells on the border are classified like any other cell.
+    const uint32_t STRIDE = SIZE + 1;
+    uint8_t cells[(V_WORLD_CHUNK_SIZE + 1) * (V_WORLD_CHUNK_SIZE + 1)] = {0};
+
+    for(uint32_t l = 0; l < mazeGenResult.linkAmount; l++) {
+        uint32_t v = mazeGenResult.pLinks[l].vertexIndex[0];
+        uint32_t neighbor = mazeGenResult.pLinks[l].vertexIndex[1];
+
+        if(v > neighbor) {
+            const uint32_t swap = v;
+            v = neighbor;
+            neighbor = swap;
+        }
+
+        cells[(v / SIZE + 1) * STRIDE + v % SIZE + 1] |= neighbor == v + 1 ? U_MAZE_CELL_EAST : U_MAZE_CELL_SOUTH;
+    }
+
+    u_maze_compact_delete_result(&mazeGenResult);
+
+    // Each border opens at one cell. Both chunks on a border hash the same coordinates, so they agree on where it is.
+    const uint32_t eastRow     = hashChunk(pChunk->seed, pChunk->x,     pChunk->y,     0) % SIZE;
+    const uint32_t westRow     = hashChunk(pChunk->seed, pChunk->x - 1, pChunk->y,     0) % SIZE;
+    const uint32_t southColumn = hashChunk(pChunk->seed, pChunk->x,     pChunk->y,     1) % SIZE;
+    const uint32_t northColumn = hashChunk(pChunk->seed, pChunk->x,     pChunk->y - 1, 1) % SIZE;
+
+    cells[(eastRow + 1) * STRIDE + SIZE]  |= U_MAZE_CELL_EAST;
+    cells[(westRow + 1) * STRIDE]         |= U_MAZE_CELL_EAST;
+    cells[SIZE * STRIDE + southColumn + 1] |= U_MAZE_CELL_SOUTH;
+    cells[northColumn + 1]                 |= U_MAZE_CELL_SOUTH;
+
+    // The chunk is the cells from (1, 1) of the padded grid, so its first cell is at chunk x * SIZE in the world.
+    VMazeInstanceBuild build = {0};
+    build.pCells = cells;
+    build.stride = STRIDE;
+    build.firstX = 1;
+    build.firstY = 1;
+    build.cellsWide = SIZE;
+    build.cellsDeep = SIZE;
+    build.originX = (float)pChunk->x * SIZE - 1;
+    build.originY = (float)pChunk->y * SIZE - 1;
+    build.textureIndex = pChunk->textureIndex;
+
+    if(!v_maze_instances_classify(&build)) {
+        SDL_AtomicSet(&pChunk->status, V_WORLD_CHUNK_FAILED);
+        return 0;
+    }
+
+    pChunk->pInstances = malloc(SIZE * SIZE * sizeof(VBufferPushConstantObject));
+
+    if(pChunk->pInstances == NULL) {
+        v_maze_instances_free(&build);
+        SDL_AtomicSet(&pChunk->status, V_WORLD_CHUNK_FAILED);
+        return 0;
+    }
+
+    VBufferPushConstantObject *ppDestinations[V_MAZE_PIECE_AMOUNT];
+    uint32_t offset = 0;
+
+    for(unsigned p = 0; p < V_MAZE_PIECE_AMOUNT; p++) {
+        pChunk->instanceOffsets[p] = offset;
+        pChunk->instanceAmounts[p] = build.pieceAmounts[p];
+        ppDestinations[p] = &pChunk->pInstances[offset];
+        offset += build.pieceAmounts[p];
+    }
+
+    v_maze_instances_scatter(&build, ppDestinations);
+
+    // Publish the instances last. The main thread only reads them after it sees this.
+    SDL_AtomicSet(&pChunk->status, V_WORLD_CHUNK_GENERATED);
+
+    return 1;
+}
+
+static int appendChunk(Context *this, VWorldChunk *pChunk) {
+    size_t oldSizes[V_MAZE_PIECE_AMOUNT];
+
+    // Grow every vector first, so that a failure leaves the vectors and the chunk as they were.
+    for(unsigned p = 0; p < V_MAZE_PIECE_AMOUNT; p++) {
+        UVector *pVector = &this->vk.pVModelArray[p].instanceVector;
+
+        oldSizes[p] = pVector->size;
+
+        if(pChunk->instanceAmounts[p] != 0 && !u_vector_scale(pVector, oldSizes[p] + pChunk->instanceAmounts[p])) {
+            for(unsigned i = 0; i < p; i++)
+                u_vector_scale(&this->vk.pVModelArray[i].instanceVector, oldSizes[i]);
+            return 0;
+        }
+    }
+
+    for(unsigned p = 0; p < V_MAZE_PIECE_AMOUNT; p++) {
+        UVector *pVector = &this->vk.pVModelArray[p].instanceVector;
+
+        if(pChunk->instanceAmounts[p] != 0)
+            memcpy((VBufferPushConstantObject*)pVector->pBuffer + oldSizes[p], &pChunk->pInstances[pChunk->instanceOffsets[p]], pChunk->instanceAmounts[p] * sizeof(VBufferPushConstantObject));
+
+        pChunk->instanceOffsets[p] = oldSizes[p];
+    }
+
+    return 1;
+}
+
+static void evictChunk(Context *this, VWorldChunk *pChunk) {
+    for(unsigned p = 0; p < V_MAZE_PIECE_AMOUNT; p++) {
+        if(pChunk->instanceAmounts[p] == 0)
+            continue;
+
+        UVector *pVector = &this->vk.pVModelArray[p].instanceVector;
+        VBufferPushConstantObject *pInstances = pVector->pBuffer;
+
+        const uint32_t offset = pChunk->instanceOffsets[p];
+        const uint32_t amount = pChunk->instanceAmounts[p];
+
+        // Close the gap. The chunks after it move down, so their offsets do as well.
+        memmove(&pInstances[offset], &pInstances[offset + amount], (pVector->size - offset - amount) * sizeof(VBufferPushConstantObject));
+
+        for(unsigned i = 0; i < V_WORLD_MAX_CHUNKS; i++) {
+            VWorldChunk *pOther = &this->world.chunks[i];
+
+            if(SDL_AtomicGet(&pOther->status) == V_WORLD_CHUNK_LOADED && pOther->instanceOffsets[p] > offset)
+                pOther->instanceOffsets[p] -= amount;
+        }
+
+        u_vector_scale(pVector, pVector->size - amount);
+    }
+
+    this->world.stats.chunksEvicted++;
+}
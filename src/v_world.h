@@ -0,0 +1,28 @@
+#ifndef V_WORLD_29
+#define V_WORLD_29
+
+#include "context.h"
+#include "v_world_def.h"
+
+/**
+ * Start an empty chunked maze world. Chunks are only made by v_world_update().
+ * @warning this->vk.pVModelArray must already hold V_MAZE_PIECE_AMOUNT model arrays in piece order.
+ * @param this The primary Context of the program.
+ * @param seed Every chunk and every border between chunks is derived from this seed.
+ */
+void v_world_init(Context *this, uint32_t seed);
+
+/**
+ * Stream chunks around the camera. Missing chunks in V_WORLD_LOAD_RADIUS are started on worker threads, finished chunks are appended to the instance vectors and chunks outside V_WORLD_EVICT_RADIUS are removed from them.
+ * @note Call this once a frame before the command buffer is recorded. It never waits for a worker.
+ * @param this The primary Context of the program.
+ */
+void v_world_update(Context *this);
+
+/**
+ * Wait for every worker and free the chunks. The instance vectors are left to v_init_dealloc().
+ * @param this The primary Context of the program.
+ */
+void v_world_free(Context *this);
+
+#endif // V_WORLD_29
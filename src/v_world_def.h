@@ -0,0 +1,48 @@
+#ifndef V_WORLD_DEF_29
+#define V_WORLD_DEF_29
+
+#include "SDL_atomic.h"
+#include "SDL_thread.h"
+
+#include "v_buffer_def.h"
+#include "v_maze_def.h"
+
+#define V_WORLD_CHUNK_SIZE   16 // The width and depth of a chunk in maze cells.
+#define V_WORLD_LOAD_RADIUS   2 // Chunks within this many chunks of the camera are generated.
+#define V_WORLD_EVICT_RADIUS  3 // Chunks further than this are evicted. The gap keeps chunks on a border from being regenerated over and over.
+#define V_WORLD_MAX_CHUNKS  ((2 * V_WORLD_EVICT_RADIUS + 1) * (2 * V_WORLD_EVICT_RADIUS + 1))
+
+typedef enum VWorldChunkStatus {
+    V_WORLD_CHUNK_EMPTY      = 0,
+    V_WORLD_CHUNK_GENERATING = 1, // A worker thread owns pInstances.
+    V_WORLD_CHUNK_GENERATED  = 2, // pInstances is ready to be appended to the instance vectors.
+    V_WORLD_CHUNK_LOADED     = 3, // The instances are in the instance vectors.
+    V_WORLD_CHUNK_FAILED     = 4
+} VWorldChunkStatus;
+
+typedef struct VWorldChunk {
+    int32_t x; // In chunk units.
+    int32_t y;
+    SDL_atomic_t status; // VWorldChunkStatus
+    SDL_Thread *pThread;
+
+    uint32_t seed;
+    uint32_t textureIndex;
+
+    VBufferPushConstantObject *pInstances; // Grouped by piece. Only valid while the chunk is generated.
+    uint32_t instanceOffsets[V_MAZE_PIECE_AMOUNT]; // Where the instances of each piece start in pInstances, and later in the instance vector.
+    uint32_t instanceAmounts[V_MAZE_PIECE_AMOUNT];
+} VWorldChunk;
+
+typedef struct VWorldStats {
+    uint64_t chunksGenerated;
+    uint64_t chunksEvicted;
+} VWorldStats;
+
+typedef struct VWorld {
+    uint32_t seed;
+    VWorldChunk chunks[V_WORLD_MAX_CHUNKS];
+    VWorldStats stats;
+} VWorld;
+
+#endif // V_WORLD_DEF_29
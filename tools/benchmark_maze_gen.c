@@ -0,0 +1,100 @@
+#include "u_maze.h"
+
+#include "SDL.h"
+
+#include <stdlib.h>
+
+// Compare the square grid maze generators, so that the fastest one can be picked for a grid size.
+// Usage: benchmark-maze-gen [grid size]...
+
+typedef int (*MazeGenerator)(UMazeCompactGenResult *pMazeGenResult, uint32_t width, uint32_t depth, uint32_t seed, int genVertexGrid);
+
+static uint32_t findRoot(uint32_t *pParents, uint32_t vertex) {
+    while(pParents[vertex] != vertex) {
+        pParents[vertex] = pParents[pParents[vertex]];
+        vertex = pParents[vertex];
+    }
+    return vertex;
+}
+
+// A perfect maze has exactly vertexAmount - 1 links between neighbors and no cycles.
+static int isPerfectMaze(const UMazeCompactGenResult *pMaze, uint32_t size) {
+    uint32_t vertexAmount = size * size;
+
+    if(pMaze->linkAmount != vertexAmount - 1)
+        return 0;
+
+    uint32_t *pParents = malloc(sizeof(uint32_t) * vertexAmount);
+
+    if(pParents == NULL)
+        return 0;
+
+    for(uint32_t v = 0; v < vertexAmount; v++)
+        pParents[v] = v;
+
+    int perfect = 1;
+
+    for(uint32_t l = 0; perfect && l < pMaze->linkAmount; l++) {
+        uint32_t a = pMaze->pLinks[l].vertexIndex[0];
+        uint32_t b = pMaze->pLinks[l].vertexIndex[1];
+        uint32_t distance = a > b ? a - b : b - a;
+
+        if(a >= vertexAmount || b >= vertexAmount || (distance != 1 && distance != size) || (distance == 1 && a / size != b / size)) {
+            perfect = 0;
+            break;
+        }
+
+        a = findRoot(pParents, a);
+        b = findRoot(pParents, b);
+
+        if(a == b)
+            perfect = 0;
+        pParents[a] = b;
+    }
+
+    free(pParents);
+
+    return perfect;
+}
+
+int main(int argc, char **argv) {
+    const uint32_t defaultSizes[] = {64, 256, 1024, 2048};
+    const char *const names[] = {"frontier", "kruskal", "wilson"};
+    const MazeGenerator generators[] = {u_maze_gen_sq_grid, u_maze_gen_sq_grid_kruskal, u_maze_gen_sq_grid_wilson};
+    const unsigned generatorAmount = sizeof(generators) / sizeof(generators[0]);
+
+    unsigned sizeAmount = argc > 1 ? (unsigned)(argc - 1) : sizeof(defaultSizes) / sizeof(defaultSizes[0]);
+    int allPerfect = 1;
+
+    for(unsigned s = 0; s < sizeAmount; s++) {
+        uint32_t size = argc > 1 ? (uint32_t)strtoul(argv[s + 1], NULL, 10) : defaultSizes[s];
+
+        if(size < 2 || size > 65535) {
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s is not a grid size from 2 to 65535", argv[s + 1]);
+            return 1;
+        }
+
+        for(unsigned g = 0; g < generatorAmount; g++) {
+            UMazeCompactGenResult maze;
+
+            Uint64 start = SDL_GetPerformanceCounter();
+            int generated = generators[g](&maze, size, size, 555, 0);
+            double milliseconds = 1000.0 * (double)(SDL_GetPerformanceCounter() - start) / (double)SDL_GetPerformanceFrequency();
+
+            if(!generated) {
+                SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%ux%u %s failed", size, size, names[g]);
+                allPerfect = 0;
+                continue;
+            }
+
+            int perfect = isPerfectMaze(&maze, size);
+            allPerfect &= perfect;
+
+            SDL_Log("%ux%u %-8s %10.3f ms %8.2f Mvertices/s %s", size, size, names[g], milliseconds, (double)size * size / (milliseconds * 1000.0), perfect ? "perfect" : "NOT PERFECT");
+
+            u_maze_compact_delete_result(&maze);
+        }
+    }
+
+    return allPerfect ? 0 : 1;
+}
@@ -0,0 +1,127 @@
+#include "u_maze.h"
+#include "u_path.h"
+#include "u_random.h"
+
+#include "SDL.h"
+
+#include <stdlib.h>
+
+// Compare hierarchical pathfinding (HPA*) against flat A* on square grid mazes.
+// Usage: benchmark-path [grid size]...
+// The vertex grid of a maze takes about 24 bytes per cell while it is generated, so 16384x16384 needs about 6 GiB.
+
+#define HPA_QUERIES  256
+#define FLAT_QUERIES  16 // Flat A* searches most of a large maze per query, so it gets fewer queries.
+
+static double elapsedMilliseconds(Uint64 start) {
+    return 1000.0 * (double)(SDL_GetPerformanceCounter() - start) / (double)SDL_GetPerformanceFrequency();
+}
+
+static int benchmarkSize(uint32_t size) {
+    UMazeCompactGenResult maze;
+
+    Uint64 start = SDL_GetPerformanceCounter();
+
+    if(!u_maze_gen_sq_grid(&maze, size, size, 555, 1)) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%ux%u: The maze could not be generated", size, size);
+        return 0;
+    }
+
+    // Only the vertex grid is searched.
+    free(maze.pLinks);
+    maze.pLinks = NULL;
+    maze.linkAmount = 0;
+
+    SDL_Log("%ux%u: Generated in %.1f ms", size, size, elapsedMilliseconds(start));
+
+    const UMazeCompactData *pGraph = &maze.vertexMazeData;
+    UPathHPA hpa;
+
+    start = SDL_GetPerformanceCounter();
+
+    if(!u_path_hpa_build(&hpa, pGraph, U_PATH_DEFAULT_CLUSTER_SIZE)) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%ux%u: The abstract graph could not be built", size, size);
+        u_maze_compact_delete_result(&maze);
+        return 0;
+    }
+
+    SDL_Log("%ux%u: HPA* built in %.1f ms with %u nodes and %u edges", size, size, elapsedMilliseconds(start), hpa.nodeAmount, hpa.edgeAmount);
+
+    uint32_t starts[HPA_QUERIES];
+    uint32_t goals[HPA_QUERIES];
+    UPath paths[HPA_QUERIES];
+    URandom random;
+
+    u_random_seed(&random, size);
+
+    for(unsigned q = 0; q < HPA_QUERIES; q++) {
+        starts[q] = u_random_range(&random, pGraph->vertexAmount);
+        goals[q]  = u_random_range(&random, pGraph->vertexAmount);
+    }
+
+    int correct = 1;
+    uint64_t pathVertices = 0;
+
+    start = SDL_GetPerformanceCounter();
+    for(unsigned q = 0; q < HPA_QUERIES; q++)
+        correct &= u_path_hpa_find(&hpa, &paths[q], starts[q], goals[q]);
+    double hpaTime = elapsedMilliseconds(start) / HPA_QUERIES;
+
+    for(unsigned q = 0; q < HPA_QUERIES; q++)
+        pathVertices += paths[q].length;
+
+    // The batch has to agree with the single queries.
+    UPath batchPaths[HPA_QUERIES];
+
+    start = SDL_GetPerformanceCounter();
+    correct &= u_path_hpa_find_batch(&hpa, batchPaths, starts, goals, HPA_QUERIES) == HPA_QUERIES;
+    double batchTime = elapsedMilliseconds(start) / HPA_QUERIES;
+
+    for(unsigned q = 0; q < HPA_QUERIES; q++) {
+        correct &= batchPaths[q].length == paths[q].length;
+        u_path_delete(&batchPaths[q]);
+    }
+
+    // A perfect maze has one path between two cells, so both searches must find the same length.
+    start = SDL_GetPerformanceCounter();
+    for(unsigned q = 0; q < FLAT_QUERIES; q++) {
+        UPath flatPath;
+
+        correct &= u_path_find(&flatPath, pGraph, starts[q], goals[q]);
+        correct &= flatPath.length == paths[q].length;
+
+        u_path_delete(&flatPath);
+    }
+    double flatTime = elapsedMilliseconds(start) / FLAT_QUERIES;
+
+    for(unsigned q = 0; q < HPA_QUERIES; q++)
+        u_path_delete(&paths[q]);
+
+    SDL_Log("%ux%u: A* %.3f ms, HPA* %.3f ms (%.1fx), HPA* batch %.3f ms per query. Average path of %lu vertices. %s",
+        size, size, flatTime, hpaTime, flatTime / hpaTime, batchTime, (unsigned long)(pathVertices / HPA_QUERIES), correct ? "Paths match" : "PATHS DO NOT MATCH");
+
+    u_path_hpa_free(&hpa);
+    u_maze_compact_delete_result(&maze);
+
+    return correct;
+}
+
+int main(int argc, char **argv) {
+    const uint32_t defaultSizes[] = {1024, 2048, 4096, 8192, 16384};
+
+    unsigned sizeAmount = argc > 1 ? (unsigned)(argc - 1) : sizeof(defaultSizes) / sizeof(defaultSizes[0]);
+    int allCorrect = 1;
+
+    for(unsigned s = 0; s < sizeAmount; s++) {
+        uint32_t size = argc > 1 ? (uint32_t)strtoul(argv[s + 1], NULL, 10) : defaultSizes[s];
+
+        if(size < 2 || size > 65535) {
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s is not a grid size from 2 to 65535", argv[s + 1]);
+            return 1;
+        }
+
+        allCorrect &= benchmarkSize(size);
+    }
+
+    return allCorrect ? 0 : 1;
+}
@@ -0,0 +1,126 @@
+#include "u_read.h"
+#include "u_thread.h"
+
+#include "SDL.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+// Compare the allocation free and batched QOI decoders against the reference qoi_decode().
+// Usage: benchmark-qoi [path to QOI image] [runs]
+
+static double elapsedMilliseconds(Uint64 start) {
+    return 1000.0 * (double)(SDL_GetPerformanceCounter() - start) / (double)SDL_GetPerformanceFrequency();
+}
+
+int main(int argc, char **argv) {
+    const char *pPath = "assets/textures/fractal.qoi";
+    unsigned runs = 20;
+
+    if(argc > 1)
+        pPath = argv[1];
+    if(argc > 2 && atoi(argv[2]) > 0)
+        runs = atoi(argv[2]);
+
+    int64_t fileSize;
+    uint8_t *pFile = u_read_file(pPath, &fileSize);
+
+    if(pFile == NULL) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Cannot read \"%s\"", pPath);
+        return 1;
+    }
+
+    qoi_desc description;
+    uint8_t *pReference = qoi_decode(pFile, (int)fileSize, &description, 4);
+
+    if(pReference == NULL) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "\"%s\" is not a QOI image", pPath);
+        free(pFile);
+        return 1;
+    }
+
+    // Decode the same image once per thread so that the batch has as much work as the threads can take.
+    unsigned imageAmount = u_thread_count();
+    size_t pixelsSize = 4 * (size_t)description.width * description.height;
+    uint8_t *pPixels = malloc(pixelsSize * imageAmount);
+    const char **ppPaths = malloc(sizeof(const char*) * imageAmount);
+    void **ppDestinations = malloc(sizeof(void*) * imageAmount);
+    size_t *pDestinationSizes = malloc(sizeof(size_t) * imageAmount);
+    qoi_desc *pDescs = malloc(sizeof(qoi_desc) * imageAmount);
+
+    if(pPixels == NULL || ppPaths == NULL || ppDestinations == NULL || pDestinationSizes == NULL || pDescs == NULL) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Out of memory for %u images of %ux%u", imageAmount, description.width, description.height);
+        free(pDescs);
+        free(pDestinationSizes);
+        free(ppDestinations);
+        free(ppPaths);
+        free(pPixels);
+        free(pReference);
+        free(pFile);
+        return 1;
+    }
+
+    for(unsigned i = 0; i < imageAmount; i++) {
+        ppPaths[i] = pPath;
+        ppDestinations[i] = pPixels + pixelsSize * i;
+        pDestinationSizes[i] = pixelsSize;
+    }
+
+    double referenceTime = 1.0e9, directTime = 1.0e9, sequentialTime = 1.0e9, batchTime = 1.0e9;
+    int identical = 1;
+
+    for(unsigned r = 0; r < runs; r++) {
+        Uint64 start = SDL_GetPerformanceCounter();
+        void *pDecoded = qoi_decode(pFile, (int)fileSize, &description, 4);
+        double time = elapsedMilliseconds(start);
+        free(pDecoded);
+        if(time < referenceTime)
+            referenceTime = time;
+
+        start = SDL_GetPerformanceCounter();
+        identical &= u_read_qoi_decode(pFile, fileSize, &pDescs[0], pPixels, pixelsSize);
+        time = elapsedMilliseconds(start);
+        if(time < directTime)
+            directTime = time;
+
+        identical &= memcmp(pReference, pPixels, pixelsSize) == 0;
+
+        // What the loader did before: read and decode every image one after another, then copy it into the staging memory.
+        start = SDL_GetPerformanceCounter();
+        for(unsigned i = 0; i < imageAmount; i++) {
+            pDecoded = u_read_qoi(pPath, &pDescs[i], 4);
+            if(pDecoded != NULL)
+                memcpy(ppDestinations[i], pDecoded, pixelsSize);
+            free(pDecoded);
+        }
+        time = elapsedMilliseconds(start);
+        if(time < sequentialTime)
+            sequentialTime = time;
+
+        memset(pPixels, 0, pixelsSize * imageAmount);
+
+        start = SDL_GetPerformanceCounter();
+        identical &= u_read_qoi_batch(ppPaths, imageAmount, pDescs, (void *const *)ppDestinations, pDestinationSizes);
+        time = elapsedMilliseconds(start);
+        if(time < batchTime)
+            batchTime = time;
+
+        for(unsigned i = 0; i < imageAmount; i++)
+            identical &= memcmp(pReference, ppDestinations[i], pixelsSize) == 0;
+    }
+
+    SDL_Log("%s: %ux%u, best of %u runs", pPath, description.width, description.height, runs);
+    SDL_Log("One image: qoi_decode %.3f ms, u_read_qoi_decode %.3f ms (%.2fx)", referenceTime, directTime, referenceTime / directTime);
+    SDL_Log("%u images: u_read_qoi in sequence %.3f ms, u_read_qoi_batch %.3f ms (%.2fx)", imageAmount, sequentialTime, batchTime, sequentialTime / batchTime);
+    SDL_Log("Pixels match qoi_decode: %s", identical ? "yes" : "NO");
+
+    free(pDescs);
+    free(pDestinationSizes);
+    free(ppDestinations);
+    free(ppPaths);
+    free(pPixels);
+    free(pReference);
+    free(pFile);
+
+    return identical ? 0 : 1;
+}